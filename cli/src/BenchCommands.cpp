@@ -0,0 +1,882 @@
+/*
+ * BenchCommands.cpp - implementation of BenchCommands class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QPointer>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <ctime>
+#include <numeric>
+
+#include "AuthenticationManager.h"
+#include "BenchCommands.h"
+#include "ComputerControlInterface.h"
+#include "CryptoCore.h"
+#include "FeatureManager.h"
+#include "VeyonConfiguration.h"
+#include "VeyonConnection.h"
+#include "VeyonWorkerInterface.h"
+
+
+// stands in for the worker process the demo server usually runs in
+class BenchDemoWorker : public VeyonWorkerInterface
+{
+public:
+	bool sendFeatureMessageReply( const FeatureMessage& reply ) override
+	{
+		Q_UNUSED(reply)
+		return true;
+	}
+
+	void stopFeatureWorker( const QUuid& featureUid ) override
+	{
+		Q_UNUSED(featureUid)
+	}
+
+} ;
+
+
+BenchCommands::BenchCommands( QObject* parent ) :
+	QObject( parent ),
+	m_commands( {
+		{ QStringLiteral("monitoring"), tr( "Monitor simulated computers with thumbnail-sized screens" ) },
+		{ QStringLiteral("fullscreen"), tr( "Receive full-resolution screens from simulated computers like remote views do" ) },
+		{ QStringLiteral("filetransfer"), tr( "Send data to simulated computers like a file transfer does" ) },
+		{ QStringLiteral("demo"), tr( "Broadcast the screen of a simulated computer through a demo server to clients" ) },
+		} )
+{
+}
+
+
+
+BenchCommands::~BenchCommands()
+{
+	stopServers();
+}
+
+
+
+QStringList BenchCommands::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString BenchCommands::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult BenchCommands::handle_monitoring( const QStringList& arguments )
+{
+	int clientCount = 0;
+	int duration = 0;
+	BenchServer::Parameters parameters;
+
+	if( parseServerArguments( arguments, clientCount, duration, parameters ) == false )
+	{
+		error( tr( "Usage: %1" ).arg( QStringLiteral("monitoring [CLIENTS=100] [SECONDS=30] [WIDTHxHEIGHT=1920x1080] [CHANGES/s=5]") ) );
+		return InvalidArguments;
+	}
+
+	if( initializeCredentials() == false || startServers( clientCount, parameters ) == false )
+	{
+		stopServers();
+		return Failed;
+	}
+
+	const QSize thumbnailSize( ThumbnailWidth, ThumbnailWidth * parameters.resolution.height() / parameters.resolution.width() );
+
+	const auto begin = resourceUsage();
+
+	QElapsedTimer connectTimer;
+	connectTimer.start();
+
+	ComputerControlInterfaceList interfaces;
+	interfaces.reserve( m_servers.size() );
+
+	for( auto server : qAsConst(m_servers) )
+	{
+		auto controlInterface = ComputerControlInterface::Pointer::create(
+									Computer( NetworkObject::Uid::createUuid(),
+											  QStringLiteral("bench-%1").arg( server->port() ),
+											  QStringLiteral("127.0.0.1:%1").arg( server->port() ) ) );
+		connect( controlInterface.data(), &ComputerControlInterface::scaledScreenUpdated, this,
+				 [this, server]() { recordFrame( server ); } );
+		controlInterface->start( thumbnailSize, ComputerControlInterface::UpdateMode::Monitoring );
+		interfaces.append( controlInterface );
+	}
+
+	const auto connectedClients = waitForConnections( clientCount, [&interfaces]() {
+		return int( std::count_if( interfaces.begin(), interfaces.end(), []( const ComputerControlInterface::Pointer& controlInterface ) {
+			return controlInterface->state() == ComputerControlInterface::State::Connected; } ) );
+	} );
+	const auto connectTime = connectTimer.elapsed();
+
+	const auto serverBytes = sentServerBytes();
+	QElapsedTimer measureTimer;
+	measureTimer.start();
+
+	runFor( duration * 1000 );
+
+	const auto elapsed = measureTimer.elapsed();
+	const auto end = resourceUsage();
+
+	printReport( tr( "Monitoring (%1 thumbnails)" ).arg( clientCount ), elapsed, clientCount, connectedClients, connectTime,
+				 sentServerBytes() - serverBytes, begin, end );
+
+	QVector<QPointer<VncConnection>> vncConnections;
+	for( const auto& controlInterface : qAsConst(interfaces) )
+	{
+		vncConnections.append( controlInterface->connection() ? controlInterface->connection()->vncConnection() : nullptr );
+	}
+
+	interfaces.clear();
+	waitForShutdown( vncConnections );
+
+	stopServers();
+
+	return connectedClients == clientCount ? NoResult : Failed;
+}
+
+
+
+CommandLinePluginInterface::RunResult BenchCommands::handle_fullscreen( const QStringList& arguments )
+{
+	int clientCount = 0;
+	int duration = 0;
+	BenchServer::Parameters parameters;
+
+	if( parseServerArguments( arguments, clientCount, duration, parameters ) == false )
+	{
+		error( tr( "Usage: %1" ).arg( QStringLiteral("fullscreen [CLIENTS=100] [SECONDS=30] [WIDTHxHEIGHT=1920x1080] [CHANGES/s=5]") ) );
+		return InvalidArguments;
+	}
+
+	if( initializeCredentials() == false || startServers( clientCount, parameters ) == false )
+	{
+		stopServers();
+		return Failed;
+	}
+
+	const auto begin = resourceUsage();
+
+	QElapsedTimer connectTimer;
+	connectTimer.start();
+
+	QVector<QPointer<VncConnection>> vncConnections;
+	QVector<VeyonConnection *> connections;
+	vncConnections.reserve( m_servers.size() );
+	connections.reserve( m_servers.size() );
+
+	for( auto server : qAsConst(m_servers) )
+	{
+		auto vncConnection = new VncConnection;
+		vncConnection->setHost( QStringLiteral("127.0.0.1:%1").arg( server->port() ) );
+		vncConnection->setQuality( VncConnection::Quality::Default );
+
+		// framebufferUpdateComplete is emitted in the connection's thread and therefore queued
+		connect( vncConnection, &VncConnection::framebufferUpdateComplete, this,
+				 [this, server]() { recordFrame( server ); } );
+
+		connections.append( new VeyonConnection( vncConnection ) );
+		vncConnections.append( vncConnection );
+
+		vncConnection->start();
+	}
+
+	const auto connectedClients = waitForConnections( clientCount, [&vncConnections]() {
+		return int( std::count_if( vncConnections.begin(), vncConnections.end(), []( const QPointer<VncConnection>& vncConnection ) {
+			return vncConnection && vncConnection->isConnected(); } ) );
+	} );
+	const auto connectTime = connectTimer.elapsed();
+
+	const auto serverBytes = sentServerBytes();
+	QElapsedTimer measureTimer;
+	measureTimer.start();
+
+	runFor( duration * 1000 );
+
+	const auto elapsed = measureTimer.elapsed();
+	const auto end = resourceUsage();
+
+	printReport( tr( "Full-resolution screens (%1 clients)" ).arg( clientCount ), elapsed, clientCount, connectedClients, connectTime,
+				 sentServerBytes() - serverBytes, begin, end );
+
+	qDeleteAll( connections );
+
+	for( const auto& vncConnection : qAsConst(vncConnections) )
+	{
+		if( vncConnection )
+		{
+			vncConnection->stopAndDeleteLater();
+		}
+	}
+
+	waitForShutdown( vncConnections );
+
+	stopServers();
+
+	return connectedClients == clientCount ? NoResult : Failed;
+}
+
+
+
+CommandLinePluginInterface::RunResult BenchCommands::handle_filetransfer( const QStringList& arguments )
+{
+	bool clientCountOk = true;
+	bool megabytesOk = true;
+	const auto clientCount = arguments.value( 0, QStringLiteral("100") ).toInt( &clientCountOk );
+	const auto megabytes = arguments.value( 1, QStringLiteral("64") ).toInt( &megabytesOk );
+
+	if( clientCountOk == false || megabytesOk == false || clientCount <= 0 || megabytes <= 0 )
+	{
+		error( tr( "Usage: %1" ).arg( QStringLiteral("filetransfer [CLIENTS=100] [MEGABYTES=64]") ) );
+		return InvalidArguments;
+	}
+
+	// keep framebuffer traffic low so the measurement is dominated by the transferred data
+	const BenchServer::Parameters parameters{ QSize( 1280, 720 ), QSize( 64, 64 ), 1 };
+
+	if( initializeCredentials() == false || startServers( clientCount, parameters ) == false )
+	{
+		stopServers();
+		return Failed;
+	}
+
+	const auto begin = resourceUsage();
+
+	QElapsedTimer connectTimer;
+	connectTimer.start();
+
+	ComputerControlInterfaceList interfaces;
+	interfaces.reserve( m_servers.size() );
+
+	for( auto server : qAsConst(m_servers) )
+	{
+		auto controlInterface = ComputerControlInterface::Pointer::create(
+									Computer( NetworkObject::Uid::createUuid(),
+											  QStringLiteral("bench-%1").arg( server->port() ),
+											  QStringLiteral("127.0.0.1:%1").arg( server->port() ) ) );
+		controlInterface->start( {}, ComputerControlInterface::UpdateMode::Disabled );
+		interfaces.append( controlInterface );
+	}
+
+	const auto connectedClients = waitForConnections( clientCount, [&interfaces]() {
+		return int( std::count_if( interfaces.begin(), interfaces.end(), []( const ComputerControlInterface::Pointer& controlInterface ) {
+			return controlInterface->state() == ComputerControlInterface::State::Connected; } ) );
+	} );
+	const auto connectTime = connectTimer.elapsed();
+
+	const auto chunkCount = int( qint64( megabytes ) * 1024 * 1024 / FileTransferChunkSize );
+
+	// serialize the chunk only once and share it between all clients like the file transfer does
+	const auto chunkMessage = FeatureMessage( BenchServer::transferFeatureUid(), FeatureMessage::DefaultCommand ).
+							  addArgument( 0, QByteArray( FileTransferChunkSize, 'x' ) );
+	const auto serializedChunk = chunkMessage.serialize( interfaces.first()->featureMessageFormat() );
+	const auto expectedBytes = quint64( chunkCount ) * quint64( sizeof(FeatureMessage::RfbMessageType) + size_t( serializedChunk.size() ) );
+
+	const auto serverBytes = sentServerBytes();
+
+	QVector<quint64> transferredBytes;
+	transferredBytes.reserve( m_servers.size() );
+	for( auto server : qAsConst(m_servers) )
+	{
+		transferredBytes.append( server->receivedTransferBytes() );
+	}
+
+	QVector<int> sentChunks( interfaces.size(), 0 );
+
+	QTimer processTimer;
+	connect( &processTimer, &QTimer::timeout, this, [&]() {
+		for( int i = 0; i < interfaces.size(); ++i )
+		{
+			while( sentChunks[i] < chunkCount &&
+				   interfaces[i]->state() == ComputerControlInterface::State::Connected &&
+				   interfaces[i]->messageQueueSize() < FileTransferWindowSize )
+			{
+				interfaces[i]->sendFeatureMessage( chunkMessage, false, serializedChunk );
+				++sentChunks[i];
+			}
+		}
+	} );
+
+	QElapsedTimer measureTimer;
+	measureTimer.start();
+
+	processTimer.start( FileTransferProcessInterval );
+
+	const auto finished = waitFor( [&]() {
+		for( int i = 0; i < m_servers.size(); ++i )
+		{
+			if( interfaces[i]->state() == ComputerControlInterface::State::Connected &&
+				m_servers[i]->receivedTransferBytes() - transferredBytes[i] < expectedBytes )
+			{
+				return false;
+			}
+		}
+		return true;
+	}, FileTransferTimeout );
+
+	processTimer.stop();
+
+	const auto elapsed = measureTimer.elapsed();
+	const auto end = resourceUsage();
+
+	quint64 receivedBytes = 0;
+	int completedClients = 0;
+	for( int i = 0; i < m_servers.size(); ++i )
+	{
+		const auto bytes = m_servers[i]->receivedTransferBytes() - transferredBytes[i];
+		receivedBytes += bytes;
+		if( bytes >= expectedBytes )
+		{
+			++completedClients;
+		}
+	}
+
+	printReport( tr( "File transfer (%1 MB to %2 clients)" ).arg( megabytes ).arg( clientCount ), elapsed,
+				 clientCount, connectedClients, connectTime, sentServerBytes() - serverBytes, begin, end, {
+					 { tr( "Clients completed" ), QStringLiteral("%1/%2").arg( completedClients ).arg( clientCount ) },
+					 { tr( "Data received by servers" ), formatBytes( receivedBytes ) },
+					 { tr( "Transfer throughput (total)" ), tr( "%1/s" ).arg( formatBytes( receivedBytes * 1000.0 / qMax<qint64>( 1, elapsed ) ) ) },
+					 { tr( "Transfer throughput (per client)" ), tr( "%1/s" ).arg( formatBytes( receivedBytes * 1000.0 / qMax<qint64>( 1, elapsed ) / clientCount ) ) },
+				 } );
+
+	if( finished == false )
+	{
+		error( tr( "Not all clients received the data within %1 s." ).arg( FileTransferTimeout / 1000 ) );
+	}
+
+	QVector<QPointer<VncConnection>> vncConnections;
+	for( const auto& controlInterface : qAsConst(interfaces) )
+	{
+		vncConnections.append( controlInterface->connection() ? controlInterface->connection()->vncConnection() : nullptr );
+	}
+
+	interfaces.clear();
+	waitForShutdown( vncConnections );
+
+	stopServers();
+
+	return finished && connectedClients == clientCount ? NoResult : Failed;
+}
+
+
+
+CommandLinePluginInterface::RunResult BenchCommands::handle_demo( const QStringList& arguments )
+{
+	int clientCount = 0;
+	int duration = 0;
+	BenchServer::Parameters parameters;
+
+	if( parseServerArguments( arguments, clientCount, duration, parameters ) == false )
+	{
+		error( tr( "Usage: %1" ).arg( QStringLiteral("demo [CLIENTS=100] [SECONDS=30] [WIDTHxHEIGHT=1920x1080] [CHANGES/s=5]") ) );
+		return InvalidArguments;
+	}
+
+	FeatureManager featureManager;
+	if( featureManager.feature( demoServerFeatureUid() ).isValid() == false )
+	{
+		error( tr( "The demo plugin is not available." ) );
+		return Failed;
+	}
+
+	// the simulated teacher computer is accessed by the demo server like the internal VNC server
+	parameters.vncAuthentication = true;
+
+	if( startServers( 1, parameters ) == false )
+	{
+		stopServers();
+		return Failed;
+	}
+
+	const auto teacher = m_servers.first();
+
+	// the demo plugin also authenticates the clients with this token
+	BenchDemoWorker worker;
+	featureManager.handleFeatureMessage( worker, FeatureMessage( demoServerFeatureUid(), StartDemoServer ).
+										 addArgument( DemoAccessToken, CryptoCore::generateChallenge().toBase64() ).
+										 addArgument( DemoVncServerPort, teacher->port() ).
+										 addArgument( DemoVncServerPassword, QByteArrayLiteral("bench") ) );
+
+	const auto stopDemoServer = [&]() {
+		featureManager.handleFeatureMessage( worker, FeatureMessage( demoServerFeatureUid(), StopDemoServer ) );
+	};
+
+	// the demo server only accepts clients once it receives the teacher's screen
+	if( waitFor( [teacher]() { return teacher->sentFramebufferUpdates() > 0; }, DemoServerStartTimeout ) == false )
+	{
+		error( tr( "The demo server did not connect to the simulated teacher computer." ) );
+		stopDemoServer();
+		stopServers();
+		return Failed;
+	}
+
+	const auto begin = resourceUsage();
+
+	QElapsedTimer connectTimer;
+	connectTimer.start();
+
+	// receives the frames so updates still queued when leaving are dropped along with it
+	QObject frameReceiver;
+
+	// every client yields one latency sample per change of the teacher's screen
+	qint64 latestChange = -1;
+	QVector<qint64> receivedChanges( clientCount, -1 );
+
+	QVector<QPointer<VncConnection>> vncConnections;
+	QVector<VeyonConnection *> connections;
+	vncConnections.reserve( clientCount );
+	connections.reserve( clientCount );
+
+	for( int i = 0; i < clientCount; ++i )
+	{
+		auto vncConnection = new VncConnection;
+		vncConnection->setHost( QStringLiteral("127.0.0.1:%1").arg( VeyonCore::config().demoServerPort() ) );
+		vncConnection->setQuality( VncConnection::Quality::Default );
+
+		connect( vncConnection, &VncConnection::framebufferUpdateComplete, &frameReceiver, [&, i]() {
+			const auto changeTimestamp = teacher->takeSentChangeTimestamp();
+			if( changeTimestamp >= 0 )
+			{
+				latestChange = changeTimestamp;
+			}
+
+			if( m_measuring )
+			{
+				++m_receivedFrames;
+				if( latestChange > receivedChanges[i] )
+				{
+					m_latencies.append( BenchServer::timestamp() - latestChange );
+					receivedChanges[i] = latestChange;
+				}
+			}
+		} );
+
+		connections.append( new VeyonConnection( vncConnection ) );
+		vncConnections.append( vncConnection );
+
+		vncConnection->start();
+	}
+
+	const auto connectedClients = waitForConnections( clientCount, [&vncConnections]() {
+		return int( std::count_if( vncConnections.begin(), vncConnections.end(), []( const QPointer<VncConnection>& vncConnection ) {
+			return vncConnection && vncConnection->isConnected(); } ) );
+	} );
+	const auto connectTime = connectTimer.elapsed();
+
+	// changes received before the measurement started don't count
+	receivedChanges.fill( latestChange );
+
+	const auto serverBytes = sentServerBytes();
+	QElapsedTimer measureTimer;
+	measureTimer.start();
+
+	runFor( duration * 1000 );
+
+	const auto elapsed = measureTimer.elapsed();
+	const auto end = resourceUsage();
+
+	printReport( tr( "Demo (%1 clients)" ).arg( clientCount ), elapsed, clientCount, connectedClients, connectTime,
+				 sentServerBytes() - serverBytes, begin, end, {
+					 { tr( "Throughput refers to" ), tr( "Teacher screen sent to the demo server" ) },
+				 } );
+
+	qDeleteAll( connections );
+
+	for( const auto& vncConnection : qAsConst(vncConnections) )
+	{
+		if( vncConnection )
+		{
+			vncConnection->stopAndDeleteLater();
+		}
+	}
+
+	waitForShutdown( vncConnections );
+
+	stopDemoServer();
+	stopServers();
+
+	return connectedClients == clientCount ? NoResult : Failed;
+}
+
+
+
+bool BenchCommands::parseServerArguments( const QStringList& arguments, int& clientCount, int& duration,
+										  BenchServer::Parameters& parameters )
+{
+	bool clientCountOk = true;
+	bool durationOk = true;
+	bool changeRateOk = true;
+
+	clientCount = arguments.value( 0, QStringLiteral("100") ).toInt( &clientCountOk );
+	duration = arguments.value( 1, QStringLiteral("30") ).toInt( &durationOk );
+
+	const auto resolution = arguments.value( 2, QStringLiteral("1920x1080") ).split( QLatin1Char('x') );
+	parameters.resolution = QSize( resolution.value( 0 ).toInt(), resolution.value( 1 ).toInt() );
+	parameters.changeRate = arguments.value( 3, QStringLiteral("5") ).toInt( &changeRateOk );
+
+	// each change touches roughly one percent of the screen like typing or a blinking cursor region
+	parameters.changeSize = parameters.resolution / 10;
+
+	return clientCountOk && durationOk && changeRateOk &&
+			clientCount > 0 && duration > 0 && parameters.changeRate >= 0 &&
+			parameters.resolution.width() >= 16 && parameters.resolution.height() >= 16 &&
+			parameters.resolution.width() <= 8192 && parameters.resolution.height() <= 8192;
+}
+
+
+
+bool BenchCommands::initializeCredentials()
+{
+	auto authenticationPlugin = VeyonCore::authenticationManager().configuredPlugin();
+
+	if( authenticationPlugin->initializeCredentials() == false ||
+		authenticationPlugin->checkCredentials() == false )
+	{
+		error( tr( "Could not initialize credentials for the configured authentication method." ) );
+		return false;
+	}
+
+	return true;
+}
+
+
+
+bool BenchCommands::startServers( int count, const BenchServer::Parameters& parameters )
+{
+	const auto threadCount = qBound( 1, QThread::idealThreadCount() / 2, count );
+
+	for( int i = 0; i < threadCount; ++i )
+	{
+		auto thread = new QThread;
+		thread->setObjectName( QStringLiteral("BenchServer%1").arg( i ) );
+		thread->start();
+		m_serverThreads.append( thread );
+	}
+
+	for( int i = 0; i < count; ++i )
+	{
+		auto server = new BenchServer( parameters );
+		server->moveToThread( m_serverThreads[i % threadCount] );
+		m_servers.append( server );
+
+		if( i < threadCount )
+		{
+			// allows accounting the CPU time of the simulated servers separately
+			Qt::HANDLE threadId = nullptr;
+			QMetaObject::invokeMethod( server, [&threadId]() { threadId = QThread::currentThreadId(); },
+									   Qt::BlockingQueuedConnection );
+			m_serverThreadIds.append( threadId );
+		}
+
+		bool started = false;
+		QMetaObject::invokeMethod( server, "start", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, started) );
+		if( started == false )
+		{
+			error( tr( "Could not start simulated server %1." ).arg( i + 1 ) );
+			return false;
+		}
+	}
+
+	m_receivedFrames = 0;
+	m_latencies.clear();
+
+	return true;
+}
+
+
+
+void BenchCommands::stopServers()
+{
+	for( auto server : qAsConst(m_servers) )
+	{
+		QMetaObject::invokeMethod( server, "stop", Qt::BlockingQueuedConnection );
+	}
+
+	for( auto thread : qAsConst(m_serverThreads) )
+	{
+		thread->quit();
+		thread->wait( ShutdownTimeout );
+	}
+
+	qDeleteAll( m_servers );
+	qDeleteAll( m_serverThreads );
+
+	m_servers.clear();
+	m_serverThreads.clear();
+	m_serverThreadIds.clear();
+}
+
+
+
+int BenchCommands::waitForConnections( int clientCount, const std::function<int()>& connectedCount )
+{
+	waitFor( [&]() { return connectedCount() >= clientCount; }, ConnectTimeout );
+
+	const auto count = connectedCount();
+	if( count < clientCount )
+	{
+		error( tr( "Only %1 of %2 clients connected within %3 s." ).arg( count ).arg( clientCount ).arg( ConnectTimeout / 1000 ) );
+	}
+
+	return count;
+}
+
+
+
+bool BenchCommands::waitFor( const std::function<bool()>& condition, int timeout )
+{
+	if( condition() )
+	{
+		return true;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QEventLoop eventLoop;
+	QTimer pollTimer;
+	connect( &pollTimer, &QTimer::timeout, &eventLoop, [&]() {
+		if( condition() || timer.elapsed() >= timeout )
+		{
+			eventLoop.quit();
+		}
+	} );
+	pollTimer.start( PollInterval );
+
+	eventLoop.exec();
+
+	return condition();
+}
+
+
+
+void BenchCommands::runFor( int duration )
+{
+	m_receivedFrames = 0;
+	m_latencies.clear();
+
+	for( auto server : qAsConst(m_servers) )
+	{
+		// discard changes sent before the measurement started
+		server->takeSentChangeTimestamp();
+	}
+
+	m_measuring = true;
+	waitFor( []() { return false; }, duration );
+	m_measuring = false;
+}
+
+
+
+void BenchCommands::waitForShutdown( const QVector<QPointer<VncConnection>>& vncConnections )
+{
+	waitFor( [&vncConnections]() {
+		return std::all_of( vncConnections.begin(), vncConnections.end(),
+							[]( const QPointer<VncConnection>& vncConnection ) { return vncConnection.isNull(); } );
+	}, ShutdownTimeout );
+}
+
+
+
+void BenchCommands::recordFrame( BenchServer* server )
+{
+	if( m_measuring == false )
+	{
+		return;
+	}
+
+	++m_receivedFrames;
+
+	const auto changeTimestamp = server->takeSentChangeTimestamp();
+	if( changeTimestamp >= 0 )
+	{
+		m_latencies.append( BenchServer::timestamp() - changeTimestamp );
+	}
+}
+
+
+
+quint64 BenchCommands::sentServerBytes() const
+{
+	quint64 bytes = 0;
+
+	for( auto server : qAsConst(m_servers) )
+	{
+		bytes += server->sentBytes();
+	}
+
+	return bytes;
+}
+
+
+
+BenchCommands::ResourceUsage BenchCommands::resourceUsage() const
+{
+	ResourceUsage usage;
+
+#ifdef Q_OS_LINUX
+	const auto microseconds = []( const timespec& time ) {
+		return qint64( time.tv_sec ) * 1000000 + time.tv_nsec / 1000;
+	};
+
+	timespec time{};
+	if( clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &time ) == 0 )
+	{
+		usage.processCpuTime = microseconds( time );
+	}
+
+	usage.serverCpuTime = 0;
+	for( auto threadId : m_serverThreadIds )
+	{
+		clockid_t clockId;
+		if( pthread_getcpuclockid( reinterpret_cast<pthread_t>( threadId ), &clockId ) == 0 &&
+			clock_gettime( clockId, &time ) == 0 )
+		{
+			usage.serverCpuTime += microseconds( time );
+		}
+	}
+
+	QFile status( QStringLiteral("/proc/self/status") );
+	if( status.open( QFile::ReadOnly ) )
+	{
+		const auto lines = status.readAll().split( '\n' );
+		for( const auto& line : lines )
+		{
+			// values are reported in kB
+			if( line.startsWith( "VmRSS:" ) )
+			{
+				usage.residentMemory = line.mid( 6 ).trimmed().split( ' ' ).value( 0 ).toLongLong() * 1024;
+			}
+			else if( line.startsWith( "VmHWM:" ) )
+			{
+				usage.peakResidentMemory = line.mid( 6 ).trimmed().split( ' ' ).value( 0 ).toLongLong() * 1024;
+			}
+		}
+	}
+#else
+	usage.processCpuTime = qint64( std::clock() ) * 1000000 / CLOCKS_PER_SEC;
+#endif
+
+	return usage;
+}
+
+
+
+void BenchCommands::printReport( const QString& scenario, qint64 elapsed, int clientCount, int connectedClients, qint64 connectTime,
+								 quint64 serverBytes, const ResourceUsage& begin, const ResourceUsage& end,
+								 const TableRows& additionalRows )
+{
+	const auto seconds = qMax<qint64>( 1, elapsed ) / 1000.0;
+
+	auto latencies = m_latencies;
+	std::sort( latencies.begin(), latencies.end() );
+
+	const auto latency = [&latencies]( double quantile ) {
+		if( latencies.isEmpty() )
+		{
+			return QStringLiteral("n/a");
+		}
+		const auto index = qBound( 0, int( quantile * ( latencies.size() - 1 ) + 0.5 ), latencies.size() - 1 );
+		return QString::number( latencies[index] / 1000.0, 'f', 2 );
+	};
+
+	const auto averageLatency = latencies.isEmpty() ? QStringLiteral("n/a") :
+									QString::number( std::accumulate( latencies.begin(), latencies.end(), 0.0 ) /
+													 latencies.size() / 1000.0, 'f', 2 );
+
+	const auto memory = []( qint64 bytes ) {
+		return bytes >= 0 ? formatBytes( bytes ) : QStringLiteral("n/a");
+	};
+
+	const auto cpuTime = [seconds]( qint64 time ) {
+		return tr( "%1 ms (%2% of one core)" ).arg( time / 1000 ).arg( time / 10000.0 / seconds, 0, 'f', 1 );
+	};
+
+	const auto processCpuTime = end.processCpuTime - begin.processCpuTime;
+	const auto serverCpuTime = end.serverCpuTime - begin.serverCpuTime;
+	const auto hasServerCpuTime = begin.serverCpuTime >= 0 && end.serverCpuTime >= 0;
+
+	TableRows rows{
+		{ tr( "Scenario" ), scenario },
+		{ tr( "Clients connected" ), QStringLiteral("%1/%2").arg( connectedClients ).arg( clientCount ) },
+		{ tr( "Time to connect" ), tr( "%1 ms" ).arg( connectTime ) },
+		{ tr( "Measured time" ), tr( "%1 s" ).arg( seconds, 0, 'f', 1 ) },
+		{ tr( "Frames received" ), QString::number( m_receivedFrames ) },
+		{ tr( "Frame rate (total)" ), tr( "%1 fps" ).arg( m_receivedFrames / seconds, 0, 'f', 1 ) },
+		{ tr( "Frame rate (per client)" ), tr( "%1 fps" ).arg( m_receivedFrames / seconds / qMax( 1, clientCount ), 0, 'f', 2 ) },
+		{ tr( "Latency avg/p50/p95/max" ), tr( "%1 / %2 / %3 / %4 ms" ).
+		  arg( averageLatency, latency( 0.5 ), latency( 0.95 ), latency( 1 ) ) },
+		{ tr( "Server throughput" ), tr( "%1/s" ).arg( formatBytes( serverBytes / seconds ) ) },
+	};
+
+	if( hasServerCpuTime )
+	{
+		// the simulated servers run in threads of their own which are accounted separately
+		rows.append( TableRow{ tr( "CPU time (clients)" ), cpuTime( processCpuTime - serverCpuTime ) } );
+		rows.append( TableRow{ tr( "CPU time (simulated servers)" ), cpuTime( serverCpuTime ) } );
+	}
+	else
+	{
+		rows.append( TableRow{ tr( "CPU time (incl. servers)" ), cpuTime( processCpuTime ) } );
+	}
+
+	// memory can't be attributed to threads so these include the simulated servers
+	rows.append( TableRow{ tr( "Resident memory (incl. servers)" ), memory( end.residentMemory ) } );
+	rows.append( TableRow{ tr( "Peak resident memory (incl. servers)" ), memory( end.peakResidentMemory ) } );
+
+	rows.append( additionalRows );
+
+	printTable( Table( TableHeader( { tr( "Metric" ), tr( "Value" ) } ), rows ) );
+}
+
+
+
+QString BenchCommands::formatBytes( double bytes )
+{
+	if( bytes >= 1024*1024*1024 )
+	{
+		return QStringLiteral("%1 GB").arg( bytes / ( 1024*1024*1024 ), 0, 'f', 2 );
+	}
+
+	if( bytes >= 1024*1024 )
+	{
+		return QStringLiteral("%1 MB").arg( bytes / ( 1024*1024 ), 0, 'f', 2 );
+	}
+
+	return QStringLiteral("%1 kB").arg( bytes / 1024, 0, 'f', 1 );
+}
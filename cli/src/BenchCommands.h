@@ -0,0 +1,166 @@
+/*
+ * BenchCommands.h - declaration of BenchCommands class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QPointer>
+#include <QThread>
+
+#include <functional>
+
+#include "BenchServer.h"
+#include "CommandLinePluginInterface.h"
+#include "CommandLineIO.h"
+
+class VncConnection;
+
+class BenchCommands : public QObject, CommandLinePluginInterface, PluginInterface, CommandLineIO
+{
+	Q_OBJECT
+	Q_INTERFACES(PluginInterface CommandLinePluginInterface)
+public:
+	explicit BenchCommands( QObject* parent = nullptr );
+	~BenchCommands() override;
+
+	Plugin::Uid uid() const override
+	{
+		return QStringLiteral("692ed8e1-5ea5-4c9c-8c52-15543ba08645");
+	}
+
+	QVersionNumber version() const override
+	{
+		return QVersionNumber( 1, 0 );
+	}
+
+	QString name() const override
+	{
+		return QStringLiteral( "Bench" );
+	}
+
+	QString description() const override
+	{
+		return tr( "Benchmarks with simulated classrooms" );
+	}
+
+	QString vendor() const override
+	{
+		return QStringLiteral( "Veyon Community" );
+	}
+
+	QString copyright() const override
+	{
+		return QStringLiteral( "Tobias Junghans" );
+	}
+
+	QString commandLineModuleName() const override
+	{
+		return QStringLiteral( "bench" );
+	}
+
+	QString commandLineModuleHelp() const override
+	{
+		return tr( "Commands for benchmarking against simulated Veyon Servers" );
+	}
+
+	QStringList commands() const override;
+	QString commandHelp( const QString& command ) const override;
+
+public slots:
+	CommandLinePluginInterface::RunResult handle_monitoring( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_fullscreen( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_filetransfer( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_demo( const QStringList& arguments );
+
+private:
+	static constexpr int ConnectTimeout = 60000;
+	static constexpr int ShutdownTimeout = 5000;
+	static constexpr int PollInterval = 25;
+	static constexpr int ThumbnailWidth = 320;
+	static constexpr int FileTransferChunkSize = 256*1024;
+	static constexpr int FileTransferWindowSize = 4;
+	static constexpr int FileTransferProcessInterval = 25;
+	static constexpr int FileTransferTimeout = 600000;
+	static constexpr int DemoServerStartTimeout = 10000;
+
+	// the demo server is driven through its feature messages like a worker does it
+	enum DemoServerCommand {
+		StartDemoServer,
+		StopDemoServer
+	};
+
+	enum DemoServerArgument {
+		DemoAccessToken,
+		DemoVncServerPort,
+		DemoVncServerPassword
+	};
+
+	static Feature::Uid demoServerFeatureUid()
+	{
+		return Feature::Uid( QStringLiteral("e4b6e743-1f5b-491d-9364-e091086200f4") );
+	}
+
+	struct ResourceUsage
+	{
+		qint64 processCpuTime{0};
+		// CPU time of the simulated servers' threads, -1 if not available on this platform
+		qint64 serverCpuTime{-1};
+		qint64 residentMemory{-1};
+		qint64 peakResidentMemory{-1};
+	};
+
+	bool parseServerArguments( const QStringList& arguments, int& clientCount, int& duration,
+							   BenchServer::Parameters& parameters );
+	bool initializeCredentials();
+
+	bool startServers( int count, const BenchServer::Parameters& parameters );
+	void stopServers();
+
+	int waitForConnections( int clientCount, const std::function<int()>& connectedCount );
+	bool waitFor( const std::function<bool()>& condition, int timeout );
+	void runFor( int duration );
+	void waitForShutdown( const QVector<QPointer<VncConnection>>& vncConnections );
+
+	void recordFrame( BenchServer* server );
+
+	quint64 sentServerBytes() const;
+
+	ResourceUsage resourceUsage() const;
+
+	void printReport( const QString& scenario, qint64 elapsed, int clientCount, int connectedClients, qint64 connectTime,
+					  quint64 serverBytes, const ResourceUsage& begin, const ResourceUsage& end,
+					  const TableRows& additionalRows = {} );
+
+	static QString formatBytes( double bytes );
+
+	const QMap<QString, QString> m_commands;
+
+	QVector<QThread *> m_serverThreads;
+	QVector<Qt::HANDLE> m_serverThreadIds;
+	QVector<BenchServer *> m_servers;
+
+	bool m_measuring{false};
+	quint64 m_receivedFrames{0};
+	QVector<qint64> m_latencies;
+
+};
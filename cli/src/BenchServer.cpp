@@ -0,0 +1,178 @@
+/*
+ * BenchServer.cpp - implementation of BenchServer class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QColor>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QtEndian>
+
+#include <chrono>
+
+#include "BenchServer.h"
+#include "BenchServerConnection.h"
+
+
+BenchServer::BenchServer( const Parameters& parameters, QObject* parent ) :
+	QObject( parent ),
+	m_parameters( parameters ),
+	m_tcpServer( new QTcpServer( this ) ),
+	m_changeTimer( this ),
+	m_framebuffer( parameters.resolution, QImage::Format_RGB32 )
+{
+	m_framebuffer.fill( Qt::darkGray );
+
+	// announce the pixel layout of QImage::Format_RGB32 so clients requesting
+	// the same format can be served without any conversion
+	const auto name = QByteArrayLiteral("Veyon Benchmark Server");
+
+	rfbServerInitMsg serverInit{};
+	serverInit.framebufferWidth = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_framebuffer.width() ) );
+	serverInit.framebufferHeight = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_framebuffer.height() ) );
+	serverInit.format.bitsPerPixel = 32;
+	serverInit.format.depth = 24;
+	serverInit.format.bigEndian = Q_BYTE_ORDER == Q_BIG_ENDIAN ? 1 : 0;
+	serverInit.format.trueColour = 1;
+	serverInit.format.redMax = qToBigEndian<uint16_t>( 255 );
+	serverInit.format.greenMax = qToBigEndian<uint16_t>( 255 );
+	serverInit.format.blueMax = qToBigEndian<uint16_t>( 255 );
+	serverInit.format.redShift = 16;
+	serverInit.format.greenShift = 8;
+	serverInit.format.blueShift = 0;
+	serverInit.nameLength = qToBigEndian<uint32_t>( static_cast<uint32_t>( name.size() ) );
+
+	m_serverInitMessage = QByteArray( reinterpret_cast<const char *>( &serverInit ), sz_rfbServerInitMsg ) + name;
+
+	connect( m_tcpServer, &QTcpServer::newConnection, this, &BenchServer::acceptConnections );
+	connect( &m_changeTimer, &QTimer::timeout, this, &BenchServer::changeFramebuffer );
+}
+
+
+
+BenchServer::~BenchServer()
+{
+	qDeleteAll( findChildren<BenchServerConnection *>() );
+}
+
+
+
+bool BenchServer::start()
+{
+	if( m_tcpServer->listen( QHostAddress::LocalHost ) == false )
+	{
+		vCritical() << "could not listen on loopback interface:" << m_tcpServer->errorString();
+		return false;
+	}
+
+	m_port = m_tcpServer->serverPort();
+
+	if( m_parameters.changeRate > 0 )
+	{
+		m_changeTimer.start( qMax( 1, 1000 / m_parameters.changeRate ) );
+	}
+
+	return true;
+}
+
+
+
+void BenchServer::stop()
+{
+	m_changeTimer.stop();
+	m_tcpServer->close();
+
+	qDeleteAll( findChildren<BenchServerConnection *>() );
+}
+
+
+
+qint64 BenchServer::timestamp()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
+
+void BenchServer::reportFramebufferUpdate( qint64 size, qint64 changeTimestamp )
+{
+	m_sentFramebufferUpdates.fetch_add( 1, std::memory_order_relaxed );
+	m_sentBytes.fetch_add( static_cast<quint64>( size ), std::memory_order_relaxed );
+
+	if( changeTimestamp >= 0 )
+	{
+		m_sentChangeTimestamp = changeTimestamp;
+	}
+}
+
+
+
+void BenchServer::reportFeatureMessage( Feature::Uid featureUid, qint64 size )
+{
+	m_receivedFeatureMessages.fetch_add( 1, std::memory_order_relaxed );
+	m_receivedFeatureMessageBytes.fetch_add( static_cast<quint64>( size ), std::memory_order_relaxed );
+
+	if( featureUid == transferFeatureUid() )
+	{
+		m_receivedTransferBytes.fetch_add( static_cast<quint64>( size ), std::memory_order_relaxed );
+	}
+}
+
+
+
+void BenchServer::acceptConnections()
+{
+	while( m_tcpServer->hasPendingConnections() )
+	{
+		new BenchServerConnection( this, m_tcpServer->nextPendingConnection() );
+	}
+}
+
+
+
+void BenchServer::changeFramebuffer()
+{
+	// move a block with changing colors over the screen line by line
+	const auto blockWidth = qBound( 1, m_parameters.changeSize.width(), m_framebuffer.width() );
+	const auto blockHeight = qBound( 1, m_parameters.changeSize.height(), m_framebuffer.height() );
+	const auto blocksPerLine = qMax( 1, m_framebuffer.width() / blockWidth );
+	const auto blockLines = qMax( 1, m_framebuffer.height() / blockHeight );
+	const auto block = m_changeCount % ( blocksPerLine * blockLines );
+
+	const QRect rect( ( block % blocksPerLine ) * blockWidth, ( block / blocksPerLine ) * blockHeight,
+					  blockWidth, blockHeight );
+
+	const auto color = QColor::fromHsv( ( m_changeCount * 37 ) % 360, 192, 224 ).rgb();
+
+	for( int y = rect.top(); y <= rect.bottom(); ++y )
+	{
+		auto line = reinterpret_cast<QRgb *>( m_framebuffer.scanLine( y ) );
+		std::fill( line + rect.left(), line + rect.left() + rect.width(), color );
+	}
+
+	++m_changeCount;
+
+	emit framebufferChanged( rect, timestamp() );
+}
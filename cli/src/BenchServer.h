@@ -0,0 +1,148 @@
+/*
+ * BenchServer.h - header file for the BenchServer class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QImage>
+#include <QTimer>
+
+#include <atomic>
+
+#include "Feature.h"
+
+class QTcpServer;
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+// simulated Veyon Server speaking the RFB protocol and the Veyon security handshake
+// on a loopback port while producing synthetic framebuffer changes at a fixed rate
+class BenchServer : public QObject
+{
+	Q_OBJECT
+public:
+	struct Parameters
+	{
+		QSize resolution;
+		QSize changeSize;
+		int changeRate;
+		// plain VNC authentication like the internal VNC server the demo server connects to
+		bool vncAuthentication{false};
+	};
+
+	explicit BenchServer( const Parameters& parameters, QObject* parent = nullptr );
+	~BenchServer() override;
+
+	// have to be called in the thread the server lives in
+	Q_INVOKABLE bool start();
+	Q_INVOKABLE void stop();
+
+	const Parameters& parameters() const
+	{
+		return m_parameters;
+	}
+
+	quint16 port() const
+	{
+		return m_port;
+	}
+
+	const QImage& framebuffer() const
+	{
+		return m_framebuffer;
+	}
+
+	const QByteArray& serverInitMessage() const
+	{
+		return m_serverInitMessage;
+	}
+
+	// monotonic clock in microseconds shared by simulated servers and benchmarked clients
+	static qint64 timestamp();
+
+	quint64 sentFramebufferUpdates() const
+	{
+		return m_sentFramebufferUpdates.load( std::memory_order_relaxed );
+	}
+
+	quint64 sentBytes() const
+	{
+		return m_sentBytes.load( std::memory_order_relaxed );
+	}
+
+	quint64 receivedFeatureMessages() const
+	{
+		return m_receivedFeatureMessages.load( std::memory_order_relaxed );
+	}
+
+	quint64 receivedFeatureMessageBytes() const
+	{
+		return m_receivedFeatureMessageBytes.load( std::memory_order_relaxed );
+	}
+
+	quint64 receivedTransferBytes() const
+	{
+		return m_receivedTransferBytes.load( std::memory_order_relaxed );
+	}
+
+	// feature UID of the data chunks sent by the file transfer benchmark
+	static Feature::Uid transferFeatureUid()
+	{
+		return Feature::Uid( QStringLiteral("c4f0b6de-3e1a-4f57-9d2b-8a6e5f1c7b90") );
+	}
+
+	// returns the time of the oldest change contained in the most recently sent
+	// framebuffer update exactly once so each update yields one latency sample
+	qint64 takeSentChangeTimestamp()
+	{
+		return m_sentChangeTimestamp.exchange( -1 );
+	}
+
+	void reportFramebufferUpdate( qint64 size, qint64 changeTimestamp );
+	void reportFeatureMessage( Feature::Uid featureUid, qint64 size );
+
+signals:
+	void framebufferChanged( const QRect& rect, qint64 timestamp );
+
+private:
+	void acceptConnections();
+	void changeFramebuffer();
+
+	const Parameters m_parameters;
+
+	QTcpServer* m_tcpServer;
+	QTimer m_changeTimer;
+	std::atomic<quint16> m_port{0};
+
+	QImage m_framebuffer;
+	QByteArray m_serverInitMessage;
+	int m_changeCount{0};
+
+	std::atomic<quint64> m_sentFramebufferUpdates{0};
+	std::atomic<quint64> m_sentBytes{0};
+	std::atomic<quint64> m_receivedFeatureMessages{0};
+	std::atomic<quint64> m_receivedFeatureMessageBytes{0};
+	std::atomic<quint64> m_receivedTransferBytes{0};
+	std::atomic<qint64> m_sentChangeTimestamp{-1};
+
+} ;
@@ -0,0 +1,430 @@
+/*
+ * BenchServerConnection.cpp - implementation of BenchServerConnection class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include <QtEndian>
+
+#include <array>
+
+#include "BenchServer.h"
+#include "BenchServerConnection.h"
+#include "FeatureMessage.h"
+
+
+BenchServerConnection::BenchServerConnection( BenchServer* server, QTcpSocket* socket ) :
+	QObject( server ),
+	m_server( server ),
+	m_socket( socket ),
+	m_serverProtocol( m_socket, &m_vncServerClient ),
+	m_rfbClientToServerMessageSizes( {
+		{ rfbKeyEvent, sz_rfbKeyEventMsg },
+		{ rfbPointerEvent, sz_rfbPointerEventMsg },
+		{ rfbXvp, sz_rfbXvpMsg },
+		} )
+{
+	m_serverProtocol.setServerInitMessage( m_server->serverInitMessage() );
+
+	m_protocolRetryTimer.setSingleShot( true );
+	m_protocolRetryTimer.setInterval( ProtocolRetryTime );
+	connect( &m_protocolRetryTimer, &QTimer::timeout, this, &BenchServerConnection::processClient );
+
+	connect( m_socket, &QTcpSocket::readyRead, this, &BenchServerConnection::processClient );
+	connect( m_socket, &QTcpSocket::disconnected, this, &BenchServerConnection::deleteLater );
+
+	connect( m_server, &BenchServer::framebufferChanged, this, &BenchServerConnection::markChanged );
+
+	if( m_server->parameters().vncAuthentication )
+	{
+		std::array<char, sz_rfbProtocolVersionMsg+1> protocol{};
+		sprintf( protocol.data(), rfbProtocolVersionFormat, 3, 8 ); // Flawfinder: ignore
+		m_socket->write( protocol.data(), sz_rfbProtocolVersionMsg );
+
+		m_vncAuthState = VncAuthState::Protocol;
+	}
+	else
+	{
+		m_serverProtocol.start();
+	}
+}
+
+
+
+BenchServerConnection::~BenchServerConnection()
+{
+	delete m_socket;
+}
+
+
+
+bool BenchServerConnection::isRunning() const
+{
+	if( m_vncAuthState == VncAuthState::Disabled )
+	{
+		return m_serverProtocol.state() == VncServerProtocol::Running;
+	}
+
+	return m_vncAuthState == VncAuthState::Running;
+}
+
+
+
+void BenchServerConnection::processClient()
+{
+	if( m_vncAuthState != VncAuthState::Disabled && m_vncAuthState != VncAuthState::Running )
+	{
+		while( receiveVncAuthenticationMessage() )
+		{
+		}
+	}
+
+	if( isRunning() == false && m_vncAuthState == VncAuthState::Disabled )
+	{
+		while( m_serverProtocol.read() )
+		{
+		}
+
+		// retry later as authentication may need further messages
+		// and client messages may already be queued - one pending retry is enough
+		if( m_protocolRetryTimer.isActive() == false )
+		{
+			m_protocolRetryTimer.start();
+		}
+	}
+	else if( isRunning() )
+	{
+		while( receiveClientMessage() )
+		{
+		}
+	}
+}
+
+
+
+bool BenchServerConnection::receiveVncAuthenticationMessage()
+{
+	switch( m_vncAuthState )
+	{
+	case VncAuthState::Protocol:
+		if( m_socket->bytesAvailable() < sz_rfbProtocolVersionMsg )
+		{
+			return false;
+		}
+		m_socket->read( sz_rfbProtocolVersionMsg );
+		{
+			constexpr std::array<char, 2> securityTypeList{ 1, rfbSecTypeVncAuth };
+			m_socket->write( securityTypeList.data(), securityTypeList.size() );
+		}
+		m_vncAuthState = VncAuthState::SecurityType;
+		return true;
+
+	case VncAuthState::SecurityType:
+	{
+		char securityType = 0;
+		if( m_socket->getChar( &securityType ) == false )
+		{
+			return false;
+		}
+		if( securityType != rfbSecTypeVncAuth )
+		{
+			vCritical() << "unsupported security type" << int( securityType );
+			m_socket->close();
+			return false;
+		}
+		// simulated servers accept any password so the challenge does not need to be random
+		m_socket->write( QByteArray( VncAuthChallengeSize, 'v' ) );
+		m_vncAuthState = VncAuthState::Challenge;
+		return true;
+	}
+
+	case VncAuthState::Challenge:
+		if( m_socket->bytesAvailable() < VncAuthChallengeSize )
+		{
+			return false;
+		}
+		m_socket->read( VncAuthChallengeSize );
+		{
+			const auto authResult = qToBigEndian<uint32_t>( rfbVncAuthOK );
+			m_socket->write( reinterpret_cast<const char *>( &authResult ), sizeof(authResult) );
+		}
+		m_vncAuthState = VncAuthState::ClientInit;
+		return true;
+
+	case VncAuthState::ClientInit:
+		if( m_socket->bytesAvailable() < sz_rfbClientInitMsg )
+		{
+			return false;
+		}
+		m_socket->read( sz_rfbClientInitMsg );
+		m_socket->write( m_server->serverInitMessage() );
+		m_vncAuthState = VncAuthState::Running;
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+
+
+bool BenchServerConnection::receiveClientMessage()
+{
+	uint8_t messageType = 0;
+	if( m_socket->peek( reinterpret_cast<char *>( &messageType ), sizeof(messageType) ) != sizeof(messageType) )
+	{
+		return false;
+	}
+
+	switch( messageType )
+	{
+	case rfbSetPixelFormat:
+		return receiveSetPixelFormat();
+
+	case rfbFramebufferUpdateRequest:
+		return receiveFramebufferUpdateRequest();
+
+	case FeatureMessage::RfbMessageType:
+		return receiveFeatureMessage();
+
+	case rfbSetEncodings:
+		// only raw encoding is provided which every client supports
+		if( m_socket->bytesAvailable() >= sz_rfbSetEncodingsMsg )
+		{
+			rfbSetEncodingsMsg setEncodingsMessage;
+			if( m_socket->peek( reinterpret_cast<char *>( &setEncodingsMessage ), sz_rfbSetEncodingsMsg ) == sz_rfbSetEncodingsMsg )
+			{
+				const qint64 totalSize = sz_rfbSetEncodingsMsg + qFromBigEndian(setEncodingsMessage.nEncodings) * sizeof(uint32_t);
+				if( m_socket->bytesAvailable() >= totalSize )
+				{
+					return m_socket->read( totalSize ).size() == totalSize;
+				}
+			}
+		}
+		break;
+
+	case rfbClientCutText:
+		if( m_socket->bytesAvailable() >= sz_rfbClientCutTextMsg )
+		{
+			rfbClientCutTextMsg clientCutTextMessage;
+			if( m_socket->peek( reinterpret_cast<char *>( &clientCutTextMessage ), sz_rfbClientCutTextMsg ) == sz_rfbClientCutTextMsg )
+			{
+				const qint64 totalSize = sz_rfbClientCutTextMsg + qFromBigEndian(clientCutTextMessage.length);
+				if( m_socket->bytesAvailable() >= totalSize )
+				{
+					return m_socket->read( totalSize ).size() == totalSize;
+				}
+			}
+		}
+		break;
+
+	default:
+		if( m_rfbClientToServerMessageSizes.contains( messageType ) == false )
+		{
+			vCritical() << "received unknown message type:" << static_cast<int>( messageType );
+			m_socket->close();
+			return false;
+		}
+
+		if( m_socket->bytesAvailable() < m_rfbClientToServerMessageSizes[messageType] )
+		{
+			return false;
+		}
+
+		m_socket->read( m_rfbClientToServerMessageSizes[messageType] );
+		return true;
+	}
+
+	return false;
+}
+
+
+
+bool BenchServerConnection::receiveSetPixelFormat()
+{
+	rfbSetPixelFormatMsg message;
+	if( m_socket->bytesAvailable() < sz_rfbSetPixelFormatMsg ||
+		m_socket->read( reinterpret_cast<char *>( &message ), sz_rfbSetPixelFormatMsg ) != sz_rfbSetPixelFormatMsg )
+	{
+		return false;
+	}
+
+	m_pixelFormat.bitsPerPixel = message.format.bitsPerPixel;
+	m_pixelFormat.bigEndian = message.format.bigEndian != 0;
+	m_pixelFormat.trueColour = message.format.trueColour != 0;
+	m_pixelFormat.redMax = qFromBigEndian( message.format.redMax );
+	m_pixelFormat.greenMax = qFromBigEndian( message.format.greenMax );
+	m_pixelFormat.blueMax = qFromBigEndian( message.format.blueMax );
+	m_pixelFormat.redShift = message.format.redShift;
+	m_pixelFormat.greenShift = message.format.greenShift;
+	m_pixelFormat.blueShift = message.format.blueShift;
+
+	if( m_pixelFormat.bitsPerPixel != 32 || m_pixelFormat.trueColour == false )
+	{
+		vCritical() << "unsupported pixel format with" << m_pixelFormat.bitsPerPixel << "bits per pixel";
+		m_socket->close();
+		return false;
+	}
+
+	// framebuffer lines can be copied as they are if the layout matches QImage::Format_RGB32
+	m_nativePixelFormat = m_pixelFormat.bigEndian == ( Q_BYTE_ORDER == Q_BIG_ENDIAN ) &&
+						  m_pixelFormat.redMax == 255 && m_pixelFormat.greenMax == 255 && m_pixelFormat.blueMax == 255 &&
+						  m_pixelFormat.redShift == 16 && m_pixelFormat.greenShift == 8 && m_pixelFormat.blueShift == 0;
+
+	return true;
+}
+
+
+
+bool BenchServerConnection::receiveFramebufferUpdateRequest()
+{
+	rfbFramebufferUpdateRequestMsg message;
+	if( m_socket->bytesAvailable() < sz_rfbFramebufferUpdateRequestMsg ||
+		m_socket->read( reinterpret_cast<char *>( &message ), sz_rfbFramebufferUpdateRequestMsg ) != sz_rfbFramebufferUpdateRequestMsg )
+	{
+		return false;
+	}
+
+	if( message.incremental == 0 )
+	{
+		m_dirtyRect = m_server->framebuffer().rect();
+	}
+
+	// answer immediately if there are changes, otherwise as soon as the next change happens
+	m_updateRequested = true;
+	sendFramebufferUpdate();
+
+	return true;
+}
+
+
+
+bool BenchServerConnection::receiveFeatureMessage()
+{
+	char messageType;
+	if( m_socket->getChar( &messageType ) == false )
+	{
+		return false;
+	}
+
+	FeatureMessage featureMessage;
+	if( featureMessage.isReadyForReceive( m_socket ) == false )
+	{
+		m_socket->ungetChar( messageType );
+		return false;
+	}
+
+	const auto bytesAvailable = m_socket->bytesAvailable();
+
+	if( featureMessage.receive( m_socket ) == false )
+	{
+		return false;
+	}
+
+	m_server->reportFeatureMessage( featureMessage.featureUid(), sizeof(messageType) + bytesAvailable - m_socket->bytesAvailable() );
+
+	return true;
+}
+
+
+
+void BenchServerConnection::markChanged( const QRect& rect, qint64 timestamp )
+{
+	m_dirtyRect = m_dirtyRect.united( rect );
+
+	if( m_oldestChangeTimestamp < 0 )
+	{
+		m_oldestChangeTimestamp = timestamp;
+	}
+
+	sendFramebufferUpdate();
+}
+
+
+
+void BenchServerConnection::sendFramebufferUpdate()
+{
+	if( m_updateRequested == false || m_dirtyRect.isEmpty() || isRunning() == false )
+	{
+		return;
+	}
+
+	rfbFramebufferUpdateMsg updateMessage{};
+	updateMessage.type = rfbFramebufferUpdate;
+	updateMessage.nRects = qToBigEndian<uint16_t>( 1 );
+
+	rfbFramebufferUpdateRectHeader rectHeader{};
+	rectHeader.r.x = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_dirtyRect.x() ) );
+	rectHeader.r.y = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_dirtyRect.y() ) );
+	rectHeader.r.w = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_dirtyRect.width() ) );
+	rectHeader.r.h = qToBigEndian<uint16_t>( static_cast<uint16_t>( m_dirtyRect.height() ) );
+	rectHeader.encoding = qToBigEndian<uint32_t>( rfbEncodingRaw );
+
+	QByteArray buffer;
+	buffer.reserve( sz_rfbFramebufferUpdateMsg + sz_rfbFramebufferUpdateRectHeader +
+					m_dirtyRect.width() * m_dirtyRect.height() * 4 );
+	buffer.append( reinterpret_cast<const char *>( &updateMessage ), sz_rfbFramebufferUpdateMsg );
+	buffer.append( reinterpret_cast<const char *>( &rectHeader ), sz_rfbFramebufferUpdateRectHeader );
+
+	encodeRect( m_dirtyRect, buffer );
+
+	m_socket->write( buffer );
+
+	m_server->reportFramebufferUpdate( buffer.size(), m_oldestChangeTimestamp );
+
+	m_dirtyRect = {};
+	m_oldestChangeTimestamp = -1;
+	m_updateRequested = false;
+}
+
+
+
+void BenchServerConnection::encodeRect( const QRect& rect, QByteArray& buffer ) const
+{
+	const auto& framebuffer = m_server->framebuffer();
+	const auto lineSize = rect.width() * 4;
+
+	for( int y = rect.top(); y <= rect.bottom(); ++y )
+	{
+		const auto line = reinterpret_cast<const QRgb *>( framebuffer.constScanLine( y ) ) + rect.left();
+
+		if( m_nativePixelFormat )
+		{
+			buffer.append( reinterpret_cast<const char *>( line ), lineSize );
+			continue;
+		}
+
+		for( int x = 0; x < rect.width(); ++x )
+		{
+			const auto pixel = static_cast<uint32_t>(
+								   ( qRed( line[x] ) * m_pixelFormat.redMax / 255 ) << m_pixelFormat.redShift |
+								   ( qGreen( line[x] ) * m_pixelFormat.greenMax / 255 ) << m_pixelFormat.greenShift |
+								   ( qBlue( line[x] ) * m_pixelFormat.blueMax / 255 ) << m_pixelFormat.blueShift );
+
+			const auto value = m_pixelFormat.bigEndian ? qToBigEndian( pixel ) : qToLittleEndian( pixel );
+			buffer.append( reinterpret_cast<const char *>( &value ), sizeof(value) );
+		}
+	}
+}
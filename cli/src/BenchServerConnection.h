@@ -0,0 +1,99 @@
+/*
+ * BenchServerConnection.h - header file for the BenchServerConnection class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "BenchServerProtocol.h"
+
+class BenchServer;
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+class BenchServerConnection : public QObject
+{
+	Q_OBJECT
+public:
+	static constexpr int ProtocolRetryTime = 250;
+	static constexpr int VncAuthChallengeSize = 16;
+
+	BenchServerConnection( BenchServer* server, QTcpSocket* socket );
+	~BenchServerConnection() override;
+
+private:
+	struct PixelFormat
+	{
+		int bitsPerPixel{32};
+		bool bigEndian{false};
+		bool trueColour{true};
+		int redMax{255};
+		int greenMax{255};
+		int blueMax{255};
+		int redShift{16};
+		int greenShift{8};
+		int blueShift{0};
+	};
+
+	enum class VncAuthState {
+		Disabled,
+		Protocol,
+		SecurityType,
+		Challenge,
+		ClientInit,
+		Running
+	};
+
+	bool isRunning() const;
+
+	void processClient();
+	bool receiveVncAuthenticationMessage();
+	bool receiveClientMessage();
+	bool receiveSetPixelFormat();
+	bool receiveFramebufferUpdateRequest();
+	bool receiveFeatureMessage();
+
+	void markChanged( const QRect& rect, qint64 timestamp );
+	void sendFramebufferUpdate();
+	void encodeRect( const QRect& rect, QByteArray& buffer ) const;
+
+	BenchServer* m_server;
+	QTcpSocket* m_socket;
+
+	VncServerClient m_vncServerClient{};
+	BenchServerProtocol m_serverProtocol;
+	QTimer m_protocolRetryTimer{this};
+	VncAuthState m_vncAuthState{VncAuthState::Disabled};
+
+	const QMap<int, int> m_rfbClientToServerMessageSizes;
+
+	PixelFormat m_pixelFormat{};
+	bool m_nativePixelFormat{true};
+
+	QRect m_dirtyRect{};
+	qint64 m_oldestChangeTimestamp{-1};
+	bool m_updateRequested{false};
+
+} ;
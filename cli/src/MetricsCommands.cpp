@@ -0,0 +1,99 @@
+/*
+ * MetricsCommands.cpp - implementation of MetricsCommands class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "MetricsCommands.h"
+#include "MetricsServer.h"
+#include "VeyonConfiguration.h"
+
+
+MetricsCommands::MetricsCommands( QObject* parent ) :
+	QObject( parent ),
+	m_commands( {
+		{ QStringLiteral("dump"), tr( "Dump metrics of the Veyon Server and its workers in the given session (default: 0)" ) },
+		{ QStringLiteral("master"), tr( "Dump metrics of the running Veyon Master" ) },
+		} )
+{
+}
+
+
+
+QStringList MetricsCommands::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString MetricsCommands::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult MetricsCommands::handle_dump( const QStringList& arguments )
+{
+	bool ok = true;
+	const auto sessionId = arguments.value( 0, QStringLiteral("0") ).toInt( &ok );
+	if( ok == false || sessionId < 0 )
+	{
+		error( tr( "Please specify a valid session ID." ) );
+		return InvalidArguments;
+	}
+
+	return dumpMetrics( VeyonCore::config().metricsPort() + sessionId );
+}
+
+
+
+CommandLinePluginInterface::RunResult MetricsCommands::handle_master( const QStringList& arguments )
+{
+	Q_UNUSED(arguments)
+
+	return dumpMetrics( VeyonCore::config().masterMetricsPort() );
+}
+
+
+
+CommandLinePluginInterface::RunResult MetricsCommands::dumpMetrics( int port )
+{
+	if( VeyonCore::config().metricsEnabled() == false )
+	{
+		error( tr( "Metrics are disabled. Set Network/MetricsEnabled to true and restart the service." ) );
+		return Failed;
+	}
+
+	QString errorString;
+	const auto metrics = MetricsServer::fetch( port, &errorString );
+	if( metrics.isEmpty() )
+	{
+		error( tr( "Could not retrieve metrics from port %1: %2" ).arg( port ).arg( errorString ) );
+		return Failed;
+	}
+
+	// output already is terminated by a newline
+	printf( "%s", qUtf8Printable( metrics ) );
+
+	return NoResult;
+}
@@ -0,0 +1,90 @@
+/*
+ * MetricsCommands.h - declaration of MetricsCommands class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include "CommandLinePluginInterface.h"
+#include "CommandLineIO.h"
+
+class MetricsCommands : public QObject, CommandLinePluginInterface, PluginInterface, CommandLineIO
+{
+	Q_OBJECT
+	Q_INTERFACES(PluginInterface CommandLinePluginInterface)
+public:
+	explicit MetricsCommands( QObject* parent = nullptr );
+	~MetricsCommands() override = default;
+
+	Plugin::Uid uid() const override
+	{
+		return QStringLiteral("b98a0f15-598e-4400-8761-502546403077");
+	}
+
+	QVersionNumber version() const override
+	{
+		return QVersionNumber( 1, 0 );
+	}
+
+	QString name() const override
+	{
+		return QStringLiteral( "Metrics" );
+	}
+
+	QString description() const override
+	{
+		return tr( "Metrics-related CLI operations" );
+	}
+
+	QString vendor() const override
+	{
+		return QStringLiteral( "Veyon Community" );
+	}
+
+	QString copyright() const override
+	{
+		return QStringLiteral( "Tobias Junghans" );
+	}
+
+	QString commandLineModuleName() const override
+	{
+		return QStringLiteral( "metrics" );
+	}
+
+	QString commandLineModuleHelp() const override
+	{
+		return tr( "Commands for inspecting performance metrics" );
+	}
+
+	QStringList commands() const override;
+	QString commandHelp( const QString& command ) const override;
+
+public slots:
+	CommandLinePluginInterface::RunResult handle_dump( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_master( const QStringList& arguments );
+
+private:
+	CommandLinePluginInterface::RunResult dumpMetrics( int port );
+
+	const QMap<QString, QString> m_commands;
+
+};
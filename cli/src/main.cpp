@@ -26,8 +26,10 @@
 
 #include <openssl/crypto.h>
 
+#include "BenchCommands.h"
 #include "ConfigCommands.h"
 #include "Logger.h"
+#include "MetricsCommands.h"
 #include "PluginsCommands.h"
 #include "PluginManager.h"
 
@@ -80,7 +82,9 @@ int main( int argc, char **argv )
 	}
 
 	auto core = new VeyonCore( app, VeyonCore::Component::CLI, QStringLiteral("CLI") );
+	VeyonCore::pluginManager().registerExtraPluginInterface( new BenchCommands( core ) );
 	VeyonCore::pluginManager().registerExtraPluginInterface( new ConfigCommands( core ) );
+	VeyonCore::pluginManager().registerExtraPluginInterface( new MetricsCommands( core ) );
 	VeyonCore::pluginManager().registerExtraPluginInterface( new PluginsCommands( core ) );
 
 	QHash<CommandLinePluginInterface *, QObject *> commandLinePluginInterfaces;
@@ -23,7 +23,8 @@
  */
 
 #include <QNetworkInterface>
-#include <QRegularExpression>
+
+#include <limits>
 
 #include "UserGroupsBackendManager.h"
 #include "AccessControlProvider.h"
@@ -36,19 +37,21 @@
 #include "PlatformUserFunctions.h"
 
 
+QMutex AccessControlProvider::s_compiledRulesMutex;
+QSharedPointer<const AccessControlProvider::CompiledRules> AccessControlProvider::s_compiledRules;
+quint64 AccessControlProvider::s_compiledRulesGeneration = 0;
+
+
 AccessControlProvider::AccessControlProvider() :
+	m_accessControlRules( compiledRules() ),
 	m_userGroupsBackend( VeyonCore::userGroupsBackendManager().accessControlBackend() ),
 	m_networkObjectDirectory( VeyonCore::networkObjectDirectoryManager().configuredDirectory() ),
-	m_queryDomainGroups( VeyonCore::config().domainGroupsForAccessControlEnabled() )
+	m_queryDomainGroups( VeyonCore::config().domainGroupsForAccessControlEnabled() ),
+	m_userGroupQueriesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_access_control_user_group_queries_total"),
+															 QStringLiteral("Groups of user queried from user groups backend for access control") ) ),
+	m_locationQueriesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_access_control_location_queries_total"),
+															QStringLiteral("Locations of computer queried from network object directory for access control") ) )
 {
-	const QJsonArray accessControlRules = VeyonCore::config().accessControlRules();
-
-	m_accessControlRules.reserve( accessControlRules.size() );
-
-	for( const auto& accessControlRule : accessControlRules )
-	{
-		m_accessControlRules.append( AccessControlRule( accessControlRule ) );
-	}
 }
 
 
@@ -176,25 +179,94 @@ AccessControlRule::Action AccessControlProvider::processAccessControlRules( cons
 																			const QString& localComputer,
 																			const QStringList& connectedUsers )
 {
-	vDebug() << "processing rules for" << accessingUser << accessingComputer << localUser << localComputer << connectedUsers;
+	Evaluation evaluation{ accessingUser, accessingComputer, localUser, localComputer, connectedUsers };
+
+	return processAccessControlRules( evaluation );
+}
+
+
+
+AccessControlProvider::Lookups AccessControlProvider::performLookups( const QStringList& users, const QStringList& computers )
+{
+	Evaluation evaluation{};
+
+	if( rulesUseCondition( AccessControlRule::Condition::MemberOfUserGroup ) ||
+		rulesUseCondition( AccessControlRule::Condition::GroupsInCommon ) )
+	{
+		for( const auto& user : users )
+		{
+			if( user.isEmpty() == false )
+			{
+				groupsOfUser( evaluation, user );
+			}
+		}
+	}
+
+	if( rulesUseCondition( AccessControlRule::Condition::LocatedAt ) ||
+		rulesUseCondition( AccessControlRule::Condition::SameLocation ) )
+	{
+		for( const auto& computer : computers )
+		{
+			if( computer.isEmpty() == false )
+			{
+				locationsOfComputer( evaluation, computer );
+			}
+		}
+	}
+
+	if( rulesUseCondition( AccessControlRule::Condition::NoUserLoggedOn ) )
+	{
+		isNoUserLoggedOn( evaluation );
+	}
+
+	return { evaluation.userGroups, evaluation.computerLocations, evaluation.noUserLoggedOn };
+}
+
+
+
+AccessControlRule::Action AccessControlProvider::processAccessControlRules( const QString& accessingUser,
+																			const QString& accessingComputer,
+																			const QString& localUser,
+																			const QString& localComputer,
+																			const QStringList& connectedUsers,
+																			const Lookups& lookups )
+{
+	Evaluation evaluation{ accessingUser, accessingComputer, localUser, localComputer, connectedUsers,
+						   lookups.userGroups, lookups.computerLocations, true, lookups.noUserLoggedOn, false, true };
+
+	return processAccessControlRules( evaluation );
+}
+
+
+
+AccessControlRule::Action AccessControlProvider::processAccessControlRules( Evaluation& evaluation )
+{
+	vDebug() << "processing rules for" << evaluation.accessingUser << evaluation.accessingComputer
+			 << evaluation.localUser << evaluation.localComputer << evaluation.connectedUsers;
+
+	m_connectedUsersQueried = false;
 
-	for( const auto& rule : qAsConst( m_accessControlRules ) )
+	for( const auto& rule : qAsConst( *m_accessControlRules ) )
 	{
 		// rule disabled?
-		if( rule.action() == AccessControlRule::Action::None )
+		if( rule.action == AccessControlRule::Action::None )
 		{
 			// then continue with next rule
 			continue;
 		}
 
-		if( rule.areConditionsIgnored() ||
-			matchConditions( rule, accessingUser, accessingComputer, localUser, localComputer, connectedUsers ) )
+		if( rule.conditionsIgnored ||
+			matchConditions( rule, evaluation ) )
 		{
-			vDebug() << "rule" << rule.name() << "matched with action" << rule.action();
-			return rule.action();
+			m_connectedUsersQueried = evaluation.connectedUsersQueried;
+
+			vDebug() << "rule" << rule.name << "matched with action" << rule.action;
+			return rule.action;
 		}
 	}
 
+	m_connectedUsersQueried = evaluation.connectedUsersQueried;
+
 	vDebug() << "no matching rule, denying access";
 
 	return AccessControlRule::Action::Deny;
@@ -211,12 +283,13 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 		return false;
 	}
 
-	for( const auto& rule : qAsConst( m_accessControlRules ) )
+	Evaluation evaluation{ {}, {}, VeyonCore::platform().userFunctions().currentUser(), HostAddress::localFQDN(), {} };
+
+	for( const auto& rule : qAsConst( *m_accessControlRules ) )
 	{
-		if( matchConditions( rule, {}, {},
-							 VeyonCore::platform().userFunctions().currentUser(), HostAddress::localFQDN(), {} ) )
+		if( matchConditions( rule, evaluation ) )
 		{
-			switch( rule.action() )
+			switch( rule.action )
 			{
 			case AccessControlRule::Action::Deny:
 				return true;
@@ -234,45 +307,185 @@ bool AccessControlProvider::isAccessToLocalComputerDenied() const
 
 
 
-bool AccessControlProvider::isMemberOfUserGroup( const QString &user,
-												 const QString &groupName ) const
+QSharedPointer<const AccessControlProvider::CompiledRules> AccessControlProvider::compiledRules()
+{
+	QMutexLocker locker( &s_compiledRulesMutex );
+
+	// a provider is created per connection so only compile again after the configuration changed
+	const auto generation = VeyonCore::config().generation();
+	if( s_compiledRules && s_compiledRulesGeneration == generation )
+	{
+		return s_compiledRules;
+	}
+
+	const QJsonArray accessControlRules = VeyonCore::config().accessControlRules();
+
+	auto rules = QSharedPointer<CompiledRules>::create();
+	rules->reserve( accessControlRules.size() );
+
+	for( const auto& accessControlRule : accessControlRules )
+	{
+		rules->append( compileRule( AccessControlRule( accessControlRule ) ) );
+	}
+
+	s_compiledRules = rules;
+	s_compiledRulesGeneration = generation;
+
+	return s_compiledRules;
+}
+
+
+
+AccessControlProvider::CompiledRule AccessControlProvider::compileRule( const AccessControlRule& rule )
+{
+	static const std::initializer_list<AccessControlRule::Condition> allConditions = {
+		AccessControlRule::Condition::MemberOfUserGroup,
+		AccessControlRule::Condition::GroupsInCommon,
+		AccessControlRule::Condition::LocatedAt,
+		AccessControlRule::Condition::SameLocation,
+		AccessControlRule::Condition::AccessFromLocalHost,
+		AccessControlRule::Condition::AccessFromLocalUser,
+		AccessControlRule::Condition::AccessFromAlreadyConnectedUser,
+		AccessControlRule::Condition::NoUserLoggedOn
+	};
+
+	CompiledRule compiledRule{ rule.name(), rule.action(), rule.areConditionsIgnored(), rule.areConditionsInverted(), {} };
+
+	for( const auto condition : allConditions )
+	{
+		if( rule.isConditionEnabled( condition ) == false )
+		{
+			continue;
+		}
+
+		CompiledCondition compiledCondition{ condition, rule.subject( condition ), rule.argument( condition ),
+											 {}, conditionCost( condition ) };
+
+		if( condition == AccessControlRule::Condition::MemberOfUserGroup )
+		{
+			compiledCondition.argumentRX.setPattern( compiledCondition.argument );
+			compiledCondition.argumentRX.optimize();
+		}
+
+		compiledRule.conditions.append( compiledCondition );
+	}
+
+	// all conditions have to match and evaluating them has no side effects, so evaluate
+	// conditions which can be decided locally before the ones requiring backend queries
+	std::stable_sort( compiledRule.conditions.begin(), compiledRule.conditions.end(),
+					  []( const CompiledCondition& a, const CompiledCondition& b ) {
+						  return a.cost < b.cost;
+					  } );
+
+	return compiledRule;
+}
+
+
+
+int AccessControlProvider::conditionCost( AccessControlRule::Condition condition )
+{
+	switch( condition )
+	{
+	case AccessControlRule::Condition::AccessFromLocalUser:
+	case AccessControlRule::Condition::AccessFromAlreadyConnectedUser:
+		return 0;
+	case AccessControlRule::Condition::AccessFromLocalHost:
+		return 1;
+	case AccessControlRule::Condition::NoUserLoggedOn:
+		return 2;
+	case AccessControlRule::Condition::MemberOfUserGroup:
+		return 3;
+	case AccessControlRule::Condition::GroupsInCommon:
+		return 4;
+	case AccessControlRule::Condition::LocatedAt:
+		return 5;
+	case AccessControlRule::Condition::SameLocation:
+		return 6;
+	default:
+		break;
+	}
+
+	return std::numeric_limits<int>::max();
+}
+
+
+
+const QStringList& AccessControlProvider::groupsOfUser( Evaluation& evaluation, const QString& user ) const
 {
-	const QRegularExpression groupNameRX( groupName );
+	auto it = evaluation.userGroups.find( user );
+	if( it == evaluation.userGroups.end() )
+	{
+		if( evaluation.lookupsPerformed )
+		{
+			vWarning() << "groups of user" << user << "have not been looked up in advance";
+			return *evaluation.userGroups.insert( user, {} );
+		}
+
+		m_userGroupQueriesCounter.increment();
+		it = evaluation.userGroups.insert( user, m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups ) );
+	}
+
+	return *it;
+}
+
+
+
+const QStringList& AccessControlProvider::locationsOfComputer( Evaluation& evaluation, const QString& computer ) const
+{
+	auto it = evaluation.computerLocations.find( computer );
+	if( it == evaluation.computerLocations.end() )
+	{
+		if( evaluation.lookupsPerformed )
+		{
+			vWarning() << "locations of computer" << computer << "have not been looked up in advance";
+			return *evaluation.computerLocations.insert( computer, {} );
+		}
+
+		m_locationQueriesCounter.increment();
+		it = evaluation.computerLocations.insert( computer, locationsOfComputer( computer ) );
+	}
+
+	return *it;
+}
 
-	if( groupNameRX.isValid() )
+
+
+bool AccessControlProvider::isMemberOfUserGroup( Evaluation& evaluation, const QString& user,
+												 const CompiledCondition& condition ) const
+{
+	if( condition.argumentRX.isValid() )
 	{
-		return m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups ).indexOf( groupNameRX ) >= 0;
+		return groupsOfUser( evaluation, user ).indexOf( condition.argumentRX ) >= 0;
 	}
 
-	return m_userGroupsBackend->groupsOfUser( user, m_queryDomainGroups ).contains( groupName );
+	return groupsOfUser( evaluation, user ).contains( condition.argument );
 }
 
 
 
-bool AccessControlProvider::isLocatedAt( const QString &computer, const QString &locationName ) const
+bool AccessControlProvider::isLocatedAt( Evaluation& evaluation, const QString& computer, const QString& locationName ) const
 {
-	return locationsOfComputer( computer ).contains( locationName );
+	return locationsOfComputer( evaluation, computer ).contains( locationName );
 }
 
 
 
-bool AccessControlProvider::haveGroupsInCommon( const QString &userOne, const QString &userTwo ) const
+bool AccessControlProvider::haveGroupsInCommon( Evaluation& evaluation, const QString& userOne, const QString& userTwo ) const
 {
-	const auto userOneGroups = m_userGroupsBackend->groupsOfUser( userOne, m_queryDomainGroups );
-	const auto userTwoGroups = m_userGroupsBackend->groupsOfUser( userTwo, m_queryDomainGroups );
+	const auto userOneGroups = groupsOfUser( evaluation, userOne ).toSet();
+	const auto userTwoGroups = groupsOfUser( evaluation, userTwo ).toSet();
 
-	return userOneGroups.toSet().intersects( userTwoGroups.toSet() );
+	return userOneGroups.intersects( userTwoGroups );
 }
 
 
 
-bool AccessControlProvider::haveSameLocations( const QString &computerOne, const QString &computerTwo ) const
+bool AccessControlProvider::haveSameLocations( Evaluation& evaluation, const QString& computerOne, const QString& computerTwo ) const
 {
-	const auto computerOneLocations = locationsOfComputer( computerOne );
-	const auto computerTwoLocations = locationsOfComputer( computerTwo );
+	const auto& computerOneLocations = locationsOfComputer( evaluation, computerOne );
 
 	return computerOneLocations.isEmpty() == false &&
-			computerOneLocations == computerTwoLocations;
+			computerOneLocations == locationsOfComputer( evaluation, computerTwo );
 }
 
 
@@ -292,23 +505,25 @@ bool AccessControlProvider::isLocalUser( const QString &accessingUser, const QSt
 
 
 
-bool AccessControlProvider::isNoUserLoggedOn() const
+bool AccessControlProvider::isNoUserLoggedOn( Evaluation& evaluation ) const
 {
-	return VeyonCore::platform().userFunctions().isAnyUserLoggedOn() == false;
+	if( evaluation.noUserLoggedOnQueried == false )
+	{
+		evaluation.noUserLoggedOn = VeyonCore::platform().userFunctions().isAnyUserLoggedOn() == false;
+		evaluation.noUserLoggedOnQueried = true;
+	}
+
+	return evaluation.noUserLoggedOn;
 }
 
 
 
-QString AccessControlProvider::lookupSubject( AccessControlRule::Subject subject,
-											  const QString &accessingUser, const QString &accessingComputer,
-											  const QString &localUser, const QString &localComputer ) const
+QString AccessControlProvider::lookupUser( AccessControlRule::Subject subject, const Evaluation& evaluation ) const
 {
 	switch( subject )
 	{
-	case AccessControlRule::Subject::AccessingUser: return accessingUser;
-	case AccessControlRule::Subject::AccessingComputer: return accessingComputer;
-	case AccessControlRule::Subject::LocalUser: return localUser;
-	case AccessControlRule::Subject::LocalComputer: return localComputer;
+	case AccessControlRule::Subject::AccessingUser: return evaluation.accessingUser;
+	case AccessControlRule::Subject::LocalUser: return evaluation.localUser;
 	default: break;
 	}
 
@@ -317,119 +532,123 @@ QString AccessControlProvider::lookupSubject( AccessControlRule::Subject subject
 
 
 
-bool AccessControlProvider::matchConditions( const AccessControlRule &rule,
-											 const QString& accessingUser, const QString& accessingComputer,
-											 const QString& localUser, const QString& localComputer,
-											 const QStringList& connectedUsers ) const
+QString AccessControlProvider::lookupComputer( AccessControlRule::Subject subject, const Evaluation& evaluation ) const
 {
-	bool hasConditions = false;
+	switch( subject )
+	{
+	case AccessControlRule::Subject::AccessingComputer: return evaluation.accessingComputer;
+	case AccessControlRule::Subject::LocalComputer: return evaluation.localComputer;
+	default: break;
+	}
 
-	// normally all selected conditions have to match in order to make the whole rule match
-	// if conditions should be inverted (i.e. "is member of" is to be interpreted as "is NOT member of")
-	// we have to check against the opposite boolean value
-	bool matchResult = rule.areConditionsInverted() == false;
+	return {};
+}
 
-	vDebug() << rule.toJson() << matchResult;
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::MemberOfUserGroup ) )
+
+bool AccessControlProvider::matchConditions( const CompiledRule& rule, Evaluation& evaluation ) const
+{
+	// do not match the rule if no conditions are set at all
+	if( rule.conditions.isEmpty() )
 	{
-		hasConditions = true;
+		return false;
+	}
 
-		const auto condition = AccessControlRule::Condition::MemberOfUserGroup;
-		const auto user = lookupSubject( rule.subject( condition ), accessingUser, {}, localUser, {} );
-		const auto group = rule.argument( condition );
+	// normally all selected conditions have to match in order to make the whole rule match
+	// if conditions should be inverted (i.e. "is member of" is to be interpreted as "is NOT member of")
+	// we have to check against the opposite boolean value
+	const bool matchResult = rule.conditionsInverted == false;
 
-		if( user.isEmpty() || group.isEmpty() ||
-			isMemberOfUserGroup( user, group ) != matchResult )
-		{
-			return false;
-		}
-	}
+	vDebug() << rule.name << matchResult;
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::GroupsInCommon ) )
+	for( const auto& condition : rule.conditions )
 	{
-		hasConditions = true;
-
-		if( accessingUser.isEmpty() || localUser.isEmpty() ||
-			haveGroupsInCommon( accessingUser, localUser ) != matchResult )
+		if( matchCondition( condition, matchResult, evaluation ) == false )
 		{
 			return false;
 		}
 	}
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::LocatedAt ) )
-	{
-		hasConditions = true;
+	return true;
+}
 
-		const auto condition = AccessControlRule::Condition::LocatedAt;
-		const auto computer = lookupSubject( rule.subject( condition ), {}, accessingComputer, {}, localComputer );
-		const auto location = rule.argument( condition );
 
-		if( computer.isEmpty() || location.isEmpty() ||
-			isLocatedAt( computer, location ) != matchResult )
-		{
-			return false;
-		}
-	}
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::SameLocation ) )
+bool AccessControlProvider::matchCondition( const CompiledCondition& condition, bool matchResult,
+											Evaluation& evaluation ) const
+{
+	const auto& accessingUser = evaluation.accessingUser;
+	const auto& accessingComputer = evaluation.accessingComputer;
+	const auto& localUser = evaluation.localUser;
+	const auto& localComputer = evaluation.localComputer;
+
+	switch( condition.condition )
+	{
+	case AccessControlRule::Condition::MemberOfUserGroup:
 	{
-		hasConditions = true;
+		const auto user = lookupUser( condition.subject, evaluation );
 
-		if( accessingComputer.isEmpty() || localComputer.isEmpty() ||
-			haveSameLocations( accessingComputer, localComputer ) != matchResult )
-		{
-			return false;
-		}
+		return user.isEmpty() == false && condition.argument.isEmpty() == false &&
+				isMemberOfUserGroup( evaluation, user, condition ) == matchResult;
 	}
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::AccessFromLocalHost ) )
+	case AccessControlRule::Condition::GroupsInCommon:
+		return accessingUser.isEmpty() == false && localUser.isEmpty() == false &&
+				haveGroupsInCommon( evaluation, accessingUser, localUser ) == matchResult;
+
+	case AccessControlRule::Condition::LocatedAt:
 	{
-		hasConditions = true;
+		const auto computer = lookupComputer( condition.subject, evaluation );
 
-		if( isLocalHost( accessingComputer ) != matchResult )
-		{
-			return false;
-		}
+		return computer.isEmpty() == false && condition.argument.isEmpty() == false &&
+				isLocatedAt( evaluation, computer, condition.argument ) == matchResult;
 	}
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::AccessFromLocalUser ) )
-	{
-		hasConditions = true;
+	case AccessControlRule::Condition::SameLocation:
+		return accessingComputer.isEmpty() == false && localComputer.isEmpty() == false &&
+				haveSameLocations( evaluation, accessingComputer, localComputer ) == matchResult;
 
-		if( isLocalUser( accessingUser, localUser ) != matchResult )
-		{
-			return false;
-		}
-	}
+	case AccessControlRule::Condition::AccessFromLocalHost:
+		return isLocalHost( accessingComputer ) == matchResult;
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::AccessFromAlreadyConnectedUser ) )
-	{
-		hasConditions = true;
+	case AccessControlRule::Condition::AccessFromLocalUser:
+		return isLocalUser( accessingUser, localUser ) == matchResult;
 
-		if( connectedUsers.contains( accessingUser ) != matchResult )
-		{
-			return false;
-		}
+	case AccessControlRule::Condition::AccessFromAlreadyConnectedUser:
+		evaluation.connectedUsersQueried = true;
+		return evaluation.connectedUsers.contains( accessingUser ) == matchResult;
+
+	case AccessControlRule::Condition::NoUserLoggedOn:
+		return isNoUserLoggedOn( evaluation ) == matchResult;
+
+	default:
+		break;
 	}
 
-	if( rule.isConditionEnabled( AccessControlRule::Condition::NoUserLoggedOn ) )
-	{
-		hasConditions = true;
+	return false;
+}
 
-		if( isNoUserLoggedOn() != matchResult )
+
+
+bool AccessControlProvider::rulesUseCondition( AccessControlRule::Condition condition ) const
+{
+	for( const auto& rule : qAsConst( *m_accessControlRules ) )
+	{
+		if( rule.action == AccessControlRule::Action::None || rule.conditionsIgnored )
 		{
-			return false;
+			continue;
 		}
-	}
 
-	// do not match the rule if no conditions are set at all
-	if( hasConditions == false )
-	{
-		return false;
+		for( const auto& compiledCondition : rule.conditions )
+		{
+			if( compiledCondition.condition == condition )
+			{
+				return true;
+			}
+		}
 	}
 
-	return true;
+	return false;
 }
 
 
@@ -24,7 +24,12 @@
 
 #pragma once
 
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSharedPointer>
+
 #include "AccessControlRule.h"
+#include "MetricsRegistry.h"
 #include "NetworkObject.h"
 
 class UserGroupsBackendInterface;
@@ -39,6 +44,15 @@ public:
 		ToBeConfirmed,
 	} ;
 
+	// results of user group and location lookups taken in advance so that rules can be processed
+	// in a different thread without accessing user groups backends and network object directories
+	struct Lookups
+	{
+		QHash<QString, QStringList> userGroups{};
+		QHash<QString, QStringList> computerLocations{};
+		bool noUserLoggedOn{false};
+	};
+
 	AccessControlProvider();
 
 	QStringList userGroups() const;
@@ -56,31 +70,99 @@ public:
 														 const QString& localComputer,
 														 const QStringList& connectedUsers );
 
+	// performs all lookups required by the configured rules for the given users and computers
+	Lookups performLookups( const QStringList& users, const QStringList& computers );
+
+	AccessControlRule::Action processAccessControlRules( const QString& accessingUser,
+														 const QString& accessingComputer,
+														 const QString& localUser,
+														 const QString& localComputer,
+														 const QStringList& connectedUsers,
+														 const Lookups& lookups );
+
 	bool isAccessToLocalComputerDenied() const;
 
+	// whether the result of the last rule processing depends on the set of connected users
+	bool hasQueriedConnectedUsers() const
+	{
+		return m_connectedUsersQueried;
+	}
+
 private:
-	bool isMemberOfUserGroup( const QString& user, const QString& groupName ) const;
-	bool isLocatedAt( const QString& computer, const QString& locationName ) const;
-	bool haveGroupsInCommon( const QString& userOne, const QString& userTwo ) const;
-	bool haveSameLocations( const QString& computerOne, const QString& computerTwo ) const;
+	struct CompiledCondition
+	{
+		AccessControlRule::Condition condition;
+		AccessControlRule::Subject subject;
+		AccessControlRule::ConditionArgument argument;
+		QRegularExpression argumentRX;
+		int cost;
+	};
+
+	struct CompiledRule
+	{
+		QString name;
+		AccessControlRule::Action action;
+		bool conditionsIgnored;
+		bool conditionsInverted;
+		QVector<CompiledCondition> conditions;
+	};
+
+	// subjects of a single rule evaluation along with lookup results memoized while processing all rules
+	struct Evaluation
+	{
+		QString accessingUser;
+		QString accessingComputer;
+		QString localUser;
+		QString localComputer;
+		QStringList connectedUsers;
+		QHash<QString, QStringList> userGroups{};
+		QHash<QString, QStringList> computerLocations{};
+		bool noUserLoggedOnQueried{false};
+		bool noUserLoggedOn{false};
+		bool connectedUsersQueried{false};
+		bool lookupsPerformed{false};
+	};
+
+	AccessControlRule::Action processAccessControlRules( Evaluation& evaluation );
+	bool rulesUseCondition( AccessControlRule::Condition condition ) const;
+
+	using CompiledRules = QVector<CompiledRule>;
+
+	// compiled once per configuration generation and shared by all instances
+	static QSharedPointer<const CompiledRules> compiledRules();
+	static CompiledRule compileRule( const AccessControlRule& rule );
+	static int conditionCost( AccessControlRule::Condition condition );
+
+	const QStringList& groupsOfUser( Evaluation& evaluation, const QString& user ) const;
+	const QStringList& locationsOfComputer( Evaluation& evaluation, const QString& computer ) const;
+
+	bool isMemberOfUserGroup( Evaluation& evaluation, const QString& user, const CompiledCondition& condition ) const;
+	bool isLocatedAt( Evaluation& evaluation, const QString& computer, const QString& locationName ) const;
+	bool haveGroupsInCommon( Evaluation& evaluation, const QString& userOne, const QString& userTwo ) const;
+	bool haveSameLocations( Evaluation& evaluation, const QString& computerOne, const QString& computerTwo ) const;
 	bool isLocalHost( const QString& accessingComputer ) const;
 	bool isLocalUser( const QString& accessingUser, const QString& localUser ) const;
-	bool isNoUserLoggedOn() const;
+	bool isNoUserLoggedOn( Evaluation& evaluation ) const;
 
-	QString lookupSubject( AccessControlRule::Subject subject,
-						   const QString& accessingUser, const QString& accessingComputer,
-						   const QString& localUser, const QString& localComputer ) const;
+	QString lookupUser( AccessControlRule::Subject subject, const Evaluation& evaluation ) const;
+	QString lookupComputer( AccessControlRule::Subject subject, const Evaluation& evaluation ) const;
 
-	bool matchConditions( const AccessControlRule& rule,
-						  const QString& accessingUser, const QString& accessingComputer,
-						  const QString& localUser, const QString& localComputer,
-						  const QStringList& connectedUsers ) const;
+	bool matchConditions( const CompiledRule& rule, Evaluation& evaluation ) const;
+	bool matchCondition( const CompiledCondition& condition, bool matchResult, Evaluation& evaluation ) const;
 
 	static QStringList objectNames( const NetworkObjectList& objects );
 
-	QList<AccessControlRule> m_accessControlRules{};
+	static QMutex s_compiledRulesMutex;
+	static QSharedPointer<const CompiledRules> s_compiledRules;
+	static quint64 s_compiledRulesGeneration;
+
+	QSharedPointer<const CompiledRules> m_accessControlRules;
 	UserGroupsBackendInterface* m_userGroupsBackend;
 	NetworkObjectDirectory* m_networkObjectDirectory;
 	bool m_queryDomainGroups;
+	bool m_connectedUsersQueried{false};
+
+	MetricsRegistry::Counter& m_userGroupQueriesCounter;
+	MetricsRegistry::Counter& m_locationQueriesCounter;
 
 } ;
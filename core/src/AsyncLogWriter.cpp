@@ -0,0 +1,174 @@
+/*
+ * AsyncLogWriter.cpp - implementation of AsyncLogWriter class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QDateTime>
+
+#include "AsyncLogWriter.h"
+
+
+AsyncLogWriter::AsyncLogWriter( const BatchHandler& batchHandler, int capacity ) :
+	QThread(),
+	m_batchHandler( batchHandler ),
+	m_queue( static_cast<size_t>( qMax( 2, capacity ) ) ),
+	m_startTime( QDateTime::currentMSecsSinceEpoch() )
+{
+	m_clock.start();
+}
+
+
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	stop();
+}
+
+
+
+bool AsyncLogWriter::enqueue( Logger::LogLevel logLevel, const QString& message )
+{
+	Record record;
+	record.logLevel = logLevel;
+	record.timestamp = m_startTime + m_clock.elapsed();
+	record.message = message;
+
+	if( m_queue.enqueue( std::move( record ) ) == false )
+	{
+		++m_droppedRecordCount;
+		++m_unreportedDroppedRecordCount;
+		return false;
+	}
+
+	if( m_idle.exchange( false ) )
+	{
+		QMutexLocker locker( &m_idleMutex );
+		m_idleCondition.wakeOne();
+	}
+
+	return true;
+}
+
+
+
+void AsyncLogWriter::flush()
+{
+	if( isRunning() == false || QThread::currentThread() == this )
+	{
+		// process records synchronously if no writer thread is available
+		// or if called by the batch handler itself
+		if( QThread::currentThread() != this )
+		{
+			processRecords();
+		}
+		return;
+	}
+
+	{
+		QMutexLocker locker( &m_idleMutex );
+		m_idleCondition.wakeOne();
+	}
+
+	QElapsedTimer flushTimer;
+	flushTimer.start();
+
+	while( ( m_queue.isEmpty() == false || m_processing ) && flushTimer.elapsed() < FlushTimeout )
+	{
+		QThread::yieldCurrentThread();
+	}
+}
+
+
+
+void AsyncLogWriter::stop()
+{
+	if( isRunning() )
+	{
+		m_running = false;
+
+		{
+			QMutexLocker locker( &m_idleMutex );
+			m_idleCondition.wakeOne();
+		}
+
+		wait();
+	}
+
+	processRecords();
+}
+
+
+
+void AsyncLogWriter::run()
+{
+	while( m_running )
+	{
+		if( processRecords() )
+		{
+			continue;
+		}
+
+		// announce idle state while holding the mutex so producers can't wake us
+		// between the check for pending records and starting to wait
+		QMutexLocker locker( &m_idleMutex );
+		m_idle = true;
+		if( m_running && m_queue.isEmpty() )
+		{
+			m_idleCondition.wait( &m_idleMutex, IdleInterval );
+		}
+		m_idle = false;
+	}
+}
+
+
+
+bool AsyncLogWriter::processRecords()
+{
+	m_processing = true;
+
+	Records records;
+	Record record;
+
+	while( records.size() < MaximumBatchSize && m_queue.dequeue( record ) )
+	{
+		records.append( std::move( record ) );
+	}
+
+	const auto droppedRecordCount = m_unreportedDroppedRecordCount.exchange( 0 );
+	if( droppedRecordCount > 0 )
+	{
+		Record droppedRecord;
+		droppedRecord.logLevel = Logger::LogLevel::Warning;
+		droppedRecord.timestamp = m_startTime + m_clock.elapsed();
+		droppedRecord.message = QStringLiteral( "Log queue overflow - dropped %1 messages" ).arg( droppedRecordCount );
+		records.append( droppedRecord );
+	}
+
+	if( records.isEmpty() == false )
+	{
+		m_batchHandler( records );
+	}
+
+	m_processing = false;
+
+	return records.isEmpty() == false;
+}
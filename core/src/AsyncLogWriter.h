@@ -0,0 +1,90 @@
+/*
+ * AsyncLogWriter.h - background thread for writing log records in batches
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <functional>
+
+#include "LockFreeQueue.h"
+#include "Logger.h"
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+class VEYON_CORE_EXPORT AsyncLogWriter : public QThread
+{
+	Q_OBJECT
+public:
+	using Record = Logger::Record;
+	using Records = QVector<Record>;
+	using BatchHandler = std::function<void(const Records&)>;
+
+	static constexpr int DefaultCapacity = 8192;
+	static constexpr int MaximumBatchSize = 1024;
+	static constexpr int IdleInterval = 50;
+	static constexpr int FlushTimeout = 1000;
+
+	explicit AsyncLogWriter( const BatchHandler& batchHandler, int capacity = DefaultCapacity );
+	~AsyncLogWriter() override;
+
+	// called by producers - never blocks and drops the record if the queue is full
+	bool enqueue( Logger::LogLevel logLevel, const QString& message );
+
+	// blocks until all records enqueued so far have been handed to the batch handler
+	// or the flush timeout has been reached
+	void flush();
+
+	void stop();
+
+	int droppedRecordCount() const
+	{
+		return m_droppedRecordCount.load();
+	}
+
+protected:
+	void run() override;
+
+private:
+	bool processRecords();
+
+	const BatchHandler m_batchHandler;
+	LockFreeQueue<Record> m_queue;
+
+	const qint64 m_startTime;
+	QElapsedTimer m_clock{};
+
+	std::atomic<bool> m_running{true};
+	std::atomic<bool> m_idle{false};
+	std::atomic<bool> m_processing{false};
+	std::atomic<int> m_droppedRecordCount{0};
+	std::atomic<int> m_unreportedDroppedRecordCount{0};
+
+	QMutex m_idleMutex{};
+	QWaitCondition m_idleCondition{};
+
+} ;
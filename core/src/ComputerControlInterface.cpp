@@ -94,6 +94,7 @@ void ComputerControlInterface::start( QSize scaledScreenSize, UpdateMode updateM
 		} );
 
 		connect( m_vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::updateState );
+		connect( m_vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::subscribeUpdates );
 		connect( m_vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::updateUser );
 		connect( m_vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::updateActiveFeatures );
 		connect( m_vncConnection, &VncConnection::stateChanged, this, &ComputerControlInterface::stateChanged );
@@ -218,16 +219,54 @@ void ComputerControlInterface::setDesignatedModeFeature( Feature::Uid designated
 
 
 
-void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& featureMessage, bool wake )
+void ComputerControlInterface::sendFeatureMessage( const FeatureMessage& featureMessage, bool wake,
+												  const QByteArray& serializedMessage )
 {
+	if( m_captureFeatureMessages )
+	{
+		m_capturedFeatureMessages.append( featureMessage );
+		return;
+	}
+
 	if( m_connection && m_connection->isConnected() )
 	{
-		m_connection->sendFeatureMessage( featureMessage, wake );
+		m_connection->sendFeatureMessage( featureMessage, wake, serializedMessage );
 	}
 }
 
 
 
+FeatureMessage::Format ComputerControlInterface::featureMessageFormat() const
+{
+	if( m_connection )
+	{
+		return m_connection->featureMessageFormat();
+	}
+
+	return FeatureMessage::Format::VariantArray;
+}
+
+
+
+void ComputerControlInterface::startFeatureMessageCapture()
+{
+	m_captureFeatureMessages = true;
+}
+
+
+
+QList<FeatureMessage> ComputerControlInterface::finishFeatureMessageCapture()
+{
+	m_captureFeatureMessages = false;
+
+	QList<FeatureMessage> capturedFeatureMessages;
+	capturedFeatureMessages.swap( m_capturedFeatureMessages );
+
+	return capturedFeatureMessages;
+}
+
+
+
 bool ComputerControlInterface::isMessageQueueEmpty()
 {
 	if( m_vncConnection && m_vncConnection->isConnected() )
@@ -239,6 +278,18 @@ bool ComputerControlInterface::isMessageQueueEmpty()
 }
 
 
+int ComputerControlInterface::messageQueueSize()
+{
+	if( m_vncConnection && m_vncConnection->isConnected() )
+	{
+		return m_vncConnection->eventQueueSize();
+	}
+
+	return 0;
+}
+
+
+
 void ComputerControlInterface::setUpdateMode( UpdateMode updateMode )
 {
 	m_updateMode = updateMode;
@@ -254,7 +305,14 @@ void ComputerControlInterface::setUpdateMode( UpdateMode updateMode )
 		}
 
 		m_userUpdateTimer.stop();
-		m_activeFeaturesUpdateTimer.start( UpdateIntervalDisabled );
+		if( m_serverPushesUpdates )
+		{
+			m_activeFeaturesUpdateTimer.stop();
+		}
+		else
+		{
+			m_activeFeaturesUpdateTimer.start( UpdateIntervalDisabled );
+		}
 		break;
 
 	case UpdateMode::Monitoring:
@@ -265,14 +323,57 @@ void ComputerControlInterface::setUpdateMode( UpdateMode updateMode )
 															   computerMonitoringUpdateInterval : -1 );
 		}
 
-		m_userUpdateTimer.start( computerMonitoringUpdateInterval );
-		m_activeFeaturesUpdateTimer.start( computerMonitoringUpdateInterval );
+		if( m_serverPushesUpdates )
+		{
+			m_userUpdateTimer.stop();
+			m_activeFeaturesUpdateTimer.stop();
+		}
+		else
+		{
+			m_userUpdateTimer.start( computerMonitoringUpdateInterval );
+			m_activeFeaturesUpdateTimer.start( computerMonitoringUpdateInterval );
+		}
 		break;
 	}
 }
 
 
 
+void ComputerControlInterface::setServerPushesUpdates( bool enabled )
+{
+	if( enabled != m_serverPushesUpdates )
+	{
+		m_serverPushesUpdates = enabled;
+
+		// (re)start or stop polling
+		setUpdateMode( m_updateMode );
+	}
+}
+
+
+
+void ComputerControlInterface::resetUpdateSequenceNumber( Feature::Uid featureUid, quint32 sequenceNumber )
+{
+	m_updateSequenceNumbers[featureUid] = sequenceNumber;
+}
+
+
+
+bool ComputerControlInterface::advanceUpdateSequenceNumber( Feature::Uid featureUid, quint32 sequenceNumber )
+{
+	const auto it = m_updateSequenceNumbers.find( featureUid );
+	if( it == m_updateSequenceNumbers.end() || it.value() + 1 != sequenceNumber )
+	{
+		return false;
+	}
+
+	it.value() = sequenceNumber;
+
+	return true;
+}
+
+
+
 ComputerControlInterface::Pointer ComputerControlInterface::weakPointer()
 {
 	return Pointer( this, []( ComputerControlInterface* ) { } );
@@ -326,11 +427,29 @@ void ComputerControlInterface::updateState()
 
 
 
+void ComputerControlInterface::subscribeUpdates()
+{
+	// sequence numbers and capabilities are only valid for a single connection
+	m_updateSequenceNumbers.clear();
+	m_serverSupportsModeSwitch = false;
+
+	if( m_vncConnection && m_connection && state() == State::Connected )
+	{
+		// assume the server supports subscriptions until it replies otherwise
+		setServerPushesUpdates( true );
+
+		VeyonCore::builtinFeatures().monitoringMode().subscribeLoggedOnUserInfo( { weakPointer() } );
+		VeyonCore::builtinFeatures().featureControl().subscribeActiveFeatures( { weakPointer() } );
+	}
+}
+
+
+
 void ComputerControlInterface::updateUser()
 {
 	if( m_vncConnection && m_connection && state() == State::Connected )
 	{
-		if( userLoginName().isEmpty() )
+		if( m_serverPushesUpdates == false && userLoginName().isEmpty() )
 		{
 			VeyonCore::builtinFeatures().monitoringMode().queryLoggedOnUserInfo( { weakPointer() } );
 		}
@@ -348,7 +467,10 @@ void ComputerControlInterface::updateActiveFeatures()
 {
 	if( m_vncConnection && m_connection && state() == State::Connected )
 	{
-		VeyonCore::builtinFeatures().featureControl().queryActiveFeatures( { weakPointer() } );
+		if( m_serverPushesUpdates == false )
+		{
+			VeyonCore::builtinFeatures().featureControl().queryActiveFeatures( { weakPointer() } );
+		}
 	}
 	else
 	{
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QSize>
@@ -31,12 +32,12 @@
 
 #include "Computer.h"
 #include "Feature.h"
+#include "FeatureMessage.h"
 #include "VeyonCore.h"
 #include "VncConnection.h"
 
 class QImage;
 
-class FeatureMessage;
 class VncConnection;
 class VeyonConnection;
 
@@ -129,8 +130,16 @@ public:
 
 	void setDesignatedModeFeature( Feature::Uid designatedModeFeature );
 
-	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake );
+	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake,
+							 const QByteArray& serializedMessage = {} );
+	FeatureMessage::Format featureMessageFormat() const;
+
+	// collect feature messages instead of sending them, e.g. for combining them into a single message
+	void startFeatureMessageCapture();
+	QList<FeatureMessage> finishFeatureMessageCapture();
+
 	bool isMessageQueueEmpty();
+	int messageQueueSize();
 
 	void setUpdateMode( UpdateMode updateMode );
 	UpdateMode updateMode() const
@@ -138,6 +147,29 @@ public:
 		return m_updateMode;
 	}
 
+	// user and active features are pushed by the server unless it does not support
+	// subscriptions in which case they are polled periodically
+	bool serverPushesUpdates() const
+	{
+		return m_serverPushesUpdates;
+	}
+
+	void setServerPushesUpdates( bool enabled );
+
+	// combined mode switch messages are only sent after the server confirmed their support
+	bool serverSupportsModeSwitch() const
+	{
+		return m_serverSupportsModeSwitch;
+	}
+
+	void setServerSupportsModeSwitch( bool supported )
+	{
+		m_serverSupportsModeSwitch = supported;
+	}
+
+	void resetUpdateSequenceNumber( Feature::Uid featureUid, quint32 sequenceNumber );
+	bool advanceUpdateSequenceNumber( Feature::Uid featureUid, quint32 sequenceNumber );
+
 private:
 	Pointer weakPointer();
 
@@ -145,6 +177,7 @@ private:
 	void restartConnection();
 
 	void updateState();
+	void subscribeUpdates();
 	void updateUser();
 	void updateActiveFeatures();
 
@@ -172,6 +205,13 @@ private:
 	QTimer m_userUpdateTimer;
 	QTimer m_activeFeaturesUpdateTimer;
 
+	bool m_serverPushesUpdates{true};
+	bool m_serverSupportsModeSwitch{false};
+	QHash<Feature::Uid, quint32> m_updateSequenceNumbers;
+
+	bool m_captureFeatureMessages{false};
+	QList<FeatureMessage> m_capturedFeatureMessages;
+
 	QStringList m_groups;
 
 signals:
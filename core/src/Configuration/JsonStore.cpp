@@ -22,10 +22,13 @@
  *
  */
 
+#include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QJsonArray>
 #include <QJsonDocument>
-#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
 
 #include "Configuration/JsonStore.h"
 #include "Configuration/Object.h"
@@ -41,43 +44,65 @@ JsonStore::JsonStore( Scope scope, const QString &file ) :
 	Store( Store::JsonFile, scope ),
 	m_file( file )
 {
+	m_flushTimer.setSingleShot( true );
+	m_flushTimer.setInterval( FlushDelay );
+
+	QObject::connect( &m_flushTimer, &QTimer::timeout, [this]() { sync(); } );
+}
+
+
+
+JsonStore::~JsonStore()
+{
+	sync();
 }
 
 
 
-static void loadJsonTree( Object* obj, const QJsonObject& jsonParent, const QString& parentKey )
+Object::DataMap JsonStore::loadJsonTree( const QJsonObject& jsonParent )
 {
+	Object::DataMap data;
+
+	// keys of QJsonObject are sorted, so always appending at the end of the map makes building it linear
 	for( auto it = jsonParent.begin(); it != jsonParent.end(); ++it )
 	{
 		if( it.value().isObject() )
 		{
-			QJsonObject jsonObject = it.value().toObject();
+			const auto jsonObject = it.value().toObject();
 
 			if( jsonObject.contains( QStringLiteral( "JsonStoreArray" ) ) )
 			{
-				obj->setValue( it.key(), jsonObject[QStringLiteral("JsonStoreArray")].toArray(), parentKey );
+				data.insert( data.constEnd(), it.key(), jsonObject[QStringLiteral("JsonStoreArray")].toArray() );
 			}
 			else if( jsonObject.contains( QStringLiteral( "JsonStoreObject" ) ) )
 			{
-				obj->setValue( it.key(), jsonObject[QStringLiteral("JsonStoreObject")].toObject(), parentKey );
+				data.insert( data.constEnd(), it.key(), jsonObject[QStringLiteral("JsonStoreObject")].toObject() );
 			}
 			else
 			{
-				const QString subParentKey = parentKey + ( parentKey.isEmpty() ? QString() : QStringLiteral("/") ) + it.key();
-				loadJsonTree( obj, it.value().toObject(), subParentKey );
+				const auto subData = loadJsonTree( jsonObject );
+				if( subData.isEmpty() == false )
+				{
+					data.insert( data.constEnd(), it.key(), subData );
+				}
 			}
 		}
 		else
 		{
-			obj->setValue( it.key(), it.value().toVariant(), parentKey );
+			data.insert( data.constEnd(), it.key(), it.value().toVariant() );
 		}
 	}
+
+	return data;
 }
 
 
 
 void JsonStore::load( Object* obj )
 {
+	// make sure not to read outdated data
+	sync();
+
 	QFile jsonFile( configurationFilePath() );
 	if( !jsonFile.open( QFile::ReadOnly ) )
 	{
@@ -85,60 +110,110 @@ void JsonStore::load( Object* obj )
 		return;
 	}
 
-	QJsonDocument jsonDoc = QJsonDocument::fromJson( jsonFile.readAll() );
-
-	loadJsonTree( obj, jsonDoc.object(), {} );
+	obj->mergeData( loadJsonTree( QJsonDocument::fromJson( jsonFile.readAll() ).object() ) );
 }
 
 
 
-static QJsonObject saveJsonTree( const Object::DataMap& dataMap )
+QJsonObject JsonStore::saveJsonTree( const Object::DataMap& dataMap, CachedTree& cache )
 {
-	QJsonObject jsonData;
+	if( cache.data.isSharedWith( dataMap ) )
+	{
+		return cache.json;
+	}
+
+	CachedTree updatedCache{ dataMap, {}, {} };
+
+	// collect values in a sorted map first as inserting into a QJsonObject one by one is not linear
+	QVariantMap jsonData;
 
 	for( auto it = dataMap.begin(); it != dataMap.end(); ++it )
 	{
+		QJsonValue jsonValue;
+
 		if( it.value().type() == QVariant::Map )
 		{
-			jsonData[it.key()] = saveJsonTree( it.value().toMap() );
+			auto childCache = cache.children.take( it.key() );
+			jsonValue = saveJsonTree( it.value().toMap(), childCache );
+			updatedCache.children.insert( updatedCache.children.constEnd(), it.key(), childCache );
 		}
 		else if( static_cast<QMetaType::Type>( it.value().type() ) == QMetaType::QJsonArray )
 		{
 			QJsonObject jsonObj;
 			jsonObj[QStringLiteral("JsonStoreArray")] = it.value().toJsonArray();
-			jsonData[it.key()] = jsonObj;
+			jsonValue = jsonObj;
 		}
 		else if( static_cast<QMetaType::Type>( it.value().type() ) == QMetaType::QJsonObject )
 		{
 			QJsonObject jsonObj;
 			jsonObj[QStringLiteral("JsonStoreObject")] = it.value().toJsonObject();
-			jsonData[it.key()] = jsonObj;
+			jsonValue = jsonObj;
 		}
 		else if( QMetaType( it.value().userType() ).flags().testFlag( QMetaType::IsEnumeration ) )
 		{
-			jsonData[it.key()] = QJsonValue( it.value().toInt() );
+			jsonValue = QJsonValue( it.value().toInt() );
 		}
 		else
 		{
-			jsonData[it.key()] = QJsonValue::fromVariant( it.value() );
+			jsonValue = QJsonValue::fromVariant( it.value() );
 		}
+
+		jsonData.insert( jsonData.constEnd(), it.key(), QVariant::fromValue( jsonValue ) );
 	}
 
-	return jsonData;
+	updatedCache.json = QJsonObject::fromVariantMap( jsonData );
+
+	cache = updatedCache;
+
+	return cache.json;
 }
 
 
 
 void JsonStore::flush( const Object* obj )
 {
-	QFile outfile( configurationFilePath() );
-	if( !outfile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	m_pendingData = obj->data();
+	m_flushPending = true;
+
+	// coalesce subsequent flushes into a single write unless there's no event loop to defer it to
+	if( QCoreApplication::instance() && QThread::currentThread() == m_flushTimer.thread() )
+	{
+		m_flushTimer.start();
+	}
+	else
+	{
+		sync();
+	}
+}
+
+
+
+void JsonStore::sync()
+{
+	m_flushTimer.stop();
+
+	if( m_flushPending == false )
 	{
-		vCritical() << "could not write to configuration file" << configurationFilePath();
 		return;
 	}
 
-	outfile.write( QJsonDocument( saveJsonTree( obj->data() ) ).toJson() );
+	m_flushPending = false;
+
+	const auto jsonData = QJsonDocument( saveJsonTree( m_pendingData, m_cache ) ).toJson();
+
+	m_pendingData.clear();
+
+	// write to a temporary file and replace the configuration file atomically so
+	// that it never ends up truncated or half-written
+	QSaveFile outfile( configurationFilePath() );
+	outfile.setDirectWriteFallback( true );
+
+	if( outfile.open( QIODevice::WriteOnly ) == false ||
+		outfile.write( jsonData ) != jsonData.size() ||
+		outfile.commit() == false )
+	{
+		vCritical() << "could not write to configuration file" << outfile.fileName() << outfile.errorString();
+	}
 }
 
 
@@ -157,6 +232,11 @@ bool JsonStore::isWritable() const
 
 void JsonStore::clear()
 {
+	// discard pending writes
+	m_flushTimer.stop();
+	m_flushPending = false;
+	m_pendingData.clear();
+
 	// truncate configuration file
 	QFile outfile( configurationFilePath() );
 	outfile.open( QIODevice::WriteOnly | QIODevice::Truncate );
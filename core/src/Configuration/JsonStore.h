@@ -24,7 +24,10 @@
 
 #pragma once
 
-#include "Configuration/Store.h"
+#include <QJsonObject>
+#include <QTimer>
+
+#include "Configuration/Object.h"
 
 namespace Configuration
 {
@@ -35,17 +38,39 @@ class VEYON_CORE_EXPORT JsonStore : public Store
 {
 public:
 	explicit JsonStore( Scope scope, const QString & file = {} );
+	~JsonStore() override;
 
 	void load( Object *obj ) override;
 	void flush( const Object *obj ) override;
 	bool isWritable() const override;
 	void clear() override;
 
+	void sync();
+
 private:
+	static constexpr int FlushDelay = 1000;
+
+	// JSON representation of a data map along with the map it has been created from - as long
+	// as both still share their data, the subtree did not change and does not need to be serialized again
+	struct CachedTree
+	{
+		Object::DataMap data;
+		QJsonObject json;
+		QMap<QString, CachedTree> children;
+	};
+
+	static Object::DataMap loadJsonTree( const QJsonObject& jsonParent );
+	static QJsonObject saveJsonTree( const Object::DataMap& dataMap, CachedTree& cache );
+
 	QString configurationFilePath() const;
 
 	QString m_file;
 
+	QTimer m_flushTimer{};
+	Object::DataMap m_pendingData{};
+	bool m_flushPending{false};
+	CachedTree m_cache{};
+
 } ;
 
 }
@@ -30,6 +30,9 @@
 namespace Configuration
 {
 
+std::atomic<quint64> Object::s_generations{0};
+
+
 Object::Object( Store::Backend backend, Store::Scope scope, const QString& storeName ) :
 	m_store( createStore( backend, scope ) )
 {
@@ -86,6 +89,7 @@ Object& Object::operator=( const Object& ref )
 	}
 
 	m_data = ref.data();
+	m_generation = nextGeneration();
 
 	return *this;
 }
@@ -114,6 +118,7 @@ static Object::DataMap operator+( Object::DataMap dst, Object::DataMap src )
 Object& Object::operator+=( const Object& ref )
 {
 	m_data = m_data + ref.data();
+	m_generation = nextGeneration();
 
 	return *this;
 }
@@ -247,6 +252,7 @@ void Object::setValue( const QString& key, const QVariant& value, const QString&
 	if( data != m_data )
 	{
 		m_data = data;
+		m_generation = nextGeneration();
 		emit configurationChanged();
 	}
 }
@@ -289,6 +295,7 @@ void Object::removeValue( const QString& key, const QString& parentKey )
 	if( data != m_data )
 	{
 		m_data = data;
+		m_generation = nextGeneration();
 		emit configurationChanged();
 	}
 }
@@ -327,6 +334,20 @@ void Object::addSubObject( Object* obj, const QString& parentKey )
 
 
 
+void Object::mergeData( const DataMap& data )
+{
+	const auto mergedData = m_data.isEmpty() ? data : m_data + data;
+
+	if( mergedData != m_data )
+	{
+		m_data = mergedData;
+		m_generation = nextGeneration();
+		emit configurationChanged();
+	}
+}
+
+
+
 Store* Object::createStore( Store::Backend backend, Store::Scope scope )
 {
 	switch( backend )
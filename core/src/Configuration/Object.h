@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "VeyonCore.h"
 #include "Configuration/Store.h"
 
@@ -57,6 +59,8 @@ public:
 
 	void addSubObject( Object* obj, const QString& parentKey );
 
+	void mergeData( const DataMap& data );
+
 	void reloadFromStore()
 	{
 		if( m_store )
@@ -81,6 +85,7 @@ public:
 	void clear()
 	{
 		m_data.clear();
+		m_generation = nextGeneration();
 	}
 
 	const DataMap & data() const
@@ -88,6 +93,12 @@ public:
 		return m_data;
 	}
 
+	// unique across all objects and changes whenever the data changes so derived data can be cached safely
+	quint64 generation() const
+	{
+		return m_generation;
+	}
+
 
 signals:
 	void configurationChanged();
@@ -96,9 +107,17 @@ signals:
 private:
 	static Store* createStore( Store::Backend backend, Store::Scope scope );
 
+	static quint64 nextGeneration()
+	{
+		return ++s_generations;
+	}
+
+	static std::atomic<quint64> s_generations;
+
 	Configuration::Store* m_store{nullptr};
 	bool m_customStore{false};
 	DataMap m_data{};
+	std::atomic<quint64> m_generation{nextGeneration()};
 
 } ;
 
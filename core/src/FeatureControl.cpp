@@ -22,7 +22,12 @@
  *
  */
 
+#include <QBuffer>
+
+#include <algorithm>
+
 #include "FeatureControl.h"
+#include "FeatureManager.h"
 #include "FeatureWorkerManager.h"
 #include "VeyonCore.h"
 #include "VeyonServerInterface.h"
@@ -49,19 +54,91 @@ bool FeatureControl::queryActiveFeatures( const ComputerControlInterfaceList& co
 
 
 
+bool FeatureControl::subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	return sendFeatureMessage( FeatureMessage( m_featureControlFeature.uid(), SubscribeActiveFeatures ),
+							   computerControlInterfaces, false );
+}
+
+
+
+bool FeatureControl::switchMode( const ComputerControlInterface::Pointer& computerControlInterface,
+								 Feature::Uid mode, const ModeSwitchMessages& messages )
+{
+	const auto format = computerControlInterface->featureMessageFormat();
+
+	QVariantList serializedMessages;
+	QVariantList conditions;
+	serializedMessages.reserve( messages.size() );
+	conditions.reserve( messages.size() );
+
+	for( const auto& message : messages )
+	{
+		conditions.append( message.first );
+		serializedMessages.append( message.second.serialize( format ) );
+	}
+
+	return sendFeatureMessage( FeatureMessage( m_featureControlFeature.uid(), SwitchMode ).
+							   addArgument( TargetMode, mode ).
+							   addArgument( ModeMessages, serializedMessages ).
+							   addArgument( ModeMessageConditions, conditions ),
+							   { computerControlInterface } );
+}
+
+
+
 bool FeatureControl::handleFeatureMessage( VeyonMasterInterface& master, const FeatureMessage& message,
 										   ComputerControlInterface::Pointer computerControlInterface )
 {
 	Q_UNUSED(master)
 
-	if( message.featureUid() == m_featureControlFeature.uid() )
+	if( message.featureUid() != m_featureControlFeature.uid() )
 	{
+		return false;
+	}
+
+	const auto sequenceNumber = message.argument( SequenceNumber );
+
+	switch( message.command() )
+	{
+	case SubscribeActiveFeatures:
+		// servers without support for subscriptions reply with the plain list of active features
+		if( sequenceNumber.isValid() )
+		{
+			computerControlInterface->resetUpdateSequenceNumber( message.featureUid(), sequenceNumber.toUInt() );
+		}
+		else
+		{
+			computerControlInterface->setServerPushesUpdates( false );
+		}
+		computerControlInterface->setServerSupportsModeSwitch( message.argument( ModeSwitchSupported ).toBool() );
 		computerControlInterface->setActiveFeatures( message.argument( ActiveFeatureList ).toStringList() );
+		break;
 
-		return true;
+	case ActiveFeaturesChanged:
+		if( computerControlInterface->advanceUpdateSequenceNumber( message.featureUid(), sequenceNumber.toUInt() ) )
+		{
+			auto activeFeatures = computerControlInterface->activeFeatures();
+			for( const auto& featureUid : message.argument( RemovedFeatures ).toStringList() )
+			{
+				activeFeatures.removeAll( featureUid );
+			}
+			activeFeatures.append( message.argument( AddedFeatures ).toStringList() );
+			computerControlInterface->setActiveFeatures( activeFeatures );
+		}
+		else
+		{
+			// missed an update so resynchronize by subscribing again
+			subscribeActiveFeatures( { computerControlInterface } );
+		}
+		break;
+
+	default:
+		computerControlInterface->setActiveFeatures( message.argument( ActiveFeatureList ).toStringList() );
+		break;
 	}
 
-	return false;
+	return true;
 }
 
 
@@ -72,6 +149,40 @@ bool FeatureControl::handleFeatureMessage( VeyonServerInterface& server,
 {
 	if( m_featureControlFeature.uid() == message.featureUid() )
 	{
+		if( message.command() == SwitchMode )
+		{
+			return processModeSwitch( server, messageContext, message );
+		}
+
+		if( message.command() == SubscribeActiveFeatures )
+		{
+			if( m_server == nullptr )
+			{
+				m_server = &server;
+				m_activeFeatures = server.featureWorkerManager().runningWorkers();
+				connect( &server.featureWorkerManager(), &FeatureWorkerManager::runningWorkersChanged,
+						 this, &FeatureControl::publishActiveFeatures );
+			}
+
+			// deliver pending changes to existing subscribers before sending the full list
+			publishActiveFeatures();
+
+			const auto ioDevice = messageContext.ioDevice();
+			const auto isSubscribed = std::any_of( m_subscribers.begin(), m_subscribers.end(),
+												   [ioDevice]( const MessageContext& subscriber ) {
+				return subscriber.ioDevice() == ioDevice; } );
+			if( isSubscribed == false )
+			{
+				m_subscribers.append( messageContext );
+			}
+
+			return server.sendFeatureMessageReply( messageContext,
+												   FeatureMessage( message.featureUid(), message.command() ).
+												   addArgument( ActiveFeatureList, m_activeFeatures ).
+												   addArgument( SequenceNumber, m_sequenceNumber ).
+												   addArgument( ModeSwitchSupported, true ) );
+		}
+
 		FeatureMessage reply( message.featureUid(), message.command() );
 		reply.addArgument( ActiveFeatureList, server.featureWorkerManager().runningWorkers() );
 
@@ -80,3 +191,116 @@ bool FeatureControl::handleFeatureMessage( VeyonServerInterface& server,
 
 	return false;
 }
+
+
+
+void FeatureControl::publishActiveFeatures()
+{
+	if( m_server == nullptr )
+	{
+		return;
+	}
+
+	const auto activeFeatures = m_server->featureWorkerManager().runningWorkers();
+
+	FeatureUidList addedFeatures;
+	for( const auto& featureUid : activeFeatures )
+	{
+		if( m_activeFeatures.contains( featureUid ) == false )
+		{
+			addedFeatures.append( featureUid );
+		}
+	}
+
+	FeatureUidList removedFeatures;
+	for( const auto& featureUid : qAsConst(m_activeFeatures) )
+	{
+		if( activeFeatures.contains( featureUid ) == false )
+		{
+			removedFeatures.append( featureUid );
+		}
+	}
+
+	if( addedFeatures.isEmpty() && removedFeatures.isEmpty() )
+	{
+		return;
+	}
+
+	m_activeFeatures = activeFeatures;
+	++m_sequenceNumber;
+
+	const auto message = FeatureMessage( m_featureControlFeature.uid(), ActiveFeaturesChanged ).
+						 addArgument( SequenceNumber, m_sequenceNumber ).
+						 addArgument( AddedFeatures, addedFeatures ).
+						 addArgument( RemovedFeatures, removedFeatures );
+
+	for( auto it = m_subscribers.begin(); it != m_subscribers.end(); )
+	{
+		if( it->ioDevice() )
+		{
+			m_server->sendFeatureMessageReply( *it, message );
+			++it;
+		}
+		else
+		{
+			it = m_subscribers.erase( it );
+		}
+	}
+}
+
+
+
+bool FeatureControl::processModeSwitch( VeyonServerInterface& server, const MessageContext& messageContext,
+										const FeatureMessage& message )
+{
+	const auto messages = message.argument( ModeMessages ).toList();
+	const auto conditions = message.argument( ModeMessageConditions ).toList();
+
+	if( messages.size() != conditions.size() )
+	{
+		vWarning() << "invalid mode switch message";
+		return false;
+	}
+
+	QList<QPair<Feature::Uid, FeatureMessage>> modeMessages;
+	modeMessages.reserve( messages.size() );
+
+	for( int i = 0; i < messages.size(); ++i )
+	{
+		auto data = messages[i].toByteArray();
+		QBuffer buffer( &data );
+		buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+
+		FeatureMessage modeMessage;
+		if( modeMessage.receive( &buffer ) == false )
+		{
+			vWarning() << "invalid message in mode switch";
+			continue;
+		}
+
+		// mode switches must not be nested as this would allow unbounded recursion
+		if( modeMessage.featureUid() == m_featureControlFeature.uid() )
+		{
+			vWarning() << "rejecting mode switch containing feature control messages";
+			return false;
+		}
+
+		modeMessages.append( qMakePair( conditions[i].toUuid(), modeMessage ) );
+	}
+
+	vDebug() << "switching to mode" << message.argument( TargetMode ).toUuid();
+
+	for( const auto& modeMessage : qAsConst(modeMessages) )
+	{
+		// only stop features which are actually running here
+		if( modeMessage.first.isNull() == false &&
+			server.featureWorkerManager().isWorkerRunning( Feature( modeMessage.first ) ) == false )
+		{
+			continue;
+		}
+
+		server.featureManager().handleFeatureMessage( server, messageContext, modeMessage.second );
+	}
+
+	return true;
+}
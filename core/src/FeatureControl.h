@@ -34,7 +34,14 @@ public:
 	explicit FeatureControl( QObject* parent = nullptr );
 	~FeatureControl() override = default;
 
+	// messages to be processed by a server when switching modes along with the feature
+	// which has to be active for a message to be processed (null for unconditional messages)
+	using ModeSwitchMessages = QList<QPair<Feature::Uid, FeatureMessage>>;
+
 	bool queryActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
+	bool subscribeActiveFeatures( const ComputerControlInterfaceList& computerControlInterfaces );
+	bool switchMode( const ComputerControlInterface::Pointer& computerControlInterface,
+					 Feature::Uid mode, const ModeSwitchMessages& messages );
 
 	Plugin::Uid uid() const override
 	{
@@ -43,7 +50,7 @@ public:
 
 	QVersionNumber version() const override
 	{
-		return QVersionNumber( 1, 1 );
+		return QVersionNumber( 1, 3 );
 	}
 
 	QString name() const override
@@ -82,16 +89,34 @@ private:
 	enum Commands
 	{
 		QueryActiveFeatures,
+		SubscribeActiveFeatures,
+		ActiveFeaturesChanged,
+		SwitchMode,
 	};
 
 	enum Arguments
 	{
 		ActiveFeatureList,
+		SequenceNumber,
+		AddedFeatures,
+		RemovedFeatures,
+		TargetMode,
+		ModeMessages,
+		ModeMessageConditions,
+		ModeSwitchSupported,
 	};
 
+	void publishActiveFeatures();
+	bool processModeSwitch( VeyonServerInterface& server, const MessageContext& messageContext,
+							const FeatureMessage& message );
+
 	const Feature m_featureControlFeature;
 	const FeatureList m_features;
 
+	VeyonServerInterface* m_server{nullptr};
+	QVector<MessageContext> m_subscribers;
+
 	FeatureUidList m_activeFeatures;
+	quint32 m_sequenceNumber{0};
 
 };
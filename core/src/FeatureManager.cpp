@@ -22,6 +22,10 @@
  *
  */
 
+#include <functional>
+
+#include "BuiltinFeatures.h"
+#include "FeatureControl.h"
 #include "FeatureManager.h"
 #include "FeatureMessage.h"
 #include "PluginInterface.h"
@@ -111,6 +115,51 @@ Plugin::Uid FeatureManager::pluginUid( const Feature& feature ) const
 
 
 
+bool FeatureManager::isWorkerHostable( const Feature& feature ) const
+{
+	for( auto featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	{
+		if( featureInterface->isWorkerHostable( feature ) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+bool FeatureManager::isWorkerRestorable( const Feature& feature ) const
+{
+	for( auto featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	{
+		if( featureInterface->isWorkerRestorable( feature ) )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+bool FeatureManager::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) const
+{
+	for( auto featureInterface : qAsConst( m_featurePluginInterfaces ) )
+	{
+		if( featureInterface->isWorkerHostable( feature ) )
+		{
+			return featureInterface->stopHostedWorker( worker, feature );
+		}
+	}
+
+	return false;
+}
+
+
+
 void FeatureManager::startFeature( VeyonMasterInterface& master,
 								   const Feature& feature,
 								   const ComputerControlInterfaceList& computerControlInterfaces )
@@ -155,6 +204,94 @@ void FeatureManager::stopFeature( VeyonMasterInterface& master,
 
 
 
+/*!
+ * \brief Stops all mode features and (re)starts the given mode feature with a single message per computer
+ *
+ * Instead of sending stop messages for every mode feature, the messages generated by the feature providers
+ * are collected and sent in one mode switch message. Each server then only processes the stop messages
+ * for features which are actually running. The given mode is stopped as well so running it again restarts
+ * it (e.g. with new arguments). Servers which have not confirmed support for mode switch messages in
+ * their reply to the active features subscription receive individual stop and start messages instead.
+ */
+void FeatureManager::switchMode( VeyonMasterInterface& master,
+								 const Feature& mode,
+								 const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	vDebug() << "mode" << mode.name() << mode.uid() << computerControlInterfaces;
+
+	ComputerControlInterfaceList switchableInterfaces;
+	ComputerControlInterfaceList legacyInterfaces;
+
+	for( const auto& controlInterface : computerControlInterfaces )
+	{
+		if( controlInterface->serverSupportsModeSwitch() )
+		{
+			switchableInterfaces.append( controlInterface );
+		}
+		else
+		{
+			legacyInterfaces.append( controlInterface );
+		}
+	}
+
+	if( legacyInterfaces.isEmpty() == false )
+	{
+		for( const auto& feature : qAsConst( m_features ) )
+		{
+			if( feature.testFlag( Feature::Mode ) )
+			{
+				stopFeature( master, feature, legacyInterfaces );
+			}
+		}
+
+		startFeature( master, mode, legacyInterfaces );
+	}
+
+	if( switchableInterfaces.isEmpty() )
+	{
+		return;
+	}
+
+	QVector<FeatureControl::ModeSwitchMessages> modeSwitchMessages( switchableInterfaces.size() );
+
+	const auto captureMessages = [&]( Feature::Uid condition, const std::function<void()>& run ) {
+		for( const auto& controlInterface : qAsConst( switchableInterfaces ) )
+		{
+			controlInterface->startFeatureMessageCapture();
+		}
+
+		run();
+
+		for( int i = 0; i < switchableInterfaces.size(); ++i )
+		{
+			const auto messages = switchableInterfaces[i]->finishFeatureMessageCapture();
+			for( const auto& message : messages )
+			{
+				modeSwitchMessages[i].append( qMakePair( condition, message ) );
+			}
+		}
+	};
+
+	for( const auto& feature : qAsConst( m_features ) )
+	{
+		if( feature.testFlag( Feature::Mode ) )
+		{
+			captureMessages( feature.uid(), [&]() { stopFeature( master, feature, switchableInterfaces ); } );
+		}
+	}
+
+	captureMessages( {}, [&]() { startFeature( master, mode, switchableInterfaces ); } );
+
+	auto& featureControl = VeyonCore::builtinFeatures().featureControl();
+
+	for( int i = 0; i < switchableInterfaces.size(); ++i )
+	{
+		featureControl.switchMode( switchableInterfaces[i], mode.uid(), modeSwitchMessages[i] );
+	}
+}
+
+
+
 bool FeatureManager::handleFeatureMessage( VeyonMasterInterface& master, const FeatureMessage& message,
 										   const ComputerControlInterface::Pointer& computerControlInterface )
 {
@@ -52,12 +52,19 @@ public:
 
 	Plugin::Uid pluginUid( const Feature& feature ) const;
 
+	bool isWorkerHostable( const Feature& feature ) const;
+	bool isWorkerRestorable( const Feature& feature ) const;
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) const;
+
 	void startFeature( VeyonMasterInterface& master,
 					   const Feature& feature,
 					   const ComputerControlInterfaceList& computerControlInterfaces );
 	void stopFeature( VeyonMasterInterface& master,
 					  const Feature& feature,
 					  const ComputerControlInterfaceList& computerControlInterfaces );
+	void switchMode( VeyonMasterInterface& master,
+					 const Feature& mode,
+					 const ComputerControlInterfaceList& computerControlInterfaces );
 
 public slots:
 	bool handleFeatureMessage( VeyonMasterInterface& master, const FeatureMessage& message,
@@ -22,14 +22,148 @@
  *
  */
 
+#include <QBuffer>
+#include <QDataStream>
+#include <QtEndian>
+
+#include <limits>
+
 #include "FeatureMessage.h"
 #include "VariantArrayMessage.h"
 
+namespace {
+
+// a VariantArrayMessage always starts with a QDataStream-serialized QVariant<QUuid>, i.e. with a zero byte,
+// so any other value in the first byte of a message unambiguously identifies the compact format
+constexpr quint8 CompactFormatMarker = 0xFC;
+
+constexpr int CompactUuidSize = 16;
+constexpr int CompactHeaderSize = 1 + 1 + CompactUuidSize + sizeof(qint32) + sizeof(quint16);
+
+enum class CompactValueType : quint8
+{
+	Invalid,
+	Bool,
+	Int,
+	LongLong,
+	String,
+	ByteArray,
+	Uuid,
+	Variant
+};
+
+
+template<typename T>
+void appendInteger( QByteArray& data, T value )
+{
+	const auto bigEndianValue = qToBigEndian<T>( value );
+	data.append( reinterpret_cast<const char *>( &bigEndianValue ), sizeof(bigEndianValue) );
+}
+
+
+
+void appendValueType( QByteArray& data, CompactValueType type )
+{
+	data.append( static_cast<char>( type ) );
+}
+
+
+
+void appendBlob( QByteArray& data, const QByteArray& blob )
+{
+	appendInteger<quint32>( data, static_cast<quint32>( blob.size() ) );
+	data.append( blob );
+}
+
+
+
+class CompactReader
+{
+public:
+	explicit CompactReader( const QByteArray& data ) :
+		m_data( data )
+	{
+	}
+
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	template<typename T>
+	T readInteger()
+	{
+		if( require( sizeof(T) ) == false )
+		{
+			return 0;
+		}
+
+		const auto value = qFromBigEndian<T>( reinterpret_cast<const uchar *>( m_data.constData() + m_offset ) );
+		m_offset += sizeof(T);
+		return value;
+	}
+
+	QByteArray readBytes( int size )
+	{
+		if( size < 0 )
+		{
+			// length exceeds what can be held in memory
+			m_valid = false;
+			return {};
+		}
+
+		if( require( size ) == false )
+		{
+			return {};
+		}
+
+		const auto bytes = m_data.mid( m_offset, size );
+		m_offset += size;
+		return bytes;
+	}
+
+	QByteArray readBlob()
+	{
+		return readBytes( static_cast<int>( readInteger<quint32>() ) );
+	}
+
+private:
+	bool require( int size )
+	{
+		if( m_valid && m_data.size() - m_offset >= size )
+		{
+			return true;
+		}
+
+		m_valid = false;
+		return false;
+	}
+
+	const QByteArray& m_data;
+	int m_offset{0};
+	bool m_valid{true};
+
+};
 
-bool FeatureMessage::send( QIODevice* ioDevice ) const
+}
+
+
+
+bool FeatureMessage::send( QIODevice* ioDevice, Format format ) const
 {
 	if( ioDevice )
 	{
+		if( format == Format::Compact && isCompactEncodable() )
+		{
+			const auto data = encodeCompact();
+			const auto messageSize = qToBigEndian<VariantArrayMessage::MessageSize>(
+										 static_cast<VariantArrayMessage::MessageSize>( data.size() ) );
+			ioDevice->write( reinterpret_cast<const char *>( &messageSize ), sizeof(messageSize) );
+			ioDevice->write( data );
+
+			return true;
+		}
+
 		VariantArrayMessage message( ioDevice );
 
 		message.write( m_featureUid );
@@ -46,6 +180,18 @@ bool FeatureMessage::send( QIODevice* ioDevice ) const
 
 
 
+QByteArray FeatureMessage::serialize( Format format ) const
+{
+	QBuffer buffer;
+	buffer.open( QBuffer::WriteOnly ); // Flawfinder: ignore
+
+	send( &buffer, format );
+
+	return buffer.data();
+}
+
+
+
 bool FeatureMessage::isReadyForReceive( QIODevice* ioDevice )
 {
 	return ioDevice != nullptr &&
@@ -62,9 +208,22 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 
 		if( message.receive() )
 		{
+			const auto& data = message.data();
+			if( data.isEmpty() == false && static_cast<quint8>( data.at( 0 ) ) == CompactFormatMarker )
+			{
+				if( decodeCompact( data ) )
+				{
+					return true;
+				}
+
+				vWarning() << "could not decode compact message!";
+				return false;
+			}
+
 			m_featureUid = message.read().toUuid(); // Flawfinder: ignore
 			m_command = message.read().value<Command>(); // Flawfinder: ignore
 			m_arguments = message.read().toMap(); // Flawfinder: ignore
+			m_format = Format::VariantArray;
 			return true;
 		}
 
@@ -77,3 +236,168 @@ bool FeatureMessage::receive( QIODevice* ioDevice )
 
 	return false;
 }
+
+
+
+bool FeatureMessage::isCompactEncodable() const
+{
+	if( m_arguments.size() > std::numeric_limits<quint16>::max() )
+	{
+		return false;
+	}
+
+	// argument keys have to be numeric indices as generated by addArgument()
+	for( auto it = m_arguments.constBegin(), end = m_arguments.constEnd(); it != end; ++it )
+	{
+		bool ok = false;
+		const auto index = it.key().toInt( &ok );
+		if( ok == false || index < 0 || index > std::numeric_limits<quint16>::max() ||
+			QString::number( index ) != it.key() )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+QByteArray FeatureMessage::encodeCompact() const
+{
+	QByteArray data;
+	data.reserve( CompactHeaderSize );
+
+	appendInteger<quint8>( data, CompactFormatMarker );
+	appendInteger<quint8>( data, CompactFormatVersion );
+	data.append( m_featureUid.toRfc4122() );
+	appendInteger<qint32>( data, m_command );
+	appendInteger<quint16>( data, static_cast<quint16>( m_arguments.size() ) );
+
+	for( auto it = m_arguments.constBegin(), end = m_arguments.constEnd(); it != end; ++it )
+	{
+		const auto& value = it.value();
+
+		appendInteger<quint16>( data, static_cast<quint16>( it.key().toInt() ) );
+
+		switch( value.userType() )
+		{
+		case QMetaType::UnknownType:
+			appendValueType( data, CompactValueType::Invalid );
+			break;
+		case QMetaType::Bool:
+			appendValueType( data, CompactValueType::Bool );
+			appendInteger<quint8>( data, value.toBool() ? 1 : 0 );
+			break;
+		case QMetaType::Int:
+			appendValueType( data, CompactValueType::Int );
+			appendInteger<qint32>( data, value.toInt() );
+			break;
+		case QMetaType::LongLong:
+			appendValueType( data, CompactValueType::LongLong );
+			appendInteger<qint64>( data, value.toLongLong() );
+			break;
+		case QMetaType::QString:
+			appendValueType( data, CompactValueType::String );
+			appendBlob( data, value.toString().toUtf8() );
+			break;
+		case QMetaType::QByteArray:
+			// raw payloads such as file chunks are copied as-is
+			appendValueType( data, CompactValueType::ByteArray );
+			appendBlob( data, value.toByteArray() );
+			break;
+		case QMetaType::QUuid:
+			appendValueType( data, CompactValueType::Uuid );
+			data.append( value.toUuid().toRfc4122() );
+			break;
+		default:
+		{
+			// everything else is transported as a QDataStream-serialized QVariant
+			QByteArray variantData;
+			QDataStream stream( &variantData, QIODevice::WriteOnly );
+			stream.setVersion( QDataStream::Qt_5_5 );
+			stream << value;
+
+			appendValueType( data, CompactValueType::Variant );
+			appendBlob( data, variantData );
+			break;
+		}
+		}
+	}
+
+	return data;
+}
+
+
+
+bool FeatureMessage::decodeCompact( const QByteArray& data )
+{
+	CompactReader reader( data );
+
+	if( reader.readInteger<quint8>() != CompactFormatMarker ||
+		reader.readInteger<quint8>() > CompactFormatVersion )
+	{
+		return false;
+	}
+
+	const auto featureUid = QUuid::fromRfc4122( reader.readBytes( CompactUuidSize ) );
+	const auto command = reader.readInteger<qint32>();
+	const auto argumentCount = reader.readInteger<quint16>();
+
+	Arguments arguments;
+
+	for( int i = 0; i < argumentCount && reader.isValid(); ++i )
+	{
+		const auto key = QString::number( reader.readInteger<quint16>() );
+
+		switch( static_cast<CompactValueType>( reader.readInteger<quint8>() ) )
+		{
+		case CompactValueType::Invalid:
+			arguments[key] = QVariant();
+			break;
+		case CompactValueType::Bool:
+			arguments[key] = reader.readInteger<quint8>() != 0;
+			break;
+		case CompactValueType::Int:
+			arguments[key] = reader.readInteger<qint32>();
+			break;
+		case CompactValueType::LongLong:
+			arguments[key] = reader.readInteger<qint64>();
+			break;
+		case CompactValueType::String:
+			arguments[key] = QString::fromUtf8( reader.readBlob() );
+			break;
+		case CompactValueType::ByteArray:
+			arguments[key] = reader.readBlob();
+			break;
+		case CompactValueType::Uuid:
+			arguments[key] = QUuid::fromRfc4122( reader.readBytes( CompactUuidSize ) );
+			break;
+		case CompactValueType::Variant:
+		{
+			const auto variantData = reader.readBlob();
+			QDataStream stream( variantData );
+			stream.setVersion( QDataStream::Qt_5_5 );
+			QVariant value;
+			stream >> value;
+			arguments[key] = value;
+			break;
+		}
+		default:
+			vWarning() << "invalid value type in compact message";
+			return false;
+		}
+	}
+
+	if( reader.isValid() == false )
+	{
+		return false;
+	}
+
+	m_featureUid = featureUid;
+	m_command = command;
+	m_arguments = arguments;
+	m_format = Format::Compact;
+
+	return true;
+}
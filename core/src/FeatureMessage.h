@@ -39,6 +39,16 @@ public:
 
 	static constexpr unsigned char RfbMessageType = 41;
 
+	// version of the compact wire format announced during connection setup
+	static constexpr int CompactFormatVersion = 1;
+
+	enum class Format
+	{
+		VariantArray,
+		Compact,
+		FormatCount
+	};
+
 	enum SpecialCommands
 	{
 		DefaultCommand = 0,
@@ -49,14 +59,16 @@ public:
 	explicit FeatureMessage( FeatureUid featureUid = {}, Command command = InvalidCommand ) :
 		m_featureUid( featureUid ),
 		m_command( command ),
-		m_arguments()
+		m_arguments(),
+		m_format( Format::VariantArray )
 	{
 	}
 
 	explicit FeatureMessage( const FeatureMessage& other ) :
 		m_featureUid( other.featureUid() ),
 		m_command( other.command() ),
-		m_arguments( other.arguments() )
+		m_arguments( other.arguments() ),
+		m_format( other.format() )
 	{
 	}
 
@@ -67,6 +79,7 @@ public:
 		m_featureUid = other.featureUid();
 		m_command = other.command();
 		m_arguments = other.arguments();
+		m_format = other.format();
 
 		return *this;
 	}
@@ -86,6 +99,12 @@ public:
 		return m_arguments;
 	}
 
+	// wire format the message has been received with
+	Format format() const
+	{
+		return m_format;
+	}
+
 	template<typename T = int>
 	FeatureMessage& addArgument( T index, const QVariant& value )
 	{
@@ -99,15 +118,22 @@ public:
 		return m_arguments[QString::number( static_cast<int>( index ) )];
 	}
 
-	bool send( QIODevice* ioDevice ) const;
+	bool send( QIODevice* ioDevice, Format format = Format::VariantArray ) const;
+
+	QByteArray serialize( Format format = Format::VariantArray ) const;
 
 	bool isReadyForReceive( QIODevice* ioDevice );
 
 	bool receive( QIODevice* ioDevice );
 
 private:
+	bool isCompactEncodable() const;
+	QByteArray encodeCompact() const;
+	bool decodeCompact( const QByteArray& data );
+
 	FeatureUid m_featureUid;
 	Command m_command;
 	Arguments m_arguments;
+	Format m_format;
 
 } ;
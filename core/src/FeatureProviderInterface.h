@@ -92,14 +92,61 @@ public:
 	 */
 	virtual bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) = 0;
 
+	/*!
+	 * \brief Returns whether the worker of given feature can run inside a shared worker host process
+	 * \param feature the feature to check
+	 * \note Such features must not quit the application but call VeyonWorkerInterface::stopFeatureWorker()
+	 * and have to implement stopHostedWorker()
+	 */
+	virtual bool isWorkerHostable( const Feature& feature ) const
+	{
+		Q_UNUSED(feature)
+		return false;
+	}
+
+	/*!
+	 * \brief Returns whether a hosted worker can be restored after its worker host died
+	 * \param feature the feature to check
+	 * \note The messages which started the worker are delivered again to the restarted worker,
+	 * so they must not have any side effects besides recreating the state of the feature
+	 */
+	virtual bool isWorkerRestorable( const Feature& feature ) const
+	{
+		Q_UNUSED(feature)
+		return false;
+	}
+
+	/*!
+	 * \brief Releases all resources of a feature stopped inside a shared worker host process
+	 * \param worker a reference to a worker instance implementing the VeyonWorkerInterface
+	 * \param feature the feature which has been stopped
+	 * \note The worker host keeps running so anything otherwise cleaned up on process exit has to be torn down here
+	 */
+	virtual bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+	{
+		Q_UNUSED(worker)
+		Q_UNUSED(feature)
+		return false;
+	}
+
 protected:
 	bool sendFeatureMessage( const FeatureMessage& message,
 							 const ComputerControlInterfaceList& computerControlInterfaces,
 							 bool wake = true )
 	{
+		// serialize message only once per wire format and let all connections share the (implicitly shared) buffer
+		std::array<QByteArray, static_cast<size_t>( FeatureMessage::Format::FormatCount )> serializedMessages;
+
 		for( const auto& controlInterface : computerControlInterfaces )
 		{
-			controlInterface->sendFeatureMessage( message, wake );
+			const auto format = controlInterface->featureMessageFormat();
+			auto& serializedMessage = serializedMessages[static_cast<size_t>( format )];
+			if( serializedMessage.isEmpty() )
+			{
+				serializedMessage = message.serialize( format );
+			}
+
+			controlInterface->sendFeatureMessage( message, wake, serializedMessage );
 		}
 
 		return true;
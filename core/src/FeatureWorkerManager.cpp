@@ -27,6 +27,9 @@
 #include <QThread>
 #include <QTimer>
 
+#include <algorithm>
+
+#include "CryptoCore.h"
 #include "FeatureManager.h"
 #include "FeatureWorkerManager.h"
 #include "Filesystem.h"
@@ -41,7 +44,13 @@ FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, Featur
 	QObject( parent ),
 	m_server( server ),
 	m_featureManager( featureManager ),
-	m_tcpServer( this )
+	m_tcpServer( this ),
+	m_sentMessagesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_feature_worker_messages_sent_total"),
+														 QStringLiteral("Feature messages sent to workers") ) ),
+	m_receivedMessagesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_feature_worker_messages_received_total"),
+															 QStringLiteral("Feature messages received from workers") ) ),
+	m_pendingMessagesGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_feature_worker_pending_messages"),
+														QStringLiteral("Feature messages waiting to be sent to workers") ) )
 {
 	connect( &m_tcpServer, &QTcpServer::newConnection,
 			 this, &FeatureWorkerManager::acceptConnection );
@@ -51,11 +60,6 @@ FeatureWorkerManager::FeatureWorkerManager( VeyonServerInterface& server, Featur
 	{
 		vCritical() << "can't listen on localhost!";
 	}
-
-	auto pendingMessagesTimer = new QTimer( this );
-	connect( pendingMessagesTimer, &QTimer::timeout, this, &FeatureWorkerManager::sendPendingMessages );
-
-	pendingMessagesTimer->start( 100 );
 }
 
 
@@ -64,11 +68,26 @@ FeatureWorkerManager::~FeatureWorkerManager()
 {
 	m_tcpServer.close();
 
+	// do not announce workers which are stopped during shutdown
+	blockSignals( true );
+
 	// properly shutdown all worker processes
 	while( m_workers.isEmpty() == false )
 	{
 		stopWorker( Feature( m_workers.firstKey() ) );
 	}
+
+	// worker hosts quit as soon as their connection is closed
+	for( auto& workerHost : m_workerHosts )
+	{
+		if( workerHost.socket )
+		{
+			workerHost.socket->disconnect( this );
+			disconnect( workerHost.socket );
+
+			workerHost.socket->close();
+		}
+	}
 }
 
 
@@ -89,9 +108,16 @@ void FeatureWorkerManager::startWorker( const Feature& feature, WorkerProcessMod
 
 	stopWorker( feature );
 
+	if( startWorkerInHost( feature, workerProcessMode ) )
+	{
+		return;
+	}
+
 	const auto featureUid = feature.uid().toString();
 
 	Worker worker;
+	worker.processMode = workerProcessMode;
+	worker.token = generateToken();
 
 	if( workerProcessMode == ManagedSystemProcess )
 	{
@@ -102,13 +128,13 @@ void FeatureWorkerManager::startWorker( const Feature& feature, WorkerProcessMod
 				 worker.process, &QProcess::deleteLater );
 
 		vDebug() << "Starting worker (managed system process) for feature" << feature.name() << featureUid;
-		worker.process->start( VeyonCore::filesystem().workerFilePath(), { featureUid } );
+		worker.process->start( VeyonCore::filesystem().workerFilePath(), { featureUid, worker.token } );
 	}
 	else
 	{
 		vDebug() << "Starting worker (unmanaged session process) for feature" << feature.name() << featureUid;
 		const auto ret = VeyonCore::platform().coreFunctions().
-				runProgramAsUser( VeyonCore::filesystem().workerFilePath(), { featureUid },
+				runProgramAsUser( VeyonCore::filesystem().workerFilePath(), { featureUid, worker.token },
 								  VeyonCore::platform().userFunctions().currentUser(),
 								  VeyonCore::platform().coreFunctions().activeDesktopName() );
 		if( ret == false )
@@ -123,6 +149,8 @@ void FeatureWorkerManager::startWorker( const Feature& feature, WorkerProcessMod
 	m_workersMutex.lock();
 	m_workers[feature.uid()] = worker;
 	m_workersMutex.unlock();
+
+	emit runningWorkersChanged();
 }
 
 
@@ -148,7 +176,18 @@ void FeatureWorkerManager::stopWorker( const Feature &feature )
 
 		auto& worker = m_workers[feature.uid()];
 
-		if( worker.socket )
+		if( worker.hosted )
+		{
+			// only detach feature from worker host and keep the shared connection open
+			const auto& workerHost = m_workerHosts[worker.processMode];
+			if( workerHost.socket )
+			{
+				FeatureMessage( workerHostUid( worker.processMode ), StopFeatureCommand ).
+						addArgument( FeatureUidArgument, feature.uid() ).
+						send( workerHost.socket, FeatureMessage::Format::Compact );
+			}
+		}
+		else if( worker.socket )
 		{
 			worker.socket->disconnect( this );
 			disconnect( worker.socket );
@@ -167,6 +206,11 @@ void FeatureWorkerManager::stopWorker( const Feature &feature )
 		}
 
 		m_workers.remove( feature.uid() );
+
+		m_workersMutex.unlock();
+
+		emit runningWorkersChanged();
+		return;
 	}
 
 	m_workersMutex.unlock();
@@ -178,12 +222,31 @@ void FeatureWorkerManager::sendMessage( const FeatureMessage& message )
 {
 	m_workersMutex.lock();
 
-	if( m_workers.contains( message.featureUid() ) )
+	if( m_workers.contains( message.featureUid() ) == false )
 	{
-		m_workers[message.featureUid()].pendingMessages.append( message );
+		m_workersMutex.unlock();
+		return;
+	}
+
+	auto& worker = m_workers[message.featureUid()];
+	worker.pendingMessages.append( message );
+
+	if( worker.restorable && worker.attached == false )
+	{
+		worker.startMessages.append( message );
 	}
 
 	m_workersMutex.unlock();
+
+	if( thread() == QThread::currentThread() )
+	{
+		sendPendingMessages();
+	}
+	else if( m_pendingMessagesScheduled.exchange( true ) == false )
+	{
+		// wake up our thread once for all messages queued until it gets to run
+		QMetaObject::invokeMethod( this, "sendPendingMessages", Qt::QueuedConnection );
+	}
 }
 
 
@@ -213,6 +276,72 @@ FeatureUidList FeatureWorkerManager::runningWorkers()
 
 
 
+void FeatureWorkerManager::startWorkerHosts()
+{
+	startWorkerHost( ManagedSystemProcess );
+	startWorkerHost( UnmanagedSessionProcess );
+}
+
+
+
+QString FeatureWorkerManager::expectWorkerHost( WorkerProcessMode workerProcessMode )
+{
+	auto& workerHost = m_workerHosts[workerProcessMode];
+
+	workerHost.token = generateToken();
+	workerHost.startPending = true;
+
+	return workerHost.token;
+}
+
+
+
+Feature::Uid FeatureWorkerManager::workerHostUid( WorkerProcessMode workerProcessMode )
+{
+	switch( workerProcessMode )
+	{
+	case ManagedSystemProcess: return QStringLiteral("0f3b4b5e-7a4c-4a0e-9d0a-8e6b3c7c2f11");
+	case UnmanagedSessionProcess: return QStringLiteral("6c5e2a9d-1f8b-4e3a-b2d4-5a7f0c9e4d22");
+	default: break;
+	}
+
+	return {};
+}
+
+
+
+bool FeatureWorkerManager::isWorkerHostUid( Feature::Uid uid )
+{
+	return uid.isNull() == false &&
+			( uid == workerHostUid( ManagedSystemProcess ) || uid == workerHostUid( UnmanagedSessionProcess ) );
+}
+
+
+
+Feature::Uid FeatureWorkerManager::metricsReportUid()
+{
+	return QStringLiteral("4d1c7e3a-9b2f-4c6d-8e5a-3f7b1d9c0e33");
+}
+
+
+
+MetricsRegistry::Snapshots FeatureWorkerManager::workerMetrics()
+{
+	QMutexLocker locker( &m_workersMutex );
+
+	MetricsRegistry::Snapshots snapshots;
+	snapshots.reserve( m_workerMetrics.size() );
+
+	for( const auto& snapshot : qAsConst( m_workerMetrics ) )
+	{
+		snapshots.append( snapshot );
+	}
+
+	return snapshots;
+}
+
+
+
 void FeatureWorkerManager::acceptConnection()
 {
 	vDebug() << "accepting connection";
@@ -225,6 +354,10 @@ void FeatureWorkerManager::acceptConnection()
 
 	connect( socket, &QTcpSocket::disconnected,
 			 this, [=] () { closeConnection( socket ); } );
+
+	// continue with messages held back due to a full write buffer
+	connect( socket, &QTcpSocket::bytesWritten,
+			 this, [=] () { sendPendingMessages(); } );
 }
 
 
@@ -232,31 +365,64 @@ void FeatureWorkerManager::acceptConnection()
 void FeatureWorkerManager::processConnection( QTcpSocket* socket )
 {
 	FeatureMessage message;
-	message.receive( socket );
-
-	m_workersMutex.lock();
 
-	// set socket information
-	if( m_workers.contains( message.featureUid() ) )
+	// readyRead() is not emitted again for data already buffered so process all complete messages
+	while( message.isReadyForReceive( socket ) && message.receive( socket ) )
 	{
-		if( m_workers[message.featureUid()].socket.isNull() )
+		if( message.featureUid() == metricsReportUid() )
 		{
-			m_workers[message.featureUid()].socket = socket;
+			processMetricsReport( socket, message );
+			continue;
 		}
 
-		m_workersMutex.unlock();
+		m_receivedMessagesCounter.increment();
 
-		if( message.command() >= 0 )
+		if( isWorkerHostUid( message.featureUid() ) )
 		{
-			m_featureManager.handleFeatureMessage( m_server, MessageContext( socket ), message );
+			if( processWorkerHostMessage( socket, message ) == false )
+			{
+				return;
+			}
+			continue;
 		}
 
-	}
-	else
-	{
-		m_workersMutex.unlock();
+		m_workersMutex.lock();
 
-		vCritical() << "got data from non-existing worker!" << message.featureUid();
+		// set socket information
+		if( m_workers.contains( message.featureUid() ) )
+		{
+			auto& worker = m_workers[message.featureUid()];
+			if( worker.socket.isNull() && isAuthorizedWorkerConnection( worker, socket, message ) )
+			{
+				worker.socket = socket;
+				worker.attached = true;
+				worker.token.clear();
+
+				// deliver messages queued while the worker was starting up
+				sendPendingMessages( worker );
+			}
+			else if( worker.socket != socket )
+			{
+				m_workersMutex.unlock();
+
+				vWarning() << "rejecting connection claiming to be the worker for feature" << message.featureUid();
+				rejectConnection( socket );
+				return;
+			}
+
+			m_workersMutex.unlock();
+
+			if( message.command() >= 0 )
+			{
+				m_featureManager.handleFeatureMessage( m_server, MessageContext( socket, message.format() ), message );
+			}
+		}
+		else
+		{
+			m_workersMutex.unlock();
+
+			vCritical() << "got data from non-existing worker!" << message.featureUid();
+		}
 	}
 }
 
@@ -264,11 +430,38 @@ void FeatureWorkerManager::processConnection( QTcpSocket* socket )
 
 void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 {
+	auto workerHostProcessMode = WorkerProcessModeCount;
+
+	for( int i = 0; i < WorkerProcessModeCount; ++i )
+	{
+		if( m_workerHosts[i].socket == socket )
+		{
+			workerHostProcessMode = static_cast<WorkerProcessMode>( i );
+		}
+	}
+
 	m_workersMutex.lock();
 
+	const auto workerCount = m_workers.size();
+
 	for( auto it = m_workers.begin(); it != m_workers.end(); )
 	{
-		if( it.value().socket == socket )
+		auto& worker = it.value();
+		const auto hostedInClosedHost = worker.hosted && worker.processMode == workerHostProcessMode;
+
+		if( hostedInClosedHost && worker.restorable )
+		{
+			vDebug() << "restoring hosted worker for feature" << it.key() << "once the worker host has been restarted";
+			worker.socket.clear();
+			worker.pendingMessages = worker.startMessages + worker.pendingMessages;
+			++it;
+		}
+		else if( hostedInClosedHost )
+		{
+			vWarning() << "stopping hosted worker for feature" << it.key() << "as its worker host died";
+			it = m_workers.erase( it );
+		}
+		else if( worker.socket == socket )
 		{
 			vDebug() << "removing worker after socket has been closed";
 			it = m_workers.erase( it );
@@ -279,27 +472,387 @@ void FeatureWorkerManager::closeConnection( QTcpSocket* socket )
 		}
 	}
 
+	const auto workersRemoved = m_workers.size() != workerCount;
+
+	m_workerMetrics.remove( socket );
+
 	m_workersMutex.unlock();
 
+	if( workersRemoved )
+	{
+		emit runningWorkersChanged();
+	}
+
+	if( workerHostProcessMode != WorkerProcessModeCount )
+	{
+		vDebug() << "worker host" << workerHostProcessMode << "disconnected - restarting it later";
+
+		restartWorkerHost( workerHostProcessMode );
+	}
+
 	socket->deleteLater();
 }
 
 
 
-void FeatureWorkerManager::sendPendingMessages()
+void FeatureWorkerManager::startWorkerHost( WorkerProcessMode workerProcessMode )
+{
+	auto& workerHost = m_workerHosts[workerProcessMode];
+
+	if( workerHost.socket || workerHost.process || workerHost.restartScheduled )
+	{
+		return;
+	}
+
+	// only the process started here is accepted as worker host
+	const QStringList arguments{ workerHostUid( workerProcessMode ).toString(), expectWorkerHost( workerProcessMode ) };
+
+	if( workerProcessMode == ManagedSystemProcess )
+	{
+		workerHost.process = new QProcess;
+		workerHost.process->setProcessChannelMode( QProcess::ForwardedChannels );
+
+		connect( workerHost.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+				 workerHost.process, &QProcess::deleteLater );
+
+		// a host exiting before connecting back never triggers closeConnection()
+		connect( workerHost.process, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+				 this, [=]() {
+			if( m_workerHosts[workerProcessMode].socket.isNull() )
+			{
+				vWarning() << "worker host" << workerProcessMode << "exited before connecting";
+				restartWorkerHost( workerProcessMode );
+			}
+		} );
+
+		vDebug() << "Starting worker host (managed system process)";
+		workerHost.process->start( VeyonCore::filesystem().workerFilePath(), arguments );
+	}
+	else
+	{
+		vDebug() << "Starting worker host (unmanaged session process)";
+		const auto ret = VeyonCore::platform().coreFunctions().
+				runProgramAsUser( VeyonCore::filesystem().workerFilePath(), arguments,
+								  VeyonCore::platform().userFunctions().currentUser(),
+								  VeyonCore::platform().coreFunctions().activeDesktopName() );
+		if( ret == false )
+		{
+			// no user logged on yet so try again later
+			QTimer::singleShot( UnmanagedSessionProcessRetryInterval, this,
+								[=]() { startWorkerHost( workerProcessMode ); } );
+			return;
+		}
+	}
+
+	// there's no process handle for session processes so also restart hosts which did not
+	// connect back in time (e.g. because they crashed during startup)
+	const auto startCount = ++workerHost.startCount;
+
+	QTimer::singleShot( WorkerHostStartTimeout, this, [=]() {
+		const auto& currentWorkerHost = m_workerHosts[workerProcessMode];
+		if( currentWorkerHost.startCount == startCount &&
+			currentWorkerHost.socket.isNull() && currentWorkerHost.restartScheduled == false )
+		{
+			vWarning() << "worker host" << workerProcessMode << "did not connect in time";
+			restartWorkerHost( workerProcessMode );
+		}
+	} );
+}
+
+
+
+void FeatureWorkerManager::restartWorkerHost( WorkerProcessMode workerProcessMode )
 {
+	auto& workerHost = m_workerHosts[workerProcessMode];
+
+	if( workerHost.restartScheduled )
+	{
+		return;
+	}
+
+	if( workerHost.process )
+	{
+		workerHost.process->disconnect( this );
+		workerHost.process->kill();
+	}
+
+	workerHost.socket.clear();
+	workerHost.process.clear();
+	workerHost.token.clear();
+	workerHost.startPending = false;
+	workerHost.restartScheduled = true;
+
+	QTimer::singleShot( WorkerHostRestartInterval, this, [=]() {
+		m_workerHosts[workerProcessMode].restartScheduled = false;
+		startWorkerHost( workerProcessMode );
+	} );
+}
+
+
+
+bool FeatureWorkerManager::startWorkerInHost( const Feature& feature, WorkerProcessMode workerProcessMode )
+{
+	if( workerHostUid( workerProcessMode ).isNull() ||
+		m_workerHosts[workerProcessMode].socket.isNull() ||
+		m_featureManager.isWorkerHostable( feature ) == false )
+	{
+		return false;
+	}
+
+	vDebug() << "Starting worker in worker host for feature" << feature.name() << feature.uid();
+
+	Worker worker;
+	worker.processMode = workerProcessMode;
+	worker.hosted = true;
+	worker.restorable = m_featureManager.isWorkerRestorable( feature );
+
 	m_workersMutex.lock();
+	m_workers[feature.uid()] = worker;
+	m_workersMutex.unlock();
 
-	for( auto it = m_workers.begin(); it != m_workers.end(); ++it )
+	emit runningWorkersChanged();
+
+	// worker host sends an init message for the feature once it's ready which then registers the socket
+	return FeatureMessage( workerHostUid( workerProcessMode ), StartFeatureCommand ).
+			addArgument( FeatureUidArgument, feature.uid() ).
+			send( m_workerHosts[workerProcessMode].socket, FeatureMessage::Format::Compact );
+}
+
+
+
+bool FeatureWorkerManager::processWorkerHostMessage( QTcpSocket* socket, const FeatureMessage& message )
+{
+	const auto workerProcessMode = message.featureUid() == workerHostUid( ManagedSystemProcess ) ?
+									   ManagedSystemProcess : UnmanagedSessionProcess;
+	auto& workerHost = m_workerHosts[workerProcessMode];
+
+	if( message.command() == FeatureMessage::InitCommand )
 	{
-		auto& worker = it.value();
+		// any local process can connect to us, so only accept the host we're waiting for and only once
+		if( workerHost.startPending == false || workerHost.socket || workerHost.token.isEmpty() ||
+			message.argument( TokenArgument ).toString() != workerHost.token )
+		{
+			vWarning() << "rejecting unexpected worker host connection for" << workerProcessMode;
+			rejectConnection( socket );
+			return false;
+		}
 
-		while( worker.socket && worker.pendingMessages.isEmpty() == false )
+		vDebug() << "worker host" << workerProcessMode << "connected";
+
+		workerHost.socket = socket;
+		workerHost.startPending = false;
+		workerHost.token.clear();
+
+		restoreHostedWorkers( workerProcessMode );
+
+		return true;
+	}
+
+	if( socket != workerHost.socket )
+	{
+		vWarning() << "rejecting worker host command from unknown connection";
+		rejectConnection( socket );
+		return false;
+	}
+
+	switch( message.command() )
+	{
+	case FeatureStoppedCommand:
+	{
+		const auto featureUid = message.argument( FeatureUidArgument ).toUuid();
+
+		m_workersMutex.lock();
+		if( m_workers.contains( featureUid ) && m_workers[featureUid].hosted &&
+			m_workers[featureUid].processMode == workerProcessMode )
 		{
-			worker.pendingMessages.first().send( worker.socket );
-			worker.pendingMessages.removeFirst();
+			vDebug() << "worker host stopped feature" << featureUid;
+			m_workers.remove( featureUid );
+			m_workersMutex.unlock();
+
+			emit runningWorkersChanged();
+			break;
 		}
+		m_workersMutex.unlock();
+		break;
 	}
 
+	default:
+		vWarning() << "unhandled worker host command" << message.command();
+		break;
+	}
+
+	return true;
+}
+
+
+
+void FeatureWorkerManager::restoreHostedWorkers( WorkerProcessMode workerProcessMode )
+{
+	FeatureUidList featureUids;
+
+	m_workersMutex.lock();
+	for( auto it = m_workers.constBegin(); it != m_workers.constEnd(); ++it )
+	{
+		if( it.value().hosted && it.value().processMode == workerProcessMode && it.value().socket.isNull() )
+		{
+			featureUids.append( it.key().toString() );
+		}
+	}
 	m_workersMutex.unlock();
+
+	for( const auto& featureUid : qAsConst(featureUids) )
+	{
+		vDebug() << "restoring hosted worker for feature" << featureUid;
+
+		// the start messages are delivered again as soon as the feature has been initialized
+		FeatureMessage( workerHostUid( workerProcessMode ), StartFeatureCommand ).
+				addArgument( FeatureUidArgument, Feature::Uid( featureUid ) ).
+				send( m_workerHosts[workerProcessMode].socket, FeatureMessage::Format::Compact );
+	}
+}
+
+
+
+bool FeatureWorkerManager::isAuthorizedWorkerConnection( const Worker& worker, QTcpSocket* socket,
+														 const FeatureMessage& message ) const
+{
+	if( worker.hosted )
+	{
+		// hosted features are initialized through the connection of the verified worker host
+		return socket == m_workerHosts[worker.processMode].socket;
+	}
+
+	return message.command() == FeatureMessage::InitCommand &&
+			worker.token.isEmpty() == false &&
+			message.argument( TokenArgument ).toString() == worker.token;
+}
+
+
+
+bool FeatureWorkerManager::isVerifiedConnection( QTcpSocket* socket ) const
+{
+	for( const auto& workerHost : m_workerHosts )
+	{
+		if( workerHost.socket == socket )
+		{
+			return true;
+		}
+	}
+
+	for( const auto& worker : m_workers )
+	{
+		if( worker.attached && worker.socket == socket )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+bool FeatureWorkerManager::isValidMetricsReport( const FeatureMessage& message )
+{
+	const auto isShortString = []( const QVariant& value ) {
+		return value.toString().size() <= MaximumMetricsStringLength;
+	};
+
+	const auto metrics = message.argument( MetricsArgument ).toList();
+
+	if( isShortString( message.argument( ProcessNameArgument ) ) == false ||
+		metrics.size() > MaximumReportedMetrics )
+	{
+		return false;
+	}
+
+	for( const auto& metric : metrics )
+	{
+		const auto map = metric.toMap();
+		if( map.size() > MaximumMetricsBucketCount ||
+			std::all_of( map.cbegin(), map.cend(), [&]( const QVariant& value ) {
+					return value.type() == QVariant::List ? value.toList().size() <= MaximumMetricsBucketCount :
+															isShortString( value );
+				} ) == false )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+
+void FeatureWorkerManager::rejectConnection( QTcpSocket* socket )
+{
+	// closeConnection() cleans up once the socket has been disconnected
+	socket->abort();
+}
+
+
+
+QString FeatureWorkerManager::generateToken()
+{
+	return QString::fromLatin1( CryptoCore::generateChallenge().toHex() );
+}
+
+
+
+void FeatureWorkerManager::processMetricsReport( QTcpSocket* socket, const FeatureMessage& message )
+{
+	QMutexLocker locker( &m_workersMutex );
+
+	// reports end up in the server's metrics export so only take them from our own workers
+	if( isVerifiedConnection( socket ) == false )
+	{
+		vWarning() << "ignoring metrics report from unverified connection";
+		return;
+	}
+
+	if( isValidMetricsReport( message ) == false )
+	{
+		vWarning() << "ignoring invalid or oversized metrics report";
+		return;
+	}
+
+	m_workerMetrics[socket] = { message.argument( ProcessNameArgument ).toString(),
+								message.argument( MetricsArgument ).toList() };
+}
+
+
+
+void FeatureWorkerManager::sendPendingMessages()
+{
+	m_pendingMessagesScheduled = false;
+
+	m_workersMutex.lock();
+
+	qint64 pendingMessageCount = 0;
+
+	for( auto it = m_workers.begin(); it != m_workers.end(); ++it )
+	{
+		sendPendingMessages( it.value() );
+		pendingMessageCount += it.value().pendingMessages.size();
+	}
+
+	m_pendingMessagesGauge.set( pendingMessageCount );
+
+	m_workersMutex.unlock();
+}
+
+
+
+void FeatureWorkerManager::sendPendingMessages( Worker& worker )
+{
+	// stop writing while the worker is still busy reading and resume on bytesWritten()
+	while( worker.socket && worker.pendingMessages.isEmpty() == false &&
+		   worker.socket->bytesToWrite() < MaximumWorkerWriteBufferSize )
+	{
+		// workers are always shipped along with the server and thus understand the compact format
+		worker.pendingMessages.first().send( worker.socket, FeatureMessage::Format::Compact );
+		worker.pendingMessages.removeFirst();
+
+		m_sentMessagesCounter.increment();
+	}
 }
@@ -31,6 +31,7 @@
 #include <QTcpSocket>
 
 #include "FeatureMessage.h"
+#include "MetricsRegistry.h"
 
 class FeatureManager;
 class VeyonServerInterface;
@@ -45,6 +46,25 @@ public:
 		WorkerProcessModeCount
 	} ;
 
+	enum WorkerHostCommand {
+		StartFeatureCommand,
+		StopFeatureCommand,
+		FeatureStoppedCommand,
+		MetricsReportCommand
+	} ;
+
+	enum WorkerHostArgument {
+		FeatureUidArgument,
+		ProcessNameArgument,
+		MetricsArgument,
+		TokenArgument
+	} ;
+
+	static constexpr auto MetricsReportInterval = 5000;
+	static constexpr auto MaximumReportedMetrics = 512;
+	static constexpr auto MaximumMetricsStringLength = 1024;
+	static constexpr auto MaximumMetricsBucketCount = 64;
+
 	FeatureWorkerManager( VeyonServerInterface& server, FeatureManager& featureManager, QObject* parent = nullptr );
 	~FeatureWorkerManager() override;
 
@@ -56,14 +76,40 @@ public:
 	bool isWorkerRunning( const Feature& feature );
 	FeatureUidList runningWorkers();
 
+	void startWorkerHosts();
+
+	// lets a worker host started by the caller register and returns the token it has to present
+	QString expectWorkerHost( WorkerProcessMode workerProcessMode );
+
+	static Feature::Uid workerHostUid( WorkerProcessMode workerProcessMode );
+	static bool isWorkerHostUid( Feature::Uid uid );
+
+	// pseudo feature UID used by worker processes for periodically reporting their metrics
+	static Feature::Uid metricsReportUid();
+
+	MetricsRegistry::Snapshots workerMetrics();
+
+signals:
+	void runningWorkersChanged();
+
 private:
 	void acceptConnection();
 	void processConnection( QTcpSocket* socket );
 	void closeConnection( QTcpSocket* socket );
 
-	void sendPendingMessages();
+	void startWorkerHost( WorkerProcessMode workerProcessMode );
+	void restartWorkerHost( WorkerProcessMode workerProcessMode );
+	bool startWorkerInHost( const Feature& feature, WorkerProcessMode workerProcessMode );
+	bool processWorkerHostMessage( QTcpSocket* socket, const FeatureMessage& message );
+	void restoreHostedWorkers( WorkerProcessMode workerProcessMode );
+	void processMetricsReport( QTcpSocket* socket, const FeatureMessage& message );
+
+	Q_INVOKABLE void sendPendingMessages();
 
 	static constexpr auto UnmanagedSessionProcessRetryInterval = 5000;
+	static constexpr auto WorkerHostRestartInterval = 5000;
+	static constexpr auto WorkerHostStartTimeout = 30000;
+	static constexpr auto MaximumWorkerWriteBufferSize = 1024*1024;
 
 	VeyonServerInterface& m_server;
 	FeatureManager& m_featureManager;
@@ -74,11 +120,49 @@ private:
 		QPointer<QTcpSocket> socket;
 		QPointer<QProcess> process;
 		QList<FeatureMessage> pendingMessages;
+		// messages delivered again when restoring a hosted worker after its worker host died
+		QList<FeatureMessage> startMessages;
+		// passed to standalone worker processes which have to present it when connecting
+		QString token;
+		WorkerProcessMode processMode{WorkerProcessModeCount};
+		bool hosted{false};
+		bool restorable{false};
+		bool attached{false};
 	};
 
+	// long-living per-session processes hosting multiple features behind a single connection
+	struct WorkerHost
+	{
+		QPointer<QTcpSocket> socket;
+		QPointer<QProcess> process;
+		QString token;
+		int startCount{0};
+		bool startPending{false};
+		bool restartScheduled{false};
+	};
+
+	bool isAuthorizedWorkerConnection( const Worker& worker, QTcpSocket* socket, const FeatureMessage& message ) const;
+	bool isVerifiedConnection( QTcpSocket* socket ) const;
+	static bool isValidMetricsReport( const FeatureMessage& message );
+	void rejectConnection( QTcpSocket* socket );
+
+	static QString generateToken();
+
+	void sendPendingMessages( Worker& worker );
+
 	using WorkerMap = QMap<Feature::Uid, Worker>;
 	WorkerMap m_workers;
 
+	std::array<WorkerHost, WorkerProcessModeCount> m_workerHosts{};
+
+	QMap<QTcpSocket*, MetricsRegistry::Snapshot> m_workerMetrics;
+
 	QMutex m_workersMutex;
 
+	MetricsRegistry::Counter& m_sentMessagesCounter;
+	MetricsRegistry::Counter& m_receivedMessagesCounter;
+	MetricsRegistry::Gauge& m_pendingMessagesGauge;
+
+	std::atomic<bool> m_pendingMessagesScheduled{false};
+
 } ;
@@ -0,0 +1,140 @@
+/*
+ * LockFreeQueue.h - bounded lock-free multi-producer single-consumer queue
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// ring buffer where each slot carries a sequence number telling producers and the
+// consumer whether it is free or filled - producers only contend on a single
+// atomic position counter and never block, a full queue makes enqueue() fail
+template<typename T>
+class LockFreeQueue
+{
+public:
+	explicit LockFreeQueue( size_t minimumCapacity ) :
+		m_slots( roundUpToPowerOfTwo( minimumCapacity ) ),
+		m_mask( m_slots.size() - 1 )
+	{
+		for( size_t i = 0; i < m_slots.size(); ++i )
+		{
+			m_slots[i].sequence.store( i, std::memory_order_relaxed );
+		}
+	}
+
+	size_t capacity() const
+	{
+		return m_slots.size();
+	}
+
+	// safe to call from any number of threads
+	bool enqueue( T&& value )
+	{
+		auto position = m_enqueuePosition.load( std::memory_order_relaxed );
+		Slot* slot = nullptr;
+
+		for( ;; )
+		{
+			slot = &m_slots[position & m_mask];
+			const auto sequence = slot->sequence.load( std::memory_order_acquire );
+			const auto difference = static_cast<std::ptrdiff_t>( sequence ) - static_cast<std::ptrdiff_t>( position );
+
+			if( difference == 0 )
+			{
+				if( m_enqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+				{
+					break;
+				}
+			}
+			else if( difference < 0 )
+			{
+				return false;
+			}
+			else
+			{
+				position = m_enqueuePosition.load( std::memory_order_relaxed );
+			}
+		}
+
+		slot->value = std::move( value );
+		slot->sequence.store( position + 1, std::memory_order_release );
+
+		return true;
+	}
+
+	// must only be called from the consumer thread
+	bool dequeue( T& value )
+	{
+		auto& slot = m_slots[m_dequeuePosition & m_mask];
+		const auto sequence = slot.sequence.load( std::memory_order_acquire );
+
+		if( static_cast<std::ptrdiff_t>( sequence ) - static_cast<std::ptrdiff_t>( m_dequeuePosition + 1 ) < 0 )
+		{
+			return false;
+		}
+
+		value = std::move( slot.value );
+		slot.value = T();
+		slot.sequence.store( m_dequeuePosition + m_mask + 1, std::memory_order_release );
+		++m_dequeuePosition;
+
+		return true;
+	}
+
+	bool isEmpty() const
+	{
+		return m_enqueuePosition.load( std::memory_order_acquire ) == m_dequeuePosition.load( std::memory_order_acquire );
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence{0};
+		T value{};
+	} ;
+
+	static size_t roundUpToPowerOfTwo( size_t value )
+	{
+		size_t result = 2;
+		while( result < value )
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	static constexpr size_t CacheLineSize = 64;
+
+	std::vector<Slot> m_slots;
+	const size_t m_mask;
+
+	// keep producer and consumer positions on separate cache lines
+	char m_padding1[CacheLineSize]{};
+	std::atomic<size_t> m_enqueuePosition{0};
+	char m_padding2[CacheLineSize]{};
+	std::atomic<size_t> m_dequeuePosition{0};
+
+} ;
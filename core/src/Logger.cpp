@@ -27,24 +27,25 @@
 #include <QDir>
 #include <QFile>
 
+#include "AsyncLogWriter.h"
 #include "VeyonConfiguration.h"
 #include "Filesystem.h"
 #include "Logger.h"
 #include "PlatformCoreFunctions.h"
 
 QAtomicPointer<Logger> Logger::s_instance = nullptr;
-QMutex Logger::s_instanceMutex;
+QReadWriteLock Logger::s_instanceLock;
 
 
 Logger::Logger( const QString &appName ) :
 	m_appName( QStringLiteral( "Veyon" ) + appName )
 {
-	s_instanceMutex.lock();
+	s_instanceLock.lockForWrite();
 
 	Q_ASSERT(s_instance == nullptr);
 
 	s_instance = this;
-	s_instanceMutex.unlock();
+	s_instanceLock.unlock();
 
 	auto configuredLogLevel = VeyonCore::config().logLevel();
 	if( qEnvironmentVariableIsSet( logLevelEnvironmentVariable() ) )
@@ -54,9 +55,13 @@ Logger::Logger( const QString &appName ) :
 
 	m_logLevel = qBound( LogLevel::Min, configuredLogLevel, LogLevel::Max );
 	m_logToSystem = VeyonCore::config().logToSystem();
+	m_logToStdErr = VeyonCore::config().logToStdErr();
 
 	initLogFile();
 
+	m_writer = new AsyncLogWriter( [this]( const AsyncLogWriter::Records& records ) { writeRecords( records ); } );
+	m_writer->start();
+
 	qInstallMessageHandler( qtMsgHandler );
 
 	VeyonCore::platform().coreFunctions().initNativeLoggingSystem( appName );
@@ -79,13 +84,13 @@ Logger::~Logger()
 {
 	vDebug() << "Shutdown";
 
-	QMutexLocker l( &m_logMutex );
-
+	s_instanceLock.lockForWrite();
 	qInstallMessageHandler(nullptr);
-
-	s_instanceMutex.lock();
 	s_instance = nullptr;
-	s_instanceMutex.unlock();
+	s_instanceLock.unlock();
+
+	// writes all pending records
+	delete m_writer;
 
 	delete m_logFile;
 }
@@ -197,7 +202,7 @@ void Logger::rotateLogFile()
 
 
 
-QString Logger::formatMessage( LogLevel ll, const QString& message )
+QString Logger::formatMessage( LogLevel ll, const QDateTime& timestamp, const QString& message )
 {
 	QString messageType;
 	switch( ll )
@@ -211,8 +216,8 @@ QString Logger::formatMessage( LogLevel ll, const QString& message )
 	}
 
 	return QStringLiteral( "%1.%2: [%3] %4\n" ).arg(
-				QDateTime::currentDateTime().toString( Qt::ISODate ),
-				QDateTime::currentDateTime().toString( QStringLiteral( "zzz" ) ),
+				timestamp.toString( Qt::ISODate ),
+				timestamp.toString( QStringLiteral( "zzz" ) ),
 				messageType,
 				message.trimmed() );
 }
@@ -222,7 +227,7 @@ QString Logger::formatMessage( LogLevel ll, const QString& message )
 
 void Logger::qtMsgHandler( QtMsgType messageType, const QMessageLogContext& context, const QString& message )
 {
-	QMutexLocker instanceLocker( &s_instanceMutex );
+	QReadLocker instanceLocker( &s_instanceLock );
 
 	if( s_instance.load() == nullptr )
 	{
@@ -257,40 +262,64 @@ void Logger::log( LogLevel logLevel, const QString& message )
 {
 	if( m_logLevel >= logLevel )
 	{
-		QMutexLocker l( &m_logMutex );
-		if( message == m_lastMessage && logLevel == m_lastMessageLevel )
+		m_writer->enqueue( logLevel, message );
+
+		if( logLevel == LogLevel::Critical )
+		{
+			// make sure critical messages reach the log before a potential abort
+			m_writer->flush();
+		}
+	}
+}
+
+
+
+void Logger::writeRecords( const QVector<Record>& records )
+{
+	QByteArray messages;
+
+	for( const auto& record : records )
+	{
+		if( record.message == m_lastMessage && record.logLevel == m_lastMessageLevel )
 		{
 			++m_lastMessageCount;
+			continue;
 		}
-		else
+
+		const auto timestamp = QDateTime::fromMSecsSinceEpoch( record.timestamp );
+
+		if( m_lastMessageCount )
 		{
-			if( m_lastMessageCount )
-			{
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "---" ) ) );
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "Last message repeated %1 times" ).arg( m_lastMessageCount ) ) );
-				outputMessage( formatMessage( m_lastMessageLevel, QStringLiteral( "---" ) ) );
-				m_lastMessageCount = 0;
-			}
-			outputMessage( formatMessage( logLevel, message ) );
+			messages += formatMessage( m_lastMessageLevel, timestamp, QStringLiteral( "---" ) ).toUtf8();
+			messages += formatMessage( m_lastMessageLevel, timestamp, QStringLiteral( "Last message repeated %1 times" ).arg( m_lastMessageCount ) ).toUtf8();
+			messages += formatMessage( m_lastMessageLevel, timestamp, QStringLiteral( "---" ) ).toUtf8();
+			m_lastMessageCount = 0;
+		}
 
-			if( m_logToSystem )
-			{
-				VeyonCore::platform().coreFunctions().writeToNativeLoggingSystem( message, logLevel );
-			}
+		messages += formatMessage( record.logLevel, timestamp, record.message ).toUtf8();
 
-			m_lastMessage = message;
-			m_lastMessageLevel = logLevel;
+		if( m_logToSystem )
+		{
+			VeyonCore::platform().coreFunctions().writeToNativeLoggingSystem( record.message, record.logLevel );
 		}
+
+		m_lastMessage = record.message;
+		m_lastMessageLevel = record.logLevel;
+	}
+
+	if( messages.isEmpty() == false )
+	{
+		outputMessages( messages );
 	}
 }
 
 
 
-void Logger::outputMessage( const QString& message )
+void Logger::outputMessages( const QByteArray& messages )
 {
 	if( m_logFile )
 	{
-		m_logFile->write( message.toUtf8() );
+		m_logFile->write( messages );
 		m_logFile->flush();
 
 		if( m_logFileSizeLimit > 0 &&
@@ -307,9 +336,9 @@ void Logger::outputMessage( const QString& message )
 		}
 	}
 
-	if( VeyonCore::config().logToStdErr() )
+	if( m_logToStdErr )
 	{
-		fprintf( stderr, "%s", message.toUtf8().constData() );
+		fwrite( messages.constData(), 1, static_cast<size_t>( messages.size() ), stderr );
 		fflush( stderr );
 	}
 }
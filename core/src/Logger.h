@@ -24,11 +24,13 @@
 
 #pragma once
 
-#include <QMutex>
+#include <QReadWriteLock>
 #include <QTextStream>
 
 #include "VeyonCore.h"
 
+class AsyncLogWriter;
+class QDateTime;
 class QFile;
 
 // clazy:excludeall=rule-of-three
@@ -52,6 +54,13 @@ public:
 	};
 	Q_ENUM(LogLevel)
 
+	struct Record
+	{
+		LogLevel logLevel{LogLevel::Nothing};
+		qint64 timestamp{0}; // milliseconds since epoch
+		QString message{};
+	} ;
+
 	static constexpr int DefaultFileSizeLimit = 100;
 	static constexpr int DefaultFileRotationCount = 10;
 	static constexpr const char* DefaultLogFileDirectory = "$TEMP";
@@ -69,6 +78,7 @@ public:
 		return m_logLevel;
 	}
 
+	static QString formatMessage( LogLevel ll, const QDateTime& timestamp, const QString& msg );
 
 private:
 	void initLogFile();
@@ -78,21 +88,23 @@ private:
 	void rotateLogFile();
 
 	void log( LogLevel logLevel, const QString& message );
-	void outputMessage( const QString& message );
+	void writeRecords( const QVector<Record>& records );
+	void outputMessages( const QByteArray& messages );
 
-	static QString formatMessage( LogLevel ll, const QString &msg );
 	static void qtMsgHandler( QtMsgType msgType, const QMessageLogContext &, const QString& msg );
 
 	static QAtomicPointer<Logger> s_instance;
-	static QMutex s_instanceMutex;
+	static QReadWriteLock s_instanceLock;
 
 	LogLevel m_logLevel{LogLevel::Default};
-	QMutex m_logMutex{};
+	AsyncLogWriter* m_writer{nullptr};
 
+	// only accessed by the writer thread
 	LogLevel m_lastMessageLevel{LogLevel::Nothing};
 	QString m_lastMessage{};
 	int m_lastMessageCount{0};
 	bool m_logToSystem{false};
+	bool m_logToStdErr{true};
 
 	QString m_appName;
 
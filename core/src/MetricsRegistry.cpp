@@ -0,0 +1,274 @@
+/*
+ * MetricsRegistry.cpp - implementation of MetricsRegistry class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <algorithm>
+
+#include "MetricsRegistry.h"
+
+
+MetricsRegistry::Histogram::Histogram( const Bounds& bounds ) :
+	m_bounds( bounds ),
+	m_buckets( new std::atomic<quint64>[static_cast<size_t>( bounds.size() + 1 )] )
+{
+	for( int i = 0; i <= m_bounds.size(); ++i )
+	{
+		m_buckets[static_cast<size_t>( i )].store( 0 );
+	}
+}
+
+
+
+void MetricsRegistry::Histogram::observe( qint64 value )
+{
+	// bounds are sorted so the first bound not less than the value denotes the bucket
+	const auto bucket = std::lower_bound( m_bounds.constBegin(), m_bounds.constEnd(), value ) - m_bounds.constBegin();
+
+	m_buckets[static_cast<size_t>( bucket )].fetch_add( 1, std::memory_order_relaxed );
+	m_sum.fetch_add( value, std::memory_order_relaxed );
+	m_count.fetch_add( 1, std::memory_order_relaxed );
+}
+
+
+
+QVector<quint64> MetricsRegistry::Histogram::cumulativeBucketCounts() const
+{
+	QVector<quint64> counts;
+	counts.reserve( m_bounds.size() + 1 );
+
+	quint64 total = 0;
+	for( int i = 0; i <= m_bounds.size(); ++i )
+	{
+		total += m_buckets[static_cast<size_t>( i )].load( std::memory_order_relaxed );
+		counts.append( total );
+	}
+
+	return counts;
+}
+
+
+
+MetricsRegistry::MetricsRegistry( const QString& processName ) :
+	m_processName( processName )
+{
+}
+
+
+
+MetricsRegistry::Counter& MetricsRegistry::counter( const QString& name, const QString& help )
+{
+	QMutexLocker locker( &m_mutex );
+
+	auto& entry = m_counters[name];
+	if( entry.metric == nullptr )
+	{
+		entry.help = help;
+		entry.metric.reset( new Counter );
+	}
+
+	return *entry.metric;
+}
+
+
+
+MetricsRegistry::Gauge& MetricsRegistry::gauge( const QString& name, const QString& help )
+{
+	QMutexLocker locker( &m_mutex );
+
+	auto& entry = m_gauges[name];
+	if( entry.metric == nullptr )
+	{
+		entry.help = help;
+		entry.metric.reset( new Gauge );
+	}
+
+	return *entry.metric;
+}
+
+
+
+MetricsRegistry::Histogram& MetricsRegistry::histogram( const QString& name, const QString& help,
+														const Histogram::Bounds& bounds )
+{
+	QMutexLocker locker( &m_mutex );
+
+	auto& entry = m_histograms[name];
+	if( entry.metric == nullptr )
+	{
+		auto sortedBounds = bounds;
+		std::sort( sortedBounds.begin(), sortedBounds.end() );
+
+		entry.help = help;
+		entry.metric.reset( new Histogram( sortedBounds ) );
+	}
+
+	return *entry.metric;
+}
+
+
+
+MetricsRegistry::Snapshot MetricsRegistry::snapshot() const
+{
+	QMutexLocker locker( &m_mutex );
+
+	QVariantList metrics;
+	metrics.reserve( static_cast<int>( m_counters.size() + m_gauges.size() + m_histograms.size() ) );
+
+	for( const auto& counter : m_counters )
+	{
+		metrics.append( QVariantMap{
+							{ QStringLiteral("name"), counter.first },
+							{ QStringLiteral("help"), counter.second.help },
+							{ QStringLiteral("type"), QStringLiteral("counter") },
+							{ QStringLiteral("value"), counter.second.metric->value() } } );
+	}
+
+	for( const auto& gauge : m_gauges )
+	{
+		metrics.append( QVariantMap{
+							{ QStringLiteral("name"), gauge.first },
+							{ QStringLiteral("help"), gauge.second.help },
+							{ QStringLiteral("type"), QStringLiteral("gauge") },
+							{ QStringLiteral("value"), gauge.second.metric->value() } } );
+	}
+
+	for( const auto& histogram : m_histograms )
+	{
+		const auto& metric = *histogram.second.metric;
+
+		QVariantList bounds;
+		bounds.reserve( metric.bounds().size() );
+		for( auto bound : metric.bounds() )
+		{
+			bounds.append( bound );
+		}
+
+		QVariantList buckets;
+		const auto bucketCounts = metric.cumulativeBucketCounts();
+		buckets.reserve( bucketCounts.size() );
+		for( auto bucketCount : bucketCounts )
+		{
+			buckets.append( bucketCount );
+		}
+
+		metrics.append( QVariantMap{
+							{ QStringLiteral("name"), histogram.first },
+							{ QStringLiteral("help"), histogram.second.help },
+							{ QStringLiteral("type"), QStringLiteral("histogram") },
+							{ QStringLiteral("bounds"), bounds },
+							{ QStringLiteral("buckets"), buckets },
+							{ QStringLiteral("count"), metric.count() },
+							{ QStringLiteral("sum"), metric.sum() } } );
+	}
+
+	return { m_processName, metrics };
+}
+
+
+
+QString MetricsRegistry::toPrometheusText() const
+{
+	return toPrometheusText( { snapshot() } );
+}
+
+
+
+QString MetricsRegistry::toPrometheusText( const Snapshots& snapshots )
+{
+	static const auto escapeLabelValue = []( QString value ) {
+		return value.replace( QLatin1Char('\\'), QStringLiteral("\\\\") ).
+				replace( QLatin1Char('"'), QStringLiteral("\\\"") ).
+				replace( QLatin1Char('\n'), QStringLiteral("\\n") );
+	};
+
+	struct Family
+	{
+		QString help;
+		QString type;
+		QStringList samples;
+	};
+
+	// samples of the same metric reported by different processes have to be grouped
+	std::map<QString, Family> families;
+
+	for( const auto& snapshot : snapshots )
+	{
+		const auto processLabel = QStringLiteral("process=\"%1\"").arg( escapeLabelValue( snapshot.first ) );
+
+		for( const auto& metricData : snapshot.second )
+		{
+			const auto metric = metricData.toMap();
+			const auto name = metric.value( QStringLiteral("name") ).toString();
+			const auto type = metric.value( QStringLiteral("type") ).toString();
+
+			auto& family = families[name];
+			family.help = metric.value( QStringLiteral("help") ).toString();
+			family.type = type;
+
+			if( type == QLatin1String("histogram") )
+			{
+				const auto bounds = metric.value( QStringLiteral("bounds") ).toList();
+				const auto buckets = metric.value( QStringLiteral("buckets") ).toList();
+
+				for( int i = 0; i < buckets.size(); ++i )
+				{
+					const auto upperBound = i < bounds.size() ? bounds[i].toString() : QStringLiteral("+Inf");
+					family.samples.append( QStringLiteral("%1_bucket{%2,le=\"%3\"} %4").
+										   arg( name, processLabel, upperBound, buckets[i].toString() ) );
+				}
+
+				family.samples.append( QStringLiteral("%1_sum{%2} %3").
+									   arg( name, processLabel, metric.value( QStringLiteral("sum") ).toString() ) );
+				family.samples.append( QStringLiteral("%1_count{%2} %3").
+									   arg( name, processLabel, metric.value( QStringLiteral("count") ).toString() ) );
+			}
+			else
+			{
+				family.samples.append( QStringLiteral("%1{%2} %3").
+									   arg( name, processLabel, metric.value( QStringLiteral("value") ).toString() ) );
+			}
+		}
+	}
+
+	QString text;
+
+	for( const auto& family : families )
+	{
+		auto help = family.second.help;
+		help.replace( QLatin1Char('\\'), QStringLiteral("\\\\") ).replace( QLatin1Char('\n'), QStringLiteral("\\n") );
+
+		text += QStringLiteral("# HELP %1 %2\n").arg( family.first, help );
+		text += QStringLiteral("# TYPE %1 %2\n").arg( family.first, family.second.type );
+		text += family.second.samples.join( QLatin1Char('\n') ) + QLatin1Char('\n');
+	}
+
+	return text;
+}
+
+
+
+const MetricsRegistry::Histogram::Bounds& MetricsRegistry::latencyBounds()
+{
+	static const Histogram::Bounds bounds{ 1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000 };
+	return bounds;
+}
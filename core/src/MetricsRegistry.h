@@ -0,0 +1,163 @@
+/*
+ * MetricsRegistry.h - registry for lightweight performance metrics
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QMutex>
+#include <QPair>
+#include <QVariant>
+#include <QVector>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+#include "VeyonCore.h"
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+class VEYON_CORE_EXPORT MetricsRegistry
+{
+public:
+	// monotonically increasing value, e.g. number of bytes transferred
+	class Counter
+	{
+	public:
+		void increment( quint64 amount = 1 )
+		{
+			m_value.fetch_add( amount, std::memory_order_relaxed );
+		}
+
+		quint64 value() const
+		{
+			return m_value.load( std::memory_order_relaxed );
+		}
+
+	private:
+		std::atomic<quint64> m_value{0};
+
+	} ;
+
+	// value which can go up and down, e.g. queue depths
+	class Gauge
+	{
+	public:
+		void set( qint64 value )
+		{
+			m_value.store( value, std::memory_order_relaxed );
+		}
+
+		void add( qint64 amount )
+		{
+			m_value.fetch_add( amount, std::memory_order_relaxed );
+		}
+
+		qint64 value() const
+		{
+			return m_value.load( std::memory_order_relaxed );
+		}
+
+	private:
+		std::atomic<qint64> m_value{0};
+
+	} ;
+
+	// distribution of observed values across a fixed set of upper bucket bounds
+	class Histogram
+	{
+	public:
+		using Bounds = QVector<qint64>;
+
+		explicit Histogram( const Bounds& bounds );
+
+		void observe( qint64 value );
+
+		const Bounds& bounds() const
+		{
+			return m_bounds;
+		}
+
+		// cumulative bucket counts as exported, the last one corresponds to +Inf
+		QVector<quint64> cumulativeBucketCounts() const;
+
+		quint64 count() const
+		{
+			return m_count.load( std::memory_order_relaxed );
+		}
+
+		qint64 sum() const
+		{
+			return m_sum.load( std::memory_order_relaxed );
+		}
+
+	private:
+		const Bounds m_bounds;
+		std::unique_ptr<std::atomic<quint64>[]> m_buckets;
+		std::atomic<quint64> m_count{0};
+		std::atomic<qint64> m_sum{0};
+
+	} ;
+
+	// a snapshot of all metrics of one process along with the process name
+	using Snapshot = QPair<QString, QVariantList>;
+	using Snapshots = QVector<Snapshot>;
+
+	explicit MetricsRegistry( const QString& processName );
+	~MetricsRegistry() = default;
+
+	// returned references stay valid for the lifetime of the registry so callers
+	// should look up a metric once and update it without any further locking
+	Counter& counter( const QString& name, const QString& help );
+	Gauge& gauge( const QString& name, const QString& help );
+	Histogram& histogram( const QString& name, const QString& help, const Histogram::Bounds& bounds );
+
+	const QString& processName() const
+	{
+		return m_processName;
+	}
+
+	Snapshot snapshot() const;
+
+	QString toPrometheusText() const;
+	static QString toPrometheusText( const Snapshots& snapshots );
+
+	// bucket bounds in milliseconds suitable for latencies of network operations
+	static const Histogram::Bounds& latencyBounds();
+
+private:
+	template<class T>
+	struct Entry
+	{
+		QString help;
+		std::unique_ptr<T> metric;
+	};
+
+	const QString m_processName;
+
+	mutable QMutex m_mutex{};
+	std::map<QString, Entry<Counter>> m_counters{};
+	std::map<QString, Entry<Gauge>> m_gauges{};
+	std::map<QString, Entry<Histogram>> m_histograms{};
+
+} ;
@@ -0,0 +1,161 @@
+/*
+ * MetricsServer.cpp - implementation of MetricsServer class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "MetricsServer.h"
+
+
+MetricsServer::MetricsServer( const SnapshotProvider& snapshotProvider, QObject* parent ) :
+	QObject( parent ),
+	m_snapshotProvider( snapshotProvider ),
+	m_tcpServer( this )
+{
+	if( m_snapshotProvider == nullptr )
+	{
+		m_snapshotProvider = []() -> MetricsRegistry::Snapshots {
+			return { VeyonCore::metrics().snapshot() };
+		};
+	}
+
+	connect( &m_tcpServer, &QTcpServer::newConnection, this, &MetricsServer::acceptConnection );
+}
+
+
+
+bool MetricsServer::start( int port )
+{
+	// metrics are for local scraping agents only
+	if( m_tcpServer.listen( QHostAddress::LocalHost, static_cast<quint16>( port ) ) == false )
+	{
+		vWarning() << "can't listen on port" << port << m_tcpServer.errorString();
+		return false;
+	}
+
+	vDebug() << "exporting metrics on port" << port;
+
+	return true;
+}
+
+
+
+QString MetricsServer::fetch( int port, QString* errorString )
+{
+	QTcpSocket socket;
+	socket.connectToHost( QHostAddress::LocalHost, static_cast<quint16>( port ) );
+
+	if( socket.waitForConnected( RequestTimeout ) == false ||
+		socket.write( "GET /metrics HTTP/1.0\r\nHost: localhost\r\n\r\n" ) < 0 ||
+		socket.waitForBytesWritten( RequestTimeout ) == false )
+	{
+		if( errorString )
+		{
+			*errorString = socket.errorString();
+		}
+		return {};
+	}
+
+	// server closes the connection after the response
+	QByteArray response;
+	while( socket.state() == QTcpSocket::ConnectedState && socket.waitForReadyRead( RequestTimeout ) )
+	{
+		response += socket.readAll();
+	}
+	response += socket.readAll();
+
+	const auto headerEnd = response.indexOf( "\r\n\r\n" );
+	if( response.startsWith( "HTTP/1.0 200" ) == false || headerEnd < 0 )
+	{
+		if( errorString )
+		{
+			*errorString = response.isEmpty() ? socket.errorString() : QString::fromUtf8( response.left( response.indexOf( '\r' ) ) );
+		}
+		return {};
+	}
+
+	return QString::fromUtf8( response.mid( headerEnd + 4 ) );
+}
+
+
+
+void MetricsServer::acceptConnection()
+{
+	while( m_tcpServer.hasPendingConnections() )
+	{
+		auto socket = m_tcpServer.nextPendingConnection();
+
+		connect( socket, &QTcpSocket::readyRead, this, [=]() { processRequest( socket ); } );
+		connect( socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater );
+
+		// drop clients which never complete their request
+		QTimer::singleShot( RequestTimeout, socket, &QTcpSocket::close );
+	}
+}
+
+
+
+void MetricsServer::processRequest( QTcpSocket* socket )
+{
+	if( socket->bytesAvailable() > MaximumRequestSize )
+	{
+		sendResponse( socket, "413 Payload Too Large", {} );
+		return;
+	}
+
+	// wait until the complete request header has been received
+	const auto request = socket->peek( MaximumRequestSize );
+	if( request.contains( "\r\n\r\n" ) == false && request.contains( "\n\n" ) == false )
+	{
+		return;
+	}
+
+	socket->readAll();
+
+	const auto requestLine = request.left( request.indexOf( '\n' ) ).trimmed().split( ' ' );
+	if( requestLine.size() < 2 || requestLine[0] != "GET" )
+	{
+		sendResponse( socket, "405 Method Not Allowed", {} );
+	}
+	else if( requestLine[1] != "/" && requestLine[1] != "/metrics" )
+	{
+		sendResponse( socket, "404 Not Found", {} );
+	}
+	else
+	{
+		sendResponse( socket, "200 OK", MetricsRegistry::toPrometheusText( m_snapshotProvider() ).toUtf8() );
+	}
+}
+
+
+
+void MetricsServer::sendResponse( QTcpSocket* socket, const QByteArray& status, const QByteArray& body )
+{
+	socket->write( "HTTP/1.0 " + status + "\r\n"
+				   "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+				   "Content-Length: " + QByteArray::number( body.size() ) + "\r\n"
+				   "Connection: close\r\n"
+				   "\r\n" + body );
+	socket->disconnectFromHost();
+}
@@ -0,0 +1,61 @@
+/*
+ * MetricsServer.h - local HTTP endpoint exporting metrics in Prometheus text format
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QTcpServer>
+
+#include <functional>
+
+#include "MetricsRegistry.h"
+
+class QTcpSocket;
+
+class VEYON_CORE_EXPORT MetricsServer : public QObject
+{
+	Q_OBJECT
+public:
+	using SnapshotProvider = std::function<MetricsRegistry::Snapshots()>;
+
+	static constexpr int MaximumRequestSize = 8192;
+	static constexpr int RequestTimeout = 5000;
+
+	// serves snapshots of the local registry if no provider is given
+	explicit MetricsServer( const SnapshotProvider& snapshotProvider = {}, QObject* parent = nullptr );
+	~MetricsServer() override = default;
+
+	bool start( int port );
+
+	// blocking HTTP GET against a local metrics server as used by the CLI
+	static QString fetch( int port, QString* errorString = nullptr );
+
+private:
+	void acceptConnection();
+	void processRequest( QTcpSocket* socket );
+	void sendResponse( QTcpSocket* socket, const QByteArray& status, const QByteArray& body );
+
+	SnapshotProvider m_snapshotProvider;
+	QTcpServer m_tcpServer;
+
+} ;
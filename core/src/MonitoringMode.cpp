@@ -24,6 +24,8 @@
 
 #include <QtConcurrent>
 
+#include <algorithm>
+
 #include "MonitoringMode.h"
 #include "PlatformUserFunctions.h"
 #include "VeyonServerInterface.h"
@@ -42,15 +44,25 @@ MonitoringMode::MonitoringMode( QObject* parent ) :
 									Feature::Session | Feature::Service | Feature::Worker | Feature::Builtin,
 									Feature::Uid( "79a5e74d-50bd-4aab-8012-0e70dc08cc72" ),
 									Feature::Uid(), {}, {}, {} ),
-	m_features( { m_monitoringModeFeature, m_queryLoggedOnUserInfoFeature } )
+	m_features( { m_monitoringModeFeature, m_queryLoggedOnUserInfoFeature } ),
+	m_userInformationRefreshTimer( this )
 {
+	connect( &m_userInformationRefreshTimer, &QTimer::timeout, this, &MonitoringMode::queryUserInformation );
 }
 
 
 
 bool MonitoringMode::queryLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces )
 {
-	return sendFeatureMessage( FeatureMessage( m_queryLoggedOnUserInfoFeature.uid(), FeatureMessage::DefaultCommand ),
+	return sendFeatureMessage( FeatureMessage( m_queryLoggedOnUserInfoFeature.uid(), QueryUserInfo ),
+							   computerControlInterfaces, false );
+}
+
+
+
+bool MonitoringMode::subscribeLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	return sendFeatureMessage( FeatureMessage( m_queryLoggedOnUserInfoFeature.uid(), SubscribeUserInfo ),
 							   computerControlInterfaces, false );
 }
 
@@ -61,15 +73,44 @@ bool MonitoringMode::handleFeatureMessage( VeyonMasterInterface& master, const F
 {
 	Q_UNUSED(master)
 
-	if( message.featureUid() == m_queryLoggedOnUserInfoFeature.uid() )
+	if( message.featureUid() != m_queryLoggedOnUserInfoFeature.uid() )
 	{
-		computerControlInterface->setUserLoginName( message.argument( UserLoginName ).toString() );
-		computerControlInterface->setUserFullName( message.argument( UserFullName ).toString() );
+		return false;
+	}
+
+	const auto sequenceNumber = message.argument( SequenceNumber );
 
-		return true;
+	switch( message.command() )
+	{
+	case SubscribeUserInfo:
+		// servers without support for subscriptions reply with the plain user information
+		if( sequenceNumber.isValid() )
+		{
+			computerControlInterface->resetUpdateSequenceNumber( message.featureUid(), sequenceNumber.toUInt() );
+		}
+		else
+		{
+			computerControlInterface->setServerPushesUpdates( false );
+		}
+		break;
+
+	case UserInfoChanged:
+		if( computerControlInterface->advanceUpdateSequenceNumber( message.featureUid(), sequenceNumber.toUInt() ) == false )
+		{
+			// missed an update so resynchronize by subscribing again
+			subscribeLoggedOnUserInfo( { computerControlInterface } );
+			return true;
+		}
+		break;
+
+	default:
+		break;
 	}
 
-	return false;
+	computerControlInterface->setUserLoginName( message.argument( UserLoginName ).toString() );
+	computerControlInterface->setUserFullName( message.argument( UserFullName ).toString() );
+
+	return true;
 }
 
 
@@ -82,6 +123,27 @@ bool MonitoringMode::handleFeatureMessage( VeyonServerInterface& server,
 	{
 		FeatureMessage reply( message.featureUid(), message.command() );
 
+		if( message.command() == SubscribeUserInfo )
+		{
+			if( m_server == nullptr )
+			{
+				// detect changes of the session user and push them to all subscribers
+				m_server = &server;
+				m_userInformationRefreshTimer.start( UserInformationRefreshInterval );
+			}
+
+			const auto ioDevice = messageContext.ioDevice();
+			const auto isSubscribed = std::any_of( m_subscribers.begin(), m_subscribers.end(),
+												   [ioDevice]( const MessageContext& subscriber ) {
+				return subscriber.ioDevice() == ioDevice; } );
+			if( isSubscribed == false )
+			{
+				m_subscribers.append( messageContext );
+			}
+
+			reply.addArgument( SequenceNumber, m_sequenceNumber );
+		}
+
 		m_userDataLock.lockForRead();
 		if( m_userLoginName.isEmpty() )
 		{
@@ -112,8 +174,47 @@ void MonitoringMode::queryUserInformation()
 		const auto userLoginName = VeyonCore::platform().userFunctions().currentUser();
 		const auto userFullName = VeyonCore::platform().userFunctions().fullName( userLoginName );
 		m_userDataLock.lockForWrite();
+		const auto changed = userLoginName != m_userLoginName || userFullName != m_userFullName;
 		m_userLoginName = userLoginName;
 		m_userFullName = userFullName;
 		m_userDataLock.unlock();
+
+		if( changed )
+		{
+			QMetaObject::invokeMethod( this, "publishUserInformation", Qt::QueuedConnection );
+		}
 	} );
 }
+
+
+
+void MonitoringMode::publishUserInformation()
+{
+	if( m_server == nullptr )
+	{
+		return;
+	}
+
+	++m_sequenceNumber;
+
+	FeatureMessage message( m_queryLoggedOnUserInfoFeature.uid(), UserInfoChanged );
+	message.addArgument( SequenceNumber, m_sequenceNumber );
+
+	m_userDataLock.lockForRead();
+	message.addArgument( UserLoginName, m_userLoginName );
+	message.addArgument( UserFullName, m_userFullName );
+	m_userDataLock.unlock();
+
+	for( auto it = m_subscribers.begin(); it != m_subscribers.end(); )
+	{
+		if( it->ioDevice() )
+		{
+			m_server->sendFeatureMessageReply( *it, message );
+			++it;
+		}
+		else
+		{
+			it = m_subscribers.erase( it );
+		}
+	}
+}
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <QTimer>
+
 #include "SimpleFeatureProvider.h"
 
 class MonitoringMode : public QObject, SimpleFeatureProvider, PluginInterface
@@ -45,7 +47,7 @@ public:
 
 	QVersionNumber version() const override
 	{
-		return QVersionNumber( 1, 2 );
+		return QVersionNumber( 1, 3 );
 	}
 
 	QString name() const override
@@ -74,6 +76,7 @@ public:
 	}
 
 	bool queryLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces );
+	bool subscribeLoggedOnUserInfo( const ComputerControlInterfaceList& computerControlInterfaces );
 
 	bool handleFeatureMessage( VeyonMasterInterface& master, const FeatureMessage& message,
 							   ComputerControlInterface::Pointer computerControlInterface ) override;
@@ -85,19 +88,35 @@ public:
 
 private:
 	void queryUserInformation();
+	Q_INVOKABLE void publishUserInformation();
+
+	static constexpr int UserInformationRefreshInterval = 10000;
 
 	const Feature m_monitoringModeFeature;
 	const Feature m_queryLoggedOnUserInfoFeature;
 	const FeatureList m_features;
 
+	enum Commands
+	{
+		QueryUserInfo = FeatureMessage::DefaultCommand,
+		SubscribeUserInfo,
+		UserInfoChanged,
+	};
+
 	enum Arguments
 	{
 		UserLoginName,
 		UserFullName,
+		SequenceNumber,
 	};
 
 	QReadWriteLock m_userDataLock;
 	QString m_userLoginName;
 	QString m_userFullName;
 
+	VeyonServerInterface* m_server{nullptr};
+	QVector<MessageContext> m_subscribers;
+	QTimer m_userInformationRefreshTimer;
+	quint32 m_sequenceNumber{0};
+
 };
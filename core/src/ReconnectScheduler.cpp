@@ -0,0 +1,188 @@
+/*
+ * ReconnectScheduler.cpp - implementation of ReconnectScheduler class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "ReconnectScheduler.h"
+
+
+bool ReconnectScheduler::beginAttempt( const QString& host, const InterruptionCheck& isInterrupted )
+{
+	QMutexLocker locker( &m_mutex );
+
+	while( isInterrupted() == false )
+	{
+		const auto it = m_hosts.constFind( host );
+		const auto isNewHost = it == m_hosts.constEnd();
+
+		if( isNewHost == false && it->nextAttempt.hasExpired() == false )
+		{
+			m_condition.wait( &m_mutex, it->nextAttempt );
+		}
+		else if( occupiedSlots() >= MaximumAttemptsInFlight ||
+				 ( isNewHost == false && m_waitingNewHosts > 0 ) )
+		{
+			// hosts being retried have to wait as long as hosts without failures are waiting for a slot
+			if( isNewHost )
+			{
+				++m_waitingNewHosts;
+			}
+
+			m_condition.wait( &m_mutex, nextSlotRelease() );
+
+			if( isNewHost && --m_waitingNewHosts == 0 )
+			{
+				// let hosts being retried re-check whether they may proceed
+				m_condition.wakeAll();
+			}
+		}
+		else
+		{
+			m_attemptsInFlight.insert( host, QDeadlineTimer( SlotHoldTime ) );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+void ReconnectScheduler::finishAttempt( const QString& host, bool succeeded, bool failureReasonChanged )
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto attempt = m_attemptsInFlight.find( host );
+	if( attempt != m_attemptsInFlight.end() )
+	{
+		m_attemptsInFlight.erase( attempt );
+	}
+
+	if( succeeded )
+	{
+		m_hosts.remove( host );
+	}
+	else
+	{
+		auto& hostState = m_hosts[host];
+
+		// start over with short intervals if something happened (e.g. host is online but service not yet running)
+		if( failureReasonChanged )
+		{
+			hostState.failures = 0;
+		}
+
+		++hostState.failures;
+		hostState.nextAttempt.setRemainingTime( backoff( hostState.failures ) );
+	}
+
+	m_condition.wakeAll();
+}
+
+
+
+void ReconnectScheduler::interrupt()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_condition.wakeAll();
+}
+
+
+
+void ReconnectScheduler::wakeUp()
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_hosts.clear();
+
+	m_condition.wakeAll();
+}
+
+
+
+void ReconnectScheduler::resetBackoff( const QString& host )
+{
+	QMutexLocker locker( &m_mutex );
+
+	for( auto it = m_hosts.begin(); it != m_hosts.end(); )
+	{
+		if( it.key() == host || it.key().left( it.key().lastIndexOf( QLatin1Char(':') ) ) == host )
+		{
+			it = m_hosts.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	m_condition.wakeAll();
+}
+
+
+
+int ReconnectScheduler::backoff( int failures )
+{
+	const auto interval = qMin( MaximumBackoff, MinimumBackoff << qMin( failures - 1, 15 ) );
+
+	// spread attempts of hosts failing at the same time over half of the interval
+	return std::uniform_int_distribution<int>( interval / 2, interval )( m_randomGenerator );
+}
+
+
+
+int ReconnectScheduler::occupiedSlots()
+{
+	// attempts still running after the hold time most likely wait for the connect timeout
+	// of an offline host and therefore release their slot
+	for( auto it = m_attemptsInFlight.begin(); it != m_attemptsInFlight.end(); )
+	{
+		if( it->hasExpired() )
+		{
+			it = m_attemptsInFlight.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	return m_attemptsInFlight.size();
+}
+
+
+
+QDeadlineTimer ReconnectScheduler::nextSlotRelease() const
+{
+	QDeadlineTimer deadline( QDeadlineTimer::Forever );
+
+	for( const auto& slotRelease : m_attemptsInFlight )
+	{
+		if( slotRelease < deadline )
+		{
+			deadline = slotRelease;
+		}
+	}
+
+	return deadline;
+}
@@ -0,0 +1,87 @@
+/*
+ * ReconnectScheduler.h - declaration of ReconnectScheduler class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <random>
+
+#include "VeyonCore.h"
+
+// coordinates connection attempts of all VNC connections of this process by applying
+// a per-host exponential backoff with jitter and limiting the attempts in flight - hosts
+// which have not failed yet take precedence over hosts being retried and an attempt only
+// occupies a slot for a short time so offline hosts waiting for their connect timeout
+// can't starve the others
+class VEYON_CORE_EXPORT ReconnectScheduler
+{
+public:
+	using InterruptionCheck = std::function<bool()>;
+
+	ReconnectScheduler() = default;
+	~ReconnectScheduler() = default;
+
+	// blocks until an attempt to connect to the given host may be made - returns false
+	// if interrupted, otherwise finishAttempt() has to be called afterwards
+	bool beginAttempt( const QString& host, const InterruptionCheck& isInterrupted );
+	void finishAttempt( const QString& host, bool succeeded, bool failureReasonChanged );
+
+	// make waiting threads re-check their interruption condition
+	void interrupt();
+
+	// retry all hosts immediately, e.g. after the user requested a refresh
+	void wakeUp();
+
+	// retry given host immediately, e.g. after its network object changed - host may
+	// be specified with or without port
+	void resetBackoff( const QString& host );
+
+private:
+	static constexpr int MinimumBackoff = 1000;
+	static constexpr int MaximumBackoff = 30000;
+	static constexpr int MaximumAttemptsInFlight = 32;
+	static constexpr int SlotHoldTime = 1000;
+
+	int backoff( int failures );
+	int occupiedSlots();
+	QDeadlineTimer nextSlotRelease() const;
+
+	struct Host
+	{
+		int failures{0};
+		QDeadlineTimer nextAttempt{};
+	};
+
+	QMutex m_mutex{};
+	QWaitCondition m_condition{};
+	QHash<QString, Host> m_hosts{};
+	QMultiHash<QString, QDeadlineTimer> m_attemptsInFlight{};
+	int m_waitingNewHosts{0};
+	std::mt19937 m_randomGenerator{ std::random_device{}() };
+
+} ;
@@ -21,20 +21,13 @@
  *  USA.
  */
 
-#include <QApplication>
 #include <QDateTime>
-#include <QDir>
 #include <QFileInfo>
-#include <QMessageBox>
 #include <QMetaEnum>
 #include <QPainter>
 #include <QRegularExpression>
 
 #include "Screenshot.h"
-#include "VeyonConfiguration.h"
-#include "Computer.h"
-#include "ComputerControlInterface.h"
-#include "Filesystem.h"
 
 Screenshot::Screenshot( const QString &fileName, QObject* parent ) :
 	QObject( parent ),
@@ -48,49 +41,33 @@ Screenshot::Screenshot( const QString &fileName, QObject* parent ) :
 
 
 
-void Screenshot::take( const ComputerControlInterface::Pointer& computerControlInterface )
+QString Screenshot::constructFileName( const QString& user, const QString& hostAddress, QDate date, QTime time,
+									   const QString& fileExtension )
 {
-	auto userLogin = computerControlInterface->userLoginName();
-	if( userLogin.isEmpty() )
-	{
-		userLogin = tr( "unknown" );
-	}
-
-	const auto dir = VeyonCore::filesystem().expandPath( VeyonCore::config().screenshotDirectory() );
+	const auto userSimplified = VeyonCore::stripDomain( user ).toLower().remove(
+				QRegularExpression( QStringLiteral("[^a-z0-9.]") ) );
 
-	if( VeyonCore::filesystem().ensurePathExists( dir ) == false )
-	{
-		const auto msg = tr( "Could not take a screenshot as directory %1 doesn't exist and couldn't be created." ).arg( dir );
-		vCritical() << msg.toUtf8().constData();
-		if( qobject_cast<QApplication *>( QCoreApplication::instance() ) )
-		{
-			QMessageBox::critical( nullptr, tr( "Screenshot" ), msg );
-		}
-
-		return;
-	}
+	return QStringLiteral( "%1_%2_%3_%4.%5" ).arg( userSimplified,
+												   hostAddress,
+												   date.toString( Qt::ISODate ),
+												   time.toString( Qt::ISODate ),
+												   fileExtension ).
+			replace( QLatin1Char(':'), QLatin1Char('-') );
+}
 
-	// construct filename
-	m_fileName = dir + QDir::separator() + constructFileName( userLogin, computerControlInterface->computer().hostAddress() );
 
-	// construct caption
-	auto user = userLogin;
-	if( computerControlInterface->userFullName().isEmpty() == false )
-	{
-		user = QStringLiteral( "%1 (%2)" ).arg( userLogin, computerControlInterface->userFullName() );
-	}
 
-	const auto host = computerControlInterface->computer().hostAddress();
-	const auto date = QDate::currentDate().toString( Qt::ISODate );
-	const auto time = QTime::currentTime().toString( Qt::ISODate );
+QImage Screenshot::compose( const QImage& image, const QString& user, const QString& host,
+							const QString& date, const QString& time )
+{
+	// only use QImage-based painting here as screenshots are composed in worker threads
+	auto composedImage = image.convertToFormat( QImage::Format_RGB32 );
 
 	const auto caption = QStringLiteral( "%1@%2 %3 %4" ).arg( user, host, date, time );
 
-	m_image = computerControlInterface->screen();
-
-	QPixmap icon( QStringLiteral( ":/core/icon16.png" ) );
+	const QImage icon( QStringLiteral( ":/core/icon16.png" ) );
 
-	QPainter painter( &m_image );
+	QPainter painter( &composedImage );
 
 	auto font = painter.font();
 	font.setPointSize( ScreenshotLabelFontPointSize );
@@ -110,7 +87,7 @@ void Screenshot::take( const ComputerControlInterface::Pointer& computerControlI
 	const auto MARGIN = 14;
 	const auto PADDING = 7;
 	const QRect rect{ MARGIN,
-				m_image.height() - MARGIN - 2 * PADDING - captionHeight,
+				composedImage.height() - MARGIN - 2 * PADDING - captionHeight,
 				4 * PADDING + captionWidth + icon.width(),
 				2 * PADDING + captionHeight };
 	const auto iconX = rect.x() + PADDING + 1;
@@ -119,29 +96,17 @@ void Screenshot::take( const ComputerControlInterface::Pointer& computerControlI
 	const auto textY = rect.y() + PADDING + fontMetrics.ascent();
 
 	painter.fillRect( rect, QColor( 255, 255, 255, 160 ) );
-	painter.drawPixmap( iconX, iconY, icon );
+	painter.drawImage( iconX, iconY, icon );
 	painter.drawText( textX, textY, caption );
 
-	m_image.setText( metaDataKey( MetaData::User ), user );
-	m_image.setText( metaDataKey( MetaData::Host ), host );
-	m_image.setText( metaDataKey( MetaData::Date ), date );
-	m_image.setText( metaDataKey( MetaData::Time ), time );
-
-	m_image.save( m_fileName, "PNG", 50 );
-}
-
+	painter.end();
 
+	composedImage.setText( metaDataKey( MetaData::User ), user );
+	composedImage.setText( metaDataKey( MetaData::Host ), host );
+	composedImage.setText( metaDataKey( MetaData::Date ), date );
+	composedImage.setText( metaDataKey( MetaData::Time ), time );
 
-QString Screenshot::constructFileName( const QString& user, const QString& hostAddress, QDate date, QTime time )
-{
-	const auto userSimplified = VeyonCore::stripDomain( user ).toLower().remove(
-				QRegularExpression( QStringLiteral("[^a-z0-9.]") ) );
-
-	return QStringLiteral( "%1_%2_%3_%4.png" ).arg( userSimplified,
-													hostAddress,
-													date.toString( Qt::ISODate ),
-													time.toString( Qt::ISODate ) ).
-			replace( QLatin1Char(':'), QLatin1Char('-') );
+	return composedImage;
 }
 
 
@@ -46,8 +46,6 @@ public:
 
 	explicit Screenshot( const QString &fileName = {}, QObject* parent = nullptr );
 
-	void take( const ComputerControlInterface::Pointer& computerControlInterface );
-
 	bool isValid() const
 	{
 		return !fileName().isEmpty() && !image().isNull();
@@ -70,7 +68,11 @@ public:
 
 	static QString constructFileName( const QString& user, const QString& hostAddress,
 									  QDate date = QDate::currentDate(),
-									  QTime time = QTime::currentTime() );
+									  QTime time = QTime::currentTime(),
+									  const QString& fileExtension = QStringLiteral("png") );
+
+	static QImage compose( const QImage& image, const QString& user, const QString& host,
+						   const QString& date, const QString& time );
 
 	QString user() const;
 	QString host() const;
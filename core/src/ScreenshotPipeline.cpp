@@ -0,0 +1,255 @@
+/*
+ * ScreenshotPipeline.cpp - implementation of ScreenshotPipeline class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QApplication>
+#include <QDir>
+#include <QFutureWatcher>
+#include <QImageWriter>
+#include <QMessageBox>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include "Computer.h"
+#include "Filesystem.h"
+#include "Screenshot.h"
+#include "ScreenshotPipeline.h"
+#include "VeyonConfiguration.h"
+#include "VeyonConnection.h"
+#include "VncConnection.h"
+
+
+ScreenshotPipeline::ScreenshotPipeline( QObject* parent ) :
+	QObject( parent ),
+	m_directory( VeyonCore::filesystem().expandPath( VeyonCore::config().screenshotDirectory() ) ),
+	m_format( VeyonCore::config().screenshotFormat().toLower() )
+{
+	if( QImageWriter::supportedImageFormats().contains( m_format.toLatin1() ) == false )
+	{
+		vWarning() << "unsupported screenshot format" << m_format << "- falling back to PNG";
+		m_format = QStringLiteral("png");
+	}
+
+	m_threadPool.setMaxThreadCount( MaximumConcurrentEncodings );
+}
+
+
+
+ScreenshotPipeline::~ScreenshotPipeline()
+{
+	for( const auto& grab : qAsConst(m_grabs) )
+	{
+		delete grab.connection;
+		grab.vncConnection->stopAndDeleteLater();
+	}
+
+	m_threadPool.waitForDone();
+}
+
+
+
+void ScreenshotPipeline::take( const ComputerControlInterfaceList& computerControlInterfaces )
+{
+	if( VeyonCore::filesystem().ensurePathExists( m_directory ) == false )
+	{
+		const auto msg = Screenshot::tr( "Could not take a screenshot as directory %1 doesn't exist and couldn't be created." ).arg( m_directory );
+		vCritical() << msg.toUtf8().constData();
+		if( qobject_cast<QApplication *>( QCoreApplication::instance() ) )
+		{
+			QMessageBox::critical( nullptr, Screenshot::tr( "Screenshot" ), msg );
+		}
+
+		m_failedCount += computerControlInterfaces.count();
+	}
+	else
+	{
+		const auto date = QDate::currentDate();
+		const auto time = QTime::currentTime();
+
+		for( const auto& computerControlInterface : computerControlInterfaces )
+		{
+			auto userLogin = computerControlInterface->userLoginName();
+			if( userLogin.isEmpty() )
+			{
+				userLogin = Screenshot::tr( "unknown" );
+			}
+
+			auto user = userLogin;
+			if( computerControlInterface->userFullName().isEmpty() == false )
+			{
+				user = QStringLiteral( "%1 (%2)" ).arg( userLogin, computerControlInterface->userFullName() );
+			}
+
+			const auto host = computerControlInterface->computer().hostAddress();
+
+			m_pendingJobs.enqueue( { computerControlInterface,
+									 m_directory + QDir::separator() +
+									 Screenshot::constructFileName( userLogin, host, date, time, m_format ),
+									 user, host,
+									 date.toString( Qt::ISODate ), time.toString( Qt::ISODate ) } );
+		}
+	}
+
+	if( isFinished() )
+	{
+		// keep signal asynchronous for callers connecting after take()
+		QTimer::singleShot( 0, this, &ScreenshotPipeline::finished );
+		return;
+	}
+
+	startGrabs();
+}
+
+
+
+void ScreenshotPipeline::startGrabs()
+{
+	// bound number of concurrent lossless framebuffer transfers
+	while( m_pendingJobs.isEmpty() == false && m_grabs.size() < MaximumConcurrentGrabs )
+	{
+		grab( m_pendingJobs.dequeue() );
+	}
+}
+
+
+
+void ScreenshotPipeline::grab( const Job& job )
+{
+	const auto grabId = m_nextGrabId++;
+
+	auto vncConnection = new VncConnection;
+	vncConnection->setHost( job.computerControlInterface->computer().hostAddress() );
+	vncConnection->setQuality( VncConnection::Quality::Screenshot );
+
+	m_grabs[grabId] = { job, vncConnection, new VeyonConnection( vncConnection ) };
+
+	// the first complete update contains the full framebuffer
+	connect( vncConnection, &VncConnection::framebufferUpdateComplete, this,
+			 [=]() { finishGrab( grabId, true ); } );
+
+	connect( vncConnection, &VncConnection::stateChanged, this, [=]() {
+		if( m_grabs.contains( grabId ) &&
+			m_grabs[grabId].vncConnection->state() == VncConnection::State::AuthenticationFailed )
+		{
+			finishGrab( grabId, false );
+		}
+	} );
+
+	QTimer::singleShot( GrabTimeout, this, [=]() { finishGrab( grabId, false ); } );
+
+	vncConnection->start();
+}
+
+
+
+void ScreenshotPipeline::finishGrab( int grabId, bool frameReceived )
+{
+	if( m_grabs.contains( grabId ) == false )
+	{
+		// grab finished already
+		return;
+	}
+
+	const auto grab = m_grabs.take( grabId );
+
+	QImage image;
+	if( frameReceived )
+	{
+		// detach from framebuffer which is still being written by the connection thread
+		image = grab.vncConnection->image().copy();
+	}
+	else
+	{
+		vWarning() << "could not grab lossless frame from" << grab.job.host << "- using last received frame";
+		image = grab.job.computerControlInterface->screen();
+	}
+
+	delete grab.connection;
+	grab.vncConnection->stopAndDeleteLater();
+
+	if( image.isNull() )
+	{
+		++m_failedCount;
+		emit screenshotFailed( grab.job.host );
+		finishJob();
+	}
+	else
+	{
+		encode( grab.job, image );
+	}
+
+	startGrabs();
+}
+
+
+
+void ScreenshotPipeline::encode( const Job& job, const QImage& image )
+{
+	++m_activeEncodings;
+
+	// do not pass the interface pointer to the worker threads
+	const auto fileName = job.fileName;
+	const auto user = job.user;
+	const auto host = job.host;
+	const auto date = job.date;
+	const auto time = job.time;
+	const auto format = m_format.toLatin1();
+	const auto quality = m_format == QLatin1String("png") ? PngQuality : WebpQuality;
+
+	auto watcher = new QFutureWatcher<bool>( this );
+
+	connect( watcher, &QFutureWatcher<bool>::finished, this, [=]() {
+		--m_activeEncodings;
+
+		if( watcher->result() )
+		{
+			++m_savedCount;
+			emit screenshotSaved( fileName );
+		}
+		else
+		{
+			vCritical() << "could not save screenshot" << fileName;
+			++m_failedCount;
+			emit screenshotFailed( host );
+		}
+
+		watcher->deleteLater();
+
+		finishJob();
+	} );
+
+	watcher->setFuture( QtConcurrent::run( &m_threadPool, [=]() {
+		return Screenshot::compose( image, user, host, date, time ).
+				save( fileName, format.constData(), quality );
+	} ) );
+}
+
+
+
+void ScreenshotPipeline::finishJob()
+{
+	if( isFinished() )
+	{
+		emit finished();
+	}
+}
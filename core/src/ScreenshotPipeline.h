@@ -0,0 +1,109 @@
+/*
+ * ScreenshotPipeline.h - declaration of ScreenshotPipeline class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QQueue>
+#include <QThreadPool>
+
+#include "ComputerControlInterface.h"
+
+class VeyonConnection;
+class VncConnection;
+
+// takes screenshots asynchronously by grabbing a lossless frame through a dedicated
+// connection per computer and composing/encoding the images in a thread pool
+class VEYON_CORE_EXPORT ScreenshotPipeline : public QObject
+{
+	Q_OBJECT
+public:
+	explicit ScreenshotPipeline( QObject* parent = nullptr );
+	~ScreenshotPipeline() override;
+
+	void take( const ComputerControlInterfaceList& computerControlInterfaces );
+
+	bool isFinished() const
+	{
+		return m_pendingJobs.isEmpty() && m_grabs.isEmpty() && m_activeEncodings == 0;
+	}
+
+	int savedCount() const
+	{
+		return m_savedCount;
+	}
+
+	int failedCount() const
+	{
+		return m_failedCount;
+	}
+
+signals:
+	void screenshotSaved( const QString& fileName );
+	void screenshotFailed( const QString& host );
+	void finished();
+
+private:
+	static constexpr auto MaximumConcurrentGrabs = 8;
+	static constexpr auto MaximumConcurrentEncodings = 4;
+	static constexpr auto GrabTimeout = 10000;
+	static constexpr auto PngQuality = 50;
+	static constexpr auto WebpQuality = 100;
+
+	struct Job
+	{
+		ComputerControlInterface::Pointer computerControlInterface;
+		QString fileName;
+		QString user;
+		QString host;
+		QString date;
+		QString time;
+	};
+
+	struct Grab
+	{
+		Job job;
+		VncConnection* vncConnection{nullptr};
+		VeyonConnection* connection{nullptr};
+	};
+
+	void startGrabs();
+	void grab( const Job& job );
+	void finishGrab( int grabId, bool frameReceived );
+	void encode( const Job& job, const QImage& image );
+	void finishJob();
+
+	QString m_directory;
+	QString m_format;
+
+	QThreadPool m_threadPool;
+
+	QQueue<Job> m_pendingJobs;
+	QMap<int, Grab> m_grabs;
+	int m_nextGrabId{0};
+	int m_activeEncodings{0};
+
+	int m_savedCount{0};
+	int m_failedCount{0};
+
+} ;
@@ -26,7 +26,9 @@
 
 #include <QIODevice>
 
-class SocketDevice : public QIODevice
+#include "VeyonCore.h"
+
+class VEYON_CORE_EXPORT SocketDevice : public QIODevice
 {
 	Q_OBJECT
 public:
@@ -61,6 +63,17 @@ public:
 		m_user = user;
 	}
 
+	// identifies the remote end, e.g. for caching per-host authentication state
+	const QString& peerName() const
+	{
+		return m_peerName;
+	}
+
+	void setPeerName( const QString& peerName )
+	{
+		m_peerName = peerName;
+	}
+
 	qint64 read( char *buf, qint64 bytes ) // Flawfinder: ignore
 	{
 		return readData( buf, bytes );
@@ -87,5 +100,6 @@ protected:
 private:
 	Dispatcher m_dispatcher;
 	void * m_user;
+	QString m_peerName{};
 
 } ;
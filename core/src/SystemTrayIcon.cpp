@@ -155,3 +155,20 @@ bool SystemTrayIcon::handleFeatureMessage( VeyonWorkerInterface& worker, const F
 
 	return false;
 }
+
+
+
+bool SystemTrayIcon::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+{
+	Q_UNUSED(worker)
+
+	if( feature != m_systemTrayIconFeature )
+	{
+		return false;
+	}
+
+	delete m_systemTrayIcon;
+	m_systemTrayIcon = nullptr;
+
+	return true;
+}
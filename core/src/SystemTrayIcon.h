@@ -85,6 +85,18 @@ public:
 
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) override;
 
+	bool isWorkerHostable( const Feature& feature ) const override
+	{
+		return feature == m_systemTrayIconFeature;
+	}
+
+	bool isWorkerRestorable( const Feature& feature ) const override
+	{
+		return feature == m_systemTrayIconFeature;
+	}
+
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) override;
+
 private:
 	enum Commands
 	{
@@ -46,6 +46,16 @@ public:
 
 	QVariant read(); // Flawfinder: ignore
 
+	bool atEnd() const
+	{
+		return m_buffer.atEnd();
+	}
+
+	const QByteArray& data() const
+	{
+		return m_buffer.data();
+	}
+
 	VariantArrayMessage& write( const QVariant& v );
 
 	QIODevice* ioDevice() const
@@ -79,7 +79,8 @@ VeyonConnection::~VeyonConnection()
 
 
 
-void VeyonConnection::sendFeatureMessage( const FeatureMessage& featureMessage, bool wake )
+void VeyonConnection::sendFeatureMessage( const FeatureMessage& featureMessage, bool wake,
+										  const QByteArray& serializedMessage )
 {
 	if( m_vncConnection.isNull() )
 	{
@@ -87,7 +88,8 @@ void VeyonConnection::sendFeatureMessage( const FeatureMessage& featureMessage,
 		return;
 	}
 
-	m_vncConnection->enqueueEvent( new VncFeatureMessageEvent( featureMessage ), wake );
+	m_vncConnection->enqueueEvent( new VncFeatureMessageEvent( featureMessage, m_featureMessageFormat,
+															   serializedMessage ), wake );
 }
 
 
@@ -157,6 +159,8 @@ int8_t VeyonConnection::handleSecTypeVeyon( rfbClient* client, uint32_t authSche
 	}
 
 	SocketDevice socketDevice( VncConnection::libvncClientDispatcher, client );
+	socketDevice.setPeerName( QStringLiteral("%1:%2").arg( QString::fromUtf8( client->serverHost ) ).arg( client->serverPort ) );
+
 	VariantArrayMessage message( &socketDevice );
 	message.receive();
 
@@ -172,6 +176,11 @@ int8_t VeyonConnection::handleSecTypeVeyon( rfbClient* client, uint32_t authSche
 
 	vDebug() << QThread::currentThreadId() << "received authentication types:" << authTypes;
 
+	// servers supporting the compact feature message format announce it after the authentication types
+	const auto compactFormatVersion = message.atEnd() ? 0 : message.read().toInt();
+	connection->m_featureMessageFormat = compactFormatVersion > 0 ? FeatureMessage::Format::Compact
+																  : FeatureMessage::Format::VariantArray;
+
 	auto chosenAuthPlugin = Plugin::Uid();
 
 	const auto& plugins = VeyonCore::authenticationManager().plugins();
@@ -26,11 +26,10 @@
 
 #include <QPointer>
 
+#include "FeatureMessage.h"
 #include "VncConnection.h"
 
 
-class FeatureMessage;
-
 class VEYON_CORE_EXPORT VeyonConnection : public QObject
 {
 	Q_OBJECT
@@ -63,7 +62,13 @@ public:
 		return m_userHomeDir;
 	}
 
-	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake );
+	FeatureMessage::Format featureMessageFormat() const
+	{
+		return m_featureMessageFormat;
+	}
+
+	void sendFeatureMessage( const FeatureMessage& featureMessage, bool wake,
+							 const QByteArray& serializedMessage = {} );
 
 	bool handleServerMessage( rfbClient* client, uint8_t msg );
 
@@ -86,4 +91,6 @@ private:
 	QString m_user;
 	QString m_userHomeDir;
 
+	std::atomic<FeatureMessage::Format> m_featureMessageFormat{FeatureMessage::Format::VariantArray};
+
 } ;
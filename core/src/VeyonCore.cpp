@@ -43,12 +43,14 @@
 #include "Filesystem.h"
 #include "HostAddress.h"
 #include "Logger.h"
+#include "MetricsRegistry.h"
 #include "NetworkObjectDirectoryManager.h"
 #include "PlatformPluginManager.h"
 #include "PlatformCoreFunctions.h"
 #include "PlatformServiceCore.h"
 #include "PluginManager.h"
 #include "QmlCore.h"
+#include "ReconnectScheduler.h"
 #include "UserGroupsBackendManager.h"
 #include "VeyonConfiguration.h"
 #include "VncConnection.h"
@@ -62,6 +64,8 @@ VeyonCore::VeyonCore( QCoreApplication* application, Component component, const
 	m_filesystem( new Filesystem ),
 	m_config( nullptr ),
 	m_logger( nullptr ),
+	m_metrics( nullptr ),
+	m_reconnectScheduler( new ReconnectScheduler ),
 	m_authenticationCredentials( nullptr ),
 	m_authenticationManager( nullptr ),
 	m_cryptoCore( nullptr ),
@@ -88,6 +92,8 @@ VeyonCore::VeyonCore( QCoreApplication* application, Component component, const
 
 	initLogging( appComponentName );
 
+	initMetrics( appComponentName );
+
 	initLocaleAndTranslation();
 
 	initCryptoCore();
@@ -109,6 +115,19 @@ VeyonCore::VeyonCore( QCoreApplication* application, Component component, const
 
 VeyonCore::~VeyonCore()
 {
+	// connection threads keep using the metrics registry, reconnect scheduler and configuration
+	// until they finished, so tear them down before any of these objects is freed
+	delete m_localComputerControlInterface;
+	m_localComputerControlInterface = nullptr;
+
+	if( VncConnection::stopAllThreads() == false )
+	{
+		// freeing anything below would crash the hanging threads so rather leak
+		// everything as the process is about to exit anyway
+		vCritical() << "VNC connection threads did not finish in time - leaking core objects";
+		return;
+	}
+
 	delete m_userGroupsBackendManager;
 	m_userGroupsBackendManager = nullptr;
 
@@ -130,6 +149,12 @@ VeyonCore::~VeyonCore()
 	delete m_logger;
 	m_logger = nullptr;
 
+	delete m_metrics;
+	m_metrics = nullptr;
+
+	delete m_reconnectScheduler;
+	m_reconnectScheduler = nullptr;
+
 	delete m_config;
 	m_config = nullptr;
 
@@ -553,6 +578,14 @@ void VeyonCore::initLogging( const QString& appComponentName )
 
 
 
+void VeyonCore::initMetrics( const QString& appComponentName )
+{
+	m_metrics = new MetricsRegistry( hasSessionId() ? QStringLiteral("%1-%2").arg( appComponentName ).arg( sessionId() )
+													: appComponentName );
+}
+
+
+
 void VeyonCore::initLocaleAndTranslation()
 {
 	QLocale configuredLocale( QLocale::C );
@@ -29,6 +29,7 @@
 #include <QString>
 #include <QDebug>
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <type_traits>
@@ -53,11 +54,13 @@ class ComputerControlInterface;
 class CryptoCore;
 class Filesystem;
 class Logger;
+class MetricsRegistry;
 class NetworkObjectDirectoryManager;
 class PlatformPluginInterface;
 class PlatformPluginManager;
 class PluginManager;
 class QmlCore;
+class ReconnectScheduler;
 class UserGroupsBackendManager;
 class VeyonConfiguration;
 
@@ -163,6 +166,16 @@ public:
 		return *( instance()->m_filesystem );
 	}
 
+	static MetricsRegistry& metrics()
+	{
+		return *( instance()->m_metrics );
+	}
+
+	static ReconnectScheduler& reconnectScheduler()
+	{
+		return *( instance()->m_reconnectScheduler );
+	}
+
 	static ComputerControlInterface& localComputerControlInterface()
 	{
 		return *( instance()->m_localComputerControlInterface );
@@ -190,6 +203,7 @@ private:
 	void initPlatformPlugin();
 	void initConfiguration();
 	void initLogging( const QString& appComponentName );
+	void initMetrics( const QString& appComponentName );
 	void initLocaleAndTranslation();
 	void initCryptoCore();
 	void initQmlCore();
@@ -204,6 +218,8 @@ private:
 	Filesystem* m_filesystem;
 	VeyonConfiguration* m_config;
 	Logger* m_logger;
+	MetricsRegistry* m_metrics;
+	ReconnectScheduler* m_reconnectScheduler;
 	AuthenticationCredentials* m_authenticationCredentials;
 	AuthenticationManager* m_authenticationManager;
 	CryptoCore* m_cryptoCore;
@@ -25,6 +25,7 @@
 #pragma once
 
 class BuiltinFeatures;
+class FeatureManager;
 class FeatureMessage;
 class FeatureWorkerManager;
 class MessageContext;
@@ -36,6 +37,7 @@ class VeyonServerInterface
 public:
 	virtual ~VeyonServerInterface() = default;
 
+	virtual FeatureManager& featureManager() = 0;
 	virtual FeatureWorkerManager& featureWorkerManager() = 0;
 	virtual bool sendFeatureMessageReply( const MessageContext& context, const FeatureMessage& reply ) = 0;
 
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <QUuid>
+
 class BuiltinFeatures;
 class FeatureMessage;
 
@@ -36,4 +38,10 @@ public:
 
 	virtual bool sendFeatureMessageReply( const FeatureMessage& reply ) = 0;
 
+	/*!
+	 * \brief Ends the worker of given feature - quits a dedicated worker process or detaches the
+	 * feature from a worker host process
+	 */
+	virtual void stopFeatureWorker( const QUuid& featureUid ) = 0;
+
 };
@@ -33,13 +33,22 @@
 #include <QPixmap>
 #include <QTime>
 
+#include <algorithm>
+#include <numeric>
+
 #include "PlatformNetworkFunctions.h"
+#include "ReconnectScheduler.h"
 #include "VeyonConfiguration.h"
 #include "VncConnection.h"
 #include "SocketDevice.h"
 #include "VncEvents.h"
 
 
+QMutex VncConnection::s_connectionsMutex;
+QWaitCondition VncConnection::s_connectionThreadFinished;
+QSet<VncConnection *> VncConnection::s_connections;
+
+
 rfbBool VncConnection::hookInitFrameBuffer( rfbClient* client )
 {
 	auto connection = static_cast<VncConnection *>( clientData( client, VncConnectionTag ) );
@@ -59,6 +68,8 @@ void VncConnection::hookUpdateFB( rfbClient* client, int x, int y, int w, int h
 	auto connection = static_cast<VncConnection *>( clientData( client, VncConnectionTag ) );
 	if( connection )
 	{
+		connection->m_framebufferUpdateBytesCounter.increment( static_cast<quint64>( w ) * static_cast<quint64>( h ) * RfbBytesPerPixel );
+
 		emit connection->imageUpdated( x, y, w, h );
 	}
 }
@@ -163,8 +174,32 @@ void VncConnection::framebufferCleanup( void* framebuffer )
 
 
 VncConnection::VncConnection( QObject* parent ) :
-	QThread( parent )
-{
+	QThread( parent ),
+	m_connectDurationHistogram( VeyonCore::metrics().histogram( QStringLiteral("veyon_vnc_connection_connect_duration_ms"),
+																QStringLiteral("Time needed for establishing VNC connections including authentication"),
+																MetricsRegistry::latencyBounds() ) ),
+	m_connectFailuresCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_connection_connect_failures_total"),
+															QStringLiteral("Failed attempts to establish VNC connections") ) ),
+	m_framebufferUpdatesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_connection_framebuffer_updates_total"),
+															   QStringLiteral("Completed framebuffer updates received from VNC servers") ) ),
+	m_framebufferUpdateBytesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_connection_framebuffer_update_bytes_total"),
+																   QStringLiteral("Decoded framebuffer data received from VNC servers") ) ),
+	m_connectionsGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_vnc_connections"),
+													QStringLiteral("Currently established VNC connections") ) ),
+	m_eventQueueLatencyHistograms( {
+		&VeyonCore::metrics().histogram( QStringLiteral("veyon_vnc_connection_input_event_queue_latency_ms"),
+										 QStringLiteral("Time keyboard, pointer and clipboard events spent in the outgoing queue"),
+										 MetricsRegistry::latencyBounds() ),
+		&VeyonCore::metrics().histogram( QStringLiteral("veyon_vnc_connection_control_event_queue_latency_ms"),
+										 QStringLiteral("Time control messages spent in the outgoing queue"),
+										 MetricsRegistry::latencyBounds() ),
+		&VeyonCore::metrics().histogram( QStringLiteral("veyon_vnc_connection_bulk_event_queue_latency_ms"),
+										 QStringLiteral("Time bulk messages (e.g. file transfer data) spent in the outgoing queue"),
+										 MetricsRegistry::latencyBounds() ),
+		} )
+{
+	QMutexLocker locker( &s_connectionsMutex );
+	s_connections.insert( this );
 }
 
 
@@ -186,6 +221,16 @@ VncConnection::~VncConnection()
 		terminate();
 		wait();
 	}
+
+	s_connectionsMutex.lock();
+	s_connections.remove( this );
+	s_connectionsMutex.unlock();
+
+	// free events which have not been sent anymore
+	for( auto& queue : m_eventQueues )
+	{
+		qDeleteAll( queue );
+	}
 }
 
 
@@ -230,6 +275,55 @@ void VncConnection::stop()
 	setControlFlag( ControlFlag::TerminateThread, true );
 
 	m_updateIntervalSleeper.wakeAll();
+
+	// only a running thread can wait for the scheduler which furthermore is gone already
+	// when connections get stopped after VeyonCore has been destroyed
+	if( isRunning() )
+	{
+		VeyonCore::reconnectScheduler().interrupt();
+	}
+}
+
+
+
+bool VncConnection::stopAllThreads()
+{
+	QMutexLocker locker( &s_connectionsMutex );
+
+	// QThread::start() marks the thread running synchronously so this also covers threads
+	// which have not entered run() yet - they see the terminate flag and return immediately
+	const auto hasRunningThreads = []() {
+		for( auto connection : qAsConst(s_connections) )
+		{
+			if( connection->isRunning() && connection->m_runFinished == false )
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+
+	for( auto connection : qAsConst(s_connections) )
+	{
+		connection->setControlFlag( ControlFlag::TerminateThread, true );
+		connection->m_updateIntervalSleeper.wakeAll();
+	}
+
+	if( hasRunningThreads() == false )
+	{
+		return true;
+	}
+
+	VeyonCore::reconnectScheduler().interrupt();
+
+	QDeadlineTimer deadline( ThreadTerminationTimeout );
+
+	while( hasRunningThreads() &&
+		   s_connectionThreadFinished.wait( &s_connectionsMutex, deadline ) )
+	{
+	}
+
+	return hasRunningThreads() == false;
 }
 
 
@@ -379,28 +473,49 @@ void VncConnection::setClientData( int tag, void* data )
 
 void VncConnection::run()
 {
+	s_connectionsMutex.lock();
+	m_runFinished = false;
+	s_connectionsMutex.unlock();
+
 	while( isControlFlagSet( ControlFlag::TerminateThread ) == false )
 	{
 		establishConnection();
 		handleConnection();
 		closeConnection();
 	}
+
+	QMutexLocker locker( &s_connectionsMutex );
+	m_runFinished = true;
+	s_connectionThreadFinished.wakeAll();
 }
 
 
 
 void VncConnection::establishConnection()
 {
-	QMutex sleeperMutex;
+	auto& reconnectScheduler = VeyonCore::reconnectScheduler();
 
 	setState( State::Connecting );
 	setControlFlag( ControlFlag::RestartConnection, false );
 
 	m_framebufferState = FramebufferState::Invalid;
 
+	m_globalMutex.lock();
+	const auto schedulerHost = QStringLiteral("%1:%2").arg( m_host ).arg( m_port );
+	m_globalMutex.unlock();
+
+	auto previousFailureState = State::None;
+
 	while( isControlFlagSet( ControlFlag::TerminateThread ) == false &&
 		   state() != State::Connected ) // try to connect as long as the server allows
 	{
+		// wait for our turn as scheduled by the backoff of the host and the limit of attempts in flight
+		if( reconnectScheduler.beginAttempt( schedulerHost, [this]() {
+				return isControlFlagSet( ControlFlag::TerminateThread ); } ) == false )
+		{
+			break;
+		}
+
 		m_client = rfbGetClient( RfbBitsPerSample, RfbSamplesPerPixel, RfbBytesPerPixel );
 		m_client->MallocFrameBuffer = hookInitFrameBuffer;
 		m_client->canHandleNewFBSize = true;
@@ -432,9 +547,16 @@ void VncConnection::establishConnection()
 
 		setControlFlag( ControlFlag::ServerReachable, false );
 
+		QElapsedTimer connectTimer;
+		connectTimer.start();
+
 		if( rfbInitClient( m_client, nullptr, nullptr ) &&
 			isControlFlagSet( ControlFlag::TerminateThread ) == false )
 		{
+			reconnectScheduler.finishAttempt( schedulerHost, true, false );
+
+			m_connectDurationHistogram.observe( connectTimer.elapsed() );
+
 			m_framebufferUpdateWatchdog.restart();
 
 			emit connectionEstablished();
@@ -453,9 +575,12 @@ void VncConnection::establishConnection()
 			// do not sleep when already requested to stop
 			if( isControlFlagSet( ControlFlag::TerminateThread ) )
 			{
+				reconnectScheduler.finishAttempt( schedulerHost, false, false );
 				break;
 			}
 
+			m_connectFailuresCounter.increment();
+
 			// guess reason why connection failed
 			if( isControlFlagSet( ControlFlag::ServerReachable ) == false )
 			{
@@ -478,18 +603,10 @@ void VncConnection::establishConnection()
 				setState( State::ConnectionFailed );
 			}
 
-			// wait a bit until next connect
-			sleeperMutex.lock();
-			if( m_framebufferUpdateInterval > 0 )
-			{
-				m_updateIntervalSleeper.wait( &sleeperMutex, QDeadlineTimer( m_framebufferUpdateInterval ) );
-			}
-			else
-			{
-				// default: retry every second
-				m_updateIntervalSleeper.wait( &sleeperMutex, QDeadlineTimer( ConnectionRetryInterval ) );
-			}
-			sleeperMutex.unlock();
+			// the next attempt is delayed by the scheduler
+			reconnectScheduler.finishAttempt( schedulerHost, false,
+											  previousFailureState != State::None && state() != previousFailureState );
+			previousFailureState = state();
 		}
 	}
 }
@@ -507,7 +624,8 @@ void VncConnection::handleConnection()
 	{
 		loopTimer.start();
 
-		const int i = WaitForMessage( m_client, MessageWaitTimeout );
+		// do not block while bulk events are still waiting for the next iteration
+		const int i = WaitForMessage( m_client, isEventQueueEmpty() ? MessageWaitTimeout : 0 );
 		if( isControlFlagSet( ControlFlag::TerminateThread ) || i < 0 )
 		{
 			break;
@@ -544,6 +662,7 @@ void VncConnection::handleConnection()
 		}
 		else if( m_framebufferState == FramebufferState::Valid &&
 			remainingUpdateInterval > 0 &&
+			isEventQueueEmpty() &&
 			isControlFlagSet( ControlFlag::TerminateThread ) == false )
 		{
 			sleeperMutex.lock();
@@ -572,8 +691,18 @@ void VncConnection::closeConnection()
 
 void VncConnection::setState( State state )
 {
-	if( m_state.exchange( state ) != state )
+	const auto previousState = m_state.exchange( state );
+	if( previousState != state )
 	{
+		if( state == State::Connected )
+		{
+			m_connectionsGauge.add( 1 );
+		}
+		else if( previousState == State::Connected )
+		{
+			m_connectionsGauge.add( -1 );
+		}
+
 		emit stateChanged();
 	}
 }
@@ -671,6 +800,8 @@ void VncConnection::finishFrameBufferUpdate()
 	m_framebufferState = FramebufferState::Valid;
 	setControlFlag( ControlFlag::ScaledScreenNeedsUpdate, true );
 
+	m_framebufferUpdatesCounter.increment();
+
 	emit framebufferUpdateComplete();
 }
 
@@ -678,20 +809,30 @@ void VncConnection::finishFrameBufferUpdate()
 
 void VncConnection::sendEvents()
 {
+	// limit bulk data per iteration so incoming messages and newly queued input are not delayed for long
+	qint64 bulkBytes = 0;
+
 	m_eventQueueMutex.lock();
 
-	while( m_eventQueue.isEmpty() == false )
-	{
-		auto event = m_eventQueue.dequeue();
+	auto priority = VncEvent::Priority::Control;
 
+	while( auto event = takeNextEvent( bulkBytes < MaximumBulkBytesPerIteration, &priority ) )
+	{
 		// unlock the queue mutex during the runtime of ClientEvent::fire()
 		m_eventQueueMutex.unlock();
 
+		m_eventQueueLatencyHistograms[static_cast<size_t>( priority )]->observe( event->queueTimer().elapsed() );
+
 		if( isControlFlagSet( ControlFlag::TerminateThread ) == false )
 		{
 			event->fire( m_client );
 		}
 
+		if( priority == VncEvent::Priority::Bulk )
+		{
+			bulkBytes += event->size();
+		}
+
 		delete event;
 
 		// and lock it again
@@ -703,6 +844,24 @@ void VncConnection::sendEvents()
 
 
 
+VncEvent* VncConnection::takeNextEvent( bool includeBulk, VncEvent::Priority* priority )
+{
+	for( size_t i = 0; i < m_eventQueues.size(); ++i )
+	{
+		*priority = static_cast<VncEvent::Priority>( i );
+
+		if( m_eventQueues[i].isEmpty() == false &&
+			( includeBulk || *priority != VncEvent::Priority::Bulk ) )
+		{
+			return m_eventQueues[i].dequeue();
+		}
+	}
+
+	return nullptr;
+}
+
+
+
 void VncConnection::enqueueEvent( VncEvent* event, bool wake )
 {
 	if( state() != State::Connected )
@@ -710,8 +869,36 @@ void VncConnection::enqueueEvent( VncEvent* event, bool wake )
 		return;
 	}
 
+	event->queueTimer().start();
+
 	m_eventQueueMutex.lock();
-	m_eventQueue.enqueue( event );
+
+	auto queueIndex = static_cast<size_t>( event->priority() );
+
+	// never let an event overtake an event it depends on in a lower priority queue
+	for( auto i = m_eventQueues.size() - 1; i > queueIndex; --i )
+	{
+		const auto& queue = m_eventQueues[i];
+		if( std::any_of( queue.begin(), queue.end(), [event]( const VncEvent* queuedEvent ) {
+				return event->dependsOn( queuedEvent ); } ) )
+		{
+			queueIndex = i;
+			break;
+		}
+	}
+
+	auto& queue = m_eventQueues[queueIndex];
+
+	// coalesce consecutive events such as pointer movements
+	if( queue.isEmpty() == false && queue.last()->merge( event ) )
+	{
+		delete event;
+	}
+	else
+	{
+		queue.enqueue( event );
+	}
+
 	m_eventQueueMutex.unlock();
 
 	if( wake )
@@ -725,7 +912,17 @@ void VncConnection::enqueueEvent( VncEvent* event, bool wake )
 bool VncConnection::isEventQueueEmpty()
 {
 	QMutexLocker lock( &m_eventQueueMutex );
-	return m_eventQueue.isEmpty();
+	return std::all_of( m_eventQueues.begin(), m_eventQueues.end(),
+						[]( const QQueue<VncEvent *>& queue ) { return queue.isEmpty(); } );
+}
+
+
+
+int VncConnection::eventQueueSize()
+{
+	QMutexLocker lock( &m_eventQueueMutex );
+	return std::accumulate( m_eventQueues.begin(), m_eventQueues.end(), 0,
+							[]( int size, const QQueue<VncEvent *>& queue ) { return size + queue.size(); } );
 }
 
 
@@ -31,18 +31,21 @@
 #include <QImage>
 #include <QMutex>
 #include <QQueue>
+#include <QSet>
 #include <QReadWriteLock>
 #include <QThread>
 #include <QTimer>
 #include <QWaitCondition>
 
+#include <array>
+
+#include "MetricsRegistry.h"
 #include "VeyonCore.h"
 #include "SocketDevice.h"
+#include "VncEvents.h"
 
 using rfbClient = struct _rfbClient;
 
-class VncEvent;
-
 class VEYON_CORE_EXPORT VncConnection : public QThread
 {
 	Q_OBJECT
@@ -86,6 +89,10 @@ public:
 	void stop();
 	void stopAndDeleteLater();
 
+	// stops the threads of all connections and waits for them to finish as they
+	// access process-wide objects such as the metrics registry
+	static bool stopAllThreads();
+
 	void setHost( const QString& host );
 	void setPort( int port );
 
@@ -113,6 +120,7 @@ public:
 
 	void enqueueEvent( VncEvent* event, bool wake );
 	bool isEventQueueEmpty();
+	int eventQueueSize();
 
 	/** \brief Returns whether framebuffer data is valid, i.e. at least one full FB update received */
 	bool hasValidFrameBuffer() const
@@ -158,8 +166,8 @@ private:
 	// intervals and timeouts
 	static constexpr int ThreadTerminationTimeout = 30000;
 	static constexpr int ConnectTimeout = 5000;
-	static constexpr int ConnectionRetryInterval = 1000;
 	static constexpr int MessageWaitTimeout = 500;
+	static constexpr int MaximumBulkBytesPerIteration = 512*1024;
 	static constexpr int FastFramebufferUpdateInterval = 100;
 	static constexpr int FramebufferUpdateWatchdogTimeout = 10000;
 	static constexpr int SocketKeepaliveIdleTime = 1000;
@@ -192,6 +200,7 @@ private:
 	void finishFrameBufferUpdate();
 
 	void sendEvents();
+	VncEvent* takeNextEvent( bool includeBulk, VncEvent::Priority* priority );
 
 	// hooks for LibVNCClient
 	static int8_t hookInitFrameBuffer( rfbClient* client );
@@ -216,14 +225,22 @@ private:
 	int m_port{-1};
 
 	// thread and timing control
+	// connections are registered at creation so threads which have been started
+	// but did not enter run() yet are waited for by stopAllThreads() as well
+	static QMutex s_connectionsMutex;
+	static QWaitCondition s_connectionThreadFinished;
+	static QSet<VncConnection *> s_connections;
+	bool m_runFinished{false}; // guarded by s_connectionsMutex
+
 	QMutex m_globalMutex{};
 	QMutex m_eventQueueMutex{};
 	QWaitCondition m_updateIntervalSleeper{};
 	QAtomicInt m_framebufferUpdateInterval{0};
 	QElapsedTimer m_framebufferUpdateWatchdog{};
 
-	// queue for RFB and custom events
-	QQueue<VncEvent *> m_eventQueue{};
+	// queues for RFB and custom events per priority class
+	using EventQueues = std::array<QQueue<VncEvent *>, static_cast<size_t>( VncEvent::Priority::Count )>;
+	EventQueues m_eventQueues{};
 
 	// framebuffer data and thread synchronization objects
 	QImage m_image{};
@@ -231,4 +248,12 @@ private:
 	QSize m_scaledSize{};
 	QReadWriteLock m_imgLock{};
 
+	// metrics shared by all connections of this process
+	MetricsRegistry::Histogram& m_connectDurationHistogram;
+	MetricsRegistry::Counter& m_connectFailuresCounter;
+	MetricsRegistry::Counter& m_framebufferUpdatesCounter;
+	MetricsRegistry::Counter& m_framebufferUpdateBytesCounter;
+	MetricsRegistry::Gauge& m_connectionsGauge;
+	const std::array<MetricsRegistry::Histogram *, static_cast<size_t>( VncEvent::Priority::Count )> m_eventQueueLatencyHistograms;
+
 } ;
@@ -57,6 +57,22 @@ void VncPointerEvent::fire(rfbClient *client)
 
 
 
+bool VncPointerEvent::merge( const VncEvent* newerEvent )
+{
+	// only coalesce pure movements so no button press or release gets lost
+	const auto pointerEvent = dynamic_cast<const VncPointerEvent *>( newerEvent );
+	if( pointerEvent && pointerEvent->m_buttonMask == m_buttonMask )
+	{
+		m_x = pointerEvent->m_x;
+		m_y = pointerEvent->m_y;
+		return true;
+	}
+
+	return false;
+}
+
+
+
 VncClientCutEvent::VncClientCutEvent( const QString& text ) :
 	m_text( text.toUtf8() )
 {
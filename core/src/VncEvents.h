@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <QElapsedTimer>
 #include <QString>
 
 using rfbClient = struct _rfbClient;
@@ -33,9 +34,51 @@ using rfbClient = struct _rfbClient;
 class VncEvent
 {
 public:
+	// queued events of a higher priority class are always sent first
+	enum class Priority
+	{
+		Input,
+		Control,
+		Bulk,
+		Count
+	} ;
+
 	virtual ~VncEvent() = default;
 	virtual void fire( rfbClient* client ) = 0;
 
+	virtual Priority priority() const
+	{
+		return Priority::Control;
+	}
+
+	// number of bytes sent by fire() as far as known in advance
+	virtual qint64 size() const
+	{
+		return 0;
+	}
+
+	// take over the data of a newer event instead of queueing it separately
+	virtual bool merge( const VncEvent* newerEvent )
+	{
+		Q_UNUSED(newerEvent)
+		return false;
+	}
+
+	// whether this event must not be sent before the given queued event
+	virtual bool dependsOn( const VncEvent* queuedEvent ) const
+	{
+		Q_UNUSED(queuedEvent)
+		return false;
+	}
+
+	QElapsedTimer& queueTimer()
+	{
+		return m_queueTimer;
+	}
+
+private:
+	QElapsedTimer m_queueTimer;
+
 } ;
 
 
@@ -46,6 +89,11 @@ public:
 
 	void fire( rfbClient* client ) override;
 
+	Priority priority() const override
+	{
+		return Priority::Input;
+	}
+
 private:
 	unsigned int m_key;
 	bool m_pressed;
@@ -59,6 +107,13 @@ public:
 
 	void fire( rfbClient* client ) override;
 
+	Priority priority() const override
+	{
+		return Priority::Input;
+	}
+
+	bool merge( const VncEvent* newerEvent ) override;
+
 private:
 	int m_x;
 	int m_y;
@@ -73,6 +128,17 @@ public:
 
 	void fire( rfbClient* client ) override;
 
+	// clipboard updates have to arrive before the keystrokes pasting them
+	Priority priority() const override
+	{
+		return Priority::Input;
+	}
+
+	qint64 size() const override
+	{
+		return m_text.size();
+	}
+
 private:
 	QByteArray m_text;
 } ;
@@ -27,8 +27,15 @@
 #include "VncFeatureMessageEvent.h"
 
 
-VncFeatureMessageEvent::VncFeatureMessageEvent( const FeatureMessage& featureMessage ) :
-	m_featureMessage( featureMessage )
+VncFeatureMessageEvent::VncFeatureMessageEvent( const FeatureMessage& featureMessage,
+												FeatureMessage::Format format,
+												const QByteArray& serializedMessage ) :
+	// keep arguments of pre-serialized messages only inside the serialized data so we do not
+	// hold references to externally owned data (e.g. memory-mapped file chunks) until sending
+	m_featureMessage( serializedMessage.isEmpty() ? FeatureMessage( featureMessage ) :
+													FeatureMessage( featureMessage.featureUid(), featureMessage.command() ) ),
+	m_format( format ),
+	m_serializedMessage( serializedMessage )
 {
 }
 
@@ -44,5 +51,24 @@ void VncFeatureMessageEvent::fire( rfbClient* client )
 	const char messageType = FeatureMessage::RfbMessageType;
 	socketDevice.write( &messageType, sizeof(messageType) );
 
-	m_featureMessage.send( &socketDevice );
+	if( m_serializedMessage.isEmpty() )
+	{
+		m_featureMessage.send( &socketDevice, m_format );
+	}
+	else
+	{
+		socketDevice.write( m_serializedMessage.constData(), m_serializedMessage.size() );
+	}
+}
+
+
+
+bool VncFeatureMessageEvent::dependsOn( const VncEvent* queuedEvent ) const
+{
+	// messages of the same feature (e.g. a file transfer's finish command following
+	// its data chunks) have to be delivered in order
+	const auto featureMessageEvent = dynamic_cast<const VncFeatureMessageEvent *>( queuedEvent );
+
+	return featureMessageEvent &&
+			featureMessageEvent->m_featureMessage.featureUid() == m_featureMessage.featureUid();
 }
@@ -32,11 +32,29 @@
 class VncFeatureMessageEvent : public VncEvent
 {
 public:
-	explicit VncFeatureMessageEvent( const FeatureMessage& featureMessage );
+	VncFeatureMessageEvent( const FeatureMessage& featureMessage,
+							FeatureMessage::Format format,
+							const QByteArray& serializedMessage = {} );
 
 	void fire( rfbClient* client ) override;
 
+	Priority priority() const override
+	{
+		return m_serializedMessage.size() >= BulkMessageSize ? Priority::Bulk : Priority::Control;
+	}
+
+	qint64 size() const override
+	{
+		return m_serializedMessage.size();
+	}
+
+	bool dependsOn( const VncEvent* queuedEvent ) const override;
+
 private:
+	static constexpr int BulkMessageSize = 64*1024;
+
 	FeatureMessage m_featureMessage;
+	const FeatureMessage::Format m_format;
+	const QByteArray m_serializedMessage;
 
 } ;
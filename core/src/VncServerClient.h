@@ -25,6 +25,7 @@
 #pragma once
 
 #include <QElapsedTimer>
+#include <QFuture>
 
 #include "CryptoCore.h"
 #include "VncServerProtocol.h"
@@ -38,6 +39,7 @@ public:
 		Stage1,
 		Successful,
 		Failed,
+		Pending,	// waiting for the result of an asynchronous verification without further messages
 	} ;
 	Q_ENUM(AuthState)
 
@@ -147,6 +149,16 @@ public:
 		m_privateKey = privateKey;
 	}
 
+	const QFuture<bool>& pendingVerification() const
+	{
+		return m_pendingVerification;
+	}
+
+	void setPendingVerification( const QFuture<bool>& pendingVerification )
+	{
+		m_pendingVerification = pendingVerification;
+	}
+
 public slots:
 	void finishAccessControl()
 	{
@@ -166,6 +178,7 @@ private:
 	QString m_hostAddress;
 	QByteArray m_challenge;
 	CryptoCore::PrivateKey m_privateKey;
+	QFuture<bool> m_pendingVerification;
 
 } ;
 
@@ -54,6 +54,21 @@ public:
 
 	virtual Password configuredPassword() = 0;
 
+	/*!
+	 * \brief Returns the path of a Unix domain socket the VNC server additionally listens at
+	 *
+	 * Local connections through this socket avoid the TCP/IP stack. Plugins not supporting
+	 * Unix domain sockets return an empty string so that the server port is used instead.
+	 * The socket has to be located in a directory only accessible by the user running
+	 * Veyon Server (e.g. a root-owned directory with mode 0700). Veyon Server still
+	 * authenticates with the VNC server password on the socket, i.e. the password must
+	 * not be dropped for socket connections.
+	 */
+	virtual QString configuredServerSocketPath()
+	{
+		return {};
+	}
+
 } ;
 
 using VncServerPluginInterfaceList = QList<VncServerPluginInterface *>;
@@ -27,6 +27,7 @@
 #include <QHostAddress>
 #include <QTcpSocket>
 #include "AuthenticationCredentials.h"
+#include "FeatureMessage.h"
 #include "VariantArrayMessage.h"
 #include "VncServerClient.h"
 #include "VncServerProtocol.h"
@@ -190,6 +191,9 @@ bool VncServerProtocol::sendAuthenticationTypes()
 		message.write( authType );
 	}
 
+	// announce support for compact feature messages - older clients ignore trailing data
+	message.write( FeatureMessage::CompactFormatVersion );
+
 	return message.send();
 }
 
@@ -237,6 +241,12 @@ bool VncServerProtocol::receiveAuthenticationMessage()
 {
 	VariantArrayMessage message( m_socket );
 
+	// let the authentication plugin check whether a running verification has finished
+	if( m_client->authState() == VncServerClient::AuthState::Pending )
+	{
+		return processAuthentication( message );
+	}
+
 	if( message.isReadyForReceive() && message.receive() )
 	{
 		return processAuthentication( message );
@@ -9,6 +9,7 @@ Rectangle {
 
 	property var textColor
 	property var view
+	property size thumbnailSize
 	property bool isComputerItem: true
 	property bool selected: false
 	property var objectUid: uid
@@ -28,20 +29,28 @@ Rectangle {
 
 	color: selected ? themeColor : "transparent";
 
+	// the thumbnail itself is drawn by ComputerScreenGrid at the same position
+	Item {
+		id: thumbnail
+		x: (parent.width - width) / 2
+		y: 5
+		width: item.thumbnailSize.width
+		height: item.thumbnailSize.height
+		MouseArea {
+			anchors.fill: parent
+			onClicked: item.selected = !item.selected
+		}
+	}
+
 	ColumnLayout {
-		anchors.fill: parent
+		anchors.top: thumbnail.bottom
+		anchors.topMargin: 5
+		anchors.left: parent.left
+		anchors.right: parent.right
+		anchors.bottom: parent.bottom
 		//clip: true
 		id: computerItemLayout
 		spacing: 0
-		Image {
-			source: imageId;
-			Layout.alignment: Qt.AlignCenter
-			Layout.margins: 5
-			MouseArea {
-				anchors.fill: parent
-				onClicked: item.selected = !item.selected
-			}
-		}
 		Label {
 			id: label
 			text: display;
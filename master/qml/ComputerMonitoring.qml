@@ -63,6 +63,18 @@ Page {
 			delegate: ComputerDelegate {
 				view: computerMonitoringView
 				textColor: computerMonitoring.textColor
+				thumbnailSize: computerMonitoring.iconSize
+			}
+
+			ComputerScreenGrid {
+				// above the delegates (z: 1) so thumbnails are drawn on top of selection backgrounds
+				z: 2
+				width: computerMonitoringView.width
+				height: computerMonitoringView.contentHeight
+				model: computerMonitoring.model
+				cellWidth: computerMonitoringView.cellWidth
+				cellHeight: computerMonitoringView.cellHeight
+				tileSize: computerMonitoring.iconSize
 			}
 
 			Label {
@@ -159,16 +159,18 @@ void CheckableItemProxyModel::loadStates( const QJsonArray& data )
 
 	m_checkStates.clear();
 
+	QSet<QUuid> checkedUids;
+	checkedUids.reserve( data.size() );
+
 	for( const auto& item : data )
 	{
-		const QUuid uid = QUuid( item.toString() );
-		const auto indexList = match( index( 0, 0 ), m_uidRole, uid, 1, // clazy:exclude=inefficient-qlist
-									  Qt::MatchExactly | Qt::MatchRecursive );
-		if( indexList.isEmpty() == false &&
-				hasChildren( indexList.first() ) == false )
-		{
-			setData( indexList.first(), Qt::Checked, Qt::CheckStateRole );
-		}
+		checkedUids.insert( QUuid( item.toString() ) );
+	}
+
+	// restore all leaf states and derive parent states bottom-up in a single traversal
+	if( checkedUids.isEmpty() == false )
+	{
+		loadChildStates( {}, checkedUids );
 	}
 
 	endResetModel();
@@ -252,3 +254,57 @@ void CheckableItemProxyModel::setParentData( const QModelIndex& index, Qt::Check
 		setParentData( index.parent(), checkState );
 	}
 }
+
+
+
+Qt::CheckState CheckableItemProxyModel::loadChildStates( const QModelIndex& parent, const QSet<QUuid>& checkedUids )
+{
+	const auto childCount = rowCount( parent );
+
+	int checkedCount = 0;
+	int uncheckedCount = 0;
+
+	for( int i = 0; i < childCount; ++i )
+	{
+		const auto childIndex = index( i, 0, parent );
+		const auto childUuid = indexToUuid( childIndex );
+
+		Qt::CheckState checkState = Qt::Unchecked;
+
+		if( hasChildren( childIndex ) )
+		{
+			checkState = loadChildStates( childIndex, checkedUids );
+		}
+		else if( checkedUids.contains( childUuid ) )
+		{
+			checkState = Qt::Checked;
+		}
+
+		if( checkState != Qt::Unchecked )
+		{
+			m_checkStates[childUuid] = checkState;
+		}
+
+		// non-checkable items are reported as unchecked and therefore have to be counted as such
+		if( flags( childIndex ).testFlag( Qt::ItemIsUserCheckable ) == false || checkState == Qt::Unchecked )
+		{
+			++uncheckedCount;
+		}
+		else if( checkState == Qt::Checked )
+		{
+			++checkedCount;
+		}
+	}
+
+	if( childCount == 0 || uncheckedCount == childCount )
+	{
+		return Qt::Unchecked;
+	}
+
+	if( checkedCount == childCount )
+	{
+		return Qt::Checked;
+	}
+
+	return Qt::PartiallyChecked;
+}
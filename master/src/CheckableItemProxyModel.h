@@ -26,6 +26,7 @@
 
 #include <QJsonArray>
 #include <QIdentityProxyModel>
+#include <QSet>
 #include <QUuid>
 
 class CheckableItemProxyModel : public QIdentityProxyModel
@@ -52,6 +53,7 @@ private:
 	QUuid indexToUuid( const QModelIndex& index ) const;
 	bool setChildData( const QModelIndex &index, Qt::CheckState checkState );
 	void setParentData( const QModelIndex &index, Qt::CheckState checkState );
+	Qt::CheckState loadChildStates( const QModelIndex& parent, const QSet<QUuid>& checkedUids );
 
 	int m_uidRole{-1};
 	int m_exceptionRole{-1};
@@ -406,7 +406,28 @@ QImage ComputerControlListModel::computerDecorationRole( const ComputerControlIn
 		break;
 	}
 
-	return image.scaled( controlInterface->scaledScreenSize(), Qt::KeepAspectRatio );
+	return scaledIcon( image, controlInterface->scaledScreenSize() );
+}
+
+
+
+QImage ComputerControlListModel::scaledIcon( const QImage& icon, const QSize& size ) const
+{
+	// icons are the same for many computers, so scale them once per size and return implicitly
+	// shared copies which also allows views to recognize them by their cache key
+	if( size != m_scaledIconsSize )
+	{
+		m_scaledIcons.clear();
+		m_scaledIconsSize = size;
+	}
+
+	auto it = m_scaledIcons.find( icon.cacheKey() );
+	if( it == m_scaledIcons.end() )
+	{
+		it = m_scaledIcons.insert( icon.cacheKey(), icon.scaled( size, Qt::KeepAspectRatio ) );
+	}
+
+	return *it;
 }
 
 
@@ -83,6 +83,7 @@ private:
 	void loadIcons();
 	QImage prepareIcon( const QImage& icon );
 	QImage computerDecorationRole( const ComputerControlInterface::Pointer& controlInterface ) const;
+	QImage scaledIcon( const QImage& icon, const QSize& size ) const;
 	QString computerToolTipRole( const ComputerControlInterface::Pointer& controlInterface ) const;
 	QString computerDisplayRole( const ComputerControlInterface::Pointer& controlInterface ) const;
 	QString computerSortRole( const ComputerControlInterface::Pointer& controlInterface ) const;
@@ -97,6 +98,9 @@ private:
 	QImage m_iconConnectionProblem{};
 	QImage m_iconDemoMode{};
 
+	mutable QSize m_scaledIconsSize{};
+	mutable QHash<qint64, QImage> m_scaledIcons{};
+
 	ComputerControlInterfaceList m_computerControlInterfaces{};
 
 };
@@ -36,6 +36,7 @@
 #include "NetworkObjectFilterProxyModel.h"
 #include "NetworkObjectOverlayDataModel.h"
 #include "NetworkObjectTreeModel.h"
+#include "ReconnectScheduler.h"
 #include "UserConfig.h"
 
 
@@ -206,6 +207,17 @@ void ComputerManager::initLocations()
 
 void ComputerManager::initNetworkObjectLayer()
 {
+	// e.g. an updated address or a computer brought back online should be tried right away
+	connect( m_networkObjectDirectory, &NetworkObjectDirectory::objectChanged, this,
+			 [this]( const NetworkObject& parent, int index ) {
+				 const auto& objects = m_networkObjectDirectory->objects( parent );
+				 if( index >= 0 && index < objects.size() &&
+					 objects[index].type() == NetworkObject::Type::Host )
+				 {
+					 VeyonCore::reconnectScheduler().resetBackoff( objects[index].hostAddress() );
+				 }
+			 } );
+
 	m_networkObjectDirectory->update();
 	m_networkObjectDirectory->setUpdateInterval( VeyonCore::config().networkObjectDirectoryUpdateInterval() );
 	m_networkObjectOverlayDataModel->setSourceModel( m_networkObjectModel );
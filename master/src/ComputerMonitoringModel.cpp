@@ -30,7 +30,7 @@
 #endif
 
 
-ComputerMonitoringModel::ComputerMonitoringModel( ComputerControlListModel* sourceModel, QObject* parent ) :
+ComputerMonitoringModel::ComputerMonitoringModel( QAbstractItemModel* sourceModel, QObject* parent ) :
 	QSortFilterProxyModel( parent )
 {
 #if defined(QT_TESTLIB_LIB) && QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
@@ -38,6 +38,8 @@ ComputerMonitoringModel::ComputerMonitoringModel( ComputerControlListModel* sour
 #endif
 
 	setSourceModel( sourceModel );
+
+	connect( sourceModel, &QAbstractItemModel::modelReset, this, [this]() { m_rowGroups.clear(); } );
 	setFilterCaseSensitivity( Qt::CaseInsensitive );
 	setSortRole( Qt::InitialSortOrderRole );
 	setStateRole( ComputerControlListModel::StateRole );
@@ -49,36 +51,46 @@ ComputerMonitoringModel::ComputerMonitoringModel( ComputerControlListModel* sour
 
 void ComputerMonitoringModel::setStateRole( int role )
 {
-	beginResetModel();
-	m_stateRole = role;
-	endResetModel();
+	if( m_stateRole != role )
+	{
+		m_stateRole = role;
+		invalidateFilter();
+	}
 }
 
 
 
 void ComputerMonitoringModel::setGroupsRole( int role )
 {
-	beginResetModel();
-	m_groupsRole = role;
-	endResetModel();
+	if( m_groupsRole != role )
+	{
+		m_groupsRole = role;
+		m_rowGroups.clear();
+		invalidateFilter();
+	}
 }
 
 
 
 void ComputerMonitoringModel::setStateFilter( ComputerControlInterface::State state )
 {
-	beginResetModel();
-	m_stateFilter = state;
-	endResetModel();
+	if( m_stateFilter != state )
+	{
+		m_stateFilter = state;
+		invalidateFilter();
+	}
 }
 
 
 
 void ComputerMonitoringModel::setGroupsFilter( const QStringList& groups )
 {
-	beginResetModel();
-	m_groupsFilter = groups.toSet();
-	endResetModel();
+	auto groupsFilter = groups.toSet();
+	if( groupsFilter != m_groupsFilter )
+	{
+		m_groupsFilter.swap( groupsFilter );
+		invalidateFilter();
+	}
 }
 
 
@@ -94,12 +106,32 @@ bool ComputerMonitoringModel::filterAcceptsRow( int sourceRow, const QModelIndex
 	}
 
 	if( m_groupsRole >= 0 &&
-		groupsFilter().isEmpty() == false &&
-		sourceModel()->data( sourceModel()->index( sourceRow, 0, sourceParent ),
-							 m_groupsRole ).toStringList().toSet().intersects( groupsFilter() ) == false )
+		m_groupsFilter.isEmpty() == false &&
+		rowGroups( sourceRow, sourceModel()->data( sourceModel()->index( sourceRow, 0, sourceParent ),
+												   m_groupsRole ).toStringList() ).intersects( m_groupsFilter ) == false )
 	{
 		return false;
 	}
 
 	return QSortFilterProxyModel::filterAcceptsRow( sourceRow, sourceParent );
 }
+
+
+
+const QSet<QString>& ComputerMonitoringModel::rowGroups( int sourceRow, const QStringList& groups ) const
+{
+	if( sourceRow >= m_rowGroups.size() )
+	{
+		m_rowGroups.resize( qMax( sourceRow + 1, sourceModel()->rowCount() ) );
+	}
+
+	// rows may have been moved or the groups of a computer may have changed since the set has been built
+	auto& rowGroups = m_rowGroups[sourceRow];
+	if( rowGroups.groups != groups )
+	{
+		rowGroups.groups = groups;
+		rowGroups.groupSet = groups.toSet();
+	}
+
+	return rowGroups.groupSet;
+}
@@ -25,16 +25,15 @@
 #pragma once
 
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 #include "ComputerControlInterface.h"
 
-class ComputerControlListModel;
-
 class ComputerMonitoringModel : public QSortFilterProxyModel
 {
 	Q_OBJECT
 public:
-	explicit ComputerMonitoringModel( ComputerControlListModel* sourceModel, QObject* parent );
+	explicit ComputerMonitoringModel( QAbstractItemModel* sourceModel, QObject* parent );
 
 	int stateRole() const
 	{
@@ -68,9 +67,20 @@ protected:
 	bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const override;
 
 private:
+	// group sets of the source rows, each valid as long as the source still returns the group
+	// list it has been built from (comparing implicitly shared lists is cheap)
+	struct RowGroups
+	{
+		QStringList groups;
+		QSet<QString> groupSet;
+	};
+
+	const QSet<QString>& rowGroups( int sourceRow, const QStringList& groups ) const;
+
 	int m_stateRole{-1};
 	int m_groupsRole{-1};
 	ComputerControlInterface::State m_stateFilter{ComputerControlInterface::State::None};
 	QSet<QString> m_groupsFilter;
+	mutable QVector<RowGroups> m_rowGroups;
 
 };
@@ -0,0 +1,995 @@
+/*
+ * ComputerScreenGridItem.cpp - renders all computer thumbnails of a grid from shared texture atlases
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QAbstractItemModel>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSGRenderNode>
+#include <QSGRendererInterface>
+
+#ifndef QT_NO_OPENGL
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QSGGeometryNode>
+#include <QSGTextureMaterial>
+#endif
+
+#include "ComputerScreenGridItem.h"
+
+
+// root node of the grid holding one container node per row so that a single row can be updated
+// without touching the nodes of all other rows
+class ComputerScreenGridNode : public QSGNode
+{
+public:
+	virtual void uploadTile( QQuickWindow* window, qint64 key, int page, const QImage& pageImage,
+							 const QRect& slotRect, const QRect& tileRect ) = 0;
+	virtual void releaseTile( qint64 key ) = 0;
+	virtual void releasePage( int page ) = 0;
+	virtual void updateRow( QQuickWindow* window, int row, qint64 key, int page,
+							const QRect& source, const QRectF& target ) = 0;
+
+	virtual int rowCount() const
+	{
+		return m_rows.size();
+	}
+
+	virtual void setRowCount( int count )
+	{
+		while( m_rows.size() > count )
+		{
+			delete m_rows.takeLast();
+		}
+
+		while( m_rows.size() < count )
+		{
+			auto rowNode = new QSGNode;
+			appendChildNode( rowNode );
+			m_rows.append( rowNode );
+		}
+	}
+
+	virtual void clearRow( int row )
+	{
+		delete m_rows[row]->firstChild();
+	}
+
+protected:
+	QSGNode* rowNode( int row ) const
+	{
+		return m_rows[row];
+	}
+
+private:
+	QVector<QSGNode *> m_rows;
+
+} ;
+
+
+
+// fallback for scene graph backends other than OpenGL and software - each tile gets a small texture
+// of its own which only is created when the tile changes, and each thumbnail is drawn through an image node
+class ComputerScreenImageGridNode : public ComputerScreenGridNode
+{
+public:
+	~ComputerScreenImageGridNode() override
+	{
+		qDeleteAll( m_textures );
+	}
+
+	void uploadTile( QQuickWindow* window, qint64 key, int page, const QImage& pageImage,
+					 const QRect& slotRect, const QRect& tileRect ) override
+	{
+		Q_UNUSED(page)
+		Q_UNUSED(slotRect)
+
+		auto& texture = m_textures[key];
+		delete texture;
+		texture = window->createTextureFromImage( pageImage.copy( tileRect ) );
+	}
+
+	void releaseTile( qint64 key ) override
+	{
+		delete m_textures.take( key );
+	}
+
+	void releasePage( int page ) override
+	{
+		Q_UNUSED(page)
+	}
+
+	void updateRow( QQuickWindow* window, int row, qint64 key, int page,
+					const QRect& source, const QRectF& target ) override
+	{
+		Q_UNUSED(page)
+
+		const auto texture = m_textures.value( key );
+		if( texture == nullptr )
+		{
+			clearRow( row );
+			return;
+		}
+
+		auto imageNode = static_cast<QSGImageNode *>( rowNode( row )->firstChild() );
+		if( imageNode == nullptr )
+		{
+			imageNode = window->createImageNode();
+			imageNode->setFiltering( QSGTexture::Linear );
+			rowNode( row )->appendChildNode( imageNode );
+		}
+
+		imageNode->setTexture( texture );
+		imageNode->setSourceRect( QRectF( QPointF( 0, 0 ), source.size() ) );
+		imageNode->setRect( target );
+	}
+
+private:
+	QHash<qint64, QSGTexture *> m_textures;
+
+} ;
+
+
+
+// draws all thumbnails of an atlas page with the painter of the software renderer
+class ComputerScreenPageNode : public QSGRenderNode
+{
+public:
+	ComputerScreenPageNode( QQuickWindow* window, const QSize& size, QImage::Format format ) :
+		m_window( window ),
+		m_image( size, format )
+	{
+		m_image.fill( Qt::transparent );
+	}
+
+	// repaint the slot of a changed tile only instead of creating a new texture for the whole page
+	void updateSlot( const QImage& pageImage, const QRect& slotRect )
+	{
+		QPainter painter( &m_image );
+		painter.setCompositionMode( QPainter::CompositionMode_Source );
+		painter.drawImage( slotRect.topLeft(), pageImage, slotRect );
+		painter.end();
+
+		markDirty( QSGNode::DirtyMaterial );
+	}
+
+	void setThumbnail( int row, const QRect& source, const QRectF& target )
+	{
+		m_thumbnails[row] = { source, target };
+		updateBoundingRect();
+	}
+
+	void removeThumbnail( int row )
+	{
+		if( m_thumbnails.remove( row ) > 0 )
+		{
+			updateBoundingRect();
+		}
+	}
+
+	bool isEmpty() const
+	{
+		return m_thumbnails.isEmpty();
+	}
+
+	void render( const RenderState* state ) override
+	{
+		auto painter = static_cast<QPainter *>( m_window->rendererInterface()->
+												getResource( m_window, QSGRendererInterface::PainterResource ) );
+		if( painter == nullptr )
+		{
+			return;
+		}
+
+		// the clip region has to be set before the transformation
+		const auto clipRegion = state->clipRegion();
+		if( clipRegion && clipRegion->isEmpty() == false )
+		{
+			painter->setClipRegion( *clipRegion, Qt::ReplaceClip );
+		}
+
+		painter->setTransform( matrix()->toTransform() );
+		painter->setOpacity( inheritedOpacity() );
+
+		for( const auto& thumbnail : qAsConst(m_thumbnails) )
+		{
+			painter->drawImage( thumbnail.target, m_image, thumbnail.source );
+		}
+	}
+
+	StateFlags changedStates() const override
+	{
+		return {};
+	}
+
+	RenderingFlags flags() const override
+	{
+		return BoundedRectRendering;
+	}
+
+	QRectF rect() const override
+	{
+		return m_boundingRect;
+	}
+
+private:
+	struct Thumbnail
+	{
+		QRect source;
+		QRectF target;
+	};
+
+	void updateBoundingRect()
+	{
+		m_boundingRect = {};
+
+		for( const auto& thumbnail : qAsConst(m_thumbnails) )
+		{
+			m_boundingRect |= thumbnail.target;
+		}
+
+		markDirty( QSGNode::DirtyGeometry );
+	}
+
+	QQuickWindow* m_window;
+	QImage m_image;
+	QHash<int, Thumbnail> m_thumbnails;
+	QRectF m_boundingRect;
+
+} ;
+
+
+
+// keeps one image per atlas page which is updated in place when tiles change - all thumbnails
+// of a page are drawn by a single node so the number of nodes only depends on the number of pages
+class ComputerScreenSoftwareGridNode : public ComputerScreenGridNode
+{
+public:
+	int rowCount() const override
+	{
+		return m_rowPages.size();
+	}
+
+	void setRowCount( int count ) override
+	{
+		for( int row = count; row < m_rowPages.size(); ++row )
+		{
+			clearRow( row );
+		}
+
+		const auto previousCount = m_rowPages.size();
+
+		m_rowPages.resize( count );
+
+		for( int row = previousCount; row < count; ++row )
+		{
+			m_rowPages[row] = -1;
+		}
+	}
+
+	void clearRow( int row ) override
+	{
+		const auto pageNode = m_pageNodes.value( m_rowPages[row] );
+		if( pageNode )
+		{
+			pageNode->removeThumbnail( row );
+		}
+
+		m_rowPages[row] = -1;
+	}
+
+	void uploadTile( QQuickWindow* window, qint64 key, int page, const QImage& pageImage,
+					 const QRect& slotRect, const QRect& tileRect ) override
+	{
+		Q_UNUSED(key)
+		Q_UNUSED(tileRect)
+
+		auto& pageNode = m_pageNodes[page];
+		if( pageNode == nullptr )
+		{
+			pageNode = new ComputerScreenPageNode( window, pageImage.size(), pageImage.format() );
+			appendChildNode( pageNode );
+		}
+
+		pageNode->updateSlot( pageImage, slotRect );
+	}
+
+	void releaseTile( qint64 key ) override
+	{
+		Q_UNUSED(key)
+	}
+
+	void releasePage( int page ) override
+	{
+		delete m_pageNodes.take( page );
+	}
+
+	void updateRow( QQuickWindow* window, int row, qint64 key, int page,
+					const QRect& source, const QRectF& target ) override
+	{
+		Q_UNUSED(window)
+		Q_UNUSED(key)
+
+		if( m_rowPages[row] != page )
+		{
+			clearRow( row );
+		}
+
+		const auto pageNode = m_pageNodes.value( page );
+		if( pageNode )
+		{
+			pageNode->setThumbnail( row, source, target );
+			m_rowPages[row] = page;
+		}
+	}
+
+private:
+	QHash<int, ComputerScreenPageNode *> m_pageNodes;
+	QVector<int> m_rowPages;
+
+} ;
+
+
+
+#ifndef QT_NO_OPENGL
+class ComputerScreenAtlasTexture : public QSGTexture
+{
+public:
+	explicit ComputerScreenAtlasTexture( const QSize& size ) :
+		m_size( size )
+	{
+	}
+
+	~ComputerScreenAtlasTexture() override
+	{
+		if( m_textureId && QOpenGLContext::currentContext() )
+		{
+			QOpenGLContext::currentContext()->functions()->glDeleteTextures( 1, &m_textureId );
+		}
+	}
+
+	int textureId() const override
+	{
+		return static_cast<int>( m_textureId );
+	}
+
+	QSize textureSize() const override
+	{
+		return m_size;
+	}
+
+	bool hasAlphaChannel() const override
+	{
+		return true;
+	}
+
+	bool hasMipmaps() const override
+	{
+		return false;
+	}
+
+	void bind() override
+	{
+		QOpenGLContext::currentContext()->functions()->glBindTexture( GL_TEXTURE_2D, m_textureId );
+		updateBindOptions();
+	}
+
+	// has to be called while synchronizing the scene graph, i.e. with the context of the render thread being current
+	void upload( const QImage& page, const QRect& rect )
+	{
+		auto gl = QOpenGLContext::currentContext()->functions();
+
+		if( m_textureId == 0 )
+		{
+			gl->glGenTextures( 1, &m_textureId );
+			gl->glBindTexture( GL_TEXTURE_2D, m_textureId );
+			gl->glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, m_size.width(), m_size.height(), 0,
+							  GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+			updateBindOptions( true );
+		}
+		else
+		{
+			gl->glBindTexture( GL_TEXTURE_2D, m_textureId );
+		}
+
+		const auto tile = page.copy( rect ).convertToFormat( QImage::Format_RGBA8888_Premultiplied );
+		gl->glTexSubImage2D( GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+							 GL_RGBA, GL_UNSIGNED_BYTE, tile.constBits() );
+	}
+
+private:
+	QSize m_size;
+	GLuint m_textureId{0};
+
+} ;
+
+
+
+// uploads changed tiles only into one texture per atlas page - all thumbnails of a page use the same
+// texture so the renderer still batches them into a single draw call
+class ComputerScreenOpenGLGridNode : public ComputerScreenGridNode
+{
+public:
+	explicit ComputerScreenOpenGLGridNode( const QSize& pageSize ) :
+		m_pageSize( pageSize )
+	{
+	}
+
+	~ComputerScreenOpenGLGridNode() override
+	{
+		qDeleteAll( m_textures );
+	}
+
+	void uploadTile( QQuickWindow* window, qint64 key, int page, const QImage& pageImage,
+					 const QRect& slotRect, const QRect& tileRect ) override
+	{
+		Q_UNUSED(window)
+		Q_UNUSED(key)
+		Q_UNUSED(tileRect)
+
+		pageTexture( page )->upload( pageImage, slotRect );
+	}
+
+	void releaseTile( qint64 key ) override
+	{
+		Q_UNUSED(key)
+	}
+
+	void releasePage( int page ) override
+	{
+		delete m_textures.take( page );
+	}
+
+	void updateRow( QQuickWindow* window, int row, qint64 key, int page,
+					const QRect& source, const QRectF& target ) override
+	{
+		Q_UNUSED(window)
+		Q_UNUSED(key)
+
+		auto geometryNode = static_cast<QSGGeometryNode *>( rowNode( row )->firstChild() );
+		if( geometryNode == nullptr )
+		{
+			auto material = new QSGTextureMaterial;
+			material->setFiltering( QSGTexture::Linear );
+
+			geometryNode = new QSGGeometryNode;
+			geometryNode->setGeometry( new QSGGeometry( QSGGeometry::defaultAttributes_TexturedPoint2D(), 4 ) );
+			geometryNode->setMaterial( material );
+			geometryNode->setFlags( QSGNode::OwnsGeometry | QSGNode::OwnsMaterial );
+
+			rowNode( row )->appendChildNode( geometryNode );
+		}
+
+		static_cast<QSGTextureMaterial *>( geometryNode->material() )->setTexture( pageTexture( page ) );
+
+		const QSizeF pageSize( m_pageSize );
+		QSGGeometry::updateTexturedRectGeometry( geometryNode->geometry(), target,
+												 QRectF( source.x() / pageSize.width(), source.y() / pageSize.height(),
+														 source.width() / pageSize.width(), source.height() / pageSize.height() ) );
+
+		geometryNode->markDirty( QSGNode::DirtyGeometry | QSGNode::DirtyMaterial );
+	}
+
+private:
+	ComputerScreenAtlasTexture* pageTexture( int page )
+	{
+		auto& texture = m_textures[page];
+		if( texture == nullptr )
+		{
+			texture = new ComputerScreenAtlasTexture( m_pageSize );
+		}
+
+		return texture;
+	}
+
+	QSize m_pageSize;
+	QHash<int, ComputerScreenAtlasTexture *> m_textures;
+
+} ;
+#endif
+
+
+
+ComputerScreenGridItem::ComputerScreenGridItem( QQuickItem* parent ) :
+	QQuickItem( parent )
+{
+	setFlag( ItemHasContents, true );
+}
+
+
+
+void ComputerScreenGridItem::setModel( QAbstractItemModel* model )
+{
+	if( m_model == model )
+	{
+		return;
+	}
+
+	if( m_model )
+	{
+		m_model->disconnect( this );
+	}
+
+	m_model = model;
+
+	if( m_model )
+	{
+		connect( m_model, &QAbstractItemModel::dataChanged, this,
+				 [this]( const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles ) {
+			if( roles.isEmpty() || roles.contains( Qt::DecorationRole ) )
+			{
+				updateRows( topLeft.row(), bottomRight.row() );
+			}
+		} );
+
+		connect( m_model, &QAbstractItemModel::rowsInserted, this, &ComputerScreenGridItem::syncRows );
+		connect( m_model, &QAbstractItemModel::rowsRemoved, this, &ComputerScreenGridItem::syncRows );
+		connect( m_model, &QAbstractItemModel::rowsMoved, this, &ComputerScreenGridItem::syncRows );
+		connect( m_model, &QAbstractItemModel::layoutChanged, this, &ComputerScreenGridItem::syncRows );
+		connect( m_model, &QAbstractItemModel::modelReset, this, &ComputerScreenGridItem::syncRows );
+	}
+
+	syncRows();
+
+	emit modelChanged();
+}
+
+
+
+void ComputerScreenGridItem::setCellWidth( qreal width )
+{
+	if( qFuzzyCompare( m_cellWidth, width ) == false && width > 0 )
+	{
+		m_cellWidth = width;
+		invalidateGeometry();
+
+		emit cellWidthChanged();
+	}
+}
+
+
+
+void ComputerScreenGridItem::setCellHeight( qreal height )
+{
+	if( qFuzzyCompare( m_cellHeight, height ) == false && height > 0 )
+	{
+		m_cellHeight = height;
+		invalidateGeometry();
+
+		emit cellHeightChanged();
+	}
+}
+
+
+
+void ComputerScreenGridItem::setTileSize( const QSize& size )
+{
+	if( m_tileSize != size )
+	{
+		m_tileSize = size;
+		resetAtlas();
+
+		emit tileSizeChanged();
+	}
+}
+
+
+
+void ComputerScreenGridItem::geometryChanged( const QRectF& newGeometry, const QRectF& oldGeometry )
+{
+	// number of columns depends on the width
+	if( qFuzzyCompare( newGeometry.width(), oldGeometry.width() ) == false )
+	{
+		invalidateGeometry();
+	}
+
+	QQuickItem::geometryChanged( newGeometry, oldGeometry );
+}
+
+
+
+QSGNode* ComputerScreenGridItem::updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data )
+{
+	Q_UNUSED(data)
+
+	auto gridNode = static_cast<ComputerScreenGridNode *>( oldNode );
+
+	// all tiles have been invalidated, so discard all textures
+	if( m_atlasReset )
+	{
+		delete gridNode;
+		gridNode = nullptr;
+		m_atlasReset = false;
+	}
+
+	if( gridNode == nullptr )
+	{
+		gridNode = createGridNode();
+
+		// a new node (e.g. after the scene graph has been invalidated) has no textures yet
+		for( auto it = m_tiles.constBegin(), end = m_tiles.constEnd(); it != end; ++it )
+		{
+			m_dirtyTiles.insert( it.key() );
+		}
+		m_releasedTiles.clear();
+		m_releasedPages.clear();
+		m_geometryDirty = true;
+	}
+
+	for( const auto key : qAsConst(m_dirtyTiles) )
+	{
+		const auto& tile = m_tiles[key];
+		const auto& page = m_pages[tile.page];
+
+		gridNode->uploadTile( window(), key, tile.page, page.image,
+							  QRect( tile.position, slotSize() ).intersected( page.image.rect() ),
+							  QRect( tile.position, tile.size ) );
+	}
+
+	if( m_geometryDirty )
+	{
+		gridNode->setRowCount( m_rowImages.size() );
+
+		for( int row = 0; row < m_rowImages.size(); ++row )
+		{
+			updateRowNode( gridNode, row );
+		}
+	}
+	else
+	{
+		for( const auto row : qAsConst(m_dirtyRows) )
+		{
+			if( row < gridNode->rowCount() )
+			{
+				updateRowNode( gridNode, row );
+			}
+		}
+	}
+
+	// all rows which showed released tiles have been updated above, so no node refers to them anymore
+	for( const auto key : qAsConst(m_releasedTiles) )
+	{
+		gridNode->releaseTile( key );
+	}
+
+	for( const auto page : qAsConst(m_releasedPages) )
+	{
+		gridNode->releasePage( page );
+	}
+
+	m_dirtyTiles.clear();
+	m_dirtyRows.clear();
+	m_releasedTiles.clear();
+	m_releasedPages.clear();
+	m_geometryDirty = false;
+
+	return gridNode;
+}
+
+
+
+void ComputerScreenGridItem::resetAtlas()
+{
+	m_tiles.clear();
+	m_pages.clear();
+	m_rowImages.clear();
+	m_dirtyRows.clear();
+	m_dirtyTiles.clear();
+	m_releasedTiles.clear();
+	m_releasedPages.clear();
+
+	m_atlasReset = true;
+
+	syncRows();
+}
+
+
+
+void ComputerScreenGridItem::syncRows()
+{
+	const auto rowCount = m_model ? m_model->rowCount() : 0;
+
+	QVector<qint64> rowImages;
+	rowImages.reserve( rowCount );
+
+	// acquire tiles for the new row set before releasing the previous ones
+	// so that unchanged images are neither released nor uploaded again
+	for( int row = 0; row < rowCount; ++row )
+	{
+		rowImages.append( acquireTile( imageOfRow( row ) ) );
+	}
+
+	for( const auto key : qAsConst(m_rowImages) )
+	{
+		releaseTile( key );
+	}
+
+	m_rowImages = rowImages;
+
+	invalidateGeometry();
+}
+
+
+
+void ComputerScreenGridItem::updateRows( int first, int last )
+{
+	last = qMin( last, m_rowImages.size() - 1 );
+
+	bool changed = false;
+
+	for( int row = qMax( 0, first ); row <= last; ++row )
+	{
+		const auto image = imageOfRow( row );
+		const auto previousKey = m_rowImages[row];
+
+		if( image.cacheKey() == previousKey )
+		{
+			continue;
+		}
+
+		m_rowImages[row] = acquireTile( image );
+		releaseTile( previousKey );
+
+		// only the node of this row has to be updated
+		m_dirtyRows.insert( row );
+		changed = true;
+	}
+
+	if( changed )
+	{
+		update();
+	}
+}
+
+
+
+void ComputerScreenGridItem::updateRowNode( ComputerScreenGridNode* gridNode, int row ) const
+{
+	const auto it = m_tiles.constFind( m_rowImages[row] );
+	if( it == m_tiles.constEnd() )
+	{
+		gridNode->clearRow( row );
+		return;
+	}
+
+	gridNode->updateRow( window(), row, it.key(), it->page, QRect( it->position, it->size ), tileRect( row, *it ) );
+}
+
+
+
+QImage ComputerScreenGridItem::imageOfRow( int row ) const
+{
+	return m_model->data( m_model->index( row, 0 ), Qt::DecorationRole ).value<QImage>();
+}
+
+
+
+QRectF ComputerScreenGridItem::tileRect( int row, const Tile& tile ) const
+{
+	// lay out tiles the same way as GridView in its default flow
+	const auto columns = qMax( 1, int( width() / m_cellWidth ) );
+	const QSizeF tileSize( m_tileSize );
+
+	const QPointF cell( ( row % columns ) * m_cellWidth, ( row / columns ) * m_cellHeight );
+	const QPointF thumbnail( cell.x() + ( m_cellWidth - tileSize.width() ) / 2, cell.y() + ThumbnailMargin );
+
+	return { thumbnail.x() + ( tileSize.width() - tile.size.width() ) / 2,
+			 thumbnail.y() + ( tileSize.height() - tile.size.height() ) / 2,
+			 qreal( tile.size.width() ), qreal( tile.size.height() ) };
+}
+
+
+
+qint64 ComputerScreenGridItem::acquireTile( const QImage& image )
+{
+	if( image.isNull() || m_tileSize.isEmpty() )
+	{
+		return 0;
+	}
+
+	const auto key = image.cacheKey();
+
+	auto it = m_tiles.find( key );
+	if( it != m_tiles.end() )
+	{
+		++it->refCount;
+		return key;
+	}
+
+	Tile tile{ 0, {}, {}, 1 };
+	allocateSlot( tile.page, tile.position );
+
+	auto tileImage = image;
+	if( image.width() > m_tileSize.width() || image.height() > m_tileSize.height() )
+	{
+		tileImage = image.scaled( m_tileSize, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+	}
+
+	tile.size = tileImage.size();
+
+	// clear the whole slot including padding so that filtering at the edges does not pick up remains
+	// of a previous tile, and only mark this tile for uploading
+	auto& page = m_pages[tile.page];
+	const QRect slotRect( tile.position, m_tileSize + QSize( TilePadding, TilePadding ) );
+
+	QPainter painter( &page.image );
+	painter.setCompositionMode( QPainter::CompositionMode_Source );
+	painter.fillRect( slotRect, Qt::transparent );
+	painter.drawImage( tile.position, tileImage );
+	painter.end();
+
+	++page.tileCount;
+
+	m_tiles.insert( key, tile );
+	m_dirtyTiles.insert( key );
+	m_releasedTiles.remove( key );
+
+	return key;
+}
+
+
+
+void ComputerScreenGridItem::releaseTile( qint64 key )
+{
+	auto it = m_tiles.find( key );
+	if( it == m_tiles.end() )
+	{
+		return;
+	}
+
+	if( --it->refCount <= 0 )
+	{
+		const auto pageIndex = it->page;
+		m_pages[pageIndex].freeSlots.append( it->position );
+		m_tiles.erase( it );
+
+		m_dirtyTiles.remove( key );
+		m_releasedTiles.insert( key );
+
+		if( --m_pages[pageIndex].tileCount <= 0 )
+		{
+			releasePage( pageIndex );
+		}
+	}
+}
+
+
+
+void ComputerScreenGridItem::allocateSlot( int& pageIndex, QPoint& position )
+{
+	const auto capacity = slotCapacity();
+	int releasedPageIndex = -1;
+
+	for( pageIndex = 0; pageIndex < m_pages.size(); ++pageIndex )
+	{
+		auto& page = m_pages[pageIndex];
+
+		if( page.image.isNull() )
+		{
+			if( releasedPageIndex < 0 )
+			{
+				releasedPageIndex = pageIndex;
+			}
+			continue;
+		}
+
+		if( page.freeSlots.isEmpty() == false )
+		{
+			position = page.freeSlots.takeLast();
+			return;
+		}
+
+		if( page.nextSlot < capacity )
+		{
+			position = slotPosition( page.nextSlot++ );
+			return;
+		}
+	}
+
+	Page page{ QImage( pageSize(), QImage::Format_ARGB32_Premultiplied ), {}, 1, 0 };
+	page.image.fill( Qt::transparent );
+
+	// reuse the index of a released page before adding a new one
+	if( releasedPageIndex >= 0 )
+	{
+		pageIndex = releasedPageIndex;
+		m_pages[pageIndex] = page;
+		m_releasedPages.remove( pageIndex );
+	}
+	else
+	{
+		m_pages.append( page );
+	}
+
+	position = slotPosition( 0 );
+}
+
+
+
+void ComputerScreenGridItem::releasePage( int pageIndex )
+{
+	// free the page image and let the scene graph delete the texture of the page
+	m_pages[pageIndex] = Page{ {}, {}, 0, 0 };
+
+	m_releasedPages.insert( pageIndex );
+}
+
+
+
+QSize ComputerScreenGridItem::slotSize() const
+{
+	return m_tileSize + QSize( TilePadding, TilePadding );
+}
+
+
+
+QPoint ComputerScreenGridItem::slotPosition( int slot ) const
+{
+	const auto columns = pageSize().width() / slotSize().width();
+
+	return { ( slot % columns ) * slotSize().width(), ( slot / columns ) * slotSize().height() };
+}
+
+
+
+QSize ComputerScreenGridItem::pageSize() const
+{
+	return { qMax( int(AtlasPageSize), slotSize().width() ), qMax( int(AtlasPageSize), slotSize().height() ) };
+}
+
+
+
+int ComputerScreenGridItem::slotCapacity() const
+{
+	return ( pageSize().width() / slotSize().width() ) * ( pageSize().height() / slotSize().height() );
+}
+
+
+
+ComputerScreenGridNode* ComputerScreenGridItem::createGridNode() const
+{
+#ifndef QT_NO_OPENGL
+	if( window()->rendererInterface()->graphicsApi() == QSGRendererInterface::OpenGL &&
+		QOpenGLContext::currentContext() )
+	{
+		return new ComputerScreenOpenGLGridNode( pageSize() );
+	}
+#endif
+
+	if( window()->rendererInterface()->graphicsApi() == QSGRendererInterface::Software )
+	{
+		return new ComputerScreenSoftwareGridNode;
+	}
+
+	return new ComputerScreenImageGridNode;
+}
+
+
+
+void ComputerScreenGridItem::invalidateGeometry()
+{
+	m_geometryDirty = true;
+
+	update();
+}
@@ -0,0 +1,148 @@
+/*
+ * ComputerScreenGridItem.h - renders all computer thumbnails of a grid from shared texture atlases
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QPointer>
+#include <QQuickItem>
+#include <QSet>
+
+class QAbstractItemModel;
+class ComputerScreenGridNode;
+
+class ComputerScreenGridItem : public QQuickItem
+{
+	Q_OBJECT
+	Q_PROPERTY(QAbstractItemModel* model READ model WRITE setModel NOTIFY modelChanged)
+	Q_PROPERTY(qreal cellWidth READ cellWidth WRITE setCellWidth NOTIFY cellWidthChanged)
+	Q_PROPERTY(qreal cellHeight READ cellHeight WRITE setCellHeight NOTIFY cellHeightChanged)
+	Q_PROPERTY(QSize tileSize READ tileSize WRITE setTileSize NOTIFY tileSizeChanged)
+public:
+	// vertical offset of thumbnails inside a grid cell - has to match ComputerDelegate.qml
+	static constexpr int ThumbnailMargin = 5;
+
+	explicit ComputerScreenGridItem( QQuickItem* parent = nullptr );
+	~ComputerScreenGridItem() override = default;
+
+	QAbstractItemModel* model() const
+	{
+		return m_model;
+	}
+
+	void setModel( QAbstractItemModel* model );
+
+	qreal cellWidth() const
+	{
+		return m_cellWidth;
+	}
+
+	void setCellWidth( qreal width );
+
+	qreal cellHeight() const
+	{
+		return m_cellHeight;
+	}
+
+	void setCellHeight( qreal height );
+
+	const QSize& tileSize() const
+	{
+		return m_tileSize;
+	}
+
+	void setTileSize( const QSize& size );
+
+protected:
+	void geometryChanged( const QRectF& newGeometry, const QRectF& oldGeometry ) override;
+	QSGNode* updatePaintNode( QSGNode* oldNode, UpdatePaintNodeData* data ) override;
+
+private:
+	static constexpr int AtlasPageSize = 2048;
+	static constexpr int TilePadding = 1;
+
+	struct Tile
+	{
+		int page;
+		QPoint position;
+		QSize size;
+		int refCount;
+	};
+
+	struct Page
+	{
+		QImage image;
+		QVector<QPoint> freeSlots;
+		int nextSlot;
+		int tileCount;
+	};
+
+	void resetAtlas();
+	void syncRows();
+	void updateRows( int first, int last );
+	void updateRowNode( ComputerScreenGridNode* gridNode, int row ) const;
+	QImage imageOfRow( int row ) const;
+	QRectF tileRect( int row, const Tile& tile ) const;
+
+	qint64 acquireTile( const QImage& image );
+	void releaseTile( qint64 key );
+	void allocateSlot( int& pageIndex, QPoint& position );
+	void releasePage( int pageIndex );
+	QSize slotSize() const;
+	QPoint slotPosition( int slot ) const;
+	QSize pageSize() const;
+	int slotCapacity() const;
+
+	ComputerScreenGridNode* createGridNode() const;
+
+	void invalidateGeometry();
+
+	QPointer<QAbstractItemModel> m_model{};
+	qreal m_cellWidth{1};
+	qreal m_cellHeight{1};
+	QSize m_tileSize{};
+
+	// tiles are keyed by QImage::cacheKey() so that rows showing the same image
+	// (e.g. placeholder icons) share a single tile
+	QHash<qint64, Tile> m_tiles{};
+	QVector<Page> m_pages{};
+	QVector<qint64> m_rowImages{};
+
+	// changes which have not been synchronized with the scene graph yet
+	QSet<int> m_dirtyRows{};
+	QSet<qint64> m_dirtyTiles{};
+	QSet<qint64> m_releasedTiles{};
+	QSet<int> m_releasedPages{};
+
+	bool m_atlasReset{false};
+	bool m_geometryDirty{true};
+
+signals:
+	void modelChanged();
+	void cellWidthChanged();
+	void cellHeightChanged();
+	void tileSizeChanged();
+
+};
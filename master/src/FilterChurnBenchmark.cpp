@@ -0,0 +1,144 @@
+/*
+ * FilterChurnBenchmark.cpp - benchmark for filter changes of master models
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "FilterChurnBenchmark.h"
+
+#ifdef VEYON_DEBUG
+
+#include <QElapsedTimer>
+#include <QItemSelectionModel>
+#include <QStandardItemModel>
+
+#include "ComputerControlListModel.h"
+#include "ComputerMonitoringModel.h"
+#include "NetworkObjectFilterProxyModel.h"
+#include "NetworkObjectModel.h"
+
+
+bool FilterChurnBenchmark::run()
+{
+	const auto monitoringModelResult = benchmarkComputerMonitoringModel();
+	const auto filterProxyModelResult = benchmarkNetworkObjectFilterProxyModel();
+
+	return monitoringModelResult && filterProxyModelResult;
+}
+
+
+
+bool FilterChurnBenchmark::benchmarkComputerMonitoringModel()
+{
+	const auto locationCount = ( m_computerCount + ComputersPerLocation - 1 ) / ComputersPerLocation;
+
+	QStandardItemModel sourceModel;
+	for( int i = 0; i < m_computerCount; ++i )
+	{
+		auto item = new QStandardItem( QStringLiteral("PC%1").arg( i ) );
+		item->setData( QVariant::fromValue( i % 2 ? ComputerControlInterface::State::Connected :
+													ComputerControlInterface::State::Disconnected ),
+					   ComputerControlListModel::StateRole );
+		item->setData( QStringList( { QStringLiteral("Room %1").arg( i / ComputersPerLocation ),
+									  QStringLiteral("Group %1").arg( i % 7 ) } ),
+					   ComputerControlListModel::GroupsRole );
+		sourceModel.appendRow( item );
+	}
+
+	ComputerMonitoringModel model( &sourceModel, nullptr );
+
+	// a selection has to survive filter changes as long as the selected computer stays visible
+	QItemSelectionModel selectionModel( &model );
+	selectionModel.select( model.index( 0, 0 ), QItemSelectionModel::Select );
+
+	int resets = 0;
+	QObject::connect( &model, &QAbstractItemModel::modelReset, [&resets]() { ++resets; } );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < m_iterations; ++i )
+	{
+		model.setGroupsFilter( { QStringLiteral("Room 0"), QStringLiteral("Room %1").arg( 1 + i % qMax( 1, locationCount - 1 ) ) } );
+		model.setStateFilter( i % 2 ? ComputerControlInterface::State::Disconnected : ComputerControlInterface::State::None );
+	}
+
+	printResult( "ComputerMonitoringModel", timer.nsecsElapsed(), m_iterations * 2, resets );
+
+	return resets == 0 && selectionModel.selectedIndexes().size() == 1;
+}
+
+
+
+bool FilterChurnBenchmark::benchmarkNetworkObjectFilterProxyModel()
+{
+	const auto locationCount = ( m_computerCount + ComputersPerLocation - 1 ) / ComputersPerLocation;
+
+	QStandardItemModel sourceModel;
+	for( int location = 0; location < locationCount; ++location )
+	{
+		auto locationItem = new QStandardItem( QStringLiteral("Room %1").arg( location ) );
+		for( int i = location * ComputersPerLocation; i < qMin( m_computerCount, ( location + 1 ) * ComputersPerLocation ); ++i )
+		{
+			auto item = new QStandardItem( QStringLiteral("PC%1").arg( i ) );
+			item->setData( QStringLiteral("PC%1.example.org").arg( i ), NetworkObjectModel::HostAddressRole );
+			locationItem->appendRow( item );
+		}
+		sourceModel.appendRow( locationItem );
+	}
+
+	NetworkObjectFilterProxyModel model( nullptr );
+	model.setSourceModel( &sourceModel );
+
+	int resets = 0;
+	QObject::connect( &model, &QAbstractItemModel::modelReset, [&resets]() { ++resets; } );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < m_iterations; ++i )
+	{
+		QStringList locations;
+		QStringList excludedComputers;
+		for( int location = i % 2; location < locationCount; location += 2 )
+		{
+			locations.append( QStringLiteral("Room %1").arg( location ) );
+			excludedComputers.append( QStringLiteral("pc%1.example.org").arg( location * ComputersPerLocation + i % ComputersPerLocation ) );
+		}
+
+		model.setGroupFilter( locations );
+		model.setComputerExcludeFilter( excludedComputers );
+	}
+
+	printResult( "NetworkObjectFilterProxyModel", timer.nsecsElapsed(), m_iterations * 2, resets );
+
+	return resets == 0;
+}
+
+
+
+void FilterChurnBenchmark::printResult( const char* name, qint64 nanoseconds, int changes, int resets )
+{
+	printf( "[BENCHMARK]: %-30s %6d filter changes  %8.3f ms/change  %d model resets\n",
+			name, changes, double(nanoseconds) / changes / 1000000, resets );
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*
+ * FilterChurnBenchmark.h - benchmark for filter changes of master models
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QtGlobal>
+
+#ifdef VEYON_DEBUG
+
+class QAbstractItemModel;
+
+// measures how long changing the filters of ComputerMonitoringModel and NetworkObjectFilterProxyModel
+// takes with many computers and verifies that filter changes never reset the models - run debug builds
+// of Veyon Master with VEYON_MASTER_BENCHMARK_FILTERS set to the number of computers (e.g. 1000)
+class FilterChurnBenchmark
+{
+public:
+	explicit FilterChurnBenchmark( int computerCount, int iterations ) :
+		m_computerCount( computerCount ),
+		m_iterations( iterations )
+	{
+	}
+
+	bool run();
+
+private:
+	static constexpr int ComputersPerLocation = 25;
+
+	bool benchmarkComputerMonitoringModel();
+	bool benchmarkNetworkObjectFilterProxyModel();
+
+	static void printResult( const char* name, qint64 nanoseconds, int changes, int resets );
+
+	const int m_computerCount;
+	const int m_iterations;
+
+} ;
+
+#endif
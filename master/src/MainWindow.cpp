@@ -42,6 +42,7 @@
 #include "MonitoringMode.h"
 #include "NetworkObjectDirectory.h"
 #include "NetworkObjectDirectoryManager.h"
+#include "ReconnectScheduler.h"
 #include "ToolButton.h"
 #include "VeyonConfiguration.h"
 #include "VeyonMaster.h"
@@ -242,6 +243,7 @@ void MainWindow::keyPressEvent( QKeyEvent* event )
 	switch( event->key() )
 	{
 	case Qt::Key_F5:
+		VeyonCore::reconnectScheduler().wakeUp();
 		VeyonCore::networkObjectDirectoryManager().configuredDirectory()->update();
 		m_master.computerControlListModel().reload();
 		event->accept();
@@ -42,18 +42,31 @@ NetworkObjectFilterProxyModel::NetworkObjectFilterProxyModel( QObject* parent )
 
 void NetworkObjectFilterProxyModel::setGroupFilter( const QStringList& groupList )
 {
-	beginResetModel();
-	m_groupList = groupList;
-	endResetModel();
+	auto groups = groupList.toSet();
+	if( groups != m_groups )
+	{
+		m_groups.swap( groups );
+		invalidateFilter();
+	}
 }
 
 
 
 void NetworkObjectFilterProxyModel::setComputerExcludeFilter( const QStringList& computerExcludeList )
 {
-	beginResetModel();
-	m_computerExcludeList = computerExcludeList;
-	endResetModel();
+	// host addresses are compared case-insensitively, so store them in lower case
+	QSet<QString> excludedComputers;
+	excludedComputers.reserve( computerExcludeList.size() );
+	for( const auto& computer : computerExcludeList )
+	{
+		excludedComputers.insert( computer.toLower() );
+	}
+
+	if( excludedComputers != m_excludedComputers )
+	{
+		m_excludedComputers.swap( excludedComputers );
+		invalidateFilter();
+	}
 }
 
 
@@ -62,7 +75,7 @@ bool NetworkObjectFilterProxyModel::filterAcceptsRow( int sourceRow, const QMode
 {
 	if( sourceParent.isValid() )
 	{
-		if( m_computerExcludeList.isEmpty() )
+		if( m_excludedComputers.isEmpty() )
 		{
 			return true;
 		}
@@ -70,7 +83,7 @@ bool NetworkObjectFilterProxyModel::filterAcceptsRow( int sourceRow, const QMode
 		const auto hostAddress = sourceModel()->data( sourceModel()->index( sourceRow, 0, sourceParent ),
 													  NetworkObjectModel::HostAddressRole ).toString();
 
-		return m_computerExcludeList.contains( hostAddress, Qt::CaseInsensitive ) == false;
+		return m_excludedComputers.contains( hostAddress.toLower() ) == false;
 	}
 
 	if( m_excludeEmptyGroups && sourceModel()->rowCount( sourceModel()->index( sourceRow, 0 ) ) == 0 )
@@ -78,10 +91,10 @@ bool NetworkObjectFilterProxyModel::filterAcceptsRow( int sourceRow, const QMode
 		return false;
 	}
 
-	if( m_groupList.isEmpty() )
+	if( m_groups.isEmpty() )
 	{
 		return true;
 	}
 
-	return m_groupList.contains( sourceModel()->data( sourceModel()->index( sourceRow, 0 ) ).toString() );
+	return m_groups.contains( sourceModel()->data( sourceModel()->index( sourceRow, 0 ) ).toString() );
 }
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <QSet>
 #include <QSortFilterProxyModel>
 
 class NetworkObjectFilterProxyModel : public QSortFilterProxyModel
@@ -43,8 +44,8 @@ protected:
 	bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const override;
 
 private:
-	QStringList m_groupList{};
-	QStringList m_computerExcludeList{};
+	QSet<QString> m_groups{};
+	QSet<QString> m_excludedComputers{};
 	bool m_excludeEmptyGroups{false};
 
 };
@@ -44,7 +44,7 @@ ScreenshotManagementPanel::ScreenshotManagementPanel( QWidget *parent ) :
 
 	VeyonCore::filesystem().ensurePathExists( VeyonCore::config().screenshotDirectory() );
 
-	m_fsModel.setNameFilters( { QStringLiteral("*.png") } );
+	m_fsModel.setNameFilters( { QStringLiteral("*.png"), QStringLiteral("*.webp") } );
 	m_fsModel.setFilter( QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Files );
 	m_fsModel.setRootPath( VeyonCore::filesystem().expandPath( VeyonCore::config().screenshotDirectory() ) );
 
@@ -31,8 +31,10 @@
 #include "ComputerManager.h"
 #include "ComputerMonitoringItem.h"
 #include "ComputerMonitoringModel.h"
+#include "ComputerScreenGridItem.h"
 #include "FeatureManager.h"
 #include "MainWindow.h"
+#include "MetricsServer.h"
 #include "MonitoringMode.h"
 #include "PluginManager.h"
 #include "UserConfig.h"
@@ -67,6 +69,11 @@ VeyonMaster::VeyonMaster( QObject* parent ) :
 
 	VeyonCore::localComputerControlInterface().start( QSize(), ComputerControlInterface::UpdateMode::Monitoring );
 
+	if( VeyonCore::config().metricsEnabled() )
+	{
+		( new MetricsServer( {}, this ) )->start( VeyonCore::config().masterMetricsPort() );
+	}
+
 	initUserInterface();
 }
 
@@ -164,20 +171,12 @@ void VeyonMaster::runFeature( const Feature& feature )
 
 	if( feature.testFlag( Feature::Mode ) )
 	{
-		stopAllModeFeatures( computerControlInterfaces );
-
-		if( m_currentMode == feature.uid() )
-		{
-			const Feature& monitoringModeFeature = VeyonCore::builtinFeatures().monitoringMode().feature();
+		// running the current mode again switches back to monitoring mode
+		const auto& mode = m_currentMode == feature.uid() ?
+							   VeyonCore::builtinFeatures().monitoringMode().feature() : feature;
 
-			m_featureManager->startFeature( *this, monitoringModeFeature, computerControlInterfaces );
-			m_currentMode = monitoringModeFeature.uid();
-		}
-		else
-		{
-			m_featureManager->startFeature( *this, feature, computerControlInterfaces );
-			m_currentMode = feature.uid();
-		}
+		m_featureManager->switchMode( *this, mode, computerControlInterfaces );
+		m_currentMode = mode.uid();
 	}
 	else
 	{
@@ -192,21 +191,9 @@ void VeyonMaster::enforceDesignatedMode( const QModelIndex& index )
 	auto controlInterface = m_computerControlListModel->computerControlInterface( index );
 	if( controlInterface )
 	{
-		auto designatedModeFeature = m_featureManager->feature( controlInterface->designatedModeFeature() );
+		const auto& designatedModeFeature = m_featureManager->feature( controlInterface->designatedModeFeature() );
 
-		// stop all other active mode feature
-		for( const auto& currentFeature : features() )
-		{
-			if( currentFeature.testFlag( Feature::Mode ) && currentFeature != designatedModeFeature )
-			{
-				featureManager().stopFeature( *this, currentFeature, { controlInterface } );
-			}
-		}
-
-		if( designatedModeFeature != VeyonCore::builtinFeatures().monitoringMode().feature() )
-		{
-			featureManager().startFeature( *this, designatedModeFeature, { controlInterface } );
-		}
+		m_featureManager->switchMode( *this, designatedModeFeature, { controlInterface } );
 	}
 }
 
@@ -214,14 +201,9 @@ void VeyonMaster::enforceDesignatedMode( const QModelIndex& index )
 
 void VeyonMaster::stopAllModeFeatures( const ComputerControlInterfaceList& computerControlInterfaces )
 {
-	// stop any previously active featues
-	for( const auto& feature : qAsConst( features() ) )
-	{
-		if( feature.testFlag( Feature::Mode ) )
-		{
-			m_featureManager->stopFeature( *this, feature, computerControlInterfaces );
-		}
-	}
+	// stop any previously active features by switching back to monitoring mode
+	m_featureManager->switchMode( *this, VeyonCore::builtinFeatures().monitoringMode().feature(),
+								  computerControlInterfaces );
 }
 
 
@@ -243,6 +225,7 @@ void VeyonMaster::initUserInterface()
 		const auto minorVersion = veyonVersion.minorVersion();
 
 		qmlRegisterType<ComputerMonitoringItem>( "Veyon.Master", majorVersion, minorVersion, "ComputerMonitoringItem" );
+		qmlRegisterType<ComputerScreenGridItem>( "Veyon.Master", majorVersion, minorVersion, "ComputerScreenGrid" );
 
 		m_qmlAppEngine = new QQmlApplicationEngine( this );
 		m_qmlAppEngine->addImageProvider( m_computerControlListModel->imageProviderId(), m_computerControlListModel );
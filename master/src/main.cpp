@@ -27,6 +27,7 @@
 #include <QSplashScreen>
 
 #include "DocumentationFigureCreator.h"
+#include "FilterChurnBenchmark.h"
 #include "MainWindow.h"
 #include "VeyonConfiguration.h"
 #include "VeyonMaster.h"
@@ -48,6 +49,12 @@ int main( int argc, char** argv )
 		DocumentationFigureCreator().run();
 		return 0;
 	}
+
+	if( qEnvironmentVariableIsSet( "VEYON_MASTER_BENCHMARK_FILTERS" ) )
+	{
+		const auto computerCount = qMax( 1, qEnvironmentVariableIntValue( "VEYON_MASTER_BENCHMARK_FILTERS" ) );
+		return FilterChurnBenchmark( computerCount, 100 ).run() ? 0 : -1;
+	}
 #endif
 
 	QSplashScreen* splashScreen = nullptr;
@@ -31,6 +31,7 @@
 #include "AuthKeysPlugin.h"
 #include "AuthKeysManager.h"
 #include "Filesystem.h"
+#include "SocketDevice.h"
 #include "VariantArrayMessage.h"
 #include "VeyonConfiguration.h"
 
@@ -139,13 +140,24 @@ VncServerClient::AuthState AuthKeysPlugin::performAuthentication( VncServerClien
 	switch( client->authState() )
 	{
 	case VncServerClient::AuthState::Init:
+	{
 		client->setChallenge( CryptoCore::generateChallenge() );
-		if( VariantArrayMessage( message.ioDevice() ).write( client->challenge() ).send() == false )
+
+		VariantArrayMessage challengeMessage( message.ioDevice() );
+		challengeMessage.write( client->challenge() );
+		if( m_configuration.sessionTicketsEnabled() )
+		{
+			// announce support for session tickets - older clients ignore this
+			challengeMessage.write( AuthKeysSessionTickets::ProtocolVersion );
+		}
+
+		if( challengeMessage.send() == false )
 		{
 			vWarning() << "failed to send challenge";
 			return VncServerClient::AuthState::Failed;
 		}
 		return VncServerClient::AuthState::Stage1;
+	}
 
 	case VncServerClient::AuthState::Stage1:
 	{
@@ -162,18 +174,34 @@ VncServerClient::AuthState AuthKeysPlugin::performAuthentication( VncServerClien
 		// under which the client claims to run
 		const auto signature = message.read().toByteArray(); // Flawfinder: ignore
 
-		const auto publicKeyPath = m_manager.publicKeyPath( authKeyName );
+		QDateTime keyTimestamp;
+		const auto publicKey = m_publicKeyCache.publicKey( m_manager.publicKeyPath( authKeyName ), &keyTimestamp );
 
-		vDebug() << "loading public key" << publicKeyPath;
-		CryptoCore::PublicKey publicKey( publicKeyPath );
+		if( publicKey.isNull() || publicKey.isPublic() == false )
+		{
+			vWarning() << "FAIL";
+			return VncServerClient::AuthState::Failed;
+		}
 
-		if( publicKey.isNull() || publicKey.isPublic() == false ||
-			publicKey.verifyMessage( client->challenge(), signature, CryptoCore::DefaultSignatureAlgorithm ) == false )
+		if( signature.isEmpty() )
+		{
+			return resumeSession( authKeyName, keyTimestamp, client, message );
+		}
+
+		if( CryptoCore::PublicKey( publicKey ).verifyMessage( client->challenge(), signature,
+															  CryptoCore::DefaultSignatureAlgorithm ) == false )
 		{
 			vWarning() << "FAIL";
 			return VncServerClient::AuthState::Failed;
 		}
 
+		const auto sessionTicketRequested = message.atEnd() == false && message.read().toBool(); // Flawfinder: ignore
+		if( sessionTicketRequested &&
+			sendSessionTicket( authKeyName, keyTimestamp, publicKey, message.ioDevice() ) == false )
+		{
+			return VncServerClient::AuthState::Failed;
+		}
+
 		vDebug() << "SUCCESS";
 		return VncServerClient::AuthState::Successful;
 	}
@@ -199,6 +227,19 @@ bool AuthKeysPlugin::authenticate( QIODevice* socket ) const
 		return false;
 	}
 
+	const auto sessionTicketsSupported = challengeReceiveMessage.atEnd() == false &&
+										 challengeReceiveMessage.read().toInt() >= AuthKeysSessionTickets::ProtocolVersion && // Flawfinder: ignore
+										 m_configuration.sessionTicketsEnabled();
+
+	const auto socketDevice = qobject_cast<SocketDevice *>( socket );
+	const auto peer = socketDevice ? socketDevice->peerName() : QString();
+	const auto useSessionTickets = sessionTicketsSupported && peer.isEmpty() == false;
+
+	if( useSessionTickets && authenticateWithSessionTicket( peer, challenge, socket ) )
+	{
+		return true;
+	}
+
 	// create local copy of private key so we can modify it within our own thread
 	auto key = m_privateKey;
 
@@ -213,13 +254,132 @@ bool AuthKeysPlugin::authenticate( QIODevice* socket ) const
 	VariantArrayMessage challengeResponseMessage( socket );
 	challengeResponseMessage.write( m_authKeyName );
 	challengeResponseMessage.write( signature );
+	if( useSessionTickets )
+	{
+		challengeResponseMessage.write( true );
+	}
 	challengeResponseMessage.send();
 
+	if( useSessionTickets )
+	{
+		receiveSessionTicket( peer, key, socket );
+	}
+
 	return true;
 }
 
 
 
+VncServerClient::AuthState AuthKeysPlugin::resumeSession( const QString& authKeyName, const QDateTime& keyTimestamp,
+														  const VncServerClient* client, VariantArrayMessage& message ) const
+{
+	if( m_configuration.sessionTicketsEnabled() == false )
+	{
+		vWarning() << "session tickets disabled";
+		return VncServerClient::AuthState::Failed;
+	}
+
+	const auto ticketId = message.read().toByteArray(); // Flawfinder: ignore
+	const auto mac = message.read().toByteArray(); // Flawfinder: ignore
+
+	const auto accepted = m_sessionTickets.verify( ticketId, authKeyName, keyTimestamp, client->challenge(), mac );
+
+	if( VariantArrayMessage( message.ioDevice() ).write( accepted ).send() == false )
+	{
+		return VncServerClient::AuthState::Failed;
+	}
+
+	if( accepted )
+	{
+		vDebug() << "SUCCESS (session ticket)";
+		return VncServerClient::AuthState::Successful;
+	}
+
+	// client falls back to signing the challenge
+	return VncServerClient::AuthState::Stage1;
+}
+
+
+
+bool AuthKeysPlugin::sendSessionTicket( const QString& authKeyName, const QDateTime& keyTimestamp,
+										const CryptoCore::PublicKey& publicKey, QIODevice* socket ) const
+{
+	VariantArrayMessage ticketMessage( socket );
+
+	auto key = publicKey;
+	if( m_configuration.sessionTicketsEnabled() && key.canEncrypt() )
+	{
+		const auto lifetime = m_configuration.sessionTicketLifetime();
+		const auto ticket = m_sessionTickets.issue( authKeyName, keyTimestamp, lifetime );
+
+		ticketMessage.write( ticket.id );
+		ticketMessage.write( key.encrypt( ticket.key, CryptoCore::DefaultEncryptionAlgorithm ).toByteArray() );
+		ticketMessage.write( lifetime );
+	}
+	else
+	{
+		ticketMessage.write( QByteArray() );
+		ticketMessage.write( QByteArray() );
+		ticketMessage.write( 0 );
+	}
+
+	return ticketMessage.send();
+}
+
+
+
+bool AuthKeysPlugin::authenticateWithSessionTicket( const QString& peer, const QByteArray& challenge, QIODevice* socket ) const
+{
+	AuthKeysSessionTickets::Ticket ticket;
+	if( m_sessionTickets.lookup( peer, m_authKeyName, ticket ) == false )
+	{
+		return false;
+	}
+
+	VariantArrayMessage resumeMessage( socket );
+	resumeMessage.write( m_authKeyName );
+	resumeMessage.write( QByteArray() );
+	resumeMessage.write( ticket.id );
+	resumeMessage.write( AuthKeysSessionTickets::computeMac( ticket.key, challenge ) );
+	resumeMessage.send();
+
+	VariantArrayMessage resultMessage( socket );
+	if( resultMessage.receive() && resultMessage.read().toBool() ) // Flawfinder: ignore
+	{
+		return true;
+	}
+
+	vDebug() << QThread::currentThreadId() << "session ticket rejected by" << peer;
+	m_sessionTickets.remove( peer );
+
+	return false;
+}
+
+
+
+void AuthKeysPlugin::receiveSessionTicket( const QString& peer, CryptoCore::PrivateKey& key, QIODevice* socket ) const
+{
+	VariantArrayMessage ticketMessage( socket );
+	if( ticketMessage.receive() == false )
+	{
+		return;
+	}
+
+	AuthKeysSessionTickets::Ticket ticket;
+	ticket.id = ticketMessage.read().toByteArray(); // Flawfinder: ignore
+	const auto encryptedKey = ticketMessage.read().toByteArray(); // Flawfinder: ignore
+	const auto lifetime = ticketMessage.read().toInt(); // Flawfinder: ignore
+
+	if( ticket.id.size() == AuthKeysSessionTickets::IdSize &&
+		key.decrypt( encryptedKey, &ticket.key, CryptoCore::DefaultEncryptionAlgorithm ) &&
+		ticket.key.size() == AuthKeysSessionTickets::KeySize )
+	{
+		m_sessionTickets.store( peer, m_authKeyName, ticket, lifetime );
+	}
+}
+
+
+
 QStringList AuthKeysPlugin::commands() const
 {
 	return m_commands.keys();
@@ -27,6 +27,8 @@
 #include "AuthenticationPluginInterface.h"
 #include "AuthKeysConfiguration.h"
 #include "AuthKeysManager.h"
+#include "AuthKeysPublicKeyCache.h"
+#include "AuthKeysSessionTickets.h"
 #include "CommandLineIO.h"
 #include "CommandLinePluginInterface.h"
 
@@ -122,6 +124,14 @@ public slots:
 private:
 	bool loadPrivateKey( const QString& privateKeyFile );
 
+	VncServerClient::AuthState resumeSession( const QString& authKeyName, const QDateTime& keyTimestamp,
+											  const VncServerClient* client, VariantArrayMessage& message ) const;
+	bool sendSessionTicket( const QString& authKeyName, const QDateTime& keyTimestamp,
+							const CryptoCore::PublicKey& publicKey, QIODevice* socket ) const;
+
+	bool authenticateWithSessionTicket( const QString& peer, const QByteArray& challenge, QIODevice* socket ) const;
+	void receiveSessionTicket( const QString& peer, CryptoCore::PrivateKey& key, QIODevice* socket ) const;
+
 	void printAuthKeyTable();
 	static QString authKeysTableData( const AuthKeysTableModel& tableModel, int row, int column );
 	void printAuthKeyList();
@@ -132,6 +142,9 @@ private:
 	CryptoCore::PrivateKey m_privateKey{};
 	QString m_authKeyName;
 
+	mutable AuthKeysPublicKeyCache m_publicKeyCache{};
+	mutable AuthKeysSessionTickets m_sessionTickets{};
+
 	QMap<QString, QString> m_commands;
 
 };
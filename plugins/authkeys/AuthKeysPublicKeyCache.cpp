@@ -0,0 +1,66 @@
+/*
+ * AuthKeysPublicKeyCache.cpp - implementation of AuthKeysPublicKeyCache class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QFileInfo>
+
+#include "AuthKeysPublicKeyCache.h"
+
+
+CryptoCore::PublicKey AuthKeysPublicKeyCache::publicKey( const QString& fileName, QDateTime* lastModified )
+{
+	const QFileInfo fileInfo( fileName );
+
+	QMutexLocker locker( &m_mutex );
+
+	if( fileInfo.exists() == false )
+	{
+		m_entries.remove( fileName );
+		return {};
+	}
+
+	const auto fileLastModified = fileInfo.lastModified();
+	const auto fileSize = fileInfo.size();
+
+	auto it = m_entries.find( fileName );
+	if( it == m_entries.end() || it->lastModified != fileLastModified || it->size != fileSize )
+	{
+		vDebug() << "loading public key" << fileName;
+
+		CryptoCore::PublicKey key( fileName );
+		if( key.isNull() )
+		{
+			m_entries.remove( fileName );
+			return {};
+		}
+
+		it = m_entries.insert( fileName, { fileLastModified, fileSize, key } );
+	}
+
+	if( lastModified )
+	{
+		*lastModified = it->lastModified;
+	}
+
+	return it->key;
+}
@@ -0,0 +1,54 @@
+/*
+ * AuthKeysPublicKeyCache.h - declaration of AuthKeysPublicKeyCache class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+
+#include "CryptoCore.h"
+
+// keeps parsed public keys in memory and reloads them only if the
+// modification time or size of the key file has changed
+class AuthKeysPublicKeyCache
+{
+public:
+	AuthKeysPublicKeyCache() = default;
+
+	// returns a copy of the key which can be used safely in the calling thread
+	CryptoCore::PublicKey publicKey( const QString& fileName, QDateTime* lastModified = nullptr );
+
+private:
+	struct Entry
+	{
+		QDateTime lastModified;
+		qint64 size{0};
+		CryptoCore::PublicKey key;
+	} ;
+
+	QMutex m_mutex{};
+	QHash<QString, Entry> m_entries{};
+
+} ;
@@ -0,0 +1,172 @@
+/*
+ * AuthKeysSessionTickets.cpp - implementation of AuthKeysSessionTickets class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "AuthKeysSessionTickets.h"
+
+
+AuthKeysSessionTickets::AuthKeysSessionTickets()
+{
+	m_clock.start();
+}
+
+
+
+AuthKeysSessionTickets::Ticket AuthKeysSessionTickets::issue( const QString& keyName, const QDateTime& keyTimestamp,
+															  int lifetime )
+{
+	QMutexLocker locker( &m_mutex );
+
+	removeExpiredTickets();
+
+	if( m_issuedTickets.size() >= MaximumTicketCount )
+	{
+		// evict ticket which expires first
+		auto oldest = m_issuedTickets.begin();
+		for( auto it = m_issuedTickets.begin(), end = m_issuedTickets.end(); it != end; ++it )
+		{
+			if( it->expiresAt < oldest->expiresAt )
+			{
+				oldest = it;
+			}
+		}
+		m_issuedTickets.erase( oldest );
+	}
+
+	Ticket ticket;
+	ticket.id = QCA::Random::randomArray( IdSize ).toByteArray();
+	ticket.key = QCA::Random::randomArray( KeySize );
+
+	m_issuedTickets.insert( ticket.id, { keyName, keyTimestamp, ticket.key, m_clock.elapsed() + lifetime * 1000 } );
+
+	return ticket;
+}
+
+
+
+bool AuthKeysSessionTickets::verify( const QByteArray& id, const QString& keyName, const QDateTime& keyTimestamp,
+									 const QByteArray& challenge, const QByteArray& mac )
+{
+	QMutexLocker locker( &m_mutex );
+
+	removeExpiredTickets();
+
+	const auto it = m_issuedTickets.constFind( id );
+	if( it == m_issuedTickets.constEnd() )
+	{
+		vDebug() << "unknown or expired session ticket";
+		return false;
+	}
+
+	if( it->keyName != keyName || it->keyTimestamp != keyTimestamp )
+	{
+		vDebug() << "session ticket does not match key" << keyName;
+		m_issuedTickets.remove( id );
+		return false;
+	}
+
+	const auto expectedMac = computeMac( it->key, challenge );
+	if( expectedMac.size() != mac.size() )
+	{
+		return false;
+	}
+
+	// compare in constant time
+	char difference = 0;
+	for( int i = 0; i < mac.size(); ++i )
+	{
+		difference |= expectedMac[i] ^ mac[i];
+	}
+
+	return difference == 0;
+}
+
+
+
+void AuthKeysSessionTickets::store( const QString& peer, const QString& keyName, const Ticket& ticket, int lifetime )
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_receivedTickets[peer] = { keyName, ticket, m_clock.elapsed() + lifetime * 1000 - ClientExpiryMargin };
+}
+
+
+
+bool AuthKeysSessionTickets::lookup( const QString& peer, const QString& keyName, Ticket& ticket )
+{
+	QMutexLocker locker( &m_mutex );
+
+	const auto it = m_receivedTickets.constFind( peer );
+	if( it == m_receivedTickets.constEnd() )
+	{
+		return false;
+	}
+
+	if( it->keyName != keyName || it->expiresAt <= m_clock.elapsed() )
+	{
+		m_receivedTickets.remove( peer );
+		return false;
+	}
+
+	ticket = it->ticket;
+
+	return true;
+}
+
+
+
+void AuthKeysSessionTickets::remove( const QString& peer )
+{
+	QMutexLocker locker( &m_mutex );
+
+	m_receivedTickets.remove( peer );
+}
+
+
+
+QByteArray AuthKeysSessionTickets::computeMac( const SecureArray& key, const QByteArray& challenge )
+{
+	QCA::MessageAuthenticationCode hmac( QStringLiteral("hmac(sha256)"), QCA::SymmetricKey( key ) );
+	hmac.update( challenge );
+
+	return hmac.final().toByteArray();
+}
+
+
+
+void AuthKeysSessionTickets::removeExpiredTickets()
+{
+	const auto now = m_clock.elapsed();
+
+	for( auto it = m_issuedTickets.begin(); it != m_issuedTickets.end(); )
+	{
+		if( it->expiresAt <= now )
+		{
+			it = m_issuedTickets.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
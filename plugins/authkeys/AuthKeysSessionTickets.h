@@ -0,0 +1,94 @@
+/*
+ * AuthKeysSessionTickets.h - declaration of AuthKeysSessionTickets class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+
+#include "CryptoCore.h"
+
+// Session tickets allow a master which recently authenticated with its key to
+// resume without signing a new challenge. The server issues a random ticket key
+// encrypted with the master's public key. On subsequent connections the master
+// proves possession of the ticket key through a HMAC over the fresh challenge,
+// so captured authentication messages can't be replayed. Tickets expire strictly
+// after their lifetime and become invalid as soon as the public key file changes.
+class AuthKeysSessionTickets
+{
+public:
+	using SecureArray = CryptoCore::SecureArray;
+
+	static constexpr int ProtocolVersion = 1;
+	static constexpr int IdSize = 16;
+	static constexpr int KeySize = 32;
+	static constexpr int MaximumTicketCount = 1024;
+	static constexpr int ClientExpiryMargin = 10000;
+
+	struct Ticket
+	{
+		QByteArray id;
+		SecureArray key;
+	} ;
+
+	AuthKeysSessionTickets();
+
+	// server side
+	Ticket issue( const QString& keyName, const QDateTime& keyTimestamp, int lifetime );
+	bool verify( const QByteArray& id, const QString& keyName, const QDateTime& keyTimestamp,
+				 const QByteArray& challenge, const QByteArray& mac );
+
+	// client side
+	void store( const QString& peer, const QString& keyName, const Ticket& ticket, int lifetime );
+	bool lookup( const QString& peer, const QString& keyName, Ticket& ticket );
+	void remove( const QString& peer );
+
+	static QByteArray computeMac( const SecureArray& key, const QByteArray& challenge );
+
+private:
+	struct IssuedTicket
+	{
+		QString keyName;
+		QDateTime keyTimestamp;
+		SecureArray key;
+		qint64 expiresAt{0};
+	} ;
+
+	struct ReceivedTicket
+	{
+		QString keyName;
+		Ticket ticket;
+		qint64 expiresAt{0};
+	} ;
+
+	void removeExpiredTickets();
+
+	QElapsedTimer m_clock{};
+	QMutex m_mutex{};
+	QHash<QByteArray, IssuedTicket> m_issuedTickets{};
+	QHash<QString, ReceivedTicket> m_receivedTickets{};
+
+} ;
@@ -24,6 +24,7 @@
 
 #include <QApplication>
 #include <QMessageBox>
+#include <QtConcurrent>
 
 #include "AuthLogonPlugin.h"
 #include "AuthLogonDialog.h"
@@ -126,7 +127,22 @@ VncServerClient::AuthState AuthLogonPlugin::performAuthentication( VncServerClie
 
 		vInfo() << "authenticating user" << client->username();
 
-		if( VeyonCore::platform().userFunctions().authenticate( client->username(), decryptedPassword.toByteArray() ) )
+		// PAM conversations may take seconds (e.g. fail delays) so don't block the server's main thread
+		const auto username = client->username();
+		client->setPendingVerification( QtConcurrent::run( [username, decryptedPassword]() {
+			return VeyonCore::platform().userFunctions().authenticate( username, decryptedPassword.toByteArray() );
+		} ) );
+
+		return VncServerClient::AuthState::Pending;
+	}
+
+	case VncServerClient::AuthState::Pending:
+		if( client->pendingVerification().isFinished() == false )
+		{
+			return VncServerClient::AuthState::Pending;
+		}
+
+		if( client->pendingVerification().result() )
 		{
 			vDebug() << "SUCCESS";
 			return VncServerClient::AuthState::Successful;
@@ -134,7 +150,6 @@ VncServerClient::AuthState AuthLogonPlugin::performAuthentication( VncServerClie
 
 		vDebug() << "FAIL";
 		return VncServerClient::AuthState::Failed;
-	}
 
 	default:
 		break;
@@ -28,13 +28,16 @@
 #include <QLayout>
 
 #include "DemoClient.h"
+#include "DemoConfiguration.h"
+#include "DemoMulticastRelay.h"
 #include "VeyonConfiguration.h"
 #include "LockWidget.h"
 #include "PlatformCoreFunctions.h"
 #include "VncViewWidget.h"
 
 
-DemoClient::DemoClient( const QString& host, bool fullscreen, QObject* parent ) :
+DemoClient::DemoClient( const QString& host, bool fullscreen, const DemoAuthentication& authentication,
+						const DemoConfiguration& configuration, QObject* parent ) :
 	QObject( parent ),
 	m_toplevel( nullptr )
 {
@@ -57,17 +60,22 @@ DemoClient::DemoClient( const QString& host, bool fullscreen, QObject* parent )
 		m_toplevel->resize( QApplication::desktop()->availableGeometry( m_toplevel ).size() - QSize( 10, 30 ) );
 	}
 
-	m_vncView = new VncViewWidget( host, VeyonCore::config().demoServerPort(), m_toplevel, VncView::DemoMode );
-
 	auto toplevelLayout = new QVBoxLayout;
 	toplevelLayout->setMargin( 0 );
 	toplevelLayout->setSpacing( 0 );
-	toplevelLayout->addWidget( m_vncView );
 
 	m_toplevel->setLayout( toplevelLayout );
 
 	connect( m_toplevel, &QObject::destroyed, this, &DemoClient::viewDestroyed );
-	connect( m_vncView, &VncViewWidget::sizeHintChanged, this, &DemoClient::resizeToplevelWidget );
+
+	if( configuration.multicastEnabled() )
+	{
+		startMulticastRelay( host, authentication, configuration );
+	}
+	else
+	{
+		createVncView( host, VeyonCore::config().demoServerPort() );
+	}
 
 	m_toplevel->move( 0, 0 );
 	if( fullscreen )
@@ -95,6 +103,45 @@ DemoClient::~DemoClient()
 
 
 
+void DemoClient::startMulticastRelay( const QString& host, const DemoAuthentication& authentication,
+									  const DemoConfiguration& configuration )
+{
+	m_multicastRelay = new DemoMulticastRelay( host, VeyonCore::config().demoServerPort(),
+											   authentication, configuration, this );
+
+	connect( m_multicastRelay, &DemoMulticastRelay::ready, this, [this]( quint16 localPort ) {
+		createVncView( QHostAddress( QHostAddress::LocalHost ).toString(), localPort );
+	} );
+
+	connect( m_multicastRelay, &DemoMulticastRelay::failed, this, [this, host]() {
+		vWarning() << "multicast not available - falling back to TCP connection to" << host;
+		m_multicastRelay->deleteLater();
+		m_multicastRelay = nullptr;
+		createVncView( host, VeyonCore::config().demoServerPort() );
+	} );
+
+	m_multicastRelay->start();
+}
+
+
+
+void DemoClient::createVncView( const QString& host, int port )
+{
+	if( m_toplevel == nullptr || m_vncView )
+	{
+		return;
+	}
+
+	m_vncView = new VncViewWidget( host, port, m_toplevel, VncView::DemoMode );
+
+	m_toplevel->layout()->addWidget( m_vncView );
+	m_vncView->show();
+
+	connect( m_vncView, &VncViewWidget::sizeHintChanged, this, &DemoClient::resizeToplevelWidget );
+}
+
+
+
 void DemoClient::viewDestroyed( QObject* obj )
 {
 	// prevent double deletion of toplevel widget
@@ -110,6 +157,11 @@ void DemoClient::viewDestroyed( QObject* obj )
 
 void DemoClient::resizeToplevelWidget()
 {
+	if( m_toplevel == nullptr || m_vncView == nullptr )
+	{
+		return;
+	}
+
 	if( m_toplevel->windowState() & Qt::WindowFullScreen )
 	{
 		m_vncView->resize( m_toplevel->size() );
@@ -26,20 +26,28 @@
 
 #include <QObject>
 
+class DemoAuthentication;
+class DemoConfiguration;
+class DemoMulticastRelay;
 class VncViewWidget;
 
 class DemoClient : public QObject
 {
 	Q_OBJECT
 public:
-	DemoClient( const QString& host, bool fullscreen, QObject* parent = nullptr );
+	DemoClient( const QString& host, bool fullscreen, const DemoAuthentication& authentication,
+				const DemoConfiguration& configuration, QObject* parent = nullptr );
 	~DemoClient() override;
 
 private:
+	void startMulticastRelay( const QString& host, const DemoAuthentication& authentication,
+							  const DemoConfiguration& configuration );
+	void createVncView( const QString& host, int port );
 	void viewDestroyed( QObject* obj );
 	void resizeToplevelWidget();
 
 	QWidget* m_toplevel;
-	VncViewWidget* m_vncView;
+	VncViewWidget* m_vncView{nullptr};
+	DemoMulticastRelay* m_multicastRelay{nullptr};
 
 } ;
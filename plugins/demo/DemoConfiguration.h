@@ -33,6 +33,12 @@
 	OP( DemoConfiguration, m_configuration, int, framebufferUpdateInterval, setFramebufferUpdateInterval, "FramebufferUpdateInterval", "Demo", 100, Configuration::Property::Flag::Advanced )	\
 	OP( DemoConfiguration, m_configuration, int, keyFrameInterval, setKeyFrameInterval, "KeyFrameInterval", "Demo", 10, Configuration::Property::Flag::Advanced )	\
 	OP( DemoConfiguration, m_configuration, int, memoryLimit, setMemoryLimit, "MemoryLimit", "Demo", 128, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, bool, multicastEnabled, setMulticastEnabled, "MulticastEnabled", "Demo", false, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, QString, multicastGroupAddress, setMulticastGroupAddress, "MulticastGroupAddress", "Demo", QStringLiteral("239.255.86.1"), Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, multicastPort, setMulticastPort, "MulticastPort", "Demo", 11450, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, multicastTtl, setMulticastTtl, "MulticastTtl", "Demo", 1, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, multicastRateLimit, setMulticastRateLimit, "MulticastRateLimit", "Demo", 100, Configuration::Property::Flag::Advanced )	\
+	OP( DemoConfiguration, m_configuration, int, multicastSimulatedPacketLoss, setMulticastSimulatedPacketLoss, "MulticastSimulatedPacketLoss", "Demo", 0, Configuration::Property::Flag::Hidden )	\
 
 // clazy:excludeall=missing-qobject-macro
 
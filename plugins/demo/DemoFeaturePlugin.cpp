@@ -23,12 +23,17 @@
  */
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include <random>
 
 #include "AuthenticationCredentials.h"
 #include "Computer.h"
 #include "DemoClient.h"
 #include "DemoConfigurationPage.h"
 #include "DemoFeaturePlugin.h"
+#include "DemoMulticastReceiver.h"
+#include "DemoMulticastSender.h"
 #include "DemoServer.h"
 #include "FeatureWorkerManager.h"
 #include "Logger.h"
@@ -63,7 +68,10 @@ DemoFeaturePlugin::DemoFeaturePlugin( QObject* parent ) :
 						 Feature::Uid(),
 						 tr( "Demo server" ), {}, {} ),
 	m_features( { m_fullscreenDemoFeature, m_windowDemoFeature, m_demoServerFeature } ),
-	m_configuration( &VeyonCore::config() )
+	m_configuration( &VeyonCore::config() ),
+	m_commands( {
+{ QStringLiteral("multicastloopback"), tr( "Distribute test messages via multicast on this host with simulated packet loss and verify them [LOSS%] [MESSAGES]" ) },
+				} )
 {
 }
 
@@ -232,8 +240,6 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server,
 
 bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message )
 {
-	Q_UNUSED(worker)
-
 	if( message.featureUid() == m_demoServerFeature.uid() )
 	{
 		switch( message.command() )
@@ -274,7 +280,7 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 				const auto isFullscreenDemo = message.featureUid() == m_fullscreenDemoFeature.uid();
 
 				vDebug() << "connecting with master" << demoServerHost;
-				m_demoClient = new DemoClient( demoServerHost, isFullscreenDemo );
+				m_demoClient = new DemoClient( demoServerHost, isFullscreenDemo, *this, m_configuration );
 			}
 			return true;
 
@@ -282,7 +288,7 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 			delete m_demoClient;
 			m_demoClient = nullptr;
 
-			QCoreApplication::quit();
+			worker.stopFeatureWorker( message.featureUid() );
 
 			return true;
 
@@ -296,10 +302,153 @@ bool DemoFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, cons
 
 
 
+bool DemoFeaturePlugin::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+{
+	Q_UNUSED(worker)
+
+	if( feature == m_demoServerFeature )
+	{
+		delete m_demoServer;
+		m_demoServer = nullptr;
+		return true;
+	}
+
+	if( feature == m_fullscreenDemoFeature || feature == m_windowDemoFeature )
+	{
+		delete m_demoClient;
+		m_demoClient = nullptr;
+		return true;
+	}
+
+	return false;
+}
+
+
+
 ConfigurationPage* DemoFeaturePlugin::createConfigurationPage()
 {
 	return new DemoConfigurationPage( m_configuration );
 }
 
 
+
+QStringList DemoFeaturePlugin::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString DemoFeaturePlugin::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult DemoFeaturePlugin::handle_multicastloopback( const QStringList& arguments )
+{
+	static constexpr int KeyFrame = 1;
+	static constexpr int MinimumMessageSize = 64;
+	static constexpr int MaximumMessageSize = 64*1024;
+	static constexpr int Timeout = 30000;
+
+	const auto packetLoss = qBound( 0, arguments.value( 0, QStringLiteral("10") ).toInt(), 100 );
+	const auto messageCount = qMax( 1, arguments.value( 1, QStringLiteral("1000") ).toInt() );
+
+	const QHostAddress groupAddress( m_configuration.multicastGroupAddress() );
+	const auto port = static_cast<quint16>( m_configuration.multicastPort() );
+
+	const auto key = CryptoCore::generateChallenge();
+
+	DemoMulticastSender sender( groupAddress, port, 0, key );
+	DemoMulticastReceiver receiver( groupAddress, port, key );
+	receiver.setSimulatedPacketLoss( packetLoss );
+
+	// sends datagrams with a newer key frame which must not disturb the receiver
+	DemoMulticastSender forger( groupAddress, port, 0, CryptoCore::generateChallenge() );
+
+	if( sender.isValid() == false || forger.isValid() == false || receiver.join() == false )
+	{
+		error( tr( "Could not set up multicast sockets for group %1:%2" ).arg( groupAddress.toString() ).arg( port ) );
+		return Failed;
+	}
+
+	std::minstd_rand random;
+	std::uniform_int_distribution<int> sizeDistribution( MinimumMessageSize, MaximumMessageSize );
+
+	QVector<QByteArray> messages;
+	messages.reserve( messageCount );
+	for( int i = 0; i < messageCount; ++i )
+	{
+		QByteArray message( sizeDistribution( random ), Qt::Uninitialized );
+		for( auto& byte : message )
+		{
+			byte = static_cast<char>( random() );
+		}
+		messages.append( message );
+	}
+
+	// serve repair requests from the message store like the control connection does
+	int repairedMessages = 0;
+	connect( &receiver, &DemoMulticastReceiver::repairRequired, this,
+			 [&]( int keyFrame, const QVector<int>& messageIndexes ) {
+		for( const auto index : messageIndexes )
+		{
+			receiver.insertMessage( keyFrame, index, messages.value( index ) );
+			++repairedMessages;
+		}
+	} );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < messageCount; ++i )
+	{
+		sender.sendMessage( KeyFrame, i, messages[i] );
+		if( i % 100 == 0 )
+		{
+			forger.announce( KeyFrame + 1, messageCount );
+			forger.sendMessage( KeyFrame + 1, i, messages[i] );
+		}
+		QCoreApplication::processEvents();
+	}
+
+	QElapsedTimer announceTimer;
+	announceTimer.start();
+	sender.announce( KeyFrame, messageCount );
+
+	while( receiver.messages().size() < messageCount && timer.elapsed() < Timeout )
+	{
+		QCoreApplication::processEvents( QEventLoop::AllEvents, DemoMulticastReceiver::RepairInterval );
+
+		if( announceTimer.elapsed() >= DemoServer::MulticastAnnounceInterval )
+		{
+			sender.announce( KeyFrame, messageCount );
+			announceTimer.restart();
+		}
+	}
+
+	const auto elapsed = qMax<qint64>( 1, timer.elapsed() );
+
+	if( receiver.messages() != messages )
+	{
+		error( tr( "Received %1 of %2 messages within %3 ms" ).
+			   arg( receiver.messages().size() ).arg( messageCount ).arg( elapsed ) );
+		return Failed;
+	}
+
+	print( tr( "Received %1 messages correctly in %2 ms: %3 datagrams sent, %4 dropped, %5 forged ones rejected, "
+			   "%6 messages repaired" ).
+		   arg( messageCount ).
+		   arg( elapsed ).
+		   arg( sender.datagramsSent() ).
+		   arg( receiver.datagramsDropped() ).
+		   arg( receiver.datagramsRejected() ).
+		   arg( repairedMessages ) );
+
+	return Successful;
+}
+
+
 IMPLEMENT_CONFIG_PROXY(DemoConfiguration)
@@ -25,6 +25,8 @@
 #pragma once
 
 #include "AuthenticationPluginInterface.h"
+#include "CommandLineIO.h"
+#include "CommandLinePluginInterface.h"
 #include "ConfigurationPagePluginInterface.h"
 #include "DemoAuthentication.h"
 #include "DemoConfiguration.h"
@@ -33,13 +35,15 @@
 class DemoServer;
 class DemoClient;
 
-class DemoFeaturePlugin : public QObject, FeatureProviderInterface, PluginInterface, ConfigurationPagePluginInterface, DemoAuthentication
+class DemoFeaturePlugin : public QObject, FeatureProviderInterface, PluginInterface, ConfigurationPagePluginInterface,
+		CommandLinePluginInterface, CommandLineIO, DemoAuthentication
 {
 	Q_OBJECT
 	Q_PLUGIN_METADATA(IID "io.veyon.Veyon.Plugins.Demo")
 	Q_INTERFACES(PluginInterface
 				 FeatureProviderInterface
 				 ConfigurationPagePluginInterface
+				 CommandLinePluginInterface
 				 AuthenticationPluginInterface)
 public:
 	explicit DemoFeaturePlugin( QObject* parent = nullptr );
@@ -95,8 +99,36 @@ public:
 
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) override;
 
+	bool isWorkerHostable( const Feature& feature ) const override
+	{
+		return m_features.contains( feature );
+	}
+
+	bool isWorkerRestorable( const Feature& feature ) const override
+	{
+		return m_features.contains( feature );
+	}
+
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) override;
+
 	ConfigurationPage* createConfigurationPage() override;
 
+	QString commandLineModuleName() const override
+	{
+		return QStringLiteral( "demo" );
+	}
+
+	QString commandLineModuleHelp() const override
+	{
+		return tr( "Commands for testing the demo transport" );
+	}
+
+	QStringList commands() const override;
+	QString commandHelp( const QString& command ) const override;
+
+public slots:
+	CommandLinePluginInterface::RunResult handle_multicastloopback( const QStringList& arguments );
+
 private:
 	enum Commands {
 		StartDemoServer,
@@ -119,6 +151,8 @@ private:
 
 	DemoConfiguration m_configuration;
 
+	QMap<QString, QString> m_commands;
+
 	QStringList m_demoClientHosts{};
 
 	DemoServer* m_demoServer{nullptr};
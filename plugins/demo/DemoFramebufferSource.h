@@ -0,0 +1,51 @@
+/*
+ * DemoFramebufferSource.h - interface for classes providing demo framebuffer updates
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QVector>
+
+class DemoConfiguration;
+
+// clazy:excludeall=copyable-polymorphic
+
+// common interface of DemoServer and DemoMulticastRelay used by DemoServerConnection
+class DemoFramebufferSource
+{
+public:
+	using MessageList = QVector<QByteArray>;
+
+	virtual ~DemoFramebufferSource() = default;
+
+	virtual const DemoConfiguration& configuration() const = 0;
+
+	virtual const QByteArray& serverInitMessage() const = 0;
+
+	virtual void lockDataForRead() = 0;
+	virtual void unlockData() = 0;
+
+	virtual int keyFrame() const = 0;
+	virtual const MessageList& framebufferUpdateMessages() const = 0;
+
+};
@@ -0,0 +1,169 @@
+/*
+ * DemoMulticastControlConnection.cpp - implementation of DemoMulticastControlConnection class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QTcpSocket>
+
+#include "DemoAuthentication.h"
+#include "DemoMulticastControlConnection.h"
+#include "DemoMulticastProtocol.h"
+#include "DemoMulticastSender.h"
+#include "CryptoCore.h"
+#include "DemoServer.h"
+#include "VariantArrayMessage.h"
+
+
+DemoMulticastControlConnection::DemoMulticastControlConnection( const DemoAuthentication& authentication,
+																QTcpSocket* socket,
+																DemoServer* demoServer ) :
+	QObject( demoServer ),
+	m_authentication( authentication ),
+	m_demoServer( demoServer ),
+	m_socket( socket ),
+	m_challenge( CryptoCore::generateChallenge() )
+{
+	m_socket->setParent( this );
+
+	connect( m_socket, &QTcpSocket::readyRead, this, &DemoMulticastControlConnection::processMessages );
+	connect( m_socket, &QTcpSocket::disconnected, this, &DemoMulticastControlConnection::deleteLater );
+
+	// relays have to prove knowledge of the access token without sending it in plaintext
+	VariantArrayMessage challengeMessage( m_socket );
+	challengeMessage.write( DemoMulticastProtocol::Challenge );
+	challengeMessage.write( m_challenge );
+	challengeMessage.send();
+
+	processMessages();
+}
+
+
+
+DemoMulticastControlConnection::~DemoMulticastControlConnection()
+{
+	m_socket->disconnect( this );
+}
+
+
+
+void DemoMulticastControlConnection::processMessages()
+{
+	while( m_socket->state() == QTcpSocket::ConnectedState )
+	{
+		VariantArrayMessage message( m_socket );
+		if( message.isReadyForReceive() == false || message.receive() == false )
+		{
+			break;
+		}
+
+		const auto command = message.read().toInt();
+
+		if( command == DemoMulticastProtocol::Join && m_joined == false )
+		{
+			if( handleJoin( message.read() ) == false )
+			{
+				m_socket->close();
+			}
+		}
+		else if( command == DemoMulticastProtocol::RepairRequest && m_joined )
+		{
+			const auto keyFrame = message.read().toInt();
+			handleRepairRequest( keyFrame, message.read().toList() );
+		}
+		else
+		{
+			vWarning() << "invalid control command" << command;
+			m_socket->close();
+		}
+	}
+}
+
+
+
+bool DemoMulticastControlConnection::handleJoin( const QVariant& response )
+{
+	const auto sender = m_demoServer->multicastSender();
+
+	if( sender == nullptr )
+	{
+		vDebug() << "rejecting relay as multicast is disabled";
+		return false;
+	}
+
+	if( m_authentication.hasCredentials() == false ||
+		DemoMulticastProtocol::isEqual( response.toByteArray(),
+										DemoMulticastProtocol::joinResponse( m_authentication.accessToken().toByteArray(),
+																			 m_challenge ) ) == false )
+	{
+		vWarning() << "rejecting relay with invalid access token from" << m_socket->peerAddress().toString();
+		return false;
+	}
+
+	m_joined = true;
+
+	VariantArrayMessage welcomeMessage( m_socket );
+	welcomeMessage.write( DemoMulticastProtocol::Welcome );
+	welcomeMessage.write( m_demoServer->serverInitMessage() );
+	welcomeMessage.write( sender->groupAddress().toString() );
+	welcomeMessage.write( int( sender->port() ) );
+	welcomeMessage.write( m_demoServer->multicastNonce() );
+
+	return welcomeMessage.send();
+}
+
+
+
+void DemoMulticastControlConnection::handleRepairRequest( int keyFrame, const QVariantList& messageIndexes )
+{
+	m_demoServer->lockDataForRead();
+
+	// messages of outdated key frames are not repaired as the relay
+	// will switch to the current key frame upon the next announcement
+	if( m_demoServer->keyFrame() == keyFrame )
+	{
+		const auto& messages = m_demoServer->framebufferUpdateMessages();
+
+		for( const auto& messageIndex : messageIndexes )
+		{
+			const auto index = messageIndex.toInt();
+			if( index < 0 || index >= messages.size() )
+			{
+				continue;
+			}
+
+			// relays which can't keep up request outstanding messages again later
+			if( m_socket->bytesToWrite() > MaximumPendingRepairData )
+			{
+				break;
+			}
+
+			VariantArrayMessage repairMessage( m_socket );
+			repairMessage.write( DemoMulticastProtocol::RepairData );
+			repairMessage.write( keyFrame );
+			repairMessage.write( index );
+			repairMessage.write( messages[index] );
+			repairMessage.send();
+		}
+	}
+
+	m_demoServer->unlockData();
+}
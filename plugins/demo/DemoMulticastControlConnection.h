@@ -0,0 +1,57 @@
+/*
+ * DemoMulticastControlConnection.h - header file for DemoMulticastControlConnection class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QObject>
+
+class DemoAuthentication;
+class DemoServer;
+class QTcpSocket;
+
+// clazy:excludeall=ctor-missing-parent-argument
+
+// serves a multicast relay which joined via the demo server port: sends the
+// multicast parameters and answers repair requests for lost messages
+class DemoMulticastControlConnection : public QObject
+{
+	Q_OBJECT
+public:
+	static constexpr qint64 MaximumPendingRepairData = 16*1024*1024;
+
+	DemoMulticastControlConnection( const DemoAuthentication& authentication, QTcpSocket* socket, DemoServer* demoServer );
+	~DemoMulticastControlConnection() override;
+
+private:
+	void processMessages();
+	bool handleJoin( const QVariant& response );
+	void handleRepairRequest( int keyFrame, const QVariantList& messageIndexes );
+
+	const DemoAuthentication& m_authentication;
+	DemoServer* m_demoServer;
+	QTcpSocket* m_socket;
+	const QByteArray m_challenge;
+	bool m_joined{false};
+
+} ;
@@ -0,0 +1,174 @@
+/*
+ * DemoMulticastProtocol.h - definitions for multicast distribution of demo framebuffer updates
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QtEndian>
+#include <QByteArray>
+#include <QMessageAuthenticationCode>
+
+// clazy:excludeall=copyable-polymorphic
+
+// Framebuffer update messages are split into datagrams which carry the key frame,
+// the index of the message within the key frame and the chunk index. Receivers
+// request lost messages through a TCP control connection on the demo server port.
+// Datagrams are authenticated with a key derived from the demo access token so
+// forged datagrams can't disturb the demo.
+class DemoMulticastProtocol
+{
+public:
+	static constexpr quint32 DatagramMagic = 0x56444d43; // "VDMC"
+	static constexpr int DatagramHeaderSize = 20;
+	static constexpr int DatagramMacSize = 16;
+	static constexpr int MaximumDatagramSize = 1400;
+	static constexpr int MaximumChunkSize = MaximumDatagramSize - DatagramHeaderSize - DatagramMacSize;
+	// larger messages (beyond an uncompressed 4K framebuffer update) are served through repairs only
+	static constexpr int MaximumMessageSize = 64*1024*1024;
+	static constexpr quint32 AnnounceMessageIndex = 0xffffffff;
+	static constexpr int SocketBufferSize = 4*1024*1024;
+
+	enum ControlCommand
+	{
+		Join,
+		Welcome,
+		RepairRequest,
+		RepairData,
+		Challenge,
+	} ;
+
+	struct DatagramHeader
+	{
+		quint32 keyFrame{0};
+		quint32 messageIndex{0};
+		quint32 messageSize{0};
+		quint16 chunkIndex{0};
+		quint16 chunkCount{0};
+	} ;
+
+	// sent by relays instead of the RFB protocol version to open a control connection
+	static QByteArray controlConnectionMagic()
+	{
+		return QByteArrayLiteral("VEYON-MCST1\n");
+	}
+
+	// proves knowledge of the access token to the demo server without revealing it
+	static QByteArray joinResponse( const QByteArray& accessToken, const QByteArray& challenge )
+	{
+		return QMessageAuthenticationCode::hash( QByteArrayLiteral("join") + challenge, accessToken,
+												 QCryptographicHash::Sha256 );
+	}
+
+	// key for authenticating datagrams of a demo server announcing the given nonce
+	static QByteArray datagramKey( const QByteArray& accessToken, const QByteArray& nonce )
+	{
+		return QMessageAuthenticationCode::hash( QByteArrayLiteral("datagram") + nonce, accessToken,
+												 QCryptographicHash::Sha256 );
+	}
+
+	// compares in constant time
+	static bool isEqual( const QByteArray& a, const QByteArray& b )
+	{
+		if( a.size() != b.size() )
+		{
+			return false;
+		}
+
+		char difference = 0;
+		for( int i = 0; i < a.size(); ++i )
+		{
+			difference |= a[i] ^ b[i];
+		}
+
+		return difference == 0;
+	}
+
+	static int chunkCount( int messageSize )
+	{
+		return qMax( 1, ( messageSize + MaximumChunkSize - 1 ) / MaximumChunkSize );
+	}
+
+	static int payloadSize( const QByteArray& datagram )
+	{
+		return datagram.size() - DatagramHeaderSize - DatagramMacSize;
+	}
+
+	static QByteArray encodeDatagram( QMessageAuthenticationCode& mac, const DatagramHeader& header,
+									  const char* payload, int payloadSize )
+	{
+		QByteArray datagram( DatagramHeaderSize + payloadSize + DatagramMacSize, Qt::Uninitialized );
+		auto data = reinterpret_cast<uchar *>( datagram.data() );
+
+		qToBigEndian<quint32>( DatagramMagic, data );
+		qToBigEndian<quint32>( header.keyFrame, data + 4 );
+		qToBigEndian<quint32>( header.messageIndex, data + 8 );
+		qToBigEndian<quint32>( header.messageSize, data + 12 );
+		qToBigEndian<quint16>( header.chunkIndex, data + 16 );
+		qToBigEndian<quint16>( header.chunkCount, data + 18 );
+
+		if( payloadSize > 0 )
+		{
+			memcpy( data + DatagramHeaderSize, payload, static_cast<size_t>( payloadSize ) );
+		}
+
+		mac.reset();
+		mac.addData( datagram.constData(), DatagramHeaderSize + payloadSize );
+		memcpy( data + DatagramHeaderSize + payloadSize, mac.result().constData(), DatagramMacSize );
+
+		return datagram;
+	}
+
+	// decodes the header of an authentic datagram only
+	static bool decodeDatagram( QMessageAuthenticationCode& mac, const QByteArray& datagram, DatagramHeader& header )
+	{
+		if( datagram.size() < DatagramHeaderSize + DatagramMacSize )
+		{
+			return false;
+		}
+
+		const auto data = reinterpret_cast<const uchar *>( datagram.constData() );
+
+		if( qFromBigEndian<quint32>( data ) != DatagramMagic )
+		{
+			return false;
+		}
+
+		const auto authenticatedSize = datagram.size() - DatagramMacSize;
+
+		mac.reset();
+		mac.addData( datagram.constData(), authenticatedSize );
+		if( isEqual( mac.result().left( DatagramMacSize ), datagram.mid( authenticatedSize ) ) == false )
+		{
+			return false;
+		}
+
+		header.keyFrame = qFromBigEndian<quint32>( data + 4 );
+		header.messageIndex = qFromBigEndian<quint32>( data + 8 );
+		header.messageSize = qFromBigEndian<quint32>( data + 12 );
+		header.chunkIndex = qFromBigEndian<quint16>( data + 16 );
+		header.chunkCount = qFromBigEndian<quint16>( data + 18 );
+
+		return true;
+	}
+
+} ;
@@ -0,0 +1,315 @@
+/*
+ * DemoMulticastReceiver.cpp - implementation of DemoMulticastReceiver class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <limits>
+
+#include "DemoMulticastProtocol.h"
+#include "DemoMulticastReceiver.h"
+
+
+DemoMulticastReceiver::DemoMulticastReceiver( const QHostAddress& groupAddress, quint16 port, const QByteArray& key,
+											  QObject* parent ) :
+	QObject( parent ),
+	m_groupAddress( groupAddress ),
+	m_port( port ),
+	m_mac( QCryptographicHash::Sha256, key )
+{
+	connect( &m_socket, &QUdpSocket::readyRead, this, &DemoMulticastReceiver::readDatagrams );
+	connect( &m_repairTimer, &QTimer::timeout, this, &DemoMulticastReceiver::requestRepairs );
+
+	m_clock.start();
+}
+
+
+
+DemoMulticastReceiver::~DemoMulticastReceiver()
+{
+	if( m_socket.state() == QAbstractSocket::BoundState )
+	{
+		m_socket.leaveMulticastGroup( m_groupAddress );
+	}
+}
+
+
+
+bool DemoMulticastReceiver::join()
+{
+	if( m_socket.bind( QHostAddress::AnyIPv4, m_port, QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint ) == false )
+	{
+		vWarning() << "could not bind multicast socket:" << m_socket.errorString();
+		return false;
+	}
+
+	m_socket.setSocketOption( QAbstractSocket::ReceiveBufferSizeSocketOption, DemoMulticastProtocol::SocketBufferSize );
+
+	if( m_socket.joinMulticastGroup( m_groupAddress ) == false )
+	{
+		vWarning() << "could not join multicast group" << m_groupAddress << m_socket.errorString();
+		m_socket.close();
+		return false;
+	}
+
+	m_repairTimer.start( RepairInterval );
+
+	return true;
+}
+
+
+
+void DemoMulticastReceiver::insertMessage( int keyFrame, int messageIndex, const QByteArray& message )
+{
+	if( keyFrame > m_keyFrame )
+	{
+		startKeyFrame( keyFrame );
+	}
+	else if( keyFrame < m_keyFrame || messageIndex < m_messages.size() )
+	{
+		return;
+	}
+
+	removePartialMessage( messageIndex );
+	m_repairRequestTimes.remove( messageIndex );
+	m_outOfOrderMessages[messageIndex] = message;
+	m_highestMessageIndex = qMax( m_highestMessageIndex, messageIndex );
+
+	updateAvailableMessages();
+}
+
+
+
+void DemoMulticastReceiver::readDatagrams()
+{
+	while( m_socket.hasPendingDatagrams() )
+	{
+		QByteArray datagram( int( m_socket.pendingDatagramSize() ), Qt::Uninitialized );
+		if( m_socket.readDatagram( datagram.data(), datagram.size() ) != datagram.size() )
+		{
+			continue;
+		}
+
+		if( m_simulatedPacketLoss > 0 && m_lossDistribution( m_random ) < m_simulatedPacketLoss )
+		{
+			++m_datagramsDropped;
+			continue;
+		}
+
+		++m_datagramsReceived;
+
+		processDatagram( datagram );
+	}
+}
+
+
+
+void DemoMulticastReceiver::processDatagram( const QByteArray& datagram )
+{
+	// anyone can send datagrams to the group so ignore everything not sent by our demo server
+	DemoMulticastProtocol::DatagramHeader header;
+	if( DemoMulticastProtocol::decodeDatagram( m_mac, datagram, header ) == false )
+	{
+		++m_datagramsRejected;
+		return;
+	}
+
+	const auto keyFrame = static_cast<int>( header.keyFrame );
+
+	if( keyFrame < m_keyFrame )
+	{
+		return;
+	}
+
+	if( keyFrame > m_keyFrame )
+	{
+		startKeyFrame( keyFrame );
+	}
+
+	if( header.messageIndex == DemoMulticastProtocol::AnnounceMessageIndex )
+	{
+		m_announcedMessageCount = qMax( m_announcedMessageCount, static_cast<int>( header.messageSize ) );
+		return;
+	}
+
+	if( header.messageIndex > static_cast<quint32>( std::numeric_limits<int>::max() ) ||
+		header.messageSize > static_cast<quint32>( DemoMulticastProtocol::MaximumMessageSize ) ||
+		header.chunkCount != DemoMulticastProtocol::chunkCount( int( header.messageSize ) ) )
+	{
+		++m_datagramsRejected;
+		return;
+	}
+
+	const auto messageIndex = static_cast<int>( header.messageIndex );
+	const auto messageSize = static_cast<int>( header.messageSize );
+	const auto chunkSize = DemoMulticastProtocol::MaximumChunkSize;
+	const auto payloadSize = DemoMulticastProtocol::payloadSize( datagram );
+	const auto offset = int( header.chunkIndex ) * chunkSize;
+
+	m_highestMessageIndex = qMax( m_highestMessageIndex, messageIndex );
+
+	if( messageIndex < m_messages.size() || m_outOfOrderMessages.contains( messageIndex ) ||
+		header.chunkIndex >= header.chunkCount ||
+		offset + payloadSize > messageSize )
+	{
+		return;
+	}
+
+	auto partialMessage = m_partialMessages.find( messageIndex );
+	if( partialMessage == m_partialMessages.end() )
+	{
+		if( m_partialMessages.size() >= MaximumPartialMessages ||
+			m_partialMessagesSize + messageSize > MaximumPartialMessagesSize )
+		{
+			// the repair mechanism fetches the message once older ones have been completed
+			return;
+		}
+
+		partialMessage = m_partialMessages.insert( messageIndex, {} );
+		partialMessage->data = QByteArray( messageSize, Qt::Uninitialized );
+		partialMessage->receivedChunks.resize( header.chunkCount );
+		partialMessage->remainingChunks = header.chunkCount;
+
+		m_partialMessagesSize += messageSize;
+	}
+	else if( partialMessage->data.size() != messageSize )
+	{
+		// inconsistent datagram - let the repair mechanism fetch the message
+		return;
+	}
+
+	if( partialMessage->receivedChunks.testBit( header.chunkIndex ) )
+	{
+		return;
+	}
+
+	memcpy( partialMessage->data.data() + offset,
+			datagram.constData() + DemoMulticastProtocol::DatagramHeaderSize,
+			static_cast<size_t>( payloadSize ) );
+	partialMessage->receivedChunks.setBit( header.chunkIndex );
+
+	if( --partialMessage->remainingChunks == 0 )
+	{
+		m_outOfOrderMessages[messageIndex] = partialMessage->data;
+		removePartialMessage( messageIndex );
+		m_repairRequestTimes.remove( messageIndex );
+
+		updateAvailableMessages();
+	}
+}
+
+
+
+void DemoMulticastReceiver::removePartialMessage( int messageIndex )
+{
+	const auto partialMessage = m_partialMessages.find( messageIndex );
+	if( partialMessage != m_partialMessages.end() )
+	{
+		m_partialMessagesSize -= partialMessage->data.size();
+		m_partialMessages.erase( partialMessage );
+	}
+}
+
+
+
+void DemoMulticastReceiver::startKeyFrame( int keyFrame )
+{
+	m_dataLock.lockForWrite();
+	m_keyFrame = keyFrame;
+	m_messages.clear();
+	m_dataLock.unlock();
+
+	m_announcedMessageCount = 0;
+	m_highestMessageIndex = -1;
+	m_outOfOrderMessages.clear();
+	m_partialMessages.clear();
+	m_partialMessagesSize = 0;
+	m_repairRequestTimes.clear();
+
+	emit keyFrameChanged();
+}
+
+
+
+void DemoMulticastReceiver::updateAvailableMessages()
+{
+	if( m_outOfOrderMessages.isEmpty() || m_outOfOrderMessages.firstKey() != m_messages.size() )
+	{
+		return;
+	}
+
+	m_dataLock.lockForWrite();
+
+	while( m_outOfOrderMessages.isEmpty() == false &&
+		   m_outOfOrderMessages.firstKey() == m_messages.size() )
+	{
+		m_messages.append( m_outOfOrderMessages.take( m_messages.size() ) );
+	}
+
+	m_dataLock.unlock();
+
+	emit messagesAvailable();
+}
+
+
+
+void DemoMulticastReceiver::requestRepairs()
+{
+	if( m_keyFrame < 0 )
+	{
+		return;
+	}
+
+	const auto expectedMessageCount = qMax( m_highestMessageIndex + 1, m_announcedMessageCount );
+	const auto now = m_clock.elapsed();
+
+	QVector<int> messageIndexes;
+
+	for( int index = m_messages.size(); index < expectedMessageCount &&
+		 messageIndexes.size() < MaximumRepairRequestSize; ++index )
+	{
+		if( m_outOfOrderMessages.contains( index ) )
+		{
+			continue;
+		}
+
+		const auto lastRequest = m_repairRequestTimes.find( index );
+		if( lastRequest == m_repairRequestTimes.end() )
+		{
+			// give datagrams which are still in flight a chance to arrive
+			m_repairRequestTimes[index] = now - RepairRequestTimeout + RepairGracePeriod;
+			continue;
+		}
+
+		if( now - lastRequest.value() < RepairRequestTimeout )
+		{
+			continue;
+		}
+
+		m_repairRequestTimes[index] = now;
+		messageIndexes.append( index );
+	}
+
+	if( messageIndexes.isEmpty() == false )
+	{
+		emit repairRequired( m_keyFrame, messageIndexes );
+	}
+}
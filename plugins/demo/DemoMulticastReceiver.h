@@ -0,0 +1,145 @@
+/*
+ * DemoMulticastReceiver.h - header file for DemoMulticastReceiver class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QMap>
+#include <QMessageAuthenticationCode>
+#include <QReadWriteLock>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <random>
+
+#include "VeyonCore.h"
+
+// reassembles framebuffer update messages from multicast datagrams and
+// keeps track of messages which have to be repaired via the control connection
+class DemoMulticastReceiver : public QObject
+{
+	Q_OBJECT
+public:
+	using MessageList = QVector<QByteArray>;
+
+	static constexpr int RepairInterval = 100;
+	static constexpr int RepairRequestTimeout = 500;
+	static constexpr int RepairGracePeriod = 200;
+	static constexpr int MaximumRepairRequestSize = 256;
+	static constexpr int MaximumPartialMessages = 256;
+	static constexpr qint64 MaximumPartialMessagesSize = 128*1024*1024;
+
+	DemoMulticastReceiver( const QHostAddress& groupAddress, quint16 port, const QByteArray& key,
+						   QObject* parent = nullptr );
+	~DemoMulticastReceiver() override;
+
+	bool join();
+
+	void setSimulatedPacketLoss( int percent )
+	{
+		m_simulatedPacketLoss = qBound( 0, percent, 100 );
+	}
+
+	QReadWriteLock& dataLock()
+	{
+		return m_dataLock;
+	}
+
+	int keyFrame() const
+	{
+		return m_keyFrame;
+	}
+
+	// contiguous list of messages of the current key frame
+	const MessageList& messages() const
+	{
+		return m_messages;
+	}
+
+	void insertMessage( int keyFrame, int messageIndex, const QByteArray& message );
+
+	qint64 datagramsReceived() const
+	{
+		return m_datagramsReceived;
+	}
+
+	qint64 datagramsDropped() const
+	{
+		return m_datagramsDropped;
+	}
+
+	qint64 datagramsRejected() const
+	{
+		return m_datagramsRejected;
+	}
+
+signals:
+	void keyFrameChanged();
+	void messagesAvailable();
+	void repairRequired( int keyFrame, const QVector<int>& messageIndexes );
+
+private:
+	struct PartialMessage
+	{
+		QByteArray data;
+		QBitArray receivedChunks;
+		int remainingChunks{0};
+	} ;
+
+	void readDatagrams();
+	void processDatagram( const QByteArray& datagram );
+	void removePartialMessage( int messageIndex );
+	void startKeyFrame( int keyFrame );
+	void updateAvailableMessages();
+	void requestRepairs();
+
+	const QHostAddress m_groupAddress;
+	const quint16 m_port;
+	QUdpSocket m_socket{this};
+	QMessageAuthenticationCode m_mac;
+
+	QReadWriteLock m_dataLock{};
+	int m_keyFrame{-1};
+	int m_announcedMessageCount{0};
+	int m_highestMessageIndex{-1};
+	MessageList m_messages{};
+	QMap<int, QByteArray> m_outOfOrderMessages{};
+	QHash<int, PartialMessage> m_partialMessages{};
+	qint64 m_partialMessagesSize{0};
+
+	QTimer m_repairTimer{this};
+	QElapsedTimer m_clock{};
+	QHash<int, qint64> m_repairRequestTimes{};
+
+	int m_simulatedPacketLoss{0};
+	std::minstd_rand m_random{std::random_device{}()};
+	std::uniform_int_distribution<int> m_lossDistribution{0, 99};
+
+	qint64 m_datagramsReceived{0};
+	qint64 m_datagramsDropped{0};
+	qint64 m_datagramsRejected{0};
+
+} ;
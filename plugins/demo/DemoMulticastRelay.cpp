@@ -0,0 +1,334 @@
+/*
+ * DemoMulticastRelay.cpp - implementation of DemoMulticastRelay class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "rfb/rfbproto.h"
+
+#include "DemoConfiguration.h"
+#include "DemoMulticastProtocol.h"
+#include "DemoMulticastReceiver.h"
+#include "DemoMulticastRelay.h"
+#include "DemoServerConnection.h"
+#include "VariantArrayMessage.h"
+
+
+DemoMulticastRelay::DemoMulticastRelay( const QString& host, int port, const DemoAuthentication& authentication,
+										const DemoConfiguration& configuration, QObject* parent ) :
+	QObject( parent ),
+	m_host( host ),
+	m_port( port ),
+	m_authentication( authentication ),
+	m_configuration( configuration )
+{
+	connect( &m_controlSocket, &QTcpSocket::readyRead, this, &DemoMulticastRelay::readControlConnection );
+	connect( &m_controlSocket, &QTcpSocket::disconnected, this, [this]() {
+		if( m_state != State::Running )
+		{
+			fail();
+		}
+		else
+		{
+			vWarning() << "control connection closed - lost messages can no longer be repaired";
+		}
+	} );
+	connect( &m_controlSocket, QOverload<QAbstractSocket::SocketError>::of( &QTcpSocket::error ), this, [this]() {
+		if( m_state != State::Running )
+		{
+			fail();
+		}
+	} );
+
+	m_joinTimeoutTimer.setSingleShot( true );
+	connect( &m_joinTimeoutTimer, &QTimer::timeout, this, [this]() {
+		vWarning() << "timeout while joining multicast group of" << m_host;
+		fail();
+	} );
+
+	connect( &m_localServer, &QTcpServer::newConnection, this, &DemoMulticastRelay::acceptLocalConnections );
+
+	m_repairClock.start();
+}
+
+
+
+DemoMulticastRelay::~DemoMulticastRelay()
+{
+	m_controlSocket.disconnect( this );
+
+	QList<DemoServerConnection *> connections;
+	while( ( connections = findChildren<DemoServerConnection *>() ).isEmpty() == false )
+	{
+		delete connections.front();
+	}
+}
+
+
+
+void DemoMulticastRelay::start()
+{
+	m_state = State::Connecting;
+	m_joinTimeoutTimer.start( JoinTimeout );
+	m_controlSocket.connectToHost( m_host, static_cast<quint16>( m_port ) );
+}
+
+
+
+void DemoMulticastRelay::lockDataForRead()
+{
+	if( m_receiver )
+	{
+		m_receiver->dataLock().lockForRead();
+	}
+}
+
+
+
+void DemoMulticastRelay::unlockData()
+{
+	if( m_receiver )
+	{
+		m_receiver->dataLock().unlock();
+	}
+}
+
+
+
+int DemoMulticastRelay::keyFrame() const
+{
+	return m_receiver ? m_receiver->keyFrame() : -1;
+}
+
+
+
+const DemoFramebufferSource::MessageList& DemoMulticastRelay::framebufferUpdateMessages() const
+{
+	return m_receiver ? m_receiver->messages() : m_emptyMessageList;
+}
+
+
+
+void DemoMulticastRelay::readControlConnection()
+{
+	if( m_state == State::Connecting )
+	{
+		// skip protocol version of demo server and request a control connection
+		if( m_controlSocket.bytesAvailable() < sz_rfbProtocolVersionMsg )
+		{
+			return;
+		}
+
+		m_controlSocket.read( sz_rfbProtocolVersionMsg );
+		m_controlSocket.write( DemoMulticastProtocol::controlConnectionMagic() );
+
+		m_state = State::Authenticating;
+	}
+
+	while( m_state != State::Failed )
+	{
+		VariantArrayMessage message( &m_controlSocket );
+		if( message.isReadyForReceive() == false || message.receive() == false )
+		{
+			break;
+		}
+
+		const auto command = message.read().toInt();
+
+		if( command == DemoMulticastProtocol::Challenge && m_state == State::Authenticating )
+		{
+			VariantArrayMessage joinMessage( &m_controlSocket );
+			joinMessage.write( DemoMulticastProtocol::Join );
+			joinMessage.write( DemoMulticastProtocol::joinResponse( m_authentication.accessToken().toByteArray(),
+																	message.read().toByteArray() ) );
+			joinMessage.send();
+
+			m_state = State::Joining;
+		}
+		else if( command == DemoMulticastProtocol::Welcome && m_state == State::Joining )
+		{
+			const auto serverInitMessage = message.read();
+			const auto groupAddress = message.read();
+			const auto port = message.read();
+			if( handleWelcome( serverInitMessage, groupAddress, port, message.read() ) == false )
+			{
+				fail();
+			}
+		}
+		else if( command == DemoMulticastProtocol::RepairData && m_receiver )
+		{
+			const auto keyFrame = message.read().toInt();
+			const auto messageIndex = message.read().toInt();
+			if( keyFrame == m_outstandingRepairsKeyFrame )
+			{
+				m_outstandingRepairs.remove( messageIndex );
+			}
+			m_receiver->insertMessage( keyFrame, messageIndex, message.read().toByteArray() );
+		}
+		else
+		{
+			vWarning() << "unexpected control command" << command;
+		}
+	}
+}
+
+
+
+bool DemoMulticastRelay::handleWelcome( const QVariant& serverInitMessage, const QVariant& groupAddress,
+										const QVariant& port, const QVariant& nonce )
+{
+	m_serverInitMessage = serverInitMessage.toByteArray();
+
+	m_receiver = new DemoMulticastReceiver( QHostAddress( groupAddress.toString() ),
+											static_cast<quint16>( port.toInt() ),
+											DemoMulticastProtocol::datagramKey( m_authentication.accessToken().toByteArray(),
+																				nonce.toByteArray() ),
+											this );
+	m_receiver->setSimulatedPacketLoss( m_configuration.multicastSimulatedPacketLoss() );
+
+	connect( m_receiver, &DemoMulticastReceiver::repairRequired, this, &DemoMulticastRelay::sendRepairRequest );
+	connect( m_receiver, &DemoMulticastReceiver::keyFrameChanged, this, [this]() {
+		if( m_state == State::WaitingForData )
+		{
+			startLocalServer();
+		}
+	} );
+
+	if( m_receiver->join() == false )
+	{
+		return false;
+	}
+
+	m_state = State::WaitingForData;
+
+	return true;
+}
+
+
+
+void DemoMulticastRelay::sendRepairRequest( int keyFrame, const QVector<int>& messageIndexes )
+{
+	if( keyFrame != m_outstandingRepairsKeyFrame )
+	{
+		// repairs of previous key frames are not served anymore
+		m_outstandingRepairs.clear();
+		m_outstandingRepairsKeyFrame = keyFrame;
+	}
+
+	expireOutstandingRepairs();
+
+	const auto now = m_repairClock.elapsed();
+
+	// coalesce with repairs still in flight and don't queue up more data on the
+	// demo server than we can receive in time - the receiver asks again later
+	QVariantList indexes;
+	for( const auto index : messageIndexes )
+	{
+		if( m_outstandingRepairs.size() >= MaximumOutstandingRepairs )
+		{
+			break;
+		}
+
+		if( m_outstandingRepairs.contains( index ) == false )
+		{
+			m_outstandingRepairs[index] = now;
+			indexes.append( index );
+		}
+	}
+
+	if( indexes.isEmpty() )
+	{
+		return;
+	}
+
+	VariantArrayMessage repairRequest( &m_controlSocket );
+	repairRequest.write( DemoMulticastProtocol::RepairRequest );
+	repairRequest.write( keyFrame );
+	repairRequest.write( indexes );
+	repairRequest.send();
+}
+
+
+
+void DemoMulticastRelay::expireOutstandingRepairs()
+{
+	const auto now = m_repairClock.elapsed();
+
+	// the demo server skips messages it can't serve anymore so don't wait for them forever
+	for( auto it = m_outstandingRepairs.begin(); it != m_outstandingRepairs.end(); )
+	{
+		if( now - it.value() >= OutstandingRepairTimeout )
+		{
+			it = m_outstandingRepairs.erase( it );
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+
+
+void DemoMulticastRelay::startLocalServer()
+{
+	m_joinTimeoutTimer.stop();
+
+	if( m_localServer.listen( QHostAddress::LocalHost, 0 ) == false )
+	{
+		vCritical() << "could not listen on local relay port";
+		fail();
+		return;
+	}
+
+	m_state = State::Running;
+
+	vDebug() << "receiving demo via multicast from" << m_host;
+
+	emit ready( m_localServer.serverPort() );
+}
+
+
+
+void DemoMulticastRelay::acceptLocalConnections()
+{
+	while( m_localServer.hasPendingConnections() )
+	{
+		new DemoServerConnection( m_authentication, m_localServer.nextPendingConnection(), this, this );
+	}
+}
+
+
+
+void DemoMulticastRelay::fail()
+{
+	if( m_state == State::Failed )
+	{
+		return;
+	}
+
+	m_state = State::Failed;
+	m_joinTimeoutTimer.stop();
+	m_controlSocket.disconnect( this );
+	m_controlSocket.abort();
+
+	emit failed();
+}
@@ -0,0 +1,112 @@
+/*
+ * DemoMulticastRelay.h - header file for DemoMulticastRelay class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include "DemoFramebufferSource.h"
+
+class DemoAuthentication;
+class DemoMulticastReceiver;
+
+// receives framebuffer updates of a demo server via multicast and serves them
+// to the local VNC view through a demo server bound to the loopback interface
+class DemoMulticastRelay : public QObject, public DemoFramebufferSource
+{
+	Q_OBJECT
+public:
+	static constexpr int JoinTimeout = 3000;
+	static constexpr int MaximumOutstandingRepairs = 64;
+	static constexpr int OutstandingRepairTimeout = 2000;
+
+	DemoMulticastRelay( const QString& host, int port, const DemoAuthentication& authentication,
+						const DemoConfiguration& configuration, QObject* parent = nullptr );
+	~DemoMulticastRelay() override;
+
+	void start();
+
+	const DemoConfiguration& configuration() const override
+	{
+		return m_configuration;
+	}
+
+	const QByteArray& serverInitMessage() const override
+	{
+		return m_serverInitMessage;
+	}
+
+	void lockDataForRead() override;
+	void unlockData() override;
+
+	int keyFrame() const override;
+	const MessageList& framebufferUpdateMessages() const override;
+
+signals:
+	void ready( quint16 localPort );
+	void failed();
+
+private:
+	enum class State {
+		Connecting,
+		Authenticating,
+		Joining,
+		WaitingForData,
+		Running,
+		Failed
+	};
+
+	void readControlConnection();
+	bool handleWelcome( const QVariant& serverInitMessage, const QVariant& groupAddress,
+						const QVariant& port, const QVariant& nonce );
+	void sendRepairRequest( int keyFrame, const QVector<int>& messageIndexes );
+	void expireOutstandingRepairs();
+	void startLocalServer();
+	void acceptLocalConnections();
+	void fail();
+
+	const QString m_host;
+	const int m_port;
+	const DemoAuthentication& m_authentication;
+	const DemoConfiguration& m_configuration;
+
+	State m_state{State::Connecting};
+	QTcpSocket m_controlSocket{this};
+	QTimer m_joinTimeoutTimer{this};
+	QTcpServer m_localServer{this};
+
+	QByteArray m_serverInitMessage{};
+	DemoMulticastReceiver* m_receiver{nullptr};
+	const MessageList m_emptyMessageList{};
+
+	// repairs requested but not received yet, mapped to the time of the request
+	QHash<int, qint64> m_outstandingRepairs{};
+	int m_outstandingRepairsKeyFrame{-1};
+	QElapsedTimer m_repairClock{};
+
+} ;
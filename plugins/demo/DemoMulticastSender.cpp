@@ -0,0 +1,180 @@
+/*
+ * DemoMulticastSender.cpp - implementation of DemoMulticastSender class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include "DemoMulticastProtocol.h"
+#include "DemoMulticastSender.h"
+
+
+DemoMulticastSender::DemoMulticastSender( const QHostAddress& groupAddress, quint16 port, int ttl, const QByteArray& key,
+										  int rateLimit, QObject* parent ) :
+	QObject( parent ),
+	m_groupAddress( groupAddress ),
+	m_port( port ),
+	m_mac( QCryptographicHash::Sha256, key ),
+	m_bytesPerSecond( qMax( 0, rateLimit ) * qint64(1000*1000/8) )
+{
+	m_tokenClock.start();
+
+	m_pacingTimer.setSingleShot( true );
+	m_pacingTimer.setTimerType( Qt::PreciseTimer );
+	connect( &m_pacingTimer, &QTimer::timeout, this, &DemoMulticastSender::sendQueuedDatagrams );
+
+	if( m_groupAddress.isMulticast() == false )
+	{
+		vCritical() << "invalid multicast group address" << m_groupAddress;
+		return;
+	}
+
+	if( m_socket.bind( QHostAddress::AnyIPv4, 0 ) == false )
+	{
+		vCritical() << "could not bind multicast socket:" << m_socket.errorString();
+		return;
+	}
+
+	m_socket.setSocketOption( QAbstractSocket::MulticastTtlOption, ttl );
+	m_socket.setSocketOption( QAbstractSocket::MulticastLoopbackOption, 1 );
+	m_socket.setSocketOption( QAbstractSocket::SendBufferSizeSocketOption, DemoMulticastProtocol::SocketBufferSize );
+
+	m_valid = true;
+}
+
+
+
+void DemoMulticastSender::sendMessage( int keyFrame, int messageIndex, const QByteArray& message )
+{
+	if( m_valid == false )
+	{
+		return;
+	}
+
+	if( message.size() > DemoMulticastProtocol::MaximumMessageSize )
+	{
+		// receivers will request this message through the control connection
+		vWarning() << "message too large for multicast distribution:" << message.size();
+		return;
+	}
+
+	if( keyFrame != m_queuedKeyFrame )
+	{
+		// datagrams of previous key frames are useless to receivers which switch to the new key frame
+		m_datagramsDropped += m_queue.size();
+		m_queue.clear();
+		m_queueSize = 0;
+		m_queuedKeyFrame = keyFrame;
+	}
+
+	const auto chunkSize = DemoMulticastProtocol::MaximumChunkSize;
+	const auto chunkCount = DemoMulticastProtocol::chunkCount( message.size() );
+
+	DemoMulticastProtocol::DatagramHeader header;
+	header.keyFrame = static_cast<quint32>( keyFrame );
+	header.messageIndex = static_cast<quint32>( messageIndex );
+	header.messageSize = static_cast<quint32>( message.size() );
+	header.chunkCount = static_cast<quint16>( chunkCount );
+
+	for( int chunk = 0; chunk < chunkCount; ++chunk )
+	{
+		const auto offset = chunk * chunkSize;
+		header.chunkIndex = static_cast<quint16>( chunk );
+		sendDatagram( DemoMulticastProtocol::encodeDatagram( m_mac, header, message.constData() + offset,
+															 qMin( chunkSize, message.size() - offset ) ) );
+	}
+}
+
+
+
+void DemoMulticastSender::announce( int keyFrame, int messageCount )
+{
+	if( m_valid == false )
+	{
+		return;
+	}
+
+	DemoMulticastProtocol::DatagramHeader header;
+	header.keyFrame = static_cast<quint32>( keyFrame );
+	header.messageIndex = DemoMulticastProtocol::AnnounceMessageIndex;
+	header.messageSize = static_cast<quint32>( messageCount );
+
+	sendDatagram( DemoMulticastProtocol::encodeDatagram( m_mac, header, nullptr, 0 ) );
+}
+
+
+
+void DemoMulticastSender::sendDatagram( const QByteArray& datagram )
+{
+	if( m_queueSize + datagram.size() > MaximumQueueSize )
+	{
+		// lost datagrams are repaired by receivers through the control connection
+		++m_datagramsDropped;
+		return;
+	}
+
+	m_queue.enqueue( datagram );
+	m_queueSize += datagram.size();
+
+	if( m_pacingTimer.isActive() == false )
+	{
+		sendQueuedDatagrams();
+	}
+}
+
+
+
+void DemoMulticastSender::sendQueuedDatagrams()
+{
+	refillTokens();
+
+	while( m_queue.isEmpty() == false &&
+		   ( m_bytesPerSecond <= 0 || m_tokens >= m_queue.head().size() ) )
+	{
+		const auto datagram = m_queue.dequeue();
+		m_queueSize -= datagram.size();
+		if( m_bytesPerSecond > 0 )
+		{
+			m_tokens -= datagram.size();
+		}
+
+		if( m_socket.writeDatagram( datagram, m_groupAddress, m_port ) == datagram.size() )
+		{
+			++m_datagramsSent;
+		}
+		// lost datagrams are repaired by receivers through the control connection
+	}
+
+	if( m_queue.isEmpty() == false )
+	{
+		m_pacingTimer.start( PacingInterval );
+	}
+}
+
+
+
+void DemoMulticastSender::refillTokens()
+{
+	// the bucket is full after a second anyway so don't let the product below overflow
+	const auto elapsed = qMin<qint64>( m_tokenClock.nsecsElapsed(), 1000*1000*1000 );
+	m_tokenClock.restart();
+
+	m_tokens = qMin<qint64>( MaximumBurstSize, m_tokens + elapsed * m_bytesPerSecond / ( 1000*1000*1000 ) );
+}
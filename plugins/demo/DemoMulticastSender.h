@@ -0,0 +1,99 @@
+/*
+ * DemoMulticastSender.h - header file for DemoMulticastSender class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QMessageAuthenticationCode>
+#include <QQueue>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include "VeyonCore.h"
+
+class DemoMulticastSender : public QObject
+{
+	Q_OBJECT
+public:
+	static constexpr int PacingInterval = 1;
+	static constexpr int MaximumBurstSize = 64*1024;
+	static constexpr int MaximumQueueSize = 32*1024*1024;
+
+	// rateLimit is given in MBit/s, 0 disables pacing
+	DemoMulticastSender( const QHostAddress& groupAddress, quint16 port, int ttl, const QByteArray& key,
+						 int rateLimit = 0, QObject* parent = nullptr );
+	~DemoMulticastSender() override = default;
+
+	bool isValid() const
+	{
+		return m_valid;
+	}
+
+	const QHostAddress& groupAddress() const
+	{
+		return m_groupAddress;
+	}
+
+	quint16 port() const
+	{
+		return m_port;
+	}
+
+	void sendMessage( int keyFrame, int messageIndex, const QByteArray& message );
+	void announce( int keyFrame, int messageCount );
+
+	qint64 datagramsSent() const
+	{
+		return m_datagramsSent;
+	}
+
+	qint64 datagramsDropped() const
+	{
+		return m_datagramsDropped;
+	}
+
+private:
+	void sendDatagram( const QByteArray& datagram );
+	void sendQueuedDatagrams();
+	void refillTokens();
+
+	const QHostAddress m_groupAddress;
+	const quint16 m_port;
+	QUdpSocket m_socket{this};
+	QMessageAuthenticationCode m_mac;
+	bool m_valid{false};
+	qint64 m_datagramsSent{0};
+	qint64 m_datagramsDropped{0};
+
+	// token bucket so key frames don't flood the network and overrun switch and receiver buffers
+	const qint64 m_bytesPerSecond;
+	qint64 m_tokens{MaximumBurstSize};
+	QElapsedTimer m_tokenClock{};
+	QTimer m_pacingTimer{this};
+	QQueue<QByteArray> m_queue{};
+	int m_queueSize{0};
+	int m_queuedKeyFrame{-1};
+
+} ;
@@ -28,7 +28,11 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 
+#include "DemoAuthentication.h"
 #include "DemoConfiguration.h"
+#include "DemoMulticastControlConnection.h"
+#include "DemoMulticastProtocol.h"
+#include "DemoMulticastSender.h"
 #include "DemoServer.h"
 #include "DemoServerConnection.h"
 #include "VeyonConfiguration.h"
@@ -45,7 +49,19 @@ DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, co
 	m_vncServerPort( vncServerPort ),
 	m_tcpServer( new QTcpServer( this ) ),
 	m_vncServerSocket( new QTcpSocket( this ) ),
-	m_vncClientProtocol( new VncClientProtocol( m_vncServerSocket, vncServerPassword ) )
+	m_vncClientProtocol( new VncClientProtocol( m_vncServerSocket, vncServerPassword ) ),
+	m_messagesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_demo_server_messages_total"),
+													 QStringLiteral("Framebuffer update messages received from the VNC server") ) ),
+	m_bytesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_demo_server_bytes_total"),
+												  QStringLiteral("Framebuffer update data received from the VNC server") ) ),
+	m_keyFramesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_demo_server_key_frames_total"),
+													  QStringLiteral("Key frames started by the demo server") ) ),
+	m_queuedMessagesGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_demo_server_queued_messages"),
+													   QStringLiteral("Framebuffer update messages in the current key frame") ) ),
+	m_queuedBytesGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_demo_server_queued_bytes"),
+													QStringLiteral("Size of framebuffer update messages in the current key frame") ) ),
+	m_clientsGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_demo_server_clients"),
+												QStringLiteral("Currently connected demo clients") ) )
 {
 	connect( m_tcpServer, &QTcpServer::newConnection, this, &DemoServer::acceptPendingConnections );
 
@@ -60,6 +76,31 @@ DemoServer::DemoServer( int vncServerPort, const Password& vncServerPassword, co
 		return;
 	}
 
+	if( m_configuration.multicastEnabled() )
+	{
+		// datagrams of previous demo servers must not be accepted
+		m_multicastNonce = CryptoCore::generateChallenge();
+
+		m_multicastSender = new DemoMulticastSender( QHostAddress( m_configuration.multicastGroupAddress() ),
+													 static_cast<quint16>( m_configuration.multicastPort() ),
+													 m_configuration.multicastTtl(),
+													 DemoMulticastProtocol::datagramKey( m_authentication.accessToken().toByteArray(),
+																						 m_multicastNonce ),
+													 m_configuration.multicastRateLimit(),
+													 this );
+		if( m_multicastSender->isValid() == false )
+		{
+			vWarning() << "multicast distribution not available - serving clients via TCP only";
+			delete m_multicastSender;
+			m_multicastSender = nullptr;
+		}
+		else
+		{
+			connect( &m_multicastAnnounceTimer, &QTimer::timeout, this, &DemoServer::announceMulticastKeyFrame );
+			m_multicastAnnounceTimer.start( MulticastAnnounceInterval );
+		}
+	}
+
 	m_framebufferUpdateTimer.start( m_configuration.framebufferUpdateInterval() );
 
 	reconnectToVncServer();
@@ -81,6 +122,12 @@ DemoServer::~DemoServer()
 		delete l.front();
 	}
 
+	QList<DemoMulticastControlConnection *> controlConnections;
+	while( !( controlConnections = findChildren<DemoMulticastControlConnection *>() ).isEmpty() )
+	{
+		delete controlConnections.front();
+	}
+
 	vDebug() << "deleting server socket";
 	delete m_vncServerSocket;
 
@@ -127,12 +174,39 @@ void DemoServer::acceptPendingConnections()
 
 	while( m_tcpServer->hasPendingConnections() )
 	{
-		new DemoServerConnection( m_authentication, m_tcpServer->nextPendingConnection(), this );
+		auto connection = new DemoServerConnection( m_authentication, m_tcpServer->nextPendingConnection(), this, this );
+		connect( connection, &DemoServerConnection::controlConnectionRequested,
+				 this, &DemoServer::acceptControlConnection );
+
+		auto clientsGauge = &m_clientsGauge;
+		clientsGauge->add( 1 );
+		connect( connection, &QObject::destroyed, this, [clientsGauge]() { clientsGauge->add( -1 ); } );
 	}
 }
 
 
 
+void DemoServer::acceptControlConnection( QTcpSocket* socket )
+{
+	new DemoMulticastControlConnection( m_authentication, socket, this );
+}
+
+
+
+void DemoServer::announceMulticastKeyFrame()
+{
+	// allows receivers to detect lost messages at the end of the queue
+	// and to switch to a new key frame even if all of its datagrams got lost
+	m_dataLock.lockForRead();
+	const auto keyFrame = m_keyFrame;
+	const auto messageCount = m_framebufferUpdateMessages.size();
+	m_dataLock.unlock();
+
+	m_multicastSender->announce( keyFrame, messageCount );
+}
+
+
+
 void DemoServer::reconnectToVncServer()
 {
 	m_vncClientProtocol->start();
@@ -241,15 +315,32 @@ void DemoServer::enqueueFramebufferUpdateMessage( const QByteArray& message )
 		m_keyFrameTimer.restart();
 		++m_keyFrame;
 
+		m_keyFramesCounter.increment();
+
 		m_framebufferUpdateMessages.clear();
 	}
 
 	m_framebufferUpdateMessages.append( message );
 
+	const auto keyFrame = m_keyFrame;
+	const auto messageIndex = m_framebufferUpdateMessages.size() - 1;
+
 	m_dataLock.unlock();
 
+	if( m_multicastSender )
+	{
+		m_multicastSender->sendMessage( keyFrame, messageIndex, message );
+	}
+
+	const auto currentQueueSize = framebufferUpdateMessageQueueSize();
+
+	m_messagesCounter.increment();
+	m_bytesCounter.increment( static_cast<quint64>( message.size() ) );
+	m_queuedMessagesGauge.set( messageIndex + 1 );
+	m_queuedBytesGauge.set( currentQueueSize );
+
 	// we're about to reach memory limits?
-	if( framebufferUpdateMessageQueueSize() > m_memoryLimit )
+	if( currentQueueSize > m_memoryLimit )
 	{
 		// then request a full update so we can clear our queue
 		m_requestFullFramebufferUpdate = true;
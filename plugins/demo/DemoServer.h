@@ -30,50 +30,65 @@
 #include <QTimer>
 
 #include "CryptoCore.h"
+#include "DemoFramebufferSource.h"
+#include "MetricsRegistry.h"
 
 class DemoAuthentication;
-class DemoConfiguration;
+class DemoMulticastSender;
 class QTcpServer;
 class QTcpSocket;
 class VncClientProtocol;
 
-class DemoServer : public QObject
+class DemoServer : public QObject, public DemoFramebufferSource
 {
 	Q_OBJECT
 public:
 	using Password = CryptoCore::PlaintextPassword;
-	using MessageList = QVector<QByteArray>;
+
+	static constexpr int MulticastAnnounceInterval = 250;
 
 	DemoServer( int vncServerPort, const Password& vncServerPassword, const DemoAuthentication& authentication,
 				const DemoConfiguration& configuration, QObject *parent );
 	~DemoServer() override;
 
-	const DemoConfiguration& configuration() const
+	const DemoConfiguration& configuration() const override
 	{
 		return m_configuration;
 	}
 
-	const QByteArray& serverInitMessage() const;
+	const QByteArray& serverInitMessage() const override;
 
-	void lockDataForRead();
+	void lockDataForRead() override;
 
-	void unlockData()
+	void unlockData() override
 	{
 		m_dataLock.unlock();
 	}
 
-	int keyFrame() const
+	int keyFrame() const override
 	{
 		return m_keyFrame;
 	}
 
-	const MessageList& framebufferUpdateMessages() const
+	const MessageList& framebufferUpdateMessages() const override
 	{
 		return m_framebufferUpdateMessages;
 	}
 
+	const DemoMulticastSender* multicastSender() const
+	{
+		return m_multicastSender;
+	}
+
+	const QByteArray& multicastNonce() const
+	{
+		return m_multicastNonce;
+	}
+
 private:
 	void acceptPendingConnections();
+	void acceptControlConnection( QTcpSocket* socket );
+	void announceMulticastKeyFrame();
 	void reconnectToVncServer();
 	void readFromVncServer();
 	void requestFramebufferUpdate();
@@ -97,6 +112,9 @@ private:
 	QTcpServer* m_tcpServer;
 	QTcpSocket* m_vncServerSocket;
 	VncClientProtocol* m_vncClientProtocol;
+	DemoMulticastSender* m_multicastSender{nullptr};
+	QByteArray m_multicastNonce{};
+	QTimer m_multicastAnnounceTimer{this};
 
 	QReadWriteLock m_dataLock{};
 	QTimer m_framebufferUpdateTimer{this};
@@ -107,4 +125,11 @@ private:
 	int m_keyFrame{0};
 	MessageList m_framebufferUpdateMessages{};
 
+	MetricsRegistry::Counter& m_messagesCounter;
+	MetricsRegistry::Counter& m_bytesCounter;
+	MetricsRegistry::Counter& m_keyFramesCounter;
+	MetricsRegistry::Gauge& m_queuedMessagesGauge;
+	MetricsRegistry::Gauge& m_queuedBytesGauge;
+	MetricsRegistry::Gauge& m_clientsGauge;
+
 } ;
@@ -28,15 +28,17 @@
 #include <QTcpSocket>
 
 #include "DemoConfiguration.h"
-#include "DemoServer.h"
+#include "DemoFramebufferSource.h"
+#include "DemoMulticastProtocol.h"
 #include "DemoServerConnection.h"
 
 
 DemoServerConnection::DemoServerConnection( const DemoAuthentication& authentication,
 											QTcpSocket* socket,
-											DemoServer* demoServer ) :
-	QObject( demoServer ),
-	m_demoServer( demoServer ),
+											DemoFramebufferSource* framebufferSource,
+											QObject* parent ) :
+	QObject( parent ),
+	m_framebufferSource( framebufferSource ),
 	m_socket( socket ),
 	m_serverProtocol( authentication, m_socket, &m_vncServerClient ),
 	m_rfbClientToServerMessageSizes( {
@@ -45,12 +47,12 @@ DemoServerConnection::DemoServerConnection( const DemoAuthentication& authentica
 									 std::pair<int, int>( rfbKeyEvent, sz_rfbKeyEventMsg ),
 									 std::pair<int, int>( rfbPointerEvent, sz_rfbPointerEventMsg ),
 									 } ),
-	m_framebufferUpdateInterval( m_demoServer->configuration().framebufferUpdateInterval() )
+	m_framebufferUpdateInterval( m_framebufferSource->configuration().framebufferUpdateInterval() )
 {
 	connect( m_socket, &QTcpSocket::readyRead, this, &DemoServerConnection::processClient );
 	connect( m_socket, &QTcpSocket::disconnected, this, &DemoServerConnection::deleteLater );
 
-	m_serverProtocol.setServerInitMessage( m_demoServer->serverInitMessage() );
+	m_serverProtocol.setServerInitMessage( m_framebufferSource->serverInitMessage() );
 	m_serverProtocol.start();
 }
 
@@ -65,6 +67,16 @@ DemoServerConnection::~DemoServerConnection()
 
 void DemoServerConnection::processClient()
 {
+	if( m_socket == nullptr )
+	{
+		return;
+	}
+
+	if( m_serverProtocol.state() == VncServerProtocol::Protocol && handOverControlConnection() )
+	{
+		return;
+	}
+
 	if( m_serverProtocol.state() != VncServerProtocol::Running )
 	{
 		while( m_serverProtocol.read() )
@@ -86,6 +98,31 @@ void DemoServerConnection::processClient()
 
 
 
+bool DemoServerConnection::handOverControlConnection()
+{
+	// multicast relays send a magic string instead of the RFB protocol version
+	const auto magic = DemoMulticastProtocol::controlConnectionMagic();
+
+	if( m_socket->bytesAvailable() < magic.size() || m_socket->peek( magic.size() ) != magic )
+	{
+		return false;
+	}
+
+	m_socket->read( magic.size() );
+	m_socket->disconnect( this );
+
+	auto socket = m_socket;
+	m_socket = nullptr;
+
+	emit controlConnectionRequested( socket );
+
+	deleteLater();
+
+	return true;
+}
+
+
+
 bool DemoServerConnection::receiveClientMessage()
 {
 	char messageType = 0;
@@ -142,17 +179,17 @@ bool DemoServerConnection::receiveClientMessage()
 
 void DemoServerConnection::sendFramebufferUpdate()
 {
-	m_demoServer->lockDataForRead();
+	m_framebufferSource->lockDataForRead();
 
-	const auto& framebufferUpdateMessages = m_demoServer->framebufferUpdateMessages();
+	const auto& framebufferUpdateMessages = m_framebufferSource->framebufferUpdateMessages();
 
 	const int framebufferUpdateMessageCount = framebufferUpdateMessages.count();
 
-	if( m_demoServer->keyFrame() != m_keyFrame ||
+	if( m_framebufferSource->keyFrame() != m_keyFrame ||
 			m_framebufferUpdateMessageIndex > framebufferUpdateMessageCount )
 	{
 		m_framebufferUpdateMessageIndex = 0;
-		m_keyFrame = m_demoServer->keyFrame();
+		m_keyFrame = m_framebufferSource->keyFrame();
 	}
 
 	bool sentUpdates = false;
@@ -162,7 +199,7 @@ void DemoServerConnection::sendFramebufferUpdate()
 		sentUpdates = true;
 	}
 
-	m_demoServer->unlockData();
+	m_framebufferSource->unlockData();
 
 	if( sentUpdates == false )
 	{
@@ -24,9 +24,11 @@
 
 #pragma once
 
+#include <QTcpSocket>
+
 #include "DemoServerProtocol.h"
 
-class DemoServer;
+class DemoFramebufferSource;
 
 // clazy:excludeall=ctor-missing-parent-argument
 
@@ -39,16 +41,21 @@ class DemoServerConnection : public QObject
 public:
 	static constexpr int ProtocolRetryTime = 250;
 
-	DemoServerConnection( const DemoAuthentication& authentication, QTcpSocket* socket, DemoServer* demoServer );
+	DemoServerConnection( const DemoAuthentication& authentication, QTcpSocket* socket,
+						  DemoFramebufferSource* framebufferSource, QObject* parent );
 	~DemoServerConnection() override;
 
+signals:
+	void controlConnectionRequested( QTcpSocket* socket );
+
 private:
 	void processClient();
+	bool handOverControlConnection();
 	void sendFramebufferUpdate();
 
 	bool receiveClientMessage();
 
-	DemoServer* m_demoServer;
+	DemoFramebufferSource* m_framebufferSource;
 
 	QTcpSocket* m_socket;
 
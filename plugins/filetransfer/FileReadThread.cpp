@@ -25,9 +25,11 @@
 #include "FileReadThread.h"
 
 
-FileReadThread::FileReadThread( const QString& fileName, QObject* parent ) :
+FileReadThread::FileReadThread( const QString& fileName, qint64 chunkSize, int readAheadChunkCount, QObject* parent ) :
 	QObject( parent ),
-	m_fileName( fileName )
+	m_fileName( fileName ),
+	m_chunkSize( chunkSize ),
+	m_readAheadChunkCount( qMax( 1, readAheadChunkCount ) )
 {
 	m_timer->moveToThread( m_thread );
 	m_thread->start();
@@ -41,26 +43,32 @@ FileReadThread::FileReadThread( const QString& fileName, QObject* parent ) :
 FileReadThread::~FileReadThread()
 {
 	m_thread->quit();
+
+	// make sure no queued read operation accesses this object after destruction
+	m_thread->wait();
 }
 
 
 
 bool FileReadThread::start()
 {
-	if( QFile( m_fileName ).open( QFile::ReadOnly ) == false )
+	QFile file( m_fileName );
+	if( file.open( QFile::ReadOnly ) == false )
 	{
 		return false;
 	}
 
-	m_timer->singleShot( 0, this, [this]() {
+	m_mutex.lock();
+	m_fileSize = file.size();
+	m_mutex.unlock();
+
+	// open file and fill read-ahead queue inside the reader thread
+	QTimer::singleShot( 0, m_timer, [this]() {
 		m_file = new QFile( m_fileName );
 		m_file->open( QFile::ReadOnly );
 		connect( m_thread, &QThread::finished, m_file, &QObject::deleteLater );
 
-		m_mutex.lock();
-		m_filePos = 0;
-		m_fileSize = m_file->size();
-		m_mutex.unlock();
+		readChunks();
 	} );
 
 	return true;
@@ -68,53 +76,77 @@ bool FileReadThread::start()
 
 
 
-QByteArray FileReadThread::currentChunk()
+bool FileReadThread::isChunkReady()
 {
 	QMutexLocker lock( &m_mutex );
-	return m_currentChunk;
+	return m_chunks.isEmpty() == false;
 }
 
 
 
-void FileReadThread::readNextChunk( qint64 chunkSize )
+QByteArray FileReadThread::takeChunk()
 {
 	m_mutex.lock();
-	m_chunkReady = false;
+
+	if( m_chunks.isEmpty() )
+	{
+		m_mutex.unlock();
+		return {};
+	}
+
+	const auto chunk = m_chunks.dequeue();
+	m_takenBytes += chunk.size();
+
 	m_mutex.unlock();
 
-	m_timer->singleShot( 0, this, [this, chunkSize]() {
-		if( m_file )
-		{
-			const auto chunk = m_file->read( chunkSize );
-			m_mutex.lock();
-			m_currentChunk = chunk;
-			m_chunkReady = true;
-			m_filePos = m_file->pos();
-			m_mutex.unlock();
-		}
-	} );
+	// refill read-ahead queue
+	QTimer::singleShot( 0, m_timer, [this]() { readChunks(); } );
+
+	return chunk;
 }
 
 
 
-bool FileReadThread::isChunkReady()
+bool FileReadThread::atEnd()
 {
 	QMutexLocker lock( &m_mutex );
-	return m_chunkReady;
+	return m_readFinished && m_chunks.isEmpty();
 }
 
 
 
-bool FileReadThread::atEnd()
+int FileReadThread::progress()
 {
 	QMutexLocker lock( &m_mutex );
-	return m_filePos >= m_fileSize;
+	return m_fileSize > 0 ? static_cast<int>( m_takenBytes * 100 / m_fileSize ) : 0;
 }
 
 
 
-int FileReadThread::progress()
+void FileReadThread::readChunks()
 {
-	QMutexLocker lock( &m_mutex );
-	return m_fileSize > 0 ? static_cast<int>( m_filePos * 100 / m_fileSize ) : 0;
+	if( m_file == nullptr )
+	{
+		return;
+	}
+
+	m_mutex.lock();
+
+	while( m_readFinished == false && m_chunks.size() < m_readAheadChunkCount )
+	{
+		// do not block consumers while reading from disk
+		m_mutex.unlock();
+		const auto chunk = m_file->read( m_chunkSize ); // Flawfinder: ignore
+		const auto finished = chunk.isEmpty() || m_file->atEnd();
+		m_mutex.lock();
+
+		if( chunk.isEmpty() == false )
+		{
+			m_chunks.enqueue( chunk );
+		}
+
+		m_readFinished = finished;
+	}
+
+	m_mutex.unlock();
 }
@@ -26,36 +26,42 @@
 
 #include <QFile>
 #include <QMutex>
+#include <QQueue>
 #include <QTimer>
 #include <QThread>
 
-class FileReadThread : public QObject
+#include "FileReader.h"
+
+class FileReadThread : public QObject, public FileReader
 {
 	Q_OBJECT
 public:
-	explicit FileReadThread( const QString& fileName, QObject* parent = nullptr );
+	FileReadThread( const QString& fileName, qint64 chunkSize, int readAheadChunkCount, QObject* parent = nullptr );
 	~FileReadThread() override;
 
-	bool start();
+	bool start() override;
 
-	QByteArray currentChunk();
-	void readNextChunk( qint64 chunkSize );
-	bool isChunkReady();
+	bool isChunkReady() override;
+	QByteArray takeChunk() override;
 
-	bool atEnd();
-	int progress();
+	bool atEnd() override;
+	int progress() override;
 
 private:
+	void readChunks();
+
 	QMutex m_mutex{};
 	QThread* m_thread{new QThread};
 	QFile* m_file{nullptr};
-	QByteArray m_currentChunk{};
+	QQueue<QByteArray> m_chunks{};
 
 	QTimer* m_timer{new QTimer};
 
-	QString m_fileName;
-	bool m_chunkReady{false};
-	qint64 m_filePos{0};
+	const QString m_fileName;
+	const qint64 m_chunkSize;
+	const int m_readAheadChunkCount;
+	bool m_readFinished{false};
+	qint64 m_takenBytes{0};
 	qint64 m_fileSize{0};
 
 };
@@ -27,21 +27,30 @@
 #include "FileReadThread.h"
 #include "FileTransferController.h"
 #include "FileTransferPlugin.h"
+#include "MappedFileReader.h"
 
 
-FileTransferController::FileTransferController( FileTransferPlugin* plugin ) :
+FileTransferController::FileTransferController( FileTransferPlugin* plugin,
+												const FileTransferConfiguration& configuration ) :
 	QObject( plugin ),
-	m_plugin( plugin )
+	m_plugin( plugin ),
+	m_configuration( configuration )
 {
-	m_processTimer.setInterval( ProcessInterval );
-	connect( &m_processTimer, &QTimer::timeout, this, &FileTransferController::process );
+	// sending is driven by acknowledgements of the clients, so only wait for data still being read
+	// from disk or for clients not responding anymore
+	m_readTimer.setSingleShot( true );
+	m_readTimer.setInterval( ReadRetryInterval );
+	connect( &m_readTimer, &QTimer::timeout, this, &FileTransferController::process );
+
+	m_stallTimer.setSingleShot( true );
+	connect( &m_stallTimer, &QTimer::timeout, this, &FileTransferController::deferStalledInterfaces );
 }
 
 
 
 FileTransferController::~FileTransferController()
 {
-	delete m_fileReadThread;
+	delete m_fileReader;
 }
 
 
@@ -75,9 +84,14 @@ void FileTransferController::start()
 	{
 		m_currentFileIndex = 0;
 		m_fileState = FileStateOpen;
-		m_processTimer.start();
+		m_activeInterfaces = m_interfaces;
+		m_deferredInterfaces.clear();
+		m_retrying = false;
+		m_running = true;
 
 		emit started();
+
+		process();
 	}
 }
 
@@ -87,15 +101,21 @@ void FileTransferController::stop()
 {
 	if( isRunning() )
 	{
-		m_processTimer.stop();
+		m_running = false;
+		m_readTimer.stop();
+		m_stallTimer.stop();
 
-		if( m_fileReadThread )
+		if( m_fileReader )
 		{
-			delete m_fileReadThread;
-			m_fileReadThread = nullptr;
+			delete m_fileReader;
+			m_fileReader = nullptr;
 		}
 
-		m_plugin->sendCancelMessage( m_currentTransferId, m_interfaces );
+		// deferred computers already have been told to cancel
+		m_plugin->sendCancelMessage( m_currentTransferId, m_activeInterfaces );
+
+		m_activeInterfaces.clear();
+		m_deferredInterfaces.clear();
 	}
 
 	emit finished();
@@ -119,54 +139,110 @@ int FileTransferController::currentFileIndex() const
 
 bool FileTransferController::isRunning() const
 {
-	return m_processTimer.isActive();
+	return m_running;
+}
+
+
+
+void FileTransferController::acknowledgeChunks( const ComputerControlInterface::Pointer& controlInterface,
+												QUuid transferId, int chunkCount )
+{
+	if( m_running == false || transferId != m_currentTransferId )
+	{
+		return;
+	}
+
+	auto& acknowledgedChunks = m_acknowledgedChunks[controlInterface.data()];
+	acknowledgedChunks = qMax( acknowledgedChunks, chunkCount );
+
+	if( m_fileState == FileStateTransferring )
+	{
+		process();
+	}
 }
 
 
 
 void FileTransferController::process()
 {
-	switch( m_fileState )
+	while( m_running )
 	{
-	case FileStateOpen:
-		if( openFile() )
-		{
-			m_fileState = FileStateTransferring;
-		}
-		else
+		switch( m_fileState )
 		{
-			m_fileState = FileStateFinished;
-		}
-		break;
+		case FileStateOpen:
+			m_fileState = openFile() ? FileStateTransferring : FileStateFinished;
+			break;
 
-	case FileStateTransferring:
-		if( transferFile() )
-		{
+		case FileStateTransferring:
+			if( transferFile() == false )
+			{
+				// continue once clients acknowledged chunks or more data has been read
+				updateProgress();
+				return;
+			}
 			m_fileState = FileStateFinished;
-		}
-		break;
+			break;
 
-	case FileStateFinished:
-		finishFile();
+		case FileStateFinished:
+			finishFile();
 
-		if( ++m_currentFileIndex >= m_files.count() )
-		{
-			if( m_flags.testFlag( OpenTransferFolder ) )
+			if( m_deferredInterfaces.isEmpty() == false )
 			{
-				m_plugin->sendOpenTransferFolderMessage( m_interfaces );
+				// send the file again to computers which could not keep up with all others
+				m_activeInterfaces = m_deferredInterfaces;
+				m_deferredInterfaces.clear();
+				m_retrying = true;
+				m_fileState = FileStateOpen;
 			}
+			else if( ++m_currentFileIndex >= m_files.count() )
+			{
+				if( m_flags.testFlag( OpenTransferFolder ) )
+				{
+					m_plugin->sendOpenTransferFolderMessage( m_interfaces );
+				}
 
-			m_processTimer.stop();
-			emit finished();
-		}
-		else
-		{
-			m_fileState = FileStateOpen;
+				m_running = false;
+				m_activeInterfaces.clear();
+
+				updateProgress();
+
+				emit finished();
+				return;
+			}
+			else
+			{
+				m_activeInterfaces = m_interfaces;
+				m_retrying = false;
+				m_fileState = FileStateOpen;
+			}
+			break;
 		}
-		break;
 	}
+}
 
-	updateProgress();
+
+
+FileReader* FileTransferController::createFileReader( const QString& fileName )
+{
+	// prefer memory-mapped access which allows passing file data to the message serialization without copying,
+	// files which might be modified during the transfer are read through the buffered reader instead
+	auto mappedFileReader = new MappedFileReader( fileName, ChunkSize, m_configuration.readAheadChunkCount() );
+	if( mappedFileReader->start() )
+	{
+		return mappedFileReader;
+	}
+
+	delete mappedFileReader;
+
+	auto fileReadThread = new FileReadThread( fileName, ChunkSize, m_configuration.readAheadChunkCount(), this );
+	if( fileReadThread->start() )
+	{
+		return fileReadThread;
+	}
+
+	delete fileReadThread;
+
+	return nullptr;
 }
 
 
@@ -178,23 +254,20 @@ bool FileTransferController::openFile()
 		return false;
 	}
 
-	m_fileReadThread = new FileReadThread( m_files[m_currentFileIndex], this );
+	m_fileReader = createFileReader( m_files[m_currentFileIndex] );
 
-	if( m_fileReadThread->start() == false )
+	if( m_fileReader == nullptr )
 	{
-		delete m_fileReadThread;
-		m_fileReadThread = nullptr;
 		emit errorOccured( tr( "Could not open file \"%1\" for reading! Please check your permissions!" ).arg( m_currentFileIndex ) );
 		return false;
 	}
 
-	// start reading initial chunk in background
-	m_fileReadThread->readNextChunk( ChunkSize );
-
 	m_currentTransferId = QUuid::createUuid();
+	m_sentChunks = 0;
+	m_acknowledgedChunks.clear();
 
 	m_plugin->sendStartMessage( m_currentTransferId, QFileInfo( m_files[m_currentFileIndex] ).fileName(),
-								m_flags.testFlag( OverwriteExistingFiles ), m_interfaces );
+								m_flags.testFlag( OverwriteExistingFiles ), m_activeInterfaces );
 
 	return true;
 }
@@ -203,36 +276,55 @@ bool FileTransferController::openFile()
 
 bool FileTransferController::transferFile()
 {
-	if( m_fileReadThread == nullptr )
+	if( m_fileReader == nullptr )
 	{
 		// something went wrong so finish this file
 		return true;
 	}
 
-	// wait for all clients to catch up and current data chunk to be read completely
-	if( allQueuesEmpty() == false || m_fileReadThread->isChunkReady() == false )
+	const auto windowSize = qMax( 1, m_configuration.chunkWindowSize() );
+
+	// send as many chunks as available as long as no client has more unacknowledged chunks than its window
+	while( m_fileReader->isChunkReady() )
 	{
-		return false;
+		if( m_sentChunks - acknowledgedChunks() >= windowSize )
+		{
+			// do not let clients which stopped acknowledging chunks hold back all others forever
+			if( m_stallTimer.isActive() == false )
+			{
+				m_stallTimer.start( m_configuration.clientStallTimeout() );
+			}
+			return false;
+		}
+
+		m_stallTimer.stop();
+
+		m_plugin->sendDataMessage( m_currentTransferId, m_fileReader->takeChunk(), m_activeInterfaces );
+		++m_sentChunks;
 	}
 
-	m_plugin->sendDataMessage( m_currentTransferId, m_fileReadThread->currentChunk(), m_interfaces );
+	if( m_fileReader->atEnd() == false )
+	{
+		m_readTimer.start();
+		return false;
+	}
 
-	m_fileReadThread->readNextChunk( ChunkSize );
+	m_stallTimer.stop();
 
-	return m_fileReadThread->atEnd();
+	return true;
 }
 
 
 
 void FileTransferController::finishFile()
 {
-	if( m_fileReadThread )
+	if( m_fileReader )
 	{
-		delete m_fileReadThread;
-		m_fileReadThread = nullptr;
+		delete m_fileReader;
+		m_fileReader = nullptr;
 
 		m_plugin->sendFinishMessage( m_currentTransferId, QFileInfo( m_files[m_currentFileIndex] ).fileName(),
-									 m_flags.testFlag( OpenFilesInApplication ), m_interfaces );
+									 m_flags.testFlag( OpenFilesInApplication ), m_activeInterfaces );
 
 		m_currentTransferId = QUuid();
 	}
@@ -242,10 +334,10 @@ void FileTransferController::finishFile()
 
 void FileTransferController::updateProgress()
 {
-	if( m_files.isEmpty() == false && m_fileReadThread )
+	if( m_files.isEmpty() == false && m_fileReader )
 	{
 		emit progressChanged( m_currentFileIndex * 100 / m_files.count() +
-							  m_fileReadThread->progress() / m_files.count() );
+							  m_fileReader->progress() / m_files.count() );
 	}
 	else if( m_files.count() > 0 && m_currentFileIndex >= m_files.count() )
 	{
@@ -255,15 +347,76 @@ void FileTransferController::updateProgress()
 
 
 
-bool FileTransferController::allQueuesEmpty()
+int FileTransferController::acknowledgedChunks() const
 {
-	for( const auto& controlInterface : qAsConst(m_interfaces) )
+	auto minimum = m_sentChunks;
+
+	for( const auto& controlInterface : qAsConst(m_activeInterfaces) )
+	{
+		minimum = qMin( minimum, m_acknowledgedChunks.value( controlInterface.data() ) );
+	}
+
+	return minimum;
+}
+
+
+
+void FileTransferController::deferStalledInterfaces()
+{
+	if( m_running == false || m_fileState != FileStateTransferring )
+	{
+		return;
+	}
+
+	const auto windowSize = qMax( 1, m_configuration.chunkWindowSize() );
+
+	ComputerControlInterfaceList stalledInterfaces;
+
+	for( auto it = m_activeInterfaces.begin(); it != m_activeInterfaces.end(); )
 	{
-		if( controlInterface->isMessageQueueEmpty() == false )
+		if( m_sentChunks - m_acknowledgedChunks.value( it->data() ) >= windowSize )
 		{
-			return false;
+			stalledInterfaces.append( *it );
+			it = m_activeInterfaces.erase( it );
+		}
+		else
+		{
+			++it;
 		}
 	}
 
-	return true;
+	if( stalledInterfaces.isEmpty() )
+	{
+		return;
+	}
+
+	// discard the partially received file - the computers either get it again after all others or are excluded
+	m_plugin->sendCancelMessage( m_currentTransferId, stalledInterfaces );
+
+	if( m_retrying == false )
+	{
+		for( const auto& controlInterface : qAsConst(stalledInterfaces) )
+		{
+			vDebug() << "deferring stalled computer" << controlInterface->computer().hostAddress();
+		}
+
+		m_deferredInterfaces.append( stalledInterfaces );
+	}
+	else
+	{
+		QStringList computerNames;
+		computerNames.reserve( stalledInterfaces.size() );
+
+		for( const auto& controlInterface : qAsConst(stalledInterfaces) )
+		{
+			vWarning() << "dropping stalled computer" << controlInterface->computer().hostAddress() << "from file transfer";
+			m_interfaces.removeAll( controlInterface );
+			computerNames.append( controlInterface->computer().name() );
+		}
+
+		emit errorOccured( tr( "The following computers did not receive data in time and "
+							   "have been excluded from the file transfer: %1" ).arg( computerNames.join( QStringLiteral(", ") ) ) );
+	}
+
+	process();
 }
@@ -27,8 +27,9 @@
 #include <QTimer>
 
 #include "ComputerControlInterface.h"
+#include "FileTransferConfiguration.h"
 
-class FileReadThread;
+class FileReader;
 class FileTransferPlugin;
 
 class FileTransferController : public QObject
@@ -44,7 +45,9 @@ public:
 	Q_DECLARE_FLAGS(Flags, Flag)
 	Q_FLAG(Flags)
 
-	explicit FileTransferController( FileTransferPlugin* plugin );
+	static constexpr int ChunkSize = 256*1024;
+
+	FileTransferController( FileTransferPlugin* plugin, const FileTransferConfiguration& configuration );
 	~FileTransferController() override;
 
 	void setFiles( const QStringList& files );
@@ -60,6 +63,9 @@ public:
 
 	bool isRunning() const;
 
+	void acknowledgeChunks( const ComputerControlInterface::Pointer& controlInterface,
+							QUuid transferId, int chunkCount );
+
 signals:
 	void errorOccured( const QString& message );
 	void filesChanged();
@@ -76,18 +82,21 @@ private:
 
 	void process();
 
+	FileReader* createFileReader( const QString& fileName );
+
 	bool openFile();
 	bool transferFile();
 	void finishFile();
 
 	void updateProgress();
 
-	bool allQueuesEmpty();
+	int acknowledgedChunks() const;
+	void deferStalledInterfaces();
 
-	static constexpr int ProcessInterval = 25;
-	static constexpr int ChunkSize = 256*1024;
+	static constexpr int ReadRetryInterval = 10;
 
 	FileTransferPlugin* m_plugin;
+	const FileTransferConfiguration& m_configuration;
 
 	int m_currentFileIndex{-1};
 	QUuid m_currentTransferId{};
@@ -95,10 +104,21 @@ private:
 	Flags m_flags{Transfer};
 	ComputerControlInterfaceList m_interfaces{};
 
-	FileReadThread* m_fileReadThread{nullptr};
+	// computers receiving the current file and computers which fell behind and
+	// receive it again once all others are done
+	ComputerControlInterfaceList m_activeInterfaces{};
+	ComputerControlInterfaceList m_deferredInterfaces{};
+	bool m_retrying{false};
+
+	FileReader* m_fileReader{nullptr};
 
 	FileState m_fileState{FileStateFinished};
+	bool m_running{false};
+
+	int m_sentChunks{0};
+	QHash<ComputerControlInterface *, int> m_acknowledgedChunks{};
 
-	QTimer m_processTimer{this};
+	QTimer m_readTimer{this};
+	QTimer m_stallTimer{this};
 
 };
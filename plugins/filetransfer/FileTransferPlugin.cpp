@@ -23,17 +23,21 @@
  */
 
 #include <QDesktopServices>
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QMessageBox>
+#include <QQueue>
 #include <QQuickWindow>
 
 #include "BuiltinFeatures.h"
+#include "FileReadThread.h"
 #include "FileTransferController.h"
 #include "FileTransferDialog.h"
 #include "FileTransferPlugin.h"
 #include "FileTransferUserConfiguration.h"
 #include "FeatureWorkerManager.h"
+#include "MappedFileReader.h"
 #include "QmlCore.h"
 #include "SystemTrayIcon.h"
 #include "VeyonMasterInterface.h"
@@ -50,7 +54,11 @@ FileTransferPlugin::FileTransferPlugin( QObject* parent ) :
 						   tr( "File transfer" ), {},
 						   tr( "Click this button to transfer files from your computer to all computers." ),
 						   QStringLiteral(":/filetransfer/applications-office.png") ),
-	m_features( { m_fileTransferFeature } )
+	m_features( { m_fileTransferFeature } ),
+	m_configuration( &VeyonCore::config() ),
+	m_commands( {
+{ QStringLiteral("benchmark"), tr( "Measure throughput of sending a file to a number of simulated clients [FILE] [CLIENTS]" ) },
+				} )
 {
 }
 
@@ -129,8 +137,18 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonMasterInterface& master, con
 											   ComputerControlInterface::Pointer computerControlInterface )
 {
 	Q_UNUSED(master)
-	Q_UNUSED(message)
-	Q_UNUSED(computerControlInterface)
+
+	if( message.featureUid() == m_fileTransferFeature.uid() && message.command() == FileTransferAckCommand )
+	{
+		if( m_fileTransferController )
+		{
+			m_fileTransferController->acknowledgeChunks( computerControlInterface,
+														 message.argument( TransferId ).toUuid(),
+														 message.argument( ChunkCount ).toInt() );
+		}
+
+		return true;
+	}
 
 	return false;
 }
@@ -141,10 +159,20 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonServerInterface& server,
 											   const MessageContext& messageContext,
 											   const FeatureMessage& message )
 {
-	Q_UNUSED(messageContext)
-
 	if( m_fileTransferFeature.uid() == message.featureUid() )
 	{
+		// acknowledgements are sent by the worker and passed on to the master
+		if( message.command() == FileTransferAckCommand )
+		{
+			return m_transferContext.ioDevice() == nullptr ||
+					server.sendFeatureMessageReply( m_transferContext, message );
+		}
+
+		if( message.command() == FileTransferStartCommand )
+		{
+			m_transferContext = messageContext;
+		}
+
 		if( server.featureWorkerManager().isWorkerRunning( m_fileTransferFeature ) == false )
 		{
 			server.featureWorkerManager().startWorker( m_fileTransferFeature, FeatureWorkerManager::UnmanagedSessionProcess );
@@ -171,8 +199,6 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonServerInterface& server,
 
 bool FileTransferPlugin::handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message )
 {
-	Q_UNUSED(worker)
-
 	if( m_fileTransferFeature.uid() == message.featureUid() )
 	{
 		switch( message.command() )
@@ -192,6 +218,7 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonWorkerInterface& worker, con
 			if( m_currentFile.open( QFile::WriteOnly | QFile::Truncate ) )
 			{
 				m_currentTransferId = message.argument( TransferId ).toUuid();
+				m_receivedChunkCount = 0;
 			}
 			else
 			{
@@ -205,6 +232,11 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonWorkerInterface& worker, con
 			if( message.argument( TransferId ).toUuid() == m_currentTransferId )
 			{
 				m_currentFile.write( message.argument( DataChunk ).toByteArray() );
+
+				// let the master send further chunks within its window
+				worker.sendFeatureMessageReply( FeatureMessage( m_fileTransferFeature.uid(), FileTransferAckCommand ).
+												addArgument( TransferId, m_currentTransferId ).
+												addArgument( ChunkCount, ++m_receivedChunkCount ) );
 			}
 			else
 			{
@@ -246,6 +278,25 @@ bool FileTransferPlugin::handleFeatureMessage( VeyonWorkerInterface& worker, con
 
 
 
+bool FileTransferPlugin::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+{
+	Q_UNUSED(worker)
+
+	if( feature != m_fileTransferFeature )
+	{
+		return false;
+	}
+
+	// do not keep an interrupted transfer's file open for the lifetime of the worker host
+	m_currentFile.close();
+	m_currentFile.setFileName( {} );
+	m_currentTransferId = {};
+
+	return true;
+}
+
+
+
 void FileTransferPlugin::sendStartMessage( QUuid transferId, const QString& fileName,
 										   bool overwriteExistingFile, const ComputerControlInterfaceList& interfaces )
 {
@@ -304,7 +355,7 @@ void FileTransferPlugin::startFileTransfer( const QStringList& files, Configurat
 
 	if( m_fileTransferController == nullptr )
 	{
-		m_fileTransferController = new FileTransferController( this );
+		m_fileTransferController = new FileTransferController( this, m_configuration );
 	}
 
 	auto relativeFiles = files;
@@ -321,3 +372,110 @@ void FileTransferPlugin::startFileTransfer( const QStringList& files, Configurat
 	m_fileTransferController->setFiles( relativeFiles );
 	m_fileTransferController->setInterfaces( interfaces );
 }
+
+
+
+QStringList FileTransferPlugin::commands() const
+{
+	return m_commands.keys();
+}
+
+
+
+QString FileTransferPlugin::commandHelp( const QString& command ) const
+{
+	return m_commands.value( command );
+}
+
+
+
+CommandLinePluginInterface::RunResult FileTransferPlugin::handle_benchmark( const QStringList& arguments )
+{
+	const auto fileName = arguments.value( 0 );
+	if( fileName.isEmpty() )
+	{
+		return NotEnoughArguments;
+	}
+
+	if( QFileInfo( fileName ).isReadable() == false )
+	{
+		error( tr( "Can't open file \"%1\" for reading!" ).arg( fileName ) );
+		return Failed;
+	}
+
+	const auto clientCount = qMax( 1, arguments.value( 1, QStringLiteral("30") ).toInt() );
+	const auto readAheadChunkCount = m_configuration.readAheadChunkCount();
+
+	benchmarkFileReader( tr( "Buffered reads" ),
+						 new FileReadThread( fileName, FileTransferController::ChunkSize, readAheadChunkCount ),
+						 clientCount );
+	benchmarkFileReader( tr( "Memory-mapped reads" ),
+						 new MappedFileReader( fileName, FileTransferController::ChunkSize, readAheadChunkCount ),
+						 clientCount );
+
+	return Successful;
+}
+
+
+
+void FileTransferPlugin::benchmarkFileReader( const QString& name, FileReader* fileReader, int clientCount )
+{
+	QScopedPointer<FileReader> reader( fileReader );
+
+	if( reader->start() == false )
+	{
+		error( tr( "%1: could not open file" ).arg( name ) );
+		return;
+	}
+
+	const auto transferId = QUuid::createUuid();
+
+	// simulate per-client send queues and a copy into each client's socket buffer
+	QVector<QQueue<QByteArray>> clientQueues( clientCount );
+	QByteArray socketBuffer( FileTransferController::ChunkSize * 2, 0 );
+	qint64 bytesSent = 0;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while( reader->atEnd() == false )
+	{
+		if( reader->isChunkReady() == false )
+		{
+			QThread::yieldCurrentThread();
+			continue;
+		}
+
+		const auto serializedMessage = FeatureMessage( m_fileTransferFeature.uid(), FileTransferContinueCommand ).
+									   addArgument( TransferId, transferId ).
+									   addArgument( DataChunk, reader->takeChunk() ).
+									   serialize( FeatureMessage::Format::Compact );
+
+		for( auto& queue : clientQueues )
+		{
+			queue.enqueue( serializedMessage );
+		}
+
+		for( auto& queue : clientQueues )
+		{
+			while( queue.isEmpty() == false )
+			{
+				const auto data = queue.dequeue();
+				memcpy( socketBuffer.data(), data.constData(), static_cast<size_t>( qMin( data.size(), socketBuffer.size() ) ) );
+				bytesSent += data.size();
+			}
+		}
+	}
+
+	const auto elapsed = qMax<qint64>( 1, timer.elapsed() );
+
+	print( tr( "%1: sent %2 MB to %3 clients in %4 ms (%5 MB/s)" ).
+		   arg( name ).
+		   arg( bytesSent / 1024 / 1024 ).
+		   arg( clientCount ).
+		   arg( elapsed ).
+		   arg( bytesSent * 1000 / elapsed / 1024 / 1024 ) );
+}
+
+
+IMPLEMENT_CONFIG_PROXY(FileTransferConfiguration)
@@ -27,17 +27,22 @@
 #include <QFile>
 #include <QUrl>
 
+#include "CommandLineIO.h"
+#include "CommandLinePluginInterface.h"
 #include "Configuration/Object.h"
 #include "FeatureProviderInterface.h"
+#include "FileTransferConfiguration.h"
+#include "MessageContext.h"
 
+class FileReader;
 class FileTransferController;
 class FileTransferUserConfiguration;
 
-class FileTransferPlugin : public QObject, FeatureProviderInterface, PluginInterface
+class FileTransferPlugin : public QObject, FeatureProviderInterface, PluginInterface, CommandLinePluginInterface, CommandLineIO
 {
 	Q_OBJECT
 	Q_PLUGIN_METADATA(IID "io.veyon.Veyon.Plugins.FileTransfer")
-	Q_INTERFACES(PluginInterface FeatureProviderInterface)
+	Q_INTERFACES(PluginInterface FeatureProviderInterface CommandLinePluginInterface)
 	Q_PROPERTY(QString lastFileTransferSourceDirectory READ lastFileTransferSourceDirectory)
 public:
 	explicit FileTransferPlugin( QObject* parent = nullptr );
@@ -93,6 +98,13 @@ public:
 
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) override;
 
+	bool isWorkerHostable( const Feature& feature ) const override
+	{
+		return feature == m_fileTransferFeature;
+	}
+
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) override;
+
 	void sendStartMessage( QUuid transferId, const QString& fileName,
 						   bool overwriteExistingFile, const ComputerControlInterfaceList& interfaces );
 	void sendDataMessage( QUuid transferId, const QByteArray& data, const ComputerControlInterfaceList& interfaces );
@@ -101,6 +113,22 @@ public:
 							bool openFileInApplication, const ComputerControlInterfaceList& interfaces );
 	void sendOpenTransferFolderMessage( const ComputerControlInterfaceList& interfaces );
 
+	QString commandLineModuleName() const override
+	{
+		return QStringLiteral( "filetransfer" );
+	}
+
+	QString commandLineModuleHelp() const override
+	{
+		return tr( "Commands for analyzing file transfer performance" );
+	}
+
+	QStringList commands() const override;
+	QString commandHelp( const QString& command ) const override;
+
+public slots:
+	CommandLinePluginInterface::RunResult handle_benchmark( const QStringList& arguments );
+
 signals:
 	Q_INVOKABLE void acceptSelectedFiles( const QList<QUrl>& fileUrls );
 
@@ -113,6 +141,8 @@ private:
 	void startFileTransfer( const QStringList& files, Configuration::Object* config,
 							const ComputerControlInterfaceList& interfaces );
 
+	void benchmarkFileReader( const QString& name, FileReader* fileReader, int clientCount );
+
 	enum Commands
 	{
 		FileTransferStartCommand,
@@ -120,6 +150,7 @@ private:
 		FileTransferCancelCommand,
 		FileTransferFinishCommand,
 		OpenTransferFolder,
+		FileTransferAckCommand,
 		CommandCount
 	};
 
@@ -130,17 +161,26 @@ private:
 		DataChunk,
 		OpenFileInApplication,
 		OverwriteExistingFile,
+		ChunkCount,
 		ArgumentsCount
 	};
 
 	const Feature m_fileTransferFeature;
 	const FeatureList m_features;
 
+	FileTransferConfiguration m_configuration;
+
+	QMap<QString, QString> m_commands;
+
 	QString m_lastFileTransferSourceDirectory;
 
 	FileTransferController* m_fileTransferController{nullptr};
 
 	QFile m_currentFile{};
 	QUuid m_currentTransferId{};
+	int m_receivedChunkCount{0};
+
+	// connection of the master which started the current transfer and receives the acknowledgements
+	MessageContext m_transferContext{nullptr};
 
 };
@@ -0,0 +1,363 @@
+/*
+ * MappedFileReader.cpp - implementation of MappedFileReader class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QMutex>
+#include <QSocketNotifier>
+
+#include "VeyonCore.h"
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFileReader.h"
+
+
+#ifdef Q_OS_LINUX
+// the kernel signals lease breaks asynchronously, so pass them from the signal handler to the event
+// loop through a socket pair and let the affected readers give up their leases right away instead of
+// blocking the writing process until the next chunk is taken
+class MappedFileLeaseBreakNotifier
+{
+public:
+	static constexpr int LeaseBreakSignal = SIGURG;
+
+	static MappedFileLeaseBreakNotifier& instance()
+	{
+		static MappedFileLeaseBreakNotifier notifier;
+		return notifier;
+	}
+
+	bool isValid() const
+	{
+		return s_sockets[0] >= 0;
+	}
+
+	void registerReader( MappedFileReader* reader )
+	{
+		QMutexLocker locker( &m_readersMutex );
+		m_readers.append( reader );
+	}
+
+	void unregisterReader( MappedFileReader* reader )
+	{
+		QMutexLocker locker( &m_readersMutex );
+		m_readers.removeAll( reader );
+	}
+
+private:
+	MappedFileLeaseBreakNotifier()
+	{
+		if( QCoreApplication::instance() == nullptr ||
+			socketpair( AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, s_sockets ) != 0 )
+		{
+			s_sockets[0] = s_sockets[1] = -1;
+			return;
+		}
+
+		struct sigaction action{};
+		action.sa_handler = handleSignal;
+		action.sa_flags = SA_RESTART;
+		sigemptyset( &action.sa_mask );
+		sigaction( LeaseBreakSignal, &action, nullptr );
+
+		// owned by the application so it does not outlive the event dispatcher
+		auto notifier = new QSocketNotifier( s_sockets[1], QSocketNotifier::Read, QCoreApplication::instance() );
+		QObject::connect( notifier, &QSocketNotifier::activated, notifier, [this]() { processLeaseBreaks(); } );
+	}
+
+	static void handleSignal( int signal )
+	{
+		Q_UNUSED(signal)
+
+		const auto savedErrno = errno;
+		const char data = 0;
+		const auto written = ::write( s_sockets[0], &data, sizeof(data) );
+		Q_UNUSED(written)
+		errno = savedErrno;
+	}
+
+	void processLeaseBreaks()
+	{
+		char buffer[64];
+		while( ::read( s_sockets[1], buffer, sizeof(buffer) ) > 0 ) // Flawfinder: ignore
+		{
+		}
+
+		QMutexLocker locker( &m_readersMutex );
+		for( auto reader : qAsConst(m_readers) )
+		{
+			reader->handleLeaseBreak();
+		}
+	}
+
+	static int s_sockets[2];
+
+	QMutex m_readersMutex;
+	QVector<MappedFileReader *> m_readers;
+
+} ;
+
+int MappedFileLeaseBreakNotifier::s_sockets[2] = { -1, -1 };
+#endif
+
+
+MappedFileReader::MappedFileReader( const QString& fileName, qint64 chunkSize, int readAheadChunkCount ) :
+	m_file( fileName ),
+	m_chunkSize( chunkSize ),
+	m_readAheadChunkCount( qMax( 1, readAheadChunkCount ) )
+{
+}
+
+
+
+MappedFileReader::~MappedFileReader()
+{
+#ifdef Q_OS_LINUX
+	MappedFileLeaseBreakNotifier::instance().unregisterReader( this );
+#endif
+
+	releaseMapping();
+}
+
+
+
+bool MappedFileReader::start()
+{
+	if( m_file.open( QFile::ReadOnly ) == false )
+	{
+		return false;
+	}
+
+	m_fileSize = m_file.size();
+	m_offset = 0;
+
+	// empty files can't be mapped but also do not provide any data
+	if( m_fileSize <= 0 )
+	{
+		return true;
+	}
+
+	// accessing a mapping beyond the end of a file truncated in the meantime raises SIGBUS,
+	// so only map files which can't be modified by anyone else while being transferred
+	if( acquireReadLease() == false )
+	{
+		vDebug() << "not mapping file" << m_file.fileName() << "as it might be modified concurrently";
+		return false;
+	}
+
+	m_data = m_file.map( 0, m_fileSize );
+	if( m_data == nullptr )
+	{
+		vDebug() << "could not map file" << m_file.fileName() << m_file.errorString();
+		releaseMapping();
+		return false;
+	}
+
+	adviseAccess( 0, m_fileSize, true );
+
+	return true;
+}
+
+
+
+bool MappedFileReader::isChunkReady()
+{
+	return m_offset < m_fileSize;
+}
+
+
+
+QByteArray MappedFileReader::takeChunk()
+{
+	if( isChunkReady() == false )
+	{
+		return {};
+	}
+
+	const auto size = qMin( m_chunkSize, m_fileSize - m_offset );
+
+	if( isMappingSafe() == false )
+	{
+		// someone is about to write to the file so continue with plain reads
+		releaseMapping();
+		return readChunk( size );
+	}
+
+	const auto chunk = QByteArray::fromRawData( reinterpret_cast<const char *>( m_data + m_offset ), static_cast<int>( size ) );
+
+	m_offset += size;
+
+	// let the kernel fetch the next chunks in background
+	const auto readAheadEnd = qMin( m_fileSize, m_offset + m_chunkSize * m_readAheadChunkCount );
+	if( readAheadEnd > m_advisedOffset )
+	{
+		const auto adviseOffset = qMax( m_offset, m_advisedOffset );
+		adviseAccess( adviseOffset, readAheadEnd - adviseOffset, false );
+		m_advisedOffset = readAheadEnd;
+	}
+
+	return chunk;
+}
+
+
+
+bool MappedFileReader::atEnd()
+{
+	return m_offset >= m_fileSize;
+}
+
+
+
+int MappedFileReader::progress()
+{
+	return m_fileSize > 0 ? static_cast<int>( m_offset * 100 / m_fileSize ) : 0;
+}
+
+
+
+void MappedFileReader::handleLeaseBreak()
+{
+	if( m_data && isMappingSafe() == false )
+	{
+		vDebug() << "lease on" << m_file.fileName() << "is being broken - continuing with plain reads";
+		// unblocks the writer immediately
+		releaseMapping();
+	}
+}
+
+
+
+bool MappedFileReader::acquireReadLease()
+{
+#if defined(Q_OS_LINUX)
+	const auto fd = m_file.handle();
+
+	auto& leaseBreakNotifier = MappedFileLeaseBreakNotifier::instance();
+
+	// lease breaks are signalled with SIGIO by default which would terminate us, so use
+	// a signal caught by the notifier instead
+	if( leaseBreakNotifier.isValid() == false ||
+		fcntl( fd, F_SETSIG, MappedFileLeaseBreakNotifier::LeaseBreakSignal ) != 0 )
+	{
+		return false;
+	}
+
+	leaseBreakNotifier.registerReader( this );
+
+	// only succeeds if nobody has the file opened for writing and we're allowed to hold
+	// leases on it (i.e. we own it) - the lease makes the kernel block any open for writing
+	// or truncation by other processes until we released it
+	return fcntl( fd, F_SETLEASE, F_RDLCK ) == 0;
+#elif defined(Q_OS_WIN)
+	// Windows refuses to truncate files with mapped views
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+
+bool MappedFileReader::isMappingSafe()
+{
+	if( m_data == nullptr )
+	{
+		return false;
+	}
+
+#ifdef Q_OS_LINUX
+	// while a lease break is pending, the writer is blocked until we release the lease
+	// (or the lease break time elapsed), so the file can't have been truncated yet
+	return fcntl( m_file.handle(), F_GETLEASE ) == F_RDLCK;
+#else
+	return true;
+#endif
+}
+
+
+
+void MappedFileReader::releaseMapping()
+{
+	if( m_data )
+	{
+		m_file.unmap( m_data );
+		m_data = nullptr;
+	}
+
+#ifdef Q_OS_LINUX
+	if( m_file.isOpen() )
+	{
+		fcntl( m_file.handle(), F_SETLEASE, F_UNLCK );
+	}
+#endif
+}
+
+
+
+QByteArray MappedFileReader::readChunk( qint64 size )
+{
+	QByteArray chunk;
+
+	if( m_file.seek( m_offset ) )
+	{
+		chunk = m_file.read( size ); // Flawfinder: ignore
+	}
+
+	if( chunk.size() < size )
+	{
+		vWarning() << "file" << m_file.fileName() << "has been truncated during transfer";
+		// finish with the data we could still read
+		m_fileSize = m_offset + chunk.size();
+	}
+
+	m_offset += chunk.size();
+
+	return chunk;
+}
+
+
+
+void MappedFileReader::adviseAccess( qint64 offset, qint64 size, bool sequential )
+{
+#ifdef Q_OS_LINUX
+	static const auto pageSize = static_cast<qint64>( sysconf( _SC_PAGESIZE ) );
+
+	// advice has to start at a page boundary
+	const auto alignedOffset = offset - offset % pageSize;
+
+	posix_madvise( m_data + alignedOffset, static_cast<size_t>( size + offset - alignedOffset ),
+				   sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_WILLNEED );
+#else
+	Q_UNUSED(offset)
+	Q_UNUSED(size)
+	Q_UNUSED(sequential)
+#endif
+}
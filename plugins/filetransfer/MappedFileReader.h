@@ -0,0 +1,73 @@
+/*
+ * MappedFileReader.h - declaration of MappedFileReader class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+
+#include "FileReader.h"
+
+// clazy:excludeall=copyable-polymorphic
+
+class MappedFileLeaseBreakNotifier;
+
+class MappedFileReader : public FileReader
+{
+public:
+	MappedFileReader( const QString& fileName, qint64 chunkSize, int readAheadChunkCount );
+	~MappedFileReader() override;
+
+	bool start() override;
+
+	bool isChunkReady() override;
+
+	// returns a chunk referencing the mapped file data which must not be used after the next
+	// call to takeChunk(), returning to the event loop or destruction of the reader
+	QByteArray takeChunk() override;
+
+	bool atEnd() override;
+	int progress() override;
+
+private:
+	friend class MappedFileLeaseBreakNotifier;
+
+	void handleLeaseBreak();
+
+	bool acquireReadLease();
+	bool isMappingSafe();
+	void releaseMapping();
+
+	QByteArray readChunk( qint64 size );
+
+	void adviseAccess( qint64 offset, qint64 size, bool sequential );
+
+	QFile m_file;
+	const qint64 m_chunkSize;
+	const int m_readAheadChunkCount;
+	uchar* m_data{nullptr};
+	qint64 m_fileSize{0};
+	qint64 m_offset{0};
+	qint64 m_advisedOffset{0};
+
+};
@@ -0,0 +1,302 @@
+/*
+ * LinuxAuthHelper.cpp - implementation of LinuxAuthHelper class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+
+#include "LinuxAuthHelper.h"
+#include "VeyonCore.h"
+#include "auth-helper/VeyonAuthHelperProtocol.h"
+
+#include <csignal>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+LinuxAuthHelper::~LinuxAuthHelper()
+{
+	QMutexLocker locker( &m_mutex );
+
+	stopHelper();
+}
+
+
+
+bool LinuxAuthHelper::authenticate( const QByteArray& username, const QByteArray& password,
+									const QByteArray& service, int timeout )
+{
+	// retry once with a restarted helper if the previous one was gone before the request could be sent -
+	// never resend credentials the helper may already have received as each attempt can count as a failed logon
+	for( int attempt = 0; attempt < 2; ++attempt )
+	{
+		const auto result = processRequest( username, password, service, timeout );
+		if( result != Result::NotDelivered )
+		{
+			return result == Result::Succeeded;
+		}
+	}
+
+	vCritical() << "auth helper not available";
+
+	return false;
+}
+
+
+
+LinuxAuthHelper::Result LinuxAuthHelper::processRequest( const QByteArray& username, const QByteArray& password,
+														 const QByteArray& service, int timeout )
+{
+	static constexpr qint32 PamSuccess = 0;
+
+	QMutexLocker locker( &m_mutex );
+
+	if( m_socket < 0 && startHelper() == false )
+	{
+		return Result::NotDelivered;
+	}
+
+	const auto requestId = ++m_lastRequestId;
+	const auto generation = m_generation;
+
+	QByteArray request;
+	QDataStream( &request, QIODevice::WriteOnly ) << requestId << username << password << service;
+
+	const auto sent = VeyonAuthHelperProtocol::writeFrame( m_socket, request );
+	request.fill( 0 );
+
+	// the helper only processes complete frames so it never received a request which failed to send
+	if( sent == false )
+	{
+		vWarning() << "failed to send request to auth helper";
+		stopHelper();
+		return Result::NotDelivered;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	forever
+	{
+		if( m_responses.contains( requestId ) )
+		{
+			const auto response = m_responses.take( requestId );
+			if( response.pamResult != PamSuccess )
+			{
+				vCritical() << "authentication failed:" << response.message;
+				return Result::Failed;
+			}
+
+			vDebug() << "User authenticated successfully";
+			return Result::Succeeded;
+		}
+
+		if( generation != m_generation )
+		{
+			vCritical() << "auth helper stopped before answering request";
+			return Result::Failed;
+		}
+
+		if( timer.hasExpired( timeout ) )
+		{
+			// do not leave a hanging PAM conversation with the credentials behind
+			vCritical() << "timeout while waiting for response from auth helper";
+			killHelper();
+			return Result::Failed;
+		}
+
+		// let only one thread at a time read responses and hand them over to the waiting threads
+		if( m_receiving )
+		{
+			m_responsesChanged.wait( &m_mutex, PollInterval );
+			continue;
+		}
+
+		m_receiving = true;
+		const auto socket = m_socket;
+
+		locker.unlock();
+
+		quint32 responseId = 0;
+		Response response{};
+		bool received = false;
+		bool failed = false;
+
+		struct pollfd pfd = { socket, POLLIN, 0 };
+		if( poll( &pfd, 1, PollInterval ) > 0 )
+		{
+			QByteArray payload;
+			if( VeyonAuthHelperProtocol::readFrame( socket, payload, FrameTimeout ) )
+			{
+				QDataStream stream( payload );
+				stream >> responseId >> response.pamResult >> response.message;
+				received = stream.status() == QDataStream::Ok;
+			}
+			failed = received == false;
+		}
+
+		locker.relock();
+
+		m_receiving = false;
+
+		if( socket != m_socket )
+		{
+			// helper has been stopped by another thread while we were receiving
+			::close( socket );
+		}
+		else if( received )
+		{
+			m_responses[responseId] = response;
+		}
+		else if( failed )
+		{
+			vWarning() << "lost connection to auth helper";
+			stopHelper();
+		}
+
+		m_responsesChanged.wakeAll();
+	}
+}
+
+
+
+bool LinuxAuthHelper::startHelper()
+{
+	int sockets[2] = { -1, -1 };
+	if( socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets ) != 0 )
+	{
+		vCritical() << "failed to create socket pair";
+		return false;
+	}
+
+	// prepare everything before forking as only async-signal-safe functions may be called in the child -
+	// Veyon Server runs with the environment of the user session so never look up the helper via PATH
+	// and do not pass the environment on to the privileged helper
+	QByteArray program = QFile::encodeName( QCoreApplication::applicationDirPath() +
+											QStringLiteral("/veyon-auth-helper") );
+	QByteArray serverArgument = VeyonAuthHelperProtocol::ServerArgument;
+	char* const arguments[] = { program.data(), serverArgument.data(), nullptr };
+	QByteArray path = QByteArrayLiteral("PATH=/usr/sbin:/usr/bin:/sbin:/bin");
+	char* const environment[] = { path.data(), nullptr };
+	const auto maximumFileDescriptor = static_cast<int>( sysconf( _SC_OPEN_MAX ) );
+
+	const auto pid = fork();
+	if( pid < 0 )
+	{
+		vCritical() << "failed to fork auth helper";
+		::close( sockets[0] );
+		::close( sockets[1] );
+		return false;
+	}
+
+	if( pid == 0 )
+	{
+		// fork once more so the helper gets reparented and never has to be reaped by us
+		const auto helperPid = fork();
+		if( helperPid == 0 )
+		{
+			dup2( sockets[1], STDIN_FILENO );
+			dup2( sockets[1], STDOUT_FILENO );
+
+			// don't leak sockets and files of the server which were not opened with O_CLOEXEC
+			for( int fd = STDERR_FILENO + 1; fd < maximumFileDescriptor; ++fd )
+			{
+				::close( fd );
+			}
+
+			execve( arguments[0], arguments, environment );
+			_exit( 1 );
+		}
+
+		// tell the PID of the helper before it can write anything so it can be killed later on
+		const auto written = write( sockets[1], &helperPid, sizeof(helperPid) );
+		_exit( helperPid > 0 && written == sizeof(helperPid) ? 0 : 1 );
+	}
+
+	::close( sockets[1] );
+
+	int status = 0;
+	pid_t helperPid = -1;
+
+	if( waitpid( pid, &status, 0 ) != pid || WIFEXITED(status) == false || WEXITSTATUS(status) != 0 ||
+		VeyonAuthHelperProtocol::readAll( sockets[0], reinterpret_cast<char *>( &helperPid ),
+										  sizeof(helperPid), FrameTimeout ) == false )
+	{
+		vCritical() << "failed to start auth helper";
+		::close( sockets[0] );
+		return false;
+	}
+
+	m_socket = sockets[0];
+	m_pid = helperPid;
+
+	vDebug() << "started auth helper";
+
+	return true;
+}
+
+
+
+void LinuxAuthHelper::stopHelper()
+{
+	if( m_socket >= 0 )
+	{
+		// the helper exits as soon as it reads EOF and has finished pending conversations
+		shutdown( m_socket, SHUT_RDWR );
+
+		// a receiving thread still polls the socket and closes it afterwards
+		if( m_receiving == false )
+		{
+			::close( m_socket );
+		}
+
+		m_socket = -1;
+	}
+
+	m_pid = -1;
+
+	++m_generation;
+
+	m_responses.clear();
+}
+
+
+
+void LinuxAuthHelper::killHelper()
+{
+	// the helper is not our child so make sure its PID has not been reused already, i.e.
+	// the helper still holds its end of the socket
+	struct pollfd pfd = { m_socket, POLLIN, 0 };
+	if( m_pid > 0 && m_socket >= 0 &&
+		( poll( &pfd, 1, 0 ) <= 0 || ( pfd.revents & ( POLLHUP | POLLERR ) ) == 0 ) )
+	{
+		vWarning() << "killing auth helper" << m_pid;
+		kill( m_pid, SIGKILL );
+	}
+
+	stopHelper();
+}
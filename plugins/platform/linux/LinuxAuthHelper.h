@@ -0,0 +1,76 @@
+/*
+ * LinuxAuthHelper.h - declaration of LinuxAuthHelper class
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <sys/types.h>
+
+// client for a persistent veyon-auth-helper process serving PAM authentication requests
+// over a socket pair - the helper is (re)started on demand, e.g. after it crashed
+class LinuxAuthHelper
+{
+public:
+	LinuxAuthHelper() = default;
+	~LinuxAuthHelper();
+
+	bool authenticate( const QByteArray& username, const QByteArray& password, const QByteArray& service, int timeout );
+
+private:
+	static constexpr auto PollInterval = 100;
+	static constexpr auto FrameTimeout = 1000;
+
+	enum class Result {
+		Succeeded,
+		Failed,
+		NotDelivered
+	} ;
+
+	struct Response
+	{
+		qint32 pamResult;
+		QByteArray message;
+	};
+
+	Result processRequest( const QByteArray& username, const QByteArray& password, const QByteArray& service, int timeout );
+
+	bool startHelper();
+	void stopHelper();
+	void killHelper();
+
+	QMutex m_mutex{};
+	QWaitCondition m_responsesChanged{};
+
+	int m_socket{-1};
+	pid_t m_pid{-1};
+	int m_generation{0};
+	quint32 m_lastRequestId{0};
+	bool m_receiving{false};
+
+	QHash<quint32, Response> m_responses{};
+
+} ;
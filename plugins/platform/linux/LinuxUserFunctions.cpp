@@ -22,8 +22,8 @@
  *
  */
 
-#include <QDataStream>
 #include <QDBusReply>
+#include <QFileInfo>
 #include <QProcess>
 
 #include "LinuxCoreFunctions.h"
@@ -37,8 +37,14 @@
 
 #include <X11/keysymdef.h>
 
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <grp.h>
 #include <pwd.h>
 #include <unistd.h>
+#include <utmpx.h>
 
 
 QString LinuxUserFunctions::fullName( const QString& username )
@@ -68,104 +74,16 @@ QStringList LinuxUserFunctions::userGroups( bool queryDomainGroups )
 {
 	Q_UNUSED(queryDomainGroups)
 
-	QStringList groupList;
-
-	QProcess getentProcess;
-	getentProcess.start( QStringLiteral("getent"), { QStringLiteral("group") } );
-	getentProcess.waitForFinished();
+	QMutexLocker locker( &m_groupCacheMutex );
 
-	const auto groups = QString::fromUtf8( getentProcess.readAll() ).split( QLatin1Char('\n') );
+	validateGroupCache();
 
-	groupList.reserve( groups.size() );
-
-	for( const auto& group : groups )
+	if( m_userGroupsCache.isEmpty() )
 	{
-		groupList += group.split( QLatin1Char(':') ).first();
+		m_userGroupsCache = queryUserGroups();
 	}
 
-	const QStringList ignoredGroups( {
-		QStringLiteral("daemon"),
-		QStringLiteral("bin"),
-		QStringLiteral("tty"),
-		QStringLiteral("disk"),
-		QStringLiteral("lp"),
-		QStringLiteral("mail"),
-		QStringLiteral("news"),
-		QStringLiteral("uucp"),
-		QStringLiteral("man"),
-		QStringLiteral("proxy"),
-		QStringLiteral("kmem"),
-		QStringLiteral("dialout"),
-		QStringLiteral("fax"),
-		QStringLiteral("voice"),
-		QStringLiteral("cdrom"),
-		QStringLiteral("tape"),
-		QStringLiteral("audio"),
-		QStringLiteral("dip"),
-		QStringLiteral("www-data"),
-		QStringLiteral("backup"),
-		QStringLiteral("list"),
-		QStringLiteral("irc"),
-		QStringLiteral("src"),
-		QStringLiteral("gnats"),
-		QStringLiteral("shadow"),
-		QStringLiteral("utmp"),
-		QStringLiteral("video"),
-		QStringLiteral("sasl"),
-		QStringLiteral("plugdev"),
-		QStringLiteral("games"),
-		QStringLiteral("nogroup"),
-		QStringLiteral("libuuid"),
-		QStringLiteral("syslog"),
-		QStringLiteral("fuse"),
-		QStringLiteral("lpadmin"),
-		QStringLiteral("ssl-cert"),
-		QStringLiteral("messagebus"),
-		QStringLiteral("crontab"),
-		QStringLiteral("mlocate"),
-		QStringLiteral("avahi-autoipd"),
-		QStringLiteral("netdev"),
-		QStringLiteral("saned"),
-		QStringLiteral("sambashare"),
-		QStringLiteral("haldaemon"),
-		QStringLiteral("polkituser"),
-		QStringLiteral("mysql"),
-		QStringLiteral("avahi"),
-		QStringLiteral("klog"),
-		QStringLiteral("floppy"),
-		QStringLiteral("oprofile"),
-		QStringLiteral("netdev"),
-		QStringLiteral("dirmngr"),
-		QStringLiteral("vboxusers"),
-		QStringLiteral("bluetooth"),
-		QStringLiteral("colord"),
-		QStringLiteral("libvirtd"),
-		QStringLiteral("nm-openvpn"),
-		QStringLiteral("input"),
-		QStringLiteral("kvm"),
-		QStringLiteral("pulse"),
-		QStringLiteral("pulse-access"),
-		QStringLiteral("rtkit"),
-		QStringLiteral("scanner"),
-		QStringLiteral("sddm"),
-		QStringLiteral("systemd-bus-proxy"),
-		QStringLiteral("systemd-journal"),
-		QStringLiteral("systemd-network"),
-		QStringLiteral("systemd-resolve"),
-		QStringLiteral("systemd-timesync"),
-		QStringLiteral("utempter"),
-		QStringLiteral("uuidd"),
-							   } );
-
-	for( const auto& ignoredGroup : ignoredGroups )
-	{
-		groupList.removeAll( ignoredGroup );
-	}
-
-	// remove all empty entries
-	groupList.removeAll( QString() );
-
-	return groupList;
+	return m_userGroupsCache;
 }
 
 
@@ -174,58 +92,77 @@ QStringList LinuxUserFunctions::groupsOfUser( const QString& username, bool quer
 {
 	Q_UNUSED(queryDomainGroups)
 
-	QStringList groupList;
-
 	const auto strippedUsername = VeyonCore::stripDomain( username );
 
-	QProcess getentProcess;
-	getentProcess.start( QStringLiteral("getent"), { QStringLiteral("group") } );
-	getentProcess.waitForFinished();
+	QMutexLocker locker( &m_groupCacheMutex );
+
+	validateGroupCache();
 
-	const auto groups = QString::fromUtf8( getentProcess.readAll() ).split( QLatin1Char('\n') );
-	for( const auto& group : groups )
+	const auto it = m_groupsOfUserCache.constFind( strippedUsername );
+	if( it != m_groupsOfUserCache.constEnd() )
 	{
-		const auto groupComponents = group.split( QLatin1Char(':') );
-		if( groupComponents.size() == 4 &&
-				groupComponents.last().split( QLatin1Char(',') ).contains( strippedUsername ) )
-		{
-			groupList += groupComponents.first(); // clazy:exclude=reserve-candidates
-		}
+		return *it;
 	}
 
-	groupList.removeAll( QString() );
+	const auto cacheTimestamp = m_groupCacheTimestamp;
 
-	return groupList;
+	// NSS lookups may block for a long time (e.g. with remote directories) so do not
+	// stall concurrent queries for other users while resolving the groups
+	locker.unlock();
+
+	const auto groups = queryGroupsOfUser( strippedUsername );
+
+	locker.relock();
+
+	// do not populate a cache which has been invalidated in the meantime
+	if( m_groupCacheTimestamp == cacheTimestamp )
+	{
+		m_groupsOfUserCache.insert( strippedUsername, groups );
+	}
+
+	return groups;
 }
 
 
 
 bool LinuxUserFunctions::isAnyUserLoggedOn()
 {
-	QProcess whoProcess;
-	whoProcess.start( QStringLiteral("who") );
-	whoProcess.waitForFinished( WhoProcessTimeout );
-
-	if( whoProcess.exitCode() != 0 )
-	{
-		return false;
-	}
+	// utmp access functions operate on a process-wide cursor
+	static QMutex utmpMutex;
+	QMutexLocker locker( &utmpMutex );
 
 	const auto displayManagerUsers = LinuxPlatformConfiguration( &VeyonCore::config() ).displayManagerUsers().
 			split( QLatin1Char(',') );
 
-	const auto lines = whoProcess.readAll().split( '\n' );
-	for( const auto& line : lines )
+	bool userLoggedOn = false;
+
+	setutxent();
+
+	while( const auto entry = getutxent() )
 	{
-		const auto user = QString::fromUtf8( line.split( ' ' ).value( 0 ) );
+		if( entry->ut_type != USER_PROCESS )
+		{
+			continue;
+		}
+
+		// skip stale entries of sessions which did not exit cleanly (same as who does)
+		if( entry->ut_pid > 0 && kill( entry->ut_pid, 0 ) != 0 && errno == ESRCH )
+		{
+			continue;
+		}
+
+		const auto user = QString::fromUtf8( entry->ut_user, static_cast<int>( strnlen( entry->ut_user, sizeof(entry->ut_user) ) ) );
 		if( user.isEmpty() == false &&
 			displayManagerUsers.contains( user ) == false )
 		{
-			return true;
+			userLoggedOn = true;
+			break;
 		}
 	}
 
-	return false;
+	endutxent();
+
+	return userLoggedOn;
 }
 
 
@@ -330,44 +267,264 @@ void LinuxUserFunctions::logoff()
 
 bool LinuxUserFunctions::authenticate( const QString& username, const Password& password )
 {
-	QProcess p;
-	p.start( QStringLiteral( "veyon-auth-helper" ), QProcess::ReadWrite | QProcess::Unbuffered );
-	if( p.waitForStarted() == false )
+	const auto pamService = LinuxPlatformConfiguration( &VeyonCore::config() ).pamServiceName();
+
+	return m_authHelper.authenticate( VeyonCore::stripDomain( username ).toUtf8(), password.toByteArray(),
+									  pamService.toUtf8(), AuthHelperTimeout );
+}
+
+
+
+uid_t LinuxUserFunctions::userIdFromName( const QString& username )
+{
+	struct passwd entry{};
+	QByteArray buffer;
+
+	if( lookupUser( username, &entry, buffer ) )
 	{
-		vCritical() << "failed to start VeyonAuthHelper";
-		return false;
+		return entry.pw_uid;
 	}
 
-	const auto pamService = LinuxPlatformConfiguration( &VeyonCore::config() ).pamServiceName();
+	return 0;
+}
 
-	QDataStream ds( &p );
-	ds << VeyonCore::stripDomain( username ).toUtf8();
-	ds << password.toByteArray();
-	ds << pamService.toUtf8();
 
-	p.waitForFinished( AuthHelperTimeout );
 
-	if( p.state() != QProcess::NotRunning || p.exitCode() != 0 )
+QStringList LinuxUserFunctions::queryUserGroups()
+{
+	QStringList groupList;
+
+	QByteArray buffer( InitialNssBufferSize, 0 );
+	struct group entry{};
+	struct group* result = nullptr;
+
+	setgrent();
+
+	forever
 	{
-		vCritical() << "VeyonAuthHelper failed:" << p.exitCode()
-					<< p.readAllStandardOutput().trimmed() << p.readAllStandardError().trimmed();
-		return false;
+		const auto error = getgrent_r( &entry, buffer.data(), static_cast<size_t>( buffer.size() ), &result );
+		if( error == ERANGE && buffer.size() < MaximumNssBufferSize )
+		{
+			buffer.resize( buffer.size() * 2 );
+			continue;
+		}
+
+		if( error != 0 || result == nullptr )
+		{
+			break;
+		}
+
+		groupList += QString::fromUtf8( entry.gr_name ); // clazy:exclude=reserve-candidates
 	}
 
-	vDebug() << "User authenticated successfully";
-	return true;
+	endgrent();
+
+	const QStringList ignoredGroups( {
+		QStringLiteral("daemon"),
+		QStringLiteral("bin"),
+		QStringLiteral("tty"),
+		QStringLiteral("disk"),
+		QStringLiteral("lp"),
+		QStringLiteral("mail"),
+		QStringLiteral("news"),
+		QStringLiteral("uucp"),
+		QStringLiteral("man"),
+		QStringLiteral("proxy"),
+		QStringLiteral("kmem"),
+		QStringLiteral("dialout"),
+		QStringLiteral("fax"),
+		QStringLiteral("voice"),
+		QStringLiteral("cdrom"),
+		QStringLiteral("tape"),
+		QStringLiteral("audio"),
+		QStringLiteral("dip"),
+		QStringLiteral("www-data"),
+		QStringLiteral("backup"),
+		QStringLiteral("list"),
+		QStringLiteral("irc"),
+		QStringLiteral("src"),
+		QStringLiteral("gnats"),
+		QStringLiteral("shadow"),
+		QStringLiteral("utmp"),
+		QStringLiteral("video"),
+		QStringLiteral("sasl"),
+		QStringLiteral("plugdev"),
+		QStringLiteral("games"),
+		QStringLiteral("nogroup"),
+		QStringLiteral("libuuid"),
+		QStringLiteral("syslog"),
+		QStringLiteral("fuse"),
+		QStringLiteral("lpadmin"),
+		QStringLiteral("ssl-cert"),
+		QStringLiteral("messagebus"),
+		QStringLiteral("crontab"),
+		QStringLiteral("mlocate"),
+		QStringLiteral("avahi-autoipd"),
+		QStringLiteral("netdev"),
+		QStringLiteral("saned"),
+		QStringLiteral("sambashare"),
+		QStringLiteral("haldaemon"),
+		QStringLiteral("polkituser"),
+		QStringLiteral("mysql"),
+		QStringLiteral("avahi"),
+		QStringLiteral("klog"),
+		QStringLiteral("floppy"),
+		QStringLiteral("oprofile"),
+		QStringLiteral("netdev"),
+		QStringLiteral("dirmngr"),
+		QStringLiteral("vboxusers"),
+		QStringLiteral("bluetooth"),
+		QStringLiteral("colord"),
+		QStringLiteral("libvirtd"),
+		QStringLiteral("nm-openvpn"),
+		QStringLiteral("input"),
+		QStringLiteral("kvm"),
+		QStringLiteral("pulse"),
+		QStringLiteral("pulse-access"),
+		QStringLiteral("rtkit"),
+		QStringLiteral("scanner"),
+		QStringLiteral("sddm"),
+		QStringLiteral("systemd-bus-proxy"),
+		QStringLiteral("systemd-journal"),
+		QStringLiteral("systemd-network"),
+		QStringLiteral("systemd-resolve"),
+		QStringLiteral("systemd-timesync"),
+		QStringLiteral("utempter"),
+		QStringLiteral("uuidd"),
+							   } );
+
+	for( const auto& ignoredGroup : ignoredGroups )
+	{
+		groupList.removeAll( ignoredGroup );
+	}
+
+	// remove all empty entries
+	groupList.removeAll( QString() );
+
+	return groupList;
 }
 
 
 
-uid_t LinuxUserFunctions::userIdFromName( const QString& username )
+QStringList LinuxUserFunctions::queryGroupsOfUser( const QString& username )
 {
-	const auto pw_entry = getpwnam( username.toUtf8().constData() );
+	struct passwd userEntry{};
+	QByteArray userBuffer;
+	if( lookupUser( username, &userEntry, userBuffer ) == false )
+	{
+		vDebug() << "could not find user" << username;
+		return {};
+	}
 
-	if( pw_entry )
+	// let NSS resolve all memberships including the ones provided by modules which
+	// do not support enumerating groups (e.g. sssd) - getgrouplist() always adds
+	// the given primary group, which is filtered below unless it lists the user
+	QVector<gid_t> groupIds( InitialGroupCount );
+	auto groupCount = groupIds.size();
+
+	while( getgrouplist( userEntry.pw_name, userEntry.pw_gid, groupIds.data(), &groupCount ) < 0 )
 	{
-		return pw_entry->pw_uid;
+		if( groupCount <= groupIds.size() || groupCount > MaximumGroupCount )
+		{
+			vWarning() << "could not query groups of user" << username;
+			return {};
+		}
+
+		groupIds.resize( groupCount );
 	}
 
-	return 0;
+	QStringList groupList;
+	groupList.reserve( groupCount );
+
+	QByteArray buffer( InitialNssBufferSize, 0 );
+	struct group entry{};
+	struct group* result = nullptr;
+
+	for( int i = 0; i < groupCount; ++i )
+	{
+		int error = 0;
+		while( ( error = getgrgid_r( groupIds[i], &entry, buffer.data(), static_cast<size_t>( buffer.size() ), &result ) ) == ERANGE &&
+			   buffer.size() < MaximumNssBufferSize )
+		{
+			buffer.resize( buffer.size() * 2 );
+		}
+
+		if( error == 0 && result &&
+			( groupIds[i] != userEntry.pw_gid || isGroupMember( entry, userEntry.pw_name ) ) )
+		{
+			groupList += QString::fromUtf8( entry.gr_name );
+		}
+	}
+
+	groupList.removeAll( QString() );
+	groupList.removeDuplicates();
+
+	return groupList;
+}
+
+
+
+bool LinuxUserFunctions::isGroupMember( const struct group& entry, const char* username )
+{
+	for( auto member = entry.gr_mem; member && *member; ++member )
+	{
+		if( strcmp( *member, username ) == 0 )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+
+bool LinuxUserFunctions::lookupUser( const QString& username, struct passwd* entry, QByteArray& buffer )
+{
+	const auto name = username.toUtf8();
+
+	buffer.resize( InitialNssBufferSize );
+
+	struct passwd* result = nullptr;
+	int error = 0;
+
+	while( ( error = getpwnam_r( name.constData(), entry, buffer.data(), static_cast<size_t>( buffer.size() ), &result ) ) == ERANGE &&
+		   buffer.size() < MaximumNssBufferSize )
+	{
+		buffer.resize( buffer.size() * 2 );
+	}
+
+	return error == 0 && result != nullptr;
+}
+
+
+
+QDateTime LinuxUserFunctions::groupDatabaseTimestamp()
+{
+	QDateTime timestamp;
+
+	for( const auto& file : { QStringLiteral("/etc/group"), QStringLiteral("/etc/passwd"), QStringLiteral("/etc/nsswitch.conf") } )
+	{
+		timestamp = qMax( timestamp, QFileInfo( file ).lastModified() );
+	}
+
+	return timestamp;
+}
+
+
+
+void LinuxUserFunctions::validateGroupCache()
+{
+	const auto timestamp = groupDatabaseTimestamp();
+
+	if( timestamp != m_groupCacheTimestamp ||
+		m_groupCacheAge.isValid() == false ||
+		m_groupCacheAge.hasExpired( GroupCacheMaximumAge ) )
+	{
+		m_userGroupsCache.clear();
+		m_groupsOfUserCache.clear();
+
+		m_groupCacheTimestamp = timestamp;
+		m_groupCacheAge.start();
+	}
 }
@@ -24,9 +24,16 @@
 
 #pragma once
 
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+
+#include "LinuxAuthHelper.h"
 #include "LogonHelper.h"
 #include "PlatformUserFunctions.h"
 
+#include <grp.h>
 #include <pwd.h>
 
 // clazy:excludeall=copyable-polymorphic
@@ -51,9 +58,30 @@ public:
 	static uid_t userIdFromName( const QString& username );
 
 private:
-	static constexpr auto WhoProcessTimeout = 3000;
 	static constexpr auto AuthHelperTimeout = 10000;
+	static constexpr auto GroupCacheMaximumAge = 60000;
+	static constexpr auto InitialNssBufferSize = 16384;
+	static constexpr auto MaximumNssBufferSize = 1024*1024;
+	static constexpr auto InitialGroupCount = 64;
+	static constexpr auto MaximumGroupCount = 65536;
+
+	static QStringList queryUserGroups();
+	static QStringList queryGroupsOfUser( const QString& username );
+	static bool lookupUser( const QString& username, struct passwd* entry, QByteArray& buffer );
+	static bool isGroupMember( const struct group& entry, const char* username );
+	static QDateTime groupDatabaseTimestamp();
+
+	void validateGroupCache();
 
 	LogonHelper m_logonHelper{};
+	LinuxAuthHelper m_authHelper{};
+
+	// results of NSS queries, dropped whenever the local databases change and after
+	// GroupCacheMaximumAge to pick up changes from network sources such as LDAP
+	QMutex m_groupCacheMutex{};
+	QDateTime m_groupCacheTimestamp{};
+	QElapsedTimer m_groupCacheAge{};
+	QStringList m_userGroupsCache{};
+	QHash<QString, QStringList> m_groupsOfUserCache{};
 
 };
@@ -24,17 +24,33 @@
 
 #include <QDataStream>
 #include <QFile>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
 
 #include <security/pam_appl.h>
+#include <sys/prctl.h>
 
-static QByteArray pam_username; // clazy:exclude=non-pod-global-static
-static QByteArray pam_password; // clazy:exclude=non-pod-global-static
-static QByteArray pam_service; // clazy:exclude=non-pod-global-static
+#include "VeyonAuthHelperProtocol.h"
 
-static int pam_conv( int num_msg, const struct pam_message** msg, struct pam_response** resp, void * )
+static constexpr auto MaximumConcurrentConversations = 4;
+static constexpr auto MaximumPendingRequests = 32;
+
+struct Credentials
 {
+	QByteArray username;
+	QByteArray password;
+	QByteArray service;
+};
+
+
+static int pam_conv( int num_msg, const struct pam_message** msg, struct pam_response** resp, void* appdata_ptr )
+{
+	const auto credentials = reinterpret_cast<const Credentials *>( appdata_ptr );
+
 	auto reply = reinterpret_cast<pam_response *>(
-				malloc( sizeof(struct pam_response) * static_cast<size_t>( num_msg ) ) );
+				calloc( static_cast<size_t>( num_msg ), sizeof(struct pam_response) ) );
 	if( reply == nullptr )
 	{
 		return PAM_CONV_ERR;
@@ -46,11 +62,11 @@ static int pam_conv( int num_msg, const struct pam_message** msg, struct pam_res
 		{
 			case PAM_PROMPT_ECHO_ON:
 				reply[replies].resp_retcode = PAM_SUCCESS;
-				reply[replies].resp = strdup( pam_username.constData() );
+				reply[replies].resp = strdup( credentials->username.constData() );
 				break;
 			case PAM_PROMPT_ECHO_OFF:
 				reply[replies].resp_retcode = PAM_SUCCESS;
-				reply[replies].resp = strdup( pam_password.constData() );
+				reply[replies].resp = strdup( credentials->password.constData() );
 				break;
 			case PAM_TEXT_INFO:
 			case PAM_ERROR_MSG:
@@ -58,6 +74,10 @@ static int pam_conv( int num_msg, const struct pam_message** msg, struct pam_res
 				reply[replies].resp = nullptr;
 				break;
 			default:
+				for( int i = 0; i < replies; ++i )
+				{
+					free( reply[i].resp );
+				}
 				free( reply );
 				return PAM_CONV_ERR;
 		}
@@ -68,37 +88,149 @@ static int pam_conv( int num_msg, const struct pam_message** msg, struct pam_res
 }
 
 
-int main()
-{
-	QFile stdIn;
-	stdIn.open( 0, QFile::ReadOnly | QFile::Unbuffered );
-	QDataStream ds( &stdIn );
-	ds >> pam_username;
-	ds >> pam_password;
-	ds >> pam_service;
 
-	if( pam_service.isEmpty() )
-	{
-		pam_service = QByteArrayLiteral("login");
-	}
-
-	struct pam_conv pconv = { &pam_conv, nullptr };
+static int authenticate( const Credentials& credentials, QByteArray& message )
+{
+	struct pam_conv pconv = { &pam_conv, const_cast<Credentials *>( &credentials ) };
 	pam_handle_t* pamh = nullptr;
-	auto err = pam_start( pam_service.constData(), nullptr, &pconv, &pamh );
+	const auto service = credentials.service.isEmpty() ? QByteArrayLiteral("login") : credentials.service;
+	auto err = pam_start( service.constData(), nullptr, &pconv, &pamh );
 	if( err == PAM_SUCCESS )
 	{
 		err = pam_authenticate( pamh, PAM_SILENT );
 		if( err != PAM_SUCCESS )
 		{
-			printf( "pam_authenticate: %s\n", pam_strerror( pamh, err ) );
+			message = QByteArrayLiteral("pam_authenticate: ") + pam_strerror( pamh, err );
 		}
 	}
 	else
 	{
-		printf( "pam_start: %s\n", pam_strerror( pamh, err ) );
+		message = QByteArrayLiteral("pam_start: ") + pam_strerror( pamh, err );
 	}
 
 	pam_end( pamh, err );
 
+	return err;
+}
+
+
+
+class AuthenticationRequest : public QRunnable
+{
+public:
+	AuthenticationRequest( quint32 requestId, const Credentials& credentials,
+						   QMutex& outputMutex, QSemaphore& pendingRequests ) :
+		m_requestId( requestId ),
+		m_credentials( credentials ),
+		m_outputMutex( outputMutex ),
+		m_pendingRequests( pendingRequests )
+	{
+	}
+
+	~AuthenticationRequest() override
+	{
+		m_credentials.password.fill( 0 );
+	}
+
+	void run() override
+	{
+		QByteArray message;
+		const qint32 result = authenticate( m_credentials, message );
+
+		QByteArray response;
+		QDataStream( &response, QIODevice::WriteOnly ) << m_requestId << result << message;
+
+		m_outputMutex.lock();
+		VeyonAuthHelperProtocol::writeFrame( STDOUT_FILENO, response );
+		m_outputMutex.unlock();
+
+		m_pendingRequests.release();
+	}
+
+private:
+	const quint32 m_requestId;
+	Credentials m_credentials;
+	QMutex& m_outputMutex;
+	QSemaphore& m_pendingRequests;
+
+} ;
+
+
+
+// serve requests until the client closes its end of the socket - PAM conversations
+// run concurrently while the number of queued requests is bounded so a flooding
+// client blocks on writing instead of letting the helper grow without limits
+static int runServer()
+{
+	// as the helper is installed setuid root, unprivileged users must not get a persistent
+	// and concurrent password oracle - only Veyon Server (running as root) may use this mode
+	if( getuid() != 0 )
+	{
+		fprintf( stderr, "server mode requires to be started by root\n" );
+		return -1;
+	}
+
+	// keep passwords out of core dumps and inaccessible for ptrace
+	prctl( PR_SET_DUMPABLE, 0 );
+
+	QThreadPool workers;
+	workers.setMaxThreadCount( MaximumConcurrentConversations );
+
+	QMutex outputMutex;
+	QSemaphore pendingRequests( MaximumPendingRequests );
+
+	QByteArray request;
+	while( VeyonAuthHelperProtocol::readFrame( STDIN_FILENO, request, -1 ) )
+	{
+		quint32 requestId = 0;
+		Credentials credentials;
+
+		QDataStream stream( request );
+		stream >> requestId >> credentials.username >> credentials.password >> credentials.service;
+		request.fill( 0 );
+
+		if( stream.status() != QDataStream::Ok )
+		{
+			// stdout carries response frames only
+			fprintf( stderr, "invalid request\n" );
+			break;
+		}
+
+		pendingRequests.acquire();
+		workers.start( new AuthenticationRequest( requestId, credentials, outputMutex, pendingRequests ) );
+
+		credentials.password.fill( 0 );
+	}
+
+	workers.waitForDone();
+
+	return 0;
+}
+
+
+
+int main( int argc, char** argv )
+{
+	if( argc > 1 && qstrcmp( argv[1], VeyonAuthHelperProtocol::ServerArgument ) == 0 )
+	{
+		return runServer();
+	}
+
+	Credentials credentials;
+
+	QFile stdIn;
+	stdIn.open( 0, QFile::ReadOnly | QFile::Unbuffered );
+	QDataStream ds( &stdIn );
+	ds >> credentials.username;
+	ds >> credentials.password;
+	ds >> credentials.service;
+
+	QByteArray message;
+	const auto err = authenticate( credentials, message );
+	if( err != PAM_SUCCESS )
+	{
+		printf( "%s\n", message.constData() );
+	}
+
 	return err == PAM_SUCCESS ? 0 : -1;
 }
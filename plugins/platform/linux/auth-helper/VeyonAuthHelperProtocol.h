@@ -0,0 +1,142 @@
+/*
+ * VeyonAuthHelperProtocol.h - framing of requests to and responses from a persistent auth helper
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// A persistent auth helper is started with ServerArgument and serves requests from stdin
+// until EOF. Each request and response is sent as a frame consisting of the payload size
+// as 32 bit unsigned integer in network byte order followed by a QDataStream payload:
+//
+//   request:  quint32 requestId, QByteArray username, QByteArray password, QByteArray service
+//   response: quint32 requestId, qint32 pamResult, QByteArray message
+//
+// Responses are not necessarily sent in the order of the requests.
+namespace VeyonAuthHelperProtocol
+{
+
+static constexpr auto ServerArgument = "--server";
+static constexpr quint32 MaximumFrameSize = 64*1024;
+
+inline bool writeAll( int fd, const char* data, size_t size )
+{
+	while( size > 0 )
+	{
+		const auto written = ::send( fd, data, size, MSG_NOSIGNAL );
+		if( written < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		if( written <= 0 )
+		{
+			return false;
+		}
+
+		data += written;
+		size -= static_cast<size_t>( written );
+	}
+
+	return true;
+}
+
+
+
+// reads exactly size bytes, timeout < 0 waits infinitely
+inline bool readAll( int fd, char* data, size_t size, int timeout )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	while( size > 0 )
+	{
+		struct pollfd pfd = { fd, POLLIN, 0 };
+		const auto remaining = timeout < 0 ? -1 : static_cast<int>( qMax<qint64>( 0, timeout - timer.elapsed() ) );
+		const auto ready = ::poll( &pfd, 1, remaining );
+		if( ready < 0 && errno == EINTR )
+		{
+			continue;
+		}
+		if( ready <= 0 )
+		{
+			return false;
+		}
+
+		const auto received = ::read( fd, data, size ); // Flawfinder: ignore
+		if( received < 0 && ( errno == EINTR || errno == EAGAIN ) )
+		{
+			continue;
+		}
+		if( received <= 0 )
+		{
+			return false;
+		}
+
+		data += received;
+		size -= static_cast<size_t>( received );
+	}
+
+	return true;
+}
+
+
+
+inline bool writeFrame( int fd, const QByteArray& payload )
+{
+	const auto header = qToBigEndian<quint32>( static_cast<quint32>( payload.size() ) );
+
+	return writeAll( fd, reinterpret_cast<const char *>( &header ), sizeof(header) ) &&
+			writeAll( fd, payload.constData(), static_cast<size_t>( payload.size() ) );
+}
+
+
+
+inline bool readFrame( int fd, QByteArray& payload, int timeout )
+{
+	quint32 header = 0;
+	if( readAll( fd, reinterpret_cast<char *>( &header ), sizeof(header), timeout ) == false )
+	{
+		return false;
+	}
+
+	const auto size = qFromBigEndian<quint32>( header );
+	if( size > MaximumFrameSize )
+	{
+		return false;
+	}
+
+	payload.resize( static_cast<int>( size ) );
+
+	return readAll( fd, payload.data(), size, timeout );
+}
+
+}
@@ -23,7 +23,7 @@
 
 #include "QmlCore.h"
 #include "RemoteAccessPage.h"
-#include "Screenshot.h"
+#include "ScreenshotPipeline.h"
 #include "VncViewItem.h"
 
 
@@ -58,6 +58,8 @@ QQuickItem* RemoteAccessPage::view() const
 /*
 void RemoteAccessPage::takeScreenshot()
 {
-	Screenshot().take( m_computerControlInterface );
+	auto screenshotPipeline = new ScreenshotPipeline( this );
+	connect( screenshotPipeline, &ScreenshotPipeline::finished, screenshotPipeline, &QObject::deleteLater );
+	screenshotPipeline->take( { m_computerControlInterface } );
 }
 */
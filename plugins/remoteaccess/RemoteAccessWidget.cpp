@@ -36,7 +36,7 @@
 #include "ComputerControlInterface.h"
 #include "PlatformCoreFunctions.h"
 #include "ToolButton.h"
-#include "Screenshot.h"
+#include "ScreenshotPipeline.h"
 
 
 // toolbar for remote-control-widget
@@ -356,5 +356,7 @@ void RemoteAccessWidget::toggleViewOnly( bool viewOnly )
 
 void RemoteAccessWidget::takeScreenshot()
 {
-	Screenshot().take( m_computerControlInterface );
+	auto screenshotPipeline = new ScreenshotPipeline( this );
+	connect( screenshotPipeline, &ScreenshotPipeline::finished, screenshotPipeline, &QObject::deleteLater );
+	screenshotPipeline->take( { m_computerControlInterface } );
 }
@@ -22,8 +22,6 @@
  *
  */
 
-#include <QCoreApplication>
-
 #include "ScreenLockFeaturePlugin.h"
 #include "FeatureWorkerManager.h"
 #include "LockWidget.h"
@@ -128,8 +126,6 @@ bool ScreenLockFeaturePlugin::handleFeatureMessage( VeyonServerInterface& server
 
 bool ScreenLockFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message )
 {
-	Q_UNUSED(worker)
-
 	if( m_screenLockFeature.uid() == message.featureUid() )
 	{
 		switch( message.command() )
@@ -150,7 +146,7 @@ bool ScreenLockFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker
 
 			VeyonCore::platform().coreFunctions().restoreScreenSaverSettings();
 
-			QCoreApplication::quit();
+			worker.stopFeatureWorker( message.featureUid() );
 
 			return true;
 
@@ -161,3 +157,25 @@ bool ScreenLockFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worker
 
 	return false;
 }
+
+
+
+bool ScreenLockFeaturePlugin::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+{
+	Q_UNUSED(worker)
+
+	if( feature != m_screenLockFeature )
+	{
+		return false;
+	}
+
+	if( m_lockWidget )
+	{
+		delete m_lockWidget;
+		m_lockWidget = nullptr;
+
+		VeyonCore::platform().coreFunctions().restoreScreenSaverSettings();
+	}
+
+	return true;
+}
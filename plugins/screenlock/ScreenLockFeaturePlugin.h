@@ -87,6 +87,18 @@ public:
 
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) override;
 
+	bool isWorkerHostable( const Feature& feature ) const override
+	{
+		return feature == m_screenLockFeature;
+	}
+
+	bool isWorkerRestorable( const Feature& feature ) const override
+	{
+		return feature == m_screenLockFeature;
+	}
+
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) override;
+
 private:
 	enum Commands
 	{
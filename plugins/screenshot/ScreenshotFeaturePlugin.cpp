@@ -25,7 +25,7 @@
 #include <QMessageBox>
 
 #include "ComputerControlInterface.h"
-#include "Screenshot.h"
+#include "ScreenshotPipeline.h"
 #include "ScreenshotFeaturePlugin.h"
 #include "QmlCore.h"
 #include "VeyonMasterInterface.h"
@@ -62,16 +62,19 @@ bool ScreenshotFeaturePlugin::startFeature( VeyonMasterInterface& master, const
 {
 	if( feature.uid() == m_screenshotFeature.uid() )
 	{
-		for( const auto& controlInterface : computerControlInterfaces )
-		{
-			Screenshot().take( controlInterface );
-
-		}
-
-		QMessageBox::information( master.mainWindow(),
-								  tr( "Screenshots taken" ),
-								  tr( "Screenshot of %1 computer have been taken successfully." ).
-								  arg( computerControlInterfaces.count() ) );
+		auto mainWindow = master.mainWindow();
+
+		// screenshots are grabbed and saved in background so report once all of them are done
+		auto screenshotPipeline = new ScreenshotPipeline( this );
+		connect( screenshotPipeline, &ScreenshotPipeline::finished, this, [=]() {
+			screenshotPipeline->deleteLater();
+			QMessageBox::information( mainWindow,
+									  tr( "Screenshots taken" ),
+									  tr( "Screenshot of %1 computer have been taken successfully." ).
+									  arg( screenshotPipeline->savedCount() ) );
+		} );
+
+		screenshotPipeline->take( computerControlInterfaces );
 
 		return true;
 	}
@@ -22,9 +22,179 @@
  *
  */
 
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMetaEnum>
+#include <QSet>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "CommandLineIO.h"
 #include "AccessControlProvider.h"
+#include "AsyncLogWriter.h"
+#include "Configuration/JsonStore.h"
+#include "Configuration/Object.h"
+#include "FeatureManager.h"
+#include "FeatureMessage.h"
+#include "FeatureWorkerManager.h"
+#include "MetricsRegistry.h"
+#include "NetworkObject.h"
+#include "PlatformPluginInterface.h"
+#include "PlatformUserFunctions.h"
 #include "TestingCommandLinePlugin.h"
+#include "VeyonConfiguration.h"
+#include "VeyonServerInterface.h"
+#include "VeyonTestingPamModule.h"
+
+#ifdef Q_OS_LINUX
+#include "../platform/linux/auth-helper/VeyonAuthHelperProtocol.h"
+#endif
+
+
+class BenchmarkServer : public VeyonServerInterface
+{
+public:
+	explicit BenchmarkServer( FeatureManager& featureManager ) :
+		m_featureManager( featureManager ),
+		m_featureWorkerManager( *this, featureManager )
+	{
+	}
+
+	FeatureManager& featureManager() override
+	{
+		return m_featureManager;
+	}
+
+	FeatureWorkerManager& featureWorkerManager() override
+	{
+		return m_featureWorkerManager;
+	}
+
+	bool sendFeatureMessageReply( const MessageContext& context, const FeatureMessage& reply ) override
+	{
+		Q_UNUSED(context)
+		Q_UNUSED(reply)
+		return true;
+	}
+
+private:
+	FeatureManager& m_featureManager;
+	FeatureWorkerManager m_featureWorkerManager;
+
+} ;
+
+
+
+static qint64 runLoggingThreads( int threadCount, int messageCount, const std::function<void(const QString&)>& log )
+{
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount( threadCount );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QList<QFuture<void>> threads;
+	for( int thread = 0; thread < threadCount; ++thread )
+	{
+		threads.append( QtConcurrent::run( &threadPool, [=]() {
+			for( int i = 0; i < messageCount; ++i )
+			{
+				log( QStringLiteral("benchmark thread %1 message %2").arg( thread ).arg( i ) );
+			}
+		} ) );
+	}
+
+	for( auto& thread : threads )
+	{
+		thread.waitForFinished();
+	}
+
+	return timer.nsecsElapsed();
+}
+
+
+
+// previous implementation of JsonStore::load() for comparison
+static void loadJsonTreePerValue( Configuration::Object* obj, const QJsonObject& jsonParent, const QString& parentKey )
+{
+	for( auto it = jsonParent.begin(); it != jsonParent.end(); ++it )
+	{
+		if( it.value().isObject() )
+		{
+			const auto jsonObject = it.value().toObject();
+
+			if( jsonObject.contains( QStringLiteral( "JsonStoreArray" ) ) )
+			{
+				obj->setValue( it.key(), jsonObject[QStringLiteral("JsonStoreArray")].toArray(), parentKey );
+			}
+			else if( jsonObject.contains( QStringLiteral( "JsonStoreObject" ) ) )
+			{
+				obj->setValue( it.key(), jsonObject[QStringLiteral("JsonStoreObject")].toObject(), parentKey );
+			}
+			else
+			{
+				const QString subParentKey = parentKey + ( parentKey.isEmpty() ? QString() : QStringLiteral("/") ) + it.key();
+				loadJsonTreePerValue( obj, jsonObject, subParentKey );
+			}
+		}
+		else
+		{
+			obj->setValue( it.key(), it.value().toVariant(), parentKey );
+		}
+	}
+}
+
+
+
+static qint64 transferData( QTcpSocket& sender, QTcpSocket& receiver, qint64 totalSize, int chunkSize )
+{
+	static constexpr auto TransferTimeout = 60000;
+
+	const QByteArray chunk( chunkSize, 'x' );
+	qint64 sentSize = 0;
+	qint64 receivedSize = 0;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	while( receivedSize < totalSize )
+	{
+		// keep a few chunks in flight without queueing the whole payload in the write buffer
+		while( sentSize < totalSize && sender.bytesToWrite() < 4 * chunkSize )
+		{
+			sentSize += sender.write( chunk.constData(), qMin<qint64>( chunkSize, totalSize - sentSize ) );
+		}
+		sender.flush();
+
+		if( receiver.bytesAvailable() > 0 || receiver.waitForReadyRead( 10 ) )
+		{
+			receivedSize += receiver.read( receiver.bytesAvailable() ).size();
+		}
+
+		if( timer.elapsed() > TransferTimeout )
+		{
+			return -1;
+		}
+	}
+
+	return timer.nsecsElapsed();
+}
+
 
 
 TestingCommandLinePlugin::TestingCommandLinePlugin( QObject* parent ) :
@@ -34,6 +204,15 @@ TestingCommandLinePlugin::TestingCommandLinePlugin( QObject* parent ) :
 { QStringLiteral("authorizedgroups"), QStringLiteral( "check if specified user is in authorized groups [ACCESSING USER]" ) },
 { QStringLiteral("accesscontrolrules"), QStringLiteral( "process access control rules with arguments [ACCESSING USER] [ACCESSING COMPUTER] [LOCAL USER] [LOCAL COMPUTER] [CONNECTED USER]" ) },
 { QStringLiteral("isaccessdeniedbylocalstate"), QStringLiteral( "check if access would be denied by local state") },
+{ QStringLiteral("benchmarkauthentication"), QStringLiteral( "measure concurrent logon authentications with arguments [USERNAME] [PASSWORD] [COUNT] [THREADS]" ) },
+{ QStringLiteral("authhelperprotocol"), QStringLiteral( "exercise the protocol of a persistent veyon-auth-helper as root with arguments [HELPER] [PAM SERVICE] [REQUESTS]" ) },
+{ QStringLiteral("authhelper"), QStringLiteral( "authenticate through veyon-auth-helper using the stub PAM module as root with arguments [PAM MODULE]" ) },
+{ QStringLiteral("benchmarkaccesscontrolrules"), QStringLiteral( "measure processing of configured access control rules with arguments [ITERATIONS] [ACCESSING USER] [ACCESSING COMPUTER] [LOCAL USER] [LOCAL COMPUTER] [CONNECTED USER]" ) },
+{ QStringLiteral("benchmarkfeaturemessages"), QStringLiteral( "compare encoding and decoding performance of feature message formats [ITERATIONS]" ) },
+{ QStringLiteral("benchmarkworkermessages"), QStringLiteral( "measure latency and throughput of messages to a loopback feature worker [COUNT]" ) },
+{ QStringLiteral("benchmarklogger"), QStringLiteral( "compare synchronous and asynchronous log writing from concurrent threads [THREADS] [MESSAGES PER THREAD]" ) },
+{ QStringLiteral("benchmarkjsonstore"), QStringLiteral( "measure loading and saving a JSON configuration with many builtin directory entries [ENTRIES]" ) },
+{ QStringLiteral("benchmarklocaltransport"), QStringLiteral( "compare throughput of loopback TCP and Unix domain sockets as used between Veyon Server and VNC server [MEGABYTES] [CHUNK SIZE]" ) },
 				} )
 {
 }
@@ -118,3 +297,844 @@ CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_isaccessd
 
 	return Successful;
 }
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkauthentication( const QStringList& arguments )
+{
+	const auto username = arguments.value( 0 );
+	const auto password = arguments.value( 1 ).toUtf8();
+	const auto count = qMax( 1, arguments.value( 2, QStringLiteral("100") ).toInt() );
+	const auto threadCount = qMax( 1, arguments.value( 3, QStringLiteral("8") ).toInt() );
+
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount( threadCount );
+
+	QAtomicInt successfulCount;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QList<QFuture<void>> authentications;
+	authentications.reserve( count );
+
+	for( int i = 0; i < count; ++i )
+	{
+		authentications.append( QtConcurrent::run( &threadPool, [&]() {
+			if( VeyonCore::platform().userFunctions().authenticate( username, password ) )
+			{
+				successfulCount.ref();
+			}
+		} ) );
+	}
+
+	for( auto& authentication : authentications )
+	{
+		authentication.waitForFinished();
+	}
+
+	const auto totalTime = timer.nsecsElapsed();
+
+	printf( "[TEST]: BenchmarkAuthentication: %d/%d successful  %2d threads  %8.2f ms/authentication  %8.2f authentications/s\n",
+			successfulCount.load(), count, threadCount,
+			double(totalTime) / count / 1000000, count / ( double(totalTime) / 1000000000 ) );
+
+	return Successful;
+}
+
+
+
+#ifdef Q_OS_LINUX
+static int startAuthHelper( const QByteArray& helper, pid_t& pid )
+{
+	int sockets[2] = { -1, -1 };
+	if( ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets ) != 0 )
+	{
+		return -1;
+	}
+
+	QByteArray program = helper;
+	QByteArray serverArgument = VeyonAuthHelperProtocol::ServerArgument;
+	char* const arguments[] = { program.data(), serverArgument.data(), nullptr };
+
+	pid = fork();
+	if( pid == 0 )
+	{
+		dup2( sockets[1], STDIN_FILENO );
+		dup2( sockets[1], STDOUT_FILENO );
+		execv( arguments[0], arguments );
+		_exit( 1 );
+	}
+
+	::close( sockets[1] );
+
+	if( pid < 0 )
+	{
+		::close( sockets[0] );
+		return -1;
+	}
+
+	return sockets[0];
+}
+
+
+
+static bool stopAuthHelper( int socket, pid_t pid )
+{
+	shutdown( socket, SHUT_WR );
+	::close( socket );
+
+	int status = 0;
+	return waitpid( pid, &status, 0 ) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+
+// the helper has to close the connection without writing anything to stdout
+static bool expectAuthHelperHangup( int socket, int timeout )
+{
+	char data = 0;
+	return VeyonAuthHelperProtocol::readAll( socket, &data, 1, timeout ) == false &&
+			::recv( socket, &data, 1, MSG_DONTWAIT ) == 0;
+}
+#endif
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_authhelperprotocol( const QStringList& arguments )
+{
+#ifdef Q_OS_LINUX
+	static constexpr auto ResponseTimeout = 30000;
+
+	const auto helper = QFile::encodeName( arguments.value( 0, QCoreApplication::applicationDirPath() +
+																 QStringLiteral("/veyon-auth-helper") ) );
+	const auto service = arguments.value( 1, QStringLiteral("login") ).toUtf8();
+	const auto count = qBound<quint32>( 1, arguments.value( 2, QStringLiteral("16") ).toUInt(), 1000 );
+
+	if( getuid() != 0 )
+	{
+		printf( "[TEST]: AuthHelperProtocol: FAIL (has to be run as root like Veyon Server)\n" );
+		return Failed;
+	}
+
+	pid_t pid = 0;
+	auto socket = startAuthHelper( helper, pid );
+	if( socket < 0 )
+	{
+		printf( "[TEST]: AuthHelperProtocol: FAIL (could not start %s)\n", helper.constData() );
+		return Failed;
+	}
+
+	// pipeline all requests and expect exactly one response per request in any order
+	QElapsedTimer timer;
+	timer.start();
+
+	for( quint32 requestId = 1; requestId <= count; ++requestId )
+	{
+		QByteArray request;
+		QDataStream( &request, QIODevice::WriteOnly ) << requestId << QByteArrayLiteral("veyon-protocol-test")
+													  << QByteArrayLiteral("invalid") << service;
+		if( VeyonAuthHelperProtocol::writeFrame( socket, request ) == false )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (could not send request %u)\n", requestId );
+			stopAuthHelper( socket, pid );
+			return Failed;
+		}
+	}
+
+	QSet<quint32> pendingRequests;
+	for( quint32 requestId = 1; requestId <= count; ++requestId )
+	{
+		pendingRequests.insert( requestId );
+	}
+
+	while( pendingRequests.isEmpty() == false )
+	{
+		QByteArray response;
+		quint32 requestId = 0;
+		qint32 pamResult = 0;
+		QByteArray message;
+
+		if( VeyonAuthHelperProtocol::readFrame( socket, response, ResponseTimeout ) == false )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (%d responses missing)\n", pendingRequests.size() );
+			stopAuthHelper( socket, pid );
+			return Failed;
+		}
+
+		QDataStream stream( response );
+		stream >> requestId >> pamResult >> message;
+
+		if( stream.status() != QDataStream::Ok || stream.atEnd() == false ||
+			pendingRequests.remove( requestId ) == false )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (invalid or unexpected response for request %u)\n", requestId );
+			stopAuthHelper( socket, pid );
+			return Failed;
+		}
+
+		if( pamResult == 0 )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (invalid credentials accepted)\n" );
+			stopAuthHelper( socket, pid );
+			return Failed;
+		}
+	}
+
+	printf( "[TEST]: AuthHelperProtocol: %u pipelined requests answered in %lld ms\n", count, timer.elapsed() );
+
+	if( stopAuthHelper( socket, pid ) == false )
+	{
+		printf( "[TEST]: AuthHelperProtocol: FAIL (helper did not exit cleanly on EOF)\n" );
+		return Failed;
+	}
+
+	// a malformed request and an oversized frame must make the helper hang up
+	const QByteArray malformedRequest( "\x00\x00\x00\x02xx", 6 );
+	const QByteArray oversizedFrame( "\xff\xff\xff\xff", 4 );
+
+	for( const auto& data : { malformedRequest, oversizedFrame } )
+	{
+		socket = startAuthHelper( helper, pid );
+		if( socket < 0 )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (could not restart %s)\n", helper.constData() );
+			return Failed;
+		}
+
+		const auto hungUp = VeyonAuthHelperProtocol::writeAll( socket, data.constData(), size_t( data.size() ) ) &&
+							expectAuthHelperHangup( socket, ResponseTimeout );
+
+		stopAuthHelper( socket, pid );
+
+		if( hungUp == false )
+		{
+			printf( "[TEST]: AuthHelperProtocol: FAIL (helper did not reject invalid data)\n" );
+			return Failed;
+		}
+	}
+
+	printf( "[TEST]: AuthHelperProtocol: OK\n" );
+
+	return Successful;
+#else
+	Q_UNUSED(arguments)
+
+	printf( "[TEST]: AuthHelperProtocol: not supported on this platform\n" );
+
+	return Failed;
+#endif
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_authhelper( const QStringList& arguments )
+{
+#ifdef Q_OS_LINUX
+	// slightly more than LinuxUserFunctions::AuthHelperTimeout
+	static constexpr auto HangingAuthenticationTimeout = 15000;
+
+	QDir pluginDir( QCoreApplication::applicationDirPath() );
+	pluginDir.cd( VeyonCore::pluginDir() );
+
+	const auto module = arguments.value( 0, pluginDir.absoluteFilePath( QStringLiteral("pam/%1").
+																			arg( QLatin1String(VeyonTestingPamModule::FileName) ) ) );
+
+	if( getuid() != 0 )
+	{
+		printf( "[TEST]: AuthHelper: FAIL (has to be run as root like Veyon Server)\n" );
+		return Failed;
+	}
+
+	if( QFileInfo::exists( module ) == false )
+	{
+		printf( "[TEST]: AuthHelper: FAIL (stub PAM module %s not found)\n", qUtf8Printable(module) );
+		return Failed;
+	}
+
+	QTemporaryDir tempDir;
+	const auto conversationLog = tempDir.filePath( QStringLiteral("conversations.log") );
+
+	// set up a PAM service which only consists of the stub module for the duration of the test
+	const auto service = QStringLiteral("veyon-testing-%1").arg( QCoreApplication::applicationPid() );
+	QFile serviceFile( QStringLiteral("/etc/pam.d/") + service );
+	if( serviceFile.open( QFile::WriteOnly | QFile::Text ) == false ) // Flawfinder: ignore
+	{
+		printf( "[TEST]: AuthHelper: FAIL (could not create PAM service %s)\n", qUtf8Printable(service) );
+		return Failed;
+	}
+	serviceFile.write( QStringLiteral("auth required %1 log=%2\n").arg( module, conversationLog ).toUtf8() );
+	serviceFile.close();
+
+	VeyonCore::config().setValue( QStringLiteral("PamServiceName"), service, QStringLiteral("Linux") );
+
+	const auto conversationCount = [&conversationLog]() {
+		QFile logFile( conversationLog );
+		return logFile.open( QFile::ReadOnly ) ? logFile.readAll().count( '\n' ) : 0; // Flawfinder: ignore
+	};
+
+	const auto authenticate = []( const char* username, const char* password ) {
+		return VeyonCore::platform().userFunctions().authenticate( QString::fromUtf8( username ),
+																   QByteArray( password ) );
+	};
+
+	QString failure;
+
+	QElapsedTimer timer;
+	timer.start();
+
+	if( authenticate( VeyonTestingPamModule::ValidUser, VeyonTestingPamModule::ValidPassword ) == false )
+	{
+		failure = QStringLiteral("valid credentials rejected");
+	}
+	else if( authenticate( VeyonTestingPamModule::ValidUser, "invalid" ) )
+	{
+		failure = QStringLiteral("invalid credentials accepted");
+	}
+	else if( conversationCount() != 2 )
+	{
+		failure = QStringLiteral("credentials not received exactly once per authentication");
+	}
+	else
+	{
+		printf( "[TEST]: AuthHelper: 2 authentications in %lld ms\n", timer.elapsed() );
+
+		// a hanging conversation must time out without resending the credentials and
+		// the helper has to be replaced so it does not keep the conversation running
+		timer.restart();
+
+		if( authenticate( VeyonTestingPamModule::HangingUser, VeyonTestingPamModule::ValidPassword ) )
+		{
+			failure = QStringLiteral("hanging authentication succeeded");
+		}
+		else if( timer.elapsed() > HangingAuthenticationTimeout )
+		{
+			failure = QStringLiteral("hanging authentication did not time out");
+		}
+		else if( conversationCount() != 3 )
+		{
+			failure = QStringLiteral("credentials resent after timeout");
+		}
+		else if( authenticate( VeyonTestingPamModule::ValidUser, VeyonTestingPamModule::ValidPassword ) == false )
+		{
+			failure = QStringLiteral("helper not restarted after timeout");
+		}
+	}
+
+	serviceFile.remove();
+
+	if( failure.isEmpty() == false )
+	{
+		printf( "[TEST]: AuthHelper: FAIL (%s)\n", qUtf8Printable(failure) );
+		return Failed;
+	}
+
+	printf( "[TEST]: AuthHelper: OK\n" );
+
+	return Successful;
+#else
+	Q_UNUSED(arguments)
+
+	printf( "[TEST]: AuthHelper: not supported on this platform\n" );
+
+	return Failed;
+#endif
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkaccesscontrolrules( const QStringList& arguments )
+{
+	const auto iterations = qMax( 1, arguments.value( 0, QStringLiteral("100") ).toInt() );
+
+	// help texts match the ones of AccessControlProvider as whoever registers first defines them
+	auto& userGroupQueries = VeyonCore::metrics().counter( QStringLiteral("veyon_access_control_user_group_queries_total"),
+														   QStringLiteral("Groups of user queried from user groups backend for access control") );
+	auto& locationQueries = VeyonCore::metrics().counter( QStringLiteral("veyon_access_control_location_queries_total"),
+														  QStringLiteral("Locations of computer queried from network object directory for access control") );
+
+	// force compiling the rules instead of using the ones cached for the current configuration
+	VeyonCore::config().setValue( QStringLiteral("BenchmarkGeneration"), QUuid::createUuid(), QStringLiteral("Testing") );
+
+	QElapsedTimer timer;
+	timer.start();
+
+	AccessControlProvider accessControlProvider;
+
+	const auto compileTime = timer.nsecsElapsed();
+
+	timer.restart();
+
+	AccessControlProvider cachedAccessControlProvider;
+
+	const auto cachedCompileTime = timer.nsecsElapsed();
+
+	const auto userGroupQueriesBefore = userGroupQueries.value();
+	const auto locationQueriesBefore = locationQueries.value();
+
+	auto action = AccessControlRule::Action::None;
+
+	timer.restart();
+
+	for( int i = 0; i < iterations; ++i )
+	{
+		action = accessControlProvider.processAccessControlRules( arguments.value( 1 ), arguments.value( 2 ),
+																  arguments.value( 3 ), arguments.value( 4 ),
+																  QStringList( arguments.value( 5 ) ) );
+	}
+
+	const auto evaluationTime = timer.nsecsElapsed();
+
+	printf( "[TEST]: BenchmarkAccessControlRules: result %s  compile %8.2f us  cached %8.2f us  evaluation %8.2f us  "
+			"user group queries %5.2f  location queries %5.2f\n",
+			QMetaEnum::fromType<AccessControlRule::Action>().valueToKey( static_cast<int>( action ) ),
+			double(compileTime) / 1000, double(cachedCompileTime) / 1000, double(evaluationTime) / iterations / 1000,
+			double( userGroupQueries.value() - userGroupQueriesBefore ) / iterations,
+			double( locationQueries.value() - locationQueriesBefore ) / iterations );
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkfeaturemessages( const QStringList& arguments )
+{
+	const auto iterations = qMax( 1, arguments.value( 0, QStringLiteral("1000") ).toInt() );
+
+	const QList<QPair<QString, FeatureMessage>> messages{
+		{ QStringLiteral("query"), FeatureMessage( QUuid::createUuid(), FeatureMessage::DefaultCommand ) },
+		{ QStringLiteral("user info"), FeatureMessage( QUuid::createUuid(), FeatureMessage::DefaultCommand ).
+				  addArgument( 0, QStringLiteral("DOMAIN\\username") ).
+				  addArgument( 1, QStringLiteral("Firstname Lastname") ) },
+		{ QStringLiteral("file chunk"), FeatureMessage( QUuid::createUuid(), FeatureMessage::DefaultCommand ).
+				  addArgument( 0, QUuid::createUuid() ).
+				  addArgument( 1, QByteArray( 256*1024, 'x' ) ) },
+	};
+
+	const QList<QPair<QString, FeatureMessage::Format>> formats{
+		{ QStringLiteral("variant array"), FeatureMessage::Format::VariantArray },
+		{ QStringLiteral("compact"), FeatureMessage::Format::Compact },
+	};
+
+	for( const auto& message : messages )
+	{
+		for( const auto& format : formats )
+		{
+			QElapsedTimer timer;
+			timer.start();
+
+			QByteArray data;
+			for( int i = 0; i < iterations; ++i )
+			{
+				data = message.second.serialize( format.second );
+			}
+
+			const auto encodeTime = timer.nsecsElapsed();
+
+			timer.restart();
+
+			for( int i = 0; i < iterations; ++i )
+			{
+				QBuffer buffer( &data );
+				buffer.open( QBuffer::ReadOnly ); // Flawfinder: ignore
+				FeatureMessage receivedMessage;
+				if( receivedMessage.receive( &buffer ) == false ||
+					receivedMessage.arguments() != message.second.arguments() )
+				{
+					printf( "[TEST]: BenchmarkFeatureMessages: FAIL (%s, %s)\n",
+							qUtf8Printable(message.first), qUtf8Printable(format.first) );
+					return Failed;
+				}
+			}
+
+			const auto decodeTime = timer.nsecsElapsed();
+
+			printf( "[TEST]: BenchmarkFeatureMessages: %-10s %-14s %8d bytes  encode %8.2f us  decode %8.2f us\n",
+					qUtf8Printable(message.first), qUtf8Printable(format.first), data.size(),
+					double(encodeTime) / iterations / 1000, double(decodeTime) / iterations / 1000 );
+		}
+	}
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkworkermessages( const QStringList& arguments )
+{
+	static constexpr auto ReceiveTimeout = 10000;
+	static constexpr auto ChunkSize = 256*1024;
+
+	const auto count = qMax( 1, arguments.value( 0, QStringLiteral("1000") ).toInt() );
+
+	FeatureManager featureManager;
+	BenchmarkServer server( featureManager );
+	auto& workerManager = server.featureWorkerManager();
+
+	// any feature which can be hosted will do as the stand-in worker host only receives messages
+	const auto& features = featureManager.features();
+	const auto featureIt = std::find_if( features.begin(), features.end(), [&]( const Feature& f ) {
+		return featureManager.isWorkerHostable( f );
+	} );
+	if( featureIt == features.end() )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (no hostable feature available)\n" );
+		return Failed;
+	}
+	const auto feature = *featureIt;
+
+	// stand-in for a worker host process connecting back to the server
+	QTcpSocket workerSocket;
+	workerSocket.connectToHost( QHostAddress::LocalHost,
+								static_cast<quint16>( VeyonCore::config().featureWorkerManagerPort() + VeyonCore::sessionId() ) );
+	if( workerSocket.waitForConnected() == false )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (could not connect to feature worker manager)\n" );
+		return Failed;
+	}
+
+	const auto workerHostUid = FeatureWorkerManager::workerHostUid( FeatureWorkerManager::ManagedSystemProcess );
+	const auto workerHostToken = workerManager.expectWorkerHost( FeatureWorkerManager::ManagedSystemProcess );
+
+	// the metrics report is processed right after the host registration so once it shows up
+	// the feature can be started in our stand-in host without spawning a real process
+	FeatureMessage( workerHostUid, FeatureMessage::InitCommand ).
+			addArgument( FeatureWorkerManager::TokenArgument, workerHostToken ).
+			send( &workerSocket, FeatureMessage::Format::Compact );
+	FeatureMessage( FeatureWorkerManager::metricsReportUid(), FeatureMessage::DefaultCommand ).
+			addArgument( FeatureWorkerManager::ProcessNameArgument, QStringLiteral("benchmark") ).
+			addArgument( FeatureWorkerManager::MetricsArgument, QVariantList{} ).
+			send( &workerSocket, FeatureMessage::Format::Compact );
+
+	QElapsedTimer registrationTimer;
+	registrationTimer.start();
+	while( workerManager.workerMetrics().isEmpty() && registrationTimer.elapsed() < ReceiveTimeout )
+	{
+		QCoreApplication::processEvents();
+		workerSocket.waitForBytesWritten( 1 );
+	}
+
+	if( workerManager.workerMetrics().isEmpty() )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (stand-in worker host not registered - is a Veyon Server running on this port?)\n" );
+		return Failed;
+	}
+
+	workerManager.startWorker( feature, FeatureWorkerManager::ManagedSystemProcess );
+
+	const auto receiveMessages = [&]( int messageCount ) {
+		QElapsedTimer timeoutTimer;
+		timeoutTimer.start();
+
+		FeatureMessage message;
+		while( messageCount > 0 && timeoutTimer.elapsed() < ReceiveTimeout )
+		{
+			QCoreApplication::processEvents();
+			workerSocket.waitForReadyRead( 1 );
+
+			while( messageCount > 0 && message.isReadyForReceive( &workerSocket ) && message.receive( &workerSocket ) )
+			{
+				--messageCount;
+			}
+		}
+		return messageCount == 0;
+	};
+
+	// worker host is asked to start the feature which then registers the feature's connection
+	if( receiveMessages( 1 ) == false )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (feature not started in stand-in worker host)\n" );
+		return Failed;
+	}
+
+	FeatureMessage( feature.uid(), FeatureMessage::InitCommand ).send( &workerSocket, FeatureMessage::Format::Compact );
+
+	FeatureMessage message( feature.uid(), FeatureMessage::DefaultCommand );
+	message.addArgument( 0, count );
+
+	// first message is delivered as soon as the worker has been registered
+	workerManager.sendMessage( message );
+	if( receiveMessages( 1 ) == false )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (no messages received - is a Veyon Server running on this port?)\n" );
+		return Failed;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for( int i = 0; i < count; ++i )
+	{
+		workerManager.sendMessage( message );
+		if( receiveMessages( 1 ) == false )
+		{
+			printf( "[TEST]: BenchmarkWorkerMessages: FAIL (timeout while measuring latency)\n" );
+			return Failed;
+		}
+	}
+
+	printf( "[TEST]: BenchmarkWorkerMessages: latency %8.2f us\n", double(timer.nsecsElapsed()) / count / 1000 );
+
+	FeatureMessage chunkMessage( feature.uid(), FeatureMessage::DefaultCommand );
+	chunkMessage.addArgument( 0, QByteArray( ChunkSize, 'x' ) );
+
+	timer.restart();
+
+	for( int i = 0; i < count; ++i )
+	{
+		workerManager.sendMessage( chunkMessage );
+	}
+
+	if( receiveMessages( count ) == false )
+	{
+		printf( "[TEST]: BenchmarkWorkerMessages: FAIL (timeout while measuring throughput)\n" );
+		return Failed;
+	}
+
+	printf( "[TEST]: BenchmarkWorkerMessages: throughput %8.2f MB/s\n",
+			double(count) * ChunkSize / 1024 / 1024 / ( double(timer.nsecsElapsed()) / 1000000000 ) );
+
+	workerManager.stopWorker( feature );
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarklogger( const QStringList& arguments )
+{
+	const auto threadCount = qMax( 1, arguments.value( 0, QStringLiteral("16") ).toInt() );
+	const auto messageCount = qMax( 1, arguments.value( 1, QStringLiteral("10000") ).toInt() );
+	const auto totalMessageCount = double( threadCount ) * messageCount;
+
+	QTemporaryDir tempDir;
+	if( tempDir.isValid() == false )
+	{
+		printf( "[TEST]: BenchmarkLogger: FAIL (could not create temporary directory)\n" );
+		return Failed;
+	}
+
+	// previous implementation: serialize all threads on a mutex and write each line unbuffered
+	QFile synchronousLogFile( tempDir.filePath( QStringLiteral("synchronous.log") ) );
+	synchronousLogFile.open( QFile::WriteOnly | QFile::Unbuffered | QFile::Text ); // Flawfinder: ignore
+	QMutex synchronousLogMutex;
+
+	const auto synchronousTime = runLoggingThreads( threadCount, messageCount, [&]( const QString& message ) {
+		QMutexLocker locker( &synchronousLogMutex );
+		synchronousLogFile.write( Logger::formatMessage( Logger::LogLevel::Debug, QDateTime::currentDateTime(), message ).toUtf8() );
+		synchronousLogFile.flush();
+	} );
+
+	printf( "[TEST]: BenchmarkLogger: synchronous   %2d threads  %8.2f us/message  total %8lld ms\n",
+			threadCount, double(synchronousTime) / totalMessageCount / 1000, synchronousTime / 1000000 );
+
+	// ring buffer with a background thread writing batches
+	QFile asynchronousLogFile( tempDir.filePath( QStringLiteral("asynchronous.log") ) );
+	asynchronousLogFile.open( QFile::WriteOnly | QFile::Unbuffered | QFile::Text ); // Flawfinder: ignore
+	qint64 writtenRecordCount = 0;
+
+	AsyncLogWriter writer( [&]( const AsyncLogWriter::Records& records ) {
+		QByteArray data;
+		for( const auto& record : records )
+		{
+			data += Logger::formatMessage( record.logLevel, QDateTime::fromMSecsSinceEpoch( record.timestamp ),
+										   record.message ).toUtf8();
+		}
+		asynchronousLogFile.write( data );
+		asynchronousLogFile.flush();
+		writtenRecordCount += records.size();
+	} );
+	writer.start();
+
+	QElapsedTimer drainTimer;
+	drainTimer.start();
+
+	const auto asynchronousTime = runLoggingThreads( threadCount, messageCount, [&]( const QString& message ) {
+		writer.enqueue( Logger::LogLevel::Debug, message );
+	} );
+
+	writer.stop();
+
+	printf( "[TEST]: BenchmarkLogger: asynchronous  %2d threads  %8.2f us/message  total %8lld ms  "
+			"(drained after %lld ms, %d dropped, %lld records written)\n",
+			threadCount, double(asynchronousTime) / totalMessageCount / 1000, asynchronousTime / 1000000,
+			drainTimer.elapsed(), writer.droppedRecordCount(), writtenRecordCount );
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarklocaltransport( const QStringList& arguments )
+{
+	const auto totalSize = qMax( 1, arguments.value( 0, QStringLiteral("1024") ).toInt() ) * qint64( 1024 * 1024 );
+	const auto chunkSize = qMax( 1, arguments.value( 1, QStringLiteral("65536") ).toInt() );
+
+	const auto printResult = [=]( const char* transport, qint64 nsecs ) {
+		if( nsecs < 0 )
+		{
+			printf( "[TEST]: BenchmarkLocalTransport: %-8s FAIL (timeout)\n", transport );
+		}
+		else
+		{
+			printf( "[TEST]: BenchmarkLocalTransport: %-8s %10.2f MB/s\n", transport,
+					double(totalSize) / 1024 / 1024 / ( double(nsecs) / 1000000000 ) );
+		}
+	};
+
+	QTcpServer tcpServer;
+	if( tcpServer.listen( QHostAddress::LocalHost ) == false )
+	{
+		printf( "[TEST]: BenchmarkLocalTransport: FAIL (could not listen on loopback interface)\n" );
+		return Failed;
+	}
+
+	QTcpSocket tcpSender;
+	tcpSender.connectToHost( QHostAddress::LocalHost, tcpServer.serverPort() );
+	if( tcpSender.waitForConnected() == false || tcpServer.waitForNewConnection( 1000 ) == false )
+	{
+		printf( "[TEST]: BenchmarkLocalTransport: FAIL (could not connect via loopback interface)\n" );
+		return Failed;
+	}
+
+	auto tcpReceiver = tcpServer.nextPendingConnection();
+	printResult( "TCP", transferData( tcpSender, *tcpReceiver, totalSize, chunkSize ) );
+
+#ifdef Q_OS_LINUX
+	int fds[2];
+	if( ::socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0, fds ) != 0 )
+	{
+		printf( "[TEST]: BenchmarkLocalTransport: FAIL (could not create Unix domain socket pair)\n" );
+		return Failed;
+	}
+
+	// wrap the sockets the same way VncProxyConnection does
+	QTcpSocket unixSender;
+	QTcpSocket unixReceiver;
+	if( unixSender.setSocketDescriptor( fds[0] ) == false )
+	{
+		::close( fds[0] );
+		::close( fds[1] );
+		printf( "[TEST]: BenchmarkLocalTransport: FAIL (could not wrap Unix domain sockets)\n" );
+		return Failed;
+	}
+
+	if( unixReceiver.setSocketDescriptor( fds[1] ) == false )
+	{
+		::close( fds[1] );
+		printf( "[TEST]: BenchmarkLocalTransport: FAIL (could not wrap Unix domain sockets)\n" );
+		return Failed;
+	}
+
+	printResult( "Unix", transferData( unixSender, unixReceiver, totalSize, chunkSize ) );
+#else
+	printf( "[TEST]: BenchmarkLocalTransport: Unix domain sockets not supported on this platform\n" );
+#endif
+
+	return Successful;
+}
+
+
+
+CommandLinePluginInterface::RunResult TestingCommandLinePlugin::handle_benchmarkjsonstore( const QStringList& arguments )
+{
+	static constexpr auto ComputersPerLocation = 25;
+
+	const auto entryCount = qMax( 1, arguments.value( 0, QStringLiteral("10000") ).toInt() );
+
+	QTemporaryDir tempDir;
+	if( tempDir.isValid() == false )
+	{
+		printf( "[TEST]: BenchmarkJsonStore: FAIL (could not create temporary directory)\n" );
+		return Failed;
+	}
+
+	const auto fileName = tempDir.filePath( QStringLiteral("config.json") );
+
+	// builtin directory with locations and computers plus a section with one key per entry
+	QJsonArray networkObjects;
+	QVariantMap entries;
+	NetworkObject::Uid locationUid;
+
+	for( int i = 0; i < entryCount; ++i )
+	{
+		if( i % ComputersPerLocation == 0 )
+		{
+			const NetworkObject location( NetworkObject::Type::Location, QStringLiteral("Room %1").arg( i / ComputersPerLocation ) );
+			locationUid = location.uid();
+			networkObjects.append( location.toJson() );
+		}
+
+		networkObjects.append( NetworkObject( NetworkObject::Type::Host, QStringLiteral("PC%1").arg( i ),
+											  QStringLiteral("pc%1.example.org").arg( i ), {}, {},
+											  {}, locationUid ).toJson() );
+
+		entries[QStringLiteral("Entry%1").arg( i, 6, 10, QLatin1Char('0') )] = i;
+	}
+
+	QJsonObject builtinDirectory;
+	builtinDirectory[QStringLiteral("NetworkObjects")] = QJsonObject{ { QStringLiteral("JsonStoreArray"), networkObjects } };
+
+	QJsonObject rootObject;
+	rootObject[QStringLiteral("BuiltinDirectory")] = builtinDirectory;
+	rootObject[QStringLiteral("Entries")] = QJsonObject::fromVariantMap( entries );
+
+	const auto jsonData = QJsonDocument( rootObject ).toJson();
+
+	QFile configFile( fileName );
+	if( configFile.open( QFile::WriteOnly ) == false || configFile.write( jsonData ) != jsonData.size() ) // Flawfinder: ignore
+	{
+		printf( "[TEST]: BenchmarkJsonStore: FAIL (could not write %s)\n", qUtf8Printable( fileName ) );
+		return Failed;
+	}
+	configFile.close();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	Configuration::Object perValueObject;
+	loadJsonTreePerValue( &perValueObject, QJsonDocument::fromJson( jsonData ).object(), {} );
+
+	printf( "[TEST]: BenchmarkJsonStore: load per value    %8lld ms\n", timer.elapsed() );
+
+	Configuration::JsonStore store( Configuration::Store::System, fileName );
+	Configuration::Object object;
+
+	timer.restart();
+	store.load( &object );
+
+	printf( "[TEST]: BenchmarkJsonStore: load single pass  %8lld ms\n", timer.elapsed() );
+
+	if( object.data() != perValueObject.data() )
+	{
+		printf( "[TEST]: BenchmarkJsonStore: FAIL (loaded data differs)\n" );
+		return Failed;
+	}
+
+	timer.restart();
+	store.flush( &object );
+	store.sync();
+
+	printf( "[TEST]: BenchmarkJsonStore: initial save      %8lld ms\n", timer.elapsed() );
+
+	object.setValue( QStringLiteral("Changed"), true, QStringLiteral("Benchmark") );
+
+	timer.restart();
+	store.flush( &object );
+	store.sync();
+
+	printf( "[TEST]: BenchmarkJsonStore: incremental save  %8lld ms\n", timer.elapsed() );
+
+	Configuration::Object reloadedObject;
+	Configuration::JsonStore( Configuration::Store::System, fileName ).load( &reloadedObject );
+
+	if( reloadedObject.data() != object.data() )
+	{
+		printf( "[TEST]: BenchmarkJsonStore: FAIL (saved data differs)\n" );
+		return Failed;
+	}
+
+	printf( "[TEST]: BenchmarkJsonStore: %d entries, %d bytes: OK\n", entryCount, int( jsonData.size() ) );
+
+	return Successful;
+}
@@ -84,6 +84,15 @@ public slots:
 	CommandLinePluginInterface::RunResult handle_authorizedgroups( const QStringList& arguments );
 	CommandLinePluginInterface::RunResult handle_accesscontrolrules( const QStringList& arguments );
 	CommandLinePluginInterface::RunResult handle_isaccessdeniedbylocalstate( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkauthentication( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_authhelperprotocol( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_authhelper( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkaccesscontrolrules( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkfeaturemessages( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkworkermessages( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarklogger( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarklocaltransport( const QStringList& arguments );
+	CommandLinePluginInterface::RunResult handle_benchmarkjsonstore( const QStringList& arguments );
 
 private:
 	QMap<QString, QString> m_commands;
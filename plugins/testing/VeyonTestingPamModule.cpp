@@ -0,0 +1,162 @@
+/*
+ * VeyonTestingPamModule.cpp - stub PAM module for testing the auth helper
+ *
+ * Copyright (c) 2020 Tobias Junghans <tobydox@veyon.io>
+ *
+ * This file is part of Veyon - https://veyon.io
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define PAM_SM_AUTH
+#include <security/pam_appl.h>
+#include <security/pam_modules.h>
+
+#include "VeyonTestingPamModule.h"
+
+// Authenticates without any system accounts so the auth helper can be tested
+// deterministically when configured for a service such as
+//
+//   auth required /path/to/pam_veyon_testing.so log=/tmp/veyon-pam.log
+//
+// The password is queried through the conversation of the auth helper. Each
+// conversation appends the username to the file passed via "log=" so tests can
+// tell how often credentials have been received.
+
+
+static const char* moduleArgument( int argc, const char** argv, const char* name )
+{
+	const auto length = strlen( name );
+
+	for( int i = 0; i < argc; ++i )
+	{
+		if( strncmp( argv[i], name, length ) == 0 && argv[i][length] == '=' )
+		{
+			return argv[i] + length + 1;
+		}
+	}
+
+	return nullptr;
+}
+
+
+
+static void logConversation( const char* logFile, const char* username )
+{
+	if( logFile == nullptr )
+	{
+		return;
+	}
+
+	const auto fd = open( logFile, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0600 );
+	if( fd >= 0 )
+	{
+		// a single write with O_APPEND keeps lines of concurrent conversations intact
+		char line[256];
+		const auto length = snprintf( line, sizeof(line), "%s\n", username );
+		if( length > 0 && static_cast<size_t>( length ) < sizeof(line) )
+		{
+			write( fd, line, static_cast<size_t>( length ) );
+		}
+		close( fd );
+	}
+}
+
+
+
+static char* queryPassword( pam_handle_t* pamh )
+{
+	const void* item = nullptr;
+	if( pam_get_item( pamh, PAM_CONV, &item ) != PAM_SUCCESS || item == nullptr )
+	{
+		return nullptr;
+	}
+
+	const auto conversation = static_cast<const struct pam_conv *>( item );
+
+	struct pam_message message{ PAM_PROMPT_ECHO_OFF, "Password: " };
+	const struct pam_message* messages[] = { &message };
+	struct pam_response* response = nullptr;
+
+	if( conversation->conv( 1, messages, &response, conversation->appdata_ptr ) != PAM_SUCCESS ||
+		response == nullptr )
+	{
+		return nullptr;
+	}
+
+	const auto password = response->resp;
+	free( response );
+
+	return password;
+}
+
+
+
+PAM_EXTERN int pam_sm_authenticate( pam_handle_t* pamh, int flags, int argc, const char** argv )
+{
+	static_cast<void>( flags );
+
+	const char* username = nullptr;
+	if( pam_get_user( pamh, &username, nullptr ) != PAM_SUCCESS || username == nullptr )
+	{
+		return PAM_USER_UNKNOWN;
+	}
+
+	logConversation( moduleArgument( argc, argv, "log" ), username );
+
+	if( strcmp( username, VeyonTestingPamModule::HangingUser ) == 0 )
+	{
+		// never finish the conversation so the client has to time out
+		for(;;)
+		{
+			pause();
+		}
+	}
+
+	const auto password = queryPassword( pamh );
+	if( password == nullptr )
+	{
+		return PAM_CONV_ERR;
+	}
+
+	const auto valid = strcmp( username, VeyonTestingPamModule::ValidUser ) == 0 &&
+					   strcmp( password, VeyonTestingPamModule::ValidPassword ) == 0;
+
+	memset( password, 0, strlen( password ) );
+	free( password );
+
+	return valid ? PAM_SUCCESS : PAM_AUTH_ERR;
+}
+
+
+
+PAM_EXTERN int pam_sm_setcred( pam_handle_t* pamh, int flags, int argc, const char** argv )
+{
+	static_cast<void>( pamh );
+	static_cast<void>( flags );
+	static_cast<void>( argc );
+	static_cast<void>( argv );
+
+	return PAM_SUCCESS;
+}
@@ -150,6 +150,9 @@ bool TextMessageFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worke
 
 		connect( messageBox, &QMessageBox::accepted, messageBox, &QMessageBox::deleteLater );
 
+		m_messageBoxes.removeAll( nullptr );
+		m_messageBoxes.append( messageBox );
+
 		return true;
 	}
 
@@ -158,6 +161,28 @@ bool TextMessageFeaturePlugin::handleFeatureMessage( VeyonWorkerInterface& worke
 
 
 
+bool TextMessageFeaturePlugin::stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature )
+{
+	Q_UNUSED(worker)
+
+	if( feature != m_textMessageFeature )
+	{
+		return false;
+	}
+
+	// close message boxes just like a dedicated worker process quitting would
+	for( const auto& messageBox : qAsConst(m_messageBoxes) )
+	{
+		delete messageBox;
+	}
+
+	m_messageBoxes.clear();
+
+	return true;
+}
+
+
+
 void TextMessageFeaturePlugin::sendTextMessage( const QString& textMessage,
 												const ComputerControlInterfaceList& computerControlInterfaces )
 {
@@ -24,9 +24,13 @@
 
 #pragma once
 
+#include <QPointer>
+
 #include "Feature.h"
 #include "FeatureProviderInterface.h"
 
+class QMessageBox;
+
 class TextMessageFeaturePlugin : public QObject, FeatureProviderInterface, PluginInterface
 {
 	Q_OBJECT
@@ -83,6 +87,18 @@ public:
 
 	bool handleFeatureMessage( VeyonWorkerInterface& worker, const FeatureMessage& message ) override;
 
+	bool isWorkerHostable( const Feature& feature ) const override
+	{
+		return feature == m_textMessageFeature;
+	}
+
+	bool isWorkerRestorable( const Feature& feature ) const override
+	{
+		return feature == m_textMessageFeature;
+	}
+
+	bool stopHostedWorker( VeyonWorkerInterface& worker, const Feature& feature ) override;
+
 signals:
 	Q_INVOKABLE void acceptTextMessage( const QString& textMessage );
 
@@ -102,4 +118,6 @@ private:
 	const Feature m_textMessageFeature;
 	const FeatureList m_features;
 
+	QList<QPointer<QMessageBox>> m_messageBoxes{};
+
 };
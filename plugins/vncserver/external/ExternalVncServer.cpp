@@ -91,4 +91,11 @@ ExternalVncServer::Password ExternalVncServer::configuredPassword()
 
 
 
+QString ExternalVncServer::configuredServerSocketPath()
+{
+	return m_configuration.serverSocketPath();
+}
+
+
+
 IMPLEMENT_CONFIG_PROXY(ExternalVncServerConfiguration)
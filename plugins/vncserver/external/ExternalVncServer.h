@@ -83,6 +83,8 @@ public:
 
 	Password configuredPassword() override;
 
+	QString configuredServerSocketPath() override;
+
 private:
 	enum {
 		MaximumPlaintextPasswordLength = 64
@@ -28,6 +28,7 @@
 
 #define FOREACH_EXTERNAL_VNC_SERVER_CONFIG_PROPERTY(OP) \
 	OP( ExternalVncServerConfiguration, m_configuration, int, serverPort, setServerPort, "ServerPort", "ExternalVncServer", 5900, Configuration::Property::Flag::Standard ) \
+	OP( ExternalVncServerConfiguration, m_configuration, QString, serverSocketPath, setServerSocketPath, "ServerSocketPath", "ExternalVncServer", QString(), Configuration::Property::Flag::Advanced ) \
 	OP( ExternalVncServerConfiguration, m_configuration, Configuration::Password, password, setPassword, "Password", "ExternalVncServer", QString(), Configuration::Property::Flag::Standard )
 
 // clazy:excludeall=missing-qobject-macro
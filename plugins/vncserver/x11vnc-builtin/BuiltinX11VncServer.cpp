@@ -23,10 +23,17 @@
  */
 
 #include <QCoreApplication>
+#include <QDir>
+#include <QFile>
 #include <QProcess>
 #include <QTemporaryFile>
 #include <QThread>
 
+#include <cerrno>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "BuiltinX11VncServer.h"
 #include "VeyonConfiguration.h"
 #include "X11VncConfigurationWidget.h"
@@ -72,6 +79,17 @@ void BuiltinX11VncServer::runServer( int serverPort, const Password& password )
 		cmdline.append( extraArguments.split( QLatin1Char(' ') ) );
 	}
 
+	// x11vnc applies the password to the Unix domain socket as well, i.e. connections through the socket
+	// are authenticated like the ones through the loopback interface - the socket is not meant to be used
+	// for dropping the password but only to bypass the TCP/IP stack
+	const auto socketPath = configuredServerSocketPath();
+	if( socketPath.isEmpty() == false )
+	{
+		// remove stale socket of a previous instance as x11vnc refuses to bind otherwise
+		QFile::remove( socketPath );
+		cmdline.append( { QStringLiteral("-unixsock"), socketPath } );
+	}
+
 	if( m_configuration.isXDamageDisabled() )
 	{
 		cmdline.append( QStringLiteral("-noxdamage") );
@@ -151,4 +169,53 @@ void BuiltinX11VncServer::runServer( int serverPort, const Password& password )
 }
 
 
+
+QString BuiltinX11VncServer::configuredServerSocketPath()
+{
+	if( m_configuration.isUnixSocketDisabled() )
+	{
+		return {};
+	}
+
+	// Veyon Server runs as root with the environment of the user session, so per-user locations such as
+	// XDG_RUNTIME_DIR would be controlled by the logged on user - only use a directory owned by root
+	if( geteuid() != 0 || prepareSocketDirectory() == false )
+	{
+		return {};
+	}
+
+	return QDir( QString::fromLatin1( SocketDirectory ) ).absoluteFilePath( QStringLiteral("vnc-%1.sock").arg( VeyonCore::sessionId() ) );
+}
+
+
+
+bool BuiltinX11VncServer::prepareSocketDirectory()
+{
+	if( mkdir( SocketDirectory, S_IRWXU ) != 0 && errno != EEXIST )
+	{
+		vWarning() << "could not create socket directory" << SocketDirectory;
+		return false;
+	}
+
+	// refuse to use a directory (or a symlink to it) created by someone else
+	struct stat directoryStat{};
+	if( lstat( SocketDirectory, &directoryStat ) != 0 ||
+		S_ISDIR( directoryStat.st_mode ) == false ||
+		directoryStat.st_uid != 0 )
+	{
+		vWarning() << "socket directory" << SocketDirectory << "is not a directory owned by root";
+		return false;
+	}
+
+	if( ( directoryStat.st_mode & 07777 ) != S_IRWXU &&
+		chmod( SocketDirectory, S_IRWXU ) != 0 )
+	{
+		vWarning() << "could not restrict permissions of socket directory" << SocketDirectory;
+		return false;
+	}
+
+	return true;
+}
+
+
 IMPLEMENT_CONFIG_PROXY(X11VncConfiguration)
@@ -87,7 +87,13 @@ public:
 		return {};
 	}
 
+	QString configuredServerSocketPath() override;
+
 private:
+	static constexpr auto SocketDirectory = "/run/veyon";
+
+	static bool prepareSocketDirectory();
+
 	X11VncConfiguration m_configuration;
 
 };
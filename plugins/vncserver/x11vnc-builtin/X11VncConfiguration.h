@@ -28,6 +28,7 @@
 
 #define FOREACH_X11VNC_CONFIG_PROPERTY(OP) \
 	OP( X11VncConfiguration, m_configuration, bool, isXDamageDisabled, setXDamageDisabled, "XDamageDisabled", "X11Vnc", false, Configuration::Property::Flag::Advanced )	\
+	OP( X11VncConfiguration, m_configuration, bool, isUnixSocketDisabled, setUnixSocketDisabled, "UnixSocketDisabled", "X11Vnc", false, Configuration::Property::Flag::Advanced )	\
 	OP( X11VncConfiguration, m_configuration, QString, extraArguments, setExtraArguments, "ExtraArguments", "X11Vnc", QString(), Configuration::Property::Flag::Advanced )
 
 // clazy:excludeall=missing-qobject-macro
@@ -32,9 +32,10 @@
 ComputerControlClient::ComputerControlClient( ComputerControlServer* server,
 											  QTcpSocket* clientSocket,
 											  int vncServerPort,
+											  const QString& vncServerSocketPath,
 											  const Password& vncServerPassword,
 											  QObject* parent ) :
-	VncProxyConnection( clientSocket, vncServerPort, parent ),
+	VncProxyConnection( clientSocket, vncServerPort, vncServerSocketPath, parent ),
 	m_server( server ),
 	m_serverProtocol( clientSocket,
 					  &m_serverClient,
@@ -40,6 +40,7 @@ public:
 	ComputerControlClient( ComputerControlServer* server,
 						   QTcpSocket* clientSocket,
 						   int vncServerPort,
+						   const QString& vncServerSocketPath,
 						   const Password& vncServerPassword,
 						   QObject* parent );
 	~ComputerControlClient() override;
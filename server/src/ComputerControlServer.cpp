@@ -43,7 +43,14 @@ ComputerControlServer::ComputerControlServer( QObject* parent ) :
 						  QHostAddress::LocalHost : QHostAddress::Any,
 					  VeyonCore::config().primaryServicePort() + VeyonCore::sessionId(),
 					  this,
-					  this )
+					  this ),
+	m_metricsServer( [this]() { return metricsSnapshots(); } ),
+	m_connectionsCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_server_connections_total"),
+														QStringLiteral("Incoming connections accepted by the server") ) ),
+	m_authenticationFailuresCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_server_authentication_failures_total"),
+																   QStringLiteral("Incoming connections which failed to authenticate") ) ),
+	m_accessControlFailuresCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_server_access_control_failures_total"),
+																  QStringLiteral("Incoming connections denied by access control") ) )
 {
 	updateTrayIconToolTip();
 
@@ -72,7 +79,7 @@ ComputerControlServer::~ComputerControlServer()
 
 bool ComputerControlServer::start()
 {
-	if( m_vncProxyServer.start( m_vncServer.serverPort(), m_vncServer.password() ) == false )
+	if( m_vncProxyServer.start( m_vncServer.serverPort(), m_vncServer.serverSocketPath(), m_vncServer.password() ) == false )
 	{
 		return false;
 	}
@@ -80,6 +87,25 @@ bool ComputerControlServer::start()
 	m_vncServer.prepare();
 	m_vncServer.start();
 
+	if( VeyonCore::config().workerHostEnabled() )
+	{
+		m_featureWorkerManager.startWorkerHosts();
+	}
+
+	if( VeyonCore::config().metricsEnabled() )
+	{
+		// per-session ports count upwards from the metrics port which by default lies above the master's one
+		const auto metricsPort = VeyonCore::config().metricsPort() + VeyonCore::sessionId();
+		if( metricsPort == VeyonCore::config().masterMetricsPort() )
+		{
+			vWarning() << "metrics port" << metricsPort << "collides with the master metrics port - not exporting metrics";
+		}
+		else
+		{
+			m_metricsServer.start( metricsPort );
+		}
+	}
+
 	return true;
 }
 
@@ -87,10 +113,13 @@ bool ComputerControlServer::start()
 
 VncProxyConnection* ComputerControlServer::createVncProxyConnection( QTcpSocket* clientSocket,
 																	 int vncServerPort,
+																	 const QString& vncServerSocketPath,
 																	 const Password& vncServerPassword,
 																	 QObject* parent )
 {
-	return new ComputerControlClient( this, clientSocket, vncServerPort, vncServerPassword, parent );
+	m_connectionsCounter.increment();
+
+	return new ComputerControlClient( this, clientSocket, vncServerPort, vncServerSocketPath, vncServerPassword, parent );
 }
 
 
@@ -114,7 +143,8 @@ bool ComputerControlServer::handleFeatureMessage( QTcpSocket* socket )
 
 	featureMessage.receive( socket );
 
-	return m_featureManager.handleFeatureMessage( *this, MessageContext( socket ), featureMessage );
+	// replies are sent in the same format the client used for its message
+	return m_featureManager.handleFeatureMessage( *this, MessageContext( socket, featureMessage.format() ), featureMessage );
 }
 
 
@@ -126,7 +156,15 @@ bool ComputerControlServer::sendFeatureMessageReply( const MessageContext& conte
 	char rfbMessageType = FeatureMessage::RfbMessageType;
 	context.ioDevice()->write( &rfbMessageType, sizeof(rfbMessageType) );
 
-	return reply.send( context.ioDevice() );
+	return reply.send( context.ioDevice(), context.featureMessageFormat() );
+}
+
+
+
+MetricsRegistry::Snapshots ComputerControlServer::metricsSnapshots()
+{
+	// workers periodically report their metrics so we can export them all in one go
+	return MetricsRegistry::Snapshots{ VeyonCore::metrics().snapshot() } + m_featureWorkerManager.workerMetrics();
 }
 
 
@@ -135,6 +173,8 @@ void ComputerControlServer::showAuthenticationMessage( VncServerClient* client )
 {
 	if( client->authState() == VncServerClient::AuthState::Failed )
 	{
+		m_authenticationFailuresCounter.increment();
+
 		vWarning() << "Authentication failed for" << client->hostAddress() << client->username();
 
 		if( VeyonCore::config().failedAuthenticationNotificationsEnabled() )
@@ -180,6 +220,8 @@ void ComputerControlServer::showAccessControlMessage( VncServerClient* client )
 	}
 	else if( client->accessControlState() == VncServerClient::AccessControlState::Failed )
 	{
+		m_accessControlFailuresCounter.increment();
+
 		vWarning() << "Access control failed for" << client->hostAddress() << client->username();
 
 		if( VeyonCore::config().failedAuthenticationNotificationsEnabled() )
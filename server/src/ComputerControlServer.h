@@ -29,6 +29,7 @@
 
 #include "FeatureManager.h"
 #include "FeatureWorkerManager.h"
+#include "MetricsServer.h"
 #include "ServerAuthenticationManager.h"
 #include "ServerAccessControlManager.h"
 #include "VeyonServerInterface.h"
@@ -47,6 +48,7 @@ public:
 
 	VncProxyConnection* createVncProxyConnection( QTcpSocket* clientSocket,
 												  int vncServerPort,
+												  const QString& vncServerSocketPath,
 												  const Password& vncServerPassword,
 												  QObject* parent ) override;
 
@@ -64,6 +66,11 @@ public:
 
 	bool sendFeatureMessageReply( const MessageContext& context, const FeatureMessage& reply ) override;
 
+	FeatureManager& featureManager() override
+	{
+		return m_featureManager;
+	}
+
 	FeatureWorkerManager& featureWorkerManager() override
 	{
 		return m_featureWorkerManager;
@@ -71,6 +78,8 @@ public:
 
 
 private:
+	MetricsRegistry::Snapshots metricsSnapshots();
+
 	void showAuthenticationMessage( VncServerClient* client );
 	void showAccessControlMessage( VncServerClient* client );
 
@@ -91,4 +100,9 @@ private:
 	VncServer m_vncServer{};
 	VncProxyServer m_vncProxyServer;
 
+	MetricsServer m_metricsServer;
+	MetricsRegistry::Counter& m_connectionsCounter;
+	MetricsRegistry::Counter& m_authenticationFailuresCounter;
+	MetricsRegistry::Counter& m_accessControlFailuresCounter;
+
 } ;
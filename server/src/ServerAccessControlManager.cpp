@@ -22,10 +22,15 @@
  *
  */
 
+#include <QtConcurrent>
+
 #include "ServerAccessControlManager.h"
 #include "AccessControlProvider.h"
 #include "AuthenticationManager.h"
 #include "DesktopAccessDialog.h"
+#include "HostAddress.h"
+#include "PlatformPluginInterface.h"
+#include "PlatformUserFunctions.h"
 #include "VeyonConfiguration.h"
 
 
@@ -36,6 +41,15 @@ ServerAccessControlManager::ServerAccessControlManager( FeatureWorkerManager& fe
 	m_featureWorkerManager( featureWorkerManager ),
 	m_desktopAccessDialog( desktopAccessDialog )
 {
+	connect( &m_revalidationWatcher, &QFutureWatcher<Revalidations>::finished,
+			 this, &ServerAccessControlManager::finishRevalidation );
+}
+
+
+
+ServerAccessControlManager::~ServerAccessControlManager()
+{
+	m_revalidationWatcher.waitForFinished();
 }
 
 
@@ -69,26 +83,23 @@ void ServerAccessControlManager::addClient( VncServerClient* client )
 
 void ServerAccessControlManager::removeClient( VncServerClient* client )
 {
-	m_clients.removeAll( client );
+	m_connectedUsersDependentClients.remove( client );
 
-	// force all remaining clients to pass access control again as conditions might
-	// have changed (e.g. AccessControlRule::ConditionAccessFromAlreadyConnectedUser)
-
-	const VncServerClientList previousClients = m_clients;
-	m_clients.clear();
-
-	for( auto prevClient : qAsConst( previousClients ) )
+	if( m_clients.removeAll( client ) == 0 )
 	{
-		prevClient->setAccessControlState( VncServerClient::AccessControlState::Init );
-		addClient( prevClient );
+		return;
+	}
 
-		if( prevClient->accessControlState() != VncServerClient::AccessControlState::Successful &&
-			prevClient->accessControlState() != VncServerClient::AccessControlState::Pending )
-		{
-			vDebug() << "closing connection as client does not pass access control any longer";
-			prevClient->setProtocolState( VncServerProtocol::Close );
-		}
+	// decisions of the remaining clients can only change if they depended on the set of connected
+	// users (e.g. AccessControlRule::Condition::AccessFromAlreadyConnectedUser) and the user
+	// of the removed client is not connected through another connection
+	if( m_connectedUsersDependentClients.isEmpty() ||
+		connectedUsers().contains( client->username() ) )
+	{
+		return;
 	}
+
+	revalidateClients();
 }
 
 
@@ -113,10 +124,21 @@ void ServerAccessControlManager::performAccessControl( VncServerClient* client )
 		break;
 	}
 
+	AccessControlProvider accessControlProvider;
+
 	const auto accessResult =
-			AccessControlProvider().checkAccess( client->username(),
-												 client->hostAddress(),
-												 connectedUsers() );
+			accessControlProvider.checkAccess( client->username(),
+											   client->hostAddress(),
+											   connectedUsers() );
+
+	if( accessControlProvider.hasQueriedConnectedUsers() )
+	{
+		m_connectedUsersDependentClients.insert( client );
+	}
+	else
+	{
+		m_connectedUsersDependentClients.remove( client );
+	}
 
 	switch( accessResult )
 	{
@@ -139,6 +161,165 @@ void ServerAccessControlManager::performAccessControl( VncServerClient* client )
 
 
 
+void ServerAccessControlManager::revalidateClients()
+{
+	// coalesce requests while a batch is being processed
+	if( m_revalidationRunning )
+	{
+		m_revalidationPending = true;
+		return;
+	}
+
+	Revalidations revalidations;
+	revalidations.reserve( m_clients.size() );
+
+	bool revalidationRequired = false;
+
+	for( auto client : qAsConst(m_clients) )
+	{
+		const auto required = m_connectedUsersDependentClients.contains( client );
+		revalidations.append( { client, client->username(), client->hostAddress(), required,
+								AccessControlProvider::Access::Allow, required } );
+		revalidationRequired |= required;
+	}
+
+	if( revalidationRequired == false )
+	{
+		return;
+	}
+
+	m_revalidationRunning = true;
+
+	const auto localUser = VeyonCore::platform().userFunctions().currentUser();
+	const auto localComputer = HostAddress::localFQDN();
+
+	QStringList users{ localUser };
+	QStringList computers{ localComputer };
+
+	for( const auto& revalidation : qAsConst(revalidations) )
+	{
+		if( revalidation.required )
+		{
+			users.append( revalidation.username );
+			computers.append( revalidation.hostAddress );
+		}
+	}
+
+	users.removeDuplicates();
+	computers.removeDuplicates();
+
+	// user groups backends, network object directories and the configuration must only be
+	// accessed from the main thread, so take all lookups the rules need here and only process
+	// the rules for all clients in a different thread
+	AccessControlProvider accessControlProvider;
+	const auto lookups = accessControlProvider.performLookups( users, computers );
+
+	m_revalidationWatcher.setFuture( QtConcurrent::run( &ServerAccessControlManager::performRevalidation,
+														accessControlProvider, revalidations,
+														localUser, localComputer, lookups ) );
+}
+
+
+
+ServerAccessControlManager::Revalidations ServerAccessControlManager::performRevalidation( AccessControlProvider accessControlProvider,
+																						  Revalidations revalidations,
+																						  const QString& localUser,
+																						  const QString& localComputer,
+																						  const AccessControlProvider::Lookups& lookups )
+{
+	// replay access control in connection order so that each client only counts as
+	// already connected user for clients which connected after it
+	QStringList connectedUsers;
+	connectedUsers.reserve( revalidations.size() );
+
+	for( auto& revalidation : revalidations )
+	{
+		if( revalidation.required )
+		{
+			switch( accessControlProvider.processAccessControlRules( revalidation.username, revalidation.hostAddress,
+																	 localUser, localComputer, connectedUsers, lookups ) )
+			{
+			case AccessControlRule::Action::Allow:
+				revalidation.access = AccessControlProvider::Access::Allow;
+				break;
+			case AccessControlRule::Action::AskForPermission:
+				revalidation.access = AccessControlProvider::Access::ToBeConfirmed;
+				break;
+			default:
+				revalidation.access = AccessControlProvider::Access::Deny;
+				break;
+			}
+
+			revalidation.dependsOnConnectedUsers = accessControlProvider.hasQueriedConnectedUsers();
+		}
+
+		if( revalidation.access == AccessControlProvider::Access::Allow )
+		{
+			connectedUsers.append( revalidation.username );
+		}
+	}
+
+	return revalidations;
+}
+
+
+
+void ServerAccessControlManager::finishRevalidation()
+{
+	m_revalidationRunning = false;
+
+	const auto revalidations = m_revalidationWatcher.result();
+
+	for( const auto& revalidation : revalidations )
+	{
+		VncServerClient* client = revalidation.client;
+
+		// skip clients which have been disconnected or removed in the meantime
+		if( revalidation.required == false || client == nullptr || m_clients.contains( client ) == false )
+		{
+			continue;
+		}
+
+		if( revalidation.dependsOnConnectedUsers == false )
+		{
+			m_connectedUsersDependentClients.remove( client );
+		}
+
+		if( revalidation.access == AccessControlProvider::Access::Allow )
+		{
+			continue;
+		}
+
+		m_clients.removeAll( client );
+
+		auto accessControlState = VncServerClient::AccessControlState::Failed;
+		if( revalidation.access == AccessControlProvider::Access::ToBeConfirmed )
+		{
+			accessControlState = confirmDesktopAccess( client );
+		}
+
+		client->setAccessControlState( accessControlState );
+
+		if( accessControlState == VncServerClient::AccessControlState::Successful )
+		{
+			m_clients.append( client );
+		}
+		else if( accessControlState != VncServerClient::AccessControlState::Pending )
+		{
+			vDebug() << "closing connection as client does not pass access control any longer";
+			client->setProtocolState( VncServerProtocol::Close );
+		}
+	}
+
+	if( m_revalidationPending )
+	{
+		m_revalidationPending = false;
+		revalidateClients();
+	}
+}
+
+
+
 VncServerClient::AccessControlState ServerAccessControlManager::confirmDesktopAccess( VncServerClient* client )
 {
 	const HostUserPair hostUserPair( client->username(), client->hostAddress() );
@@ -24,6 +24,10 @@
 
 #pragma once
 
+#include <QFutureWatcher>
+#include <QPointer>
+
+#include "AccessControlProvider.h"
 #include "DesktopAccessDialog.h"
 #include "VncServerClient.h"
 
@@ -36,18 +40,35 @@ public:
 	ServerAccessControlManager( FeatureWorkerManager& featureWorkerManager,
 								DesktopAccessDialog& desktopAccessDialog,
 								QObject* parent );
+	~ServerAccessControlManager() override;
 
 	void addClient( VncServerClient* client );
 	void removeClient( VncServerClient* client );
 
-
 signals:
 	void finished( VncServerClient* client );
 
 private:
 	static constexpr int ClientWaitInterval = 1000;
 
+	struct Revalidation
+	{
+		QPointer<VncServerClient> client;
+		QString username;
+		QString hostAddress;
+		bool required;
+		AccessControlProvider::Access access;
+		bool dependsOnConnectedUsers;
+	};
+	using Revalidations = QVector<Revalidation>;
+
 	void performAccessControl( VncServerClient* client );
+	void revalidateClients();
+	static Revalidations performRevalidation( AccessControlProvider accessControlProvider,
+											  Revalidations revalidations,
+											  const QString& localUser, const QString& localComputer,
+											  const AccessControlProvider::Lookups& lookups );
+	void finishRevalidation();
 	VncServerClient::AccessControlState confirmDesktopAccess( VncServerClient* client );
 	void finishDesktopAccessConfirmation( VncServerClient* client );
 
@@ -57,6 +78,11 @@ private:
 	DesktopAccessDialog& m_desktopAccessDialog;
 
 	VncServerClientList m_clients{};
+	QSet<VncServerClient *> m_connectedUsersDependentClients{};
+
+	QFutureWatcher<Revalidations> m_revalidationWatcher{};
+	bool m_revalidationRunning{false};
+	bool m_revalidationPending{false};
 
 	using HostUserPair = QPair<QString, QString>;
 	using DesktopAccessChoiceMap = QMap<HostUserPair, DesktopAccessDialog::Choice>;
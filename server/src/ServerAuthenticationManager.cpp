@@ -22,13 +22,18 @@
  *
  */
 
+#include <QElapsedTimer>
+
 #include "AuthenticationManager.h"
 #include "ServerAuthenticationManager.h"
 #include "VeyonConfiguration.h"
 
 
 ServerAuthenticationManager::ServerAuthenticationManager( QObject* parent ) :
-	QObject( parent )
+	QObject( parent ),
+	m_authenticationDurationHistogram( VeyonCore::metrics().histogram( QStringLiteral("veyon_server_authentication_step_duration_ms"),
+																	   QStringLiteral("Time spent in the authentication plugin per received authentication message"),
+																	   MetricsRegistry::latencyBounds() ) )
 {
 }
 
@@ -44,7 +49,12 @@ void ServerAuthenticationManager::processAuthenticationMessage( VncServerClient*
 
 	if( client->authPluginUid() == VeyonCore::config().authenticationPlugin()  )
 	{
+		QElapsedTimer authenticationTimer;
+		authenticationTimer.start();
+
 		client->setAuthState( VeyonCore::authenticationManager().configuredPlugin()->performAuthentication( client, message ) );
+
+		m_authenticationDurationHistogram.observe( authenticationTimer.elapsed() );
 	}
 	else
 	{
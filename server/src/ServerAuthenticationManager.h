@@ -27,6 +27,7 @@
 #include <QMutex>
 #include <QStringList>
 
+#include "MetricsRegistry.h"
 #include "VncServerClient.h"
 
 class VariantArrayMessage;
@@ -46,6 +47,8 @@ public:
 	void processAuthenticationMessage( VncServerClient* client,
 									   VariantArrayMessage& message );
 
+private:
+	MetricsRegistry::Histogram& m_authenticationDurationHistogram;
 
 signals:
 	void finished( VncServerClient* client );
@@ -23,16 +23,25 @@
  */
 
 #include <QBuffer>
+#include <QFile>
 #include <QHostAddress>
 #include <QTcpSocket>
 #include <QTimer>
 
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
 #include "VncClientProtocol.h"
 #include "VncProxyConnection.h"
 #include "VncServerProtocol.h"
 
 VncProxyConnection::VncProxyConnection( QTcpSocket* clientSocket,
 										int vncServerPort,
+										const QString& vncServerSocketPath,
 										QObject* parent ) :
 	QObject( parent ),
 	m_proxyClientSocket( clientSocket ),
@@ -43,15 +52,28 @@ VncProxyConnection::VncProxyConnection( QTcpSocket* clientSocket,
 		{ rfbKeyEvent, sz_rfbKeyEventMsg },
 		{ rfbPointerEvent, sz_rfbPointerEventMsg },
 		{ rfbXvp, sz_rfbXvpMsg },
-		} )
+		} ),
+	m_bytesToClientCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_proxy_bytes_to_client_total"),
+														  QStringLiteral("Data forwarded from the VNC server to proxy clients") ) ),
+	m_bytesToServerCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_proxy_bytes_to_server_total"),
+														  QStringLiteral("Data forwarded from proxy clients to the VNC server") ) ),
+	m_serverMessagesCounter( VeyonCore::metrics().counter( QStringLiteral("veyon_vnc_proxy_server_messages_total"),
+														   QStringLiteral("RFB messages forwarded from the VNC server to proxy clients") ) ),
+	m_connectionsGauge( VeyonCore::metrics().gauge( QStringLiteral("veyon_vnc_proxy_connections"),
+													QStringLiteral("Currently open VNC proxy connections") ) )
 {
+	m_connectionsGauge.add( 1 );
+
 	connect( m_proxyClientSocket, &QTcpSocket::readyRead, this, &VncProxyConnection::readFromClient );
 	connect( m_vncServerSocket, &QTcpSocket::readyRead, this, &VncProxyConnection::readFromServer );
 
 	connect( m_vncServerSocket, &QTcpSocket::disconnected, this, &VncProxyConnection::clientConnectionClosed );
 	connect( m_proxyClientSocket, &QTcpSocket::disconnected, this, &VncProxyConnection::serverConnectionClosed );
 
-	m_vncServerSocket->connectToHost( QHostAddress::LocalHost, static_cast<quint16>( vncServerPort ) );
+	if( vncServerSocketPath.isEmpty() || connectToServerSocket( vncServerSocketPath ) == false )
+	{
+		m_vncServerSocket->connectToHost( QHostAddress::LocalHost, static_cast<quint16>( vncServerPort ) );
+	}
 }
 
 
@@ -64,6 +86,8 @@ VncProxyConnection::~VncProxyConnection()
 
 	delete m_vncServerSocket;
 	delete m_proxyClientSocket;
+
+	m_connectionsGauge.add( -1 );
 }
 
 
@@ -138,6 +162,7 @@ bool VncProxyConnection::forwardDataToClient( qint64 size )
 		const auto data = m_vncServerSocket->read( size ); // Flawfinder: ignore
 		if( data.size() == size )
 		{
+			m_bytesToClientCounter.increment( static_cast<quint64>( size ) );
 			return m_proxyClientSocket->write( data ) == size;
 		}
 	}
@@ -154,6 +179,7 @@ bool VncProxyConnection::forwardDataToServer( qint64 size )
 		const auto data = m_proxyClientSocket->read( size ); // Flawfinder: ignore
 		if( data.size() == size )
 		{
+			m_bytesToServerCounter.increment( static_cast<quint64>( size ) );
 			return m_vncServerSocket->write( data ) == size;
 		}
 	}
@@ -177,6 +203,70 @@ void VncProxyConnection::readFromClientLater()
 
 
 
+bool VncProxyConnection::connectToServerSocket( const QString& path )
+{
+#ifdef Q_OS_LINUX
+	const auto encodedPath = QFile::encodeName( path );
+
+	sockaddr_un address{};
+	if( encodedPath.size() >= static_cast<int>( sizeof(address.sun_path) ) )
+	{
+		vWarning() << "socket path too long:" << path;
+		return false;
+	}
+
+	address.sun_family = AF_UNIX;
+	memcpy( address.sun_path, encodedPath.constData(), static_cast<size_t>( encodedPath.size() ) );
+
+	// only talk to a socket created by a VNC server running as the same user and make sure
+	// nobody else can connect to it regardless of the umask it has been created with
+	struct stat socketStat{};
+	if( lstat( encodedPath.constData(), &socketStat ) != 0 ||
+		S_ISSOCK( socketStat.st_mode ) == false ||
+		socketStat.st_uid != geteuid() )
+	{
+		vDebug() << "no socket owned by the server user at" << path << "- falling back to TCP";
+		return false;
+	}
+
+	if( ( socketStat.st_mode & 0777 ) != ( S_IRUSR | S_IWUSR ) &&
+		chmod( encodedPath.constData(), S_IRUSR | S_IWUSR ) != 0 )
+	{
+		vWarning() << "could not restrict permissions of" << path << "- falling back to TCP";
+		return false;
+	}
+
+	const auto fd = ::socket( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0 );
+	if( fd < 0 )
+	{
+		return false;
+	}
+
+	// the server is local so connecting either succeeds or fails immediately
+	if( ::connect( fd, reinterpret_cast<sockaddr *>( &address ), sizeof(address) ) != 0 )
+	{
+		vDebug() << "could not connect to" << path << "- falling back to TCP";
+		::close( fd );
+		return false;
+	}
+
+	// QLocalSocket wraps Unix domain sockets the same way internally, so all protocol
+	// code can keep operating on a QTcpSocket
+	if( m_vncServerSocket->setSocketDescriptor( fd ) == false )
+	{
+		::close( fd );
+		return false;
+	}
+
+	return true;
+#else
+	Q_UNUSED(path)
+	return false;
+#endif
+}
+
+
+
 bool VncProxyConnection::receiveClientMessage()
 {
 	auto socket = proxyClientSocket();
@@ -227,7 +317,12 @@ bool VncProxyConnection::receiveServerMessage()
 {
 	if( clientProtocol().receiveMessage() )
 	{
-		m_proxyClientSocket->write( clientProtocol().lastMessage() );
+		const auto& message = clientProtocol().lastMessage();
+
+		m_serverMessagesCounter.increment();
+		m_bytesToClientCounter.increment( static_cast<quint64>( message.size() ) );
+
+		m_proxyClientSocket->write( message );
 
 		return true;
 	}
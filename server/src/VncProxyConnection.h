@@ -24,7 +24,7 @@
 
 #pragma once
 
-#include "VeyonCore.h"
+#include "MetricsRegistry.h"
 
 class QBuffer;
 class QTcpSocket;
@@ -36,7 +36,7 @@ class VncProxyConnection : public QObject
 {
 	Q_OBJECT
 public:
-	VncProxyConnection( QTcpSocket* clientSocket, int vncServerPort, QObject* parent );
+	VncProxyConnection( QTcpSocket* clientSocket, int vncServerPort, const QString& vncServerSocketPath, QObject* parent );
 	~VncProxyConnection() override;
 
 	QTcpSocket* proxyClientSocket() const
@@ -60,6 +60,8 @@ protected:
 	void readFromServerLater();
 	void readFromClientLater();
 
+	bool connectToServerSocket( const QString& path );
+
 	virtual bool receiveClientMessage();
 	virtual bool receiveServerMessage();
 
@@ -74,6 +76,11 @@ private:
 
 	const QMap<int, int> m_rfbClientToServerMessageSizes;
 
+	MetricsRegistry::Counter& m_bytesToClientCounter;
+	MetricsRegistry::Counter& m_bytesToServerCounter;
+	MetricsRegistry::Counter& m_serverMessagesCounter;
+	MetricsRegistry::Gauge& m_connectionsGauge;
+
 signals:
 	void clientConnectionClosed();
 	void serverConnectionClosed();
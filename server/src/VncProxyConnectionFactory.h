@@ -40,6 +40,7 @@ public:
 
 	virtual VncProxyConnection* createVncProxyConnection( QTcpSocket* clientSocket,
 														  int vncServerPort,
+														  const QString& vncServerSocketPath,
 														  const Password& vncServerPassword,
 														  QObject* parent ) = 0;
 
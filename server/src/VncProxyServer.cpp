@@ -53,9 +53,10 @@ VncProxyServer::~VncProxyServer()
 
 
 
-bool VncProxyServer::start( int vncServerPort, const Password& vncServerPassword )
+bool VncProxyServer::start( int vncServerPort, const QString& vncServerSocketPath, const Password& vncServerPassword )
 {
 	m_vncServerPort = vncServerPort;
+	m_vncServerSocketPath = vncServerSocketPath;
 	m_vncServerPassword = vncServerPassword;
 
 	if( m_listenPort < 0 ||
@@ -91,6 +92,7 @@ void VncProxyServer::acceptConnection()
 	VncProxyConnection* connection =
 			m_connectionFactory->createVncProxyConnection( m_server->nextPendingConnection(),
 														   m_vncServerPort,
+														   m_vncServerSocketPath,
 														   m_vncServerPassword,
 														   this );
 
@@ -46,7 +46,7 @@ public:
 					QObject* parent = nullptr );
 	~VncProxyServer() override;
 
-	bool start( int vncServerPort, const Password& vncServerPassword );
+	bool start( int vncServerPort, const QString& vncServerSocketPath, const Password& vncServerPassword );
 	void stop();
 
 	const VncProxyConnectionList& clients() const
@@ -62,6 +62,7 @@ private:
 	void closeConnection( VncProxyConnection* );
 
 	int m_vncServerPort{-1};
+	QString m_vncServerSocketPath{};
 	Password m_vncServerPassword{};
 	QHostAddress m_listenAddress;
 	int m_listenPort;
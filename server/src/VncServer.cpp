@@ -106,6 +106,18 @@ int VncServer::serverPort() const
 
 
 
+QString VncServer::serverSocketPath() const
+{
+	if( m_pluginInterface )
+	{
+		return m_pluginInterface->configuredServerSocketPath();
+	}
+
+	return {};
+}
+
+
+
 VncServer::Password VncServer::password() const
 {
 	if( m_pluginInterface && m_pluginInterface->configuredPassword().isEmpty() == false )
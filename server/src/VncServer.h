@@ -44,6 +44,8 @@ public:
 
 	int serverPort() const;
 
+	QString serverSocketPath() const;
+
 	Password password() const;
 
 private:
@@ -26,6 +26,7 @@
 #include <QHostAddress>
 
 #include "FeatureManager.h"
+#include "FeatureWorkerManager.h"
 #include "FeatureWorkerManagerConnection.h"
 #include "VeyonConfiguration.h"
 
@@ -33,12 +34,15 @@
 FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
 																FeatureManager& featureManager,
 																Feature::Uid featureUid,
+																const QString& token,
 																QObject* parent ) :
 	QObject( parent ),
 	m_worker( worker ),
 	m_featureManager( featureManager ),
 	m_socket( this ),
-	m_featureUid( featureUid )
+	m_featureUid( featureUid ),
+	m_token( token ),
+	m_metricsReportTimer( this )
 {
 	connect( &m_socket, &QTcpSocket::connected,
 			 this, &FeatureWorkerManagerConnection::sendInitMessage );
@@ -49,6 +53,9 @@ FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInter
 	connect( &m_socket, &QTcpSocket::readyRead,
 			 this, &FeatureWorkerManagerConnection::receiveMessage );
 
+	connect( &m_metricsReportTimer, &QTimer::timeout,
+			 this, &FeatureWorkerManagerConnection::sendMetricsReport );
+
 	m_socket.connectToHost( QHostAddress::LocalHost,
 							static_cast<quint16>( VeyonCore::config().featureWorkerManagerPort() + VeyonCore::sessionId() ) );
 }
@@ -57,7 +64,33 @@ FeatureWorkerManagerConnection::FeatureWorkerManagerConnection( VeyonWorkerInter
 
 bool FeatureWorkerManagerConnection::sendMessage( const FeatureMessage& message )
 {
-	return message.send( &m_socket );
+	return message.send( &m_socket, FeatureMessage::Format::Compact );
+}
+
+
+
+void FeatureWorkerManagerConnection::stopFeature( Feature::Uid featureUid )
+{
+	if( isWorkerHost() == false )
+	{
+		QCoreApplication::quit();
+		return;
+	}
+
+	if( m_hostedFeatures.remove( featureUid ) )
+	{
+		vDebug() << featureUid;
+
+		sendMessage( FeatureMessage( m_featureUid, FeatureWorkerManager::FeatureStoppedCommand ).
+					 addArgument( FeatureWorkerManager::FeatureUidArgument, featureUid ) );
+	}
+}
+
+
+
+bool FeatureWorkerManagerConnection::isWorkerHost() const
+{
+	return FeatureWorkerManager::isWorkerHostUid( m_featureUid );
 }
 
 
@@ -66,7 +99,26 @@ void FeatureWorkerManagerConnection::sendInitMessage()
 {
 	vDebug() << m_featureUid;
 
-	FeatureMessage( m_featureUid, FeatureMessage::InitCommand ).send( &m_socket );
+	FeatureMessage( m_featureUid, FeatureMessage::InitCommand ).
+			addArgument( FeatureWorkerManager::TokenArgument, m_token ).
+			send( &m_socket, FeatureMessage::Format::Compact );
+
+	// worker metrics are exported by the server along with its own ones
+	if( VeyonCore::config().metricsEnabled() )
+	{
+		m_metricsReportTimer.start( FeatureWorkerManager::MetricsReportInterval );
+	}
+}
+
+
+
+void FeatureWorkerManagerConnection::sendMetricsReport()
+{
+	const auto snapshot = VeyonCore::metrics().snapshot();
+
+	sendMessage( FeatureMessage( FeatureWorkerManager::metricsReportUid(), FeatureWorkerManager::MetricsReportCommand ).
+				 addArgument( FeatureWorkerManager::ProcessNameArgument, snapshot.first ).
+				 addArgument( FeatureWorkerManager::MetricsArgument, snapshot.second ) );
 }
 
 
@@ -77,9 +129,91 @@ void FeatureWorkerManagerConnection::receiveMessage()
 
 	while( featureMessage.isReadyForReceive( &m_socket ) )
 	{
-		if( featureMessage.receive( &m_socket ) )
+		if( featureMessage.receive( &m_socket ) == false )
+		{
+			continue;
+		}
+
+		if( isWorkerHost() == false )
+		{
+			m_featureManager.handleFeatureMessage( m_worker, featureMessage );
+		}
+		else if( featureMessage.featureUid() == m_featureUid )
+		{
+			handleWorkerHostMessage( featureMessage );
+		}
+		else if( m_hostedFeatures.contains( featureMessage.featureUid() ) )
 		{
 			m_featureManager.handleFeatureMessage( m_worker, featureMessage );
 		}
+		else
+		{
+			vWarning() << "ignoring message for feature not hosted" << featureMessage.featureUid();
+		}
+	}
+}
+
+
+
+void FeatureWorkerManagerConnection::handleWorkerHostMessage( const FeatureMessage& message )
+{
+	const auto featureUid = message.argument( FeatureWorkerManager::FeatureUidArgument ).toUuid();
+
+	switch( message.command() )
+	{
+	case FeatureWorkerManager::StartFeatureCommand:
+		startHostedFeature( featureUid );
+		break;
+
+	case FeatureWorkerManager::StopFeatureCommand:
+		stopHostedFeature( featureUid );
+		break;
+
+	default:
+		vWarning() << "unhandled worker host command" << message.command();
+		break;
+	}
+}
+
+
+
+void FeatureWorkerManagerConnection::startHostedFeature( Feature::Uid featureUid )
+{
+	const auto& feature = m_featureManager.feature( featureUid );
+
+	if( feature.uid() != featureUid ||
+		VeyonCore::config().disabledFeatures().contains( featureUid.toString() ) ||
+		m_featureManager.isWorkerHostable( feature ) == false )
+	{
+		vWarning() << "can't host feature" << featureUid;
+
+		// let server remove its worker entry
+		sendMessage( FeatureMessage( m_featureUid, FeatureWorkerManager::FeatureStoppedCommand ).
+					 addArgument( FeatureWorkerManager::FeatureUidArgument, featureUid ) );
+		return;
+	}
+
+	vInfo() << "Hosting worker for feature" << feature.name();
+
+	m_hostedFeatures.insert( featureUid );
+
+	FeatureMessage( featureUid, FeatureMessage::InitCommand ).send( &m_socket, FeatureMessage::Format::Compact );
+}
+
+
+
+void FeatureWorkerManagerConnection::stopHostedFeature( Feature::Uid featureUid )
+{
+	if( m_hostedFeatures.remove( featureUid ) == false )
+	{
+		return;
+	}
+
+	vInfo() << "Stopping hosted worker for feature" << featureUid;
+
+	// the host process keeps running so the plugin has to release everything otherwise freed on exit
+	if( m_featureManager.stopHostedWorker( m_worker, m_featureManager.feature( featureUid ) ) == false )
+	{
+		vWarning() << "feature" << featureUid << "did not tear down its hosted worker";
 	}
 }
@@ -24,7 +24,9 @@
 
 #pragma once
 
+#include <QSet>
 #include <QTcpSocket>
+#include <QTimer>
 
 #include "Feature.h"
 
@@ -39,18 +41,31 @@ public:
 	FeatureWorkerManagerConnection( VeyonWorkerInterface& worker,
 									FeatureManager& featureManager,
 									Feature::Uid featureUid,
+									const QString& token,
 									QObject* parent = nullptr );
 
 
 	bool sendMessage( const FeatureMessage& message );
 
+	void stopFeature( Feature::Uid featureUid );
+
 private:
+	bool isWorkerHost() const;
+
 	void sendInitMessage();
+	void sendMetricsReport();
 	void receiveMessage();
 
+	void handleWorkerHostMessage( const FeatureMessage& message );
+	void startHostedFeature( Feature::Uid featureUid );
+	void stopHostedFeature( Feature::Uid featureUid );
+
 	VeyonWorkerInterface& m_worker;
 	FeatureManager& m_featureManager;
 	QTcpSocket m_socket;
 	Feature::Uid m_featureUid;
+	const QString m_token;
+	QSet<Feature::Uid> m_hostedFeatures;
+	QTimer m_metricsReportTimer;
 
 } ;
@@ -24,17 +24,29 @@
 
 #include <QCoreApplication>
 
+#include "FeatureWorkerManager.h"
 #include "FeatureWorkerManagerConnection.h"
 #include "VeyonConfiguration.h"
 #include "VeyonWorker.h"
 
 
-VeyonWorker::VeyonWorker( const QString& featureUid, QObject* parent ) :
+VeyonWorker::VeyonWorker( const QString& featureUid, const QString& token, QObject* parent ) :
 	QObject( parent ),
 	m_core( QCoreApplication::instance(),
 			VeyonCore::Component::Worker,
-			QStringLiteral( "FeatureWorker-" ) + VeyonCore::formattedUuid( featureUid ) )
+			( FeatureWorkerManager::isWorkerHostUid( featureUid ) ? QStringLiteral( "FeatureWorkerHost-" ) :
+																	QStringLiteral( "FeatureWorker-" ) ) +
+			VeyonCore::formattedUuid( featureUid ) )
 {
+	if( FeatureWorkerManager::isWorkerHostUid( featureUid ) )
+	{
+		// features are started and stopped on demand through the connection
+		m_workerManagerConnection = new FeatureWorkerManagerConnection( *this, m_featureManager, featureUid, token, this );
+
+		vInfo() << "Running worker host";
+		return;
+	}
+
 	const Feature* workerFeature = nullptr;
 
 	for( const auto& feature : m_featureManager.features() )
@@ -55,7 +67,7 @@ VeyonWorker::VeyonWorker( const QString& featureUid, QObject* parent ) :
 		qFatal( "Specified feature is disabled by configuration!" );
 	}
 
-	m_workerManagerConnection = new FeatureWorkerManagerConnection( *this, m_featureManager, featureUid, this );
+	m_workerManagerConnection = new FeatureWorkerManagerConnection( *this, m_featureManager, featureUid, token, this );
 
 	vInfo() << "Running worker for feature" << workerFeature->name();
 }
@@ -66,3 +78,10 @@ bool VeyonWorker::sendFeatureMessageReply( const FeatureMessage& reply )
 {
 	return m_workerManagerConnection->sendMessage( reply );
 }
+
+
+
+void VeyonWorker::stopFeatureWorker( const QUuid& featureUid )
+{
+	m_workerManagerConnection->stopFeature( featureUid );
+}
@@ -33,10 +33,12 @@ class VeyonWorker : public QObject, VeyonWorkerInterface
 {
 	Q_OBJECT
 public:
-	explicit VeyonWorker( const QString& featureUid, QObject* parent = nullptr );
+	VeyonWorker( const QString& featureUid, const QString& token, QObject* parent = nullptr );
 
 	bool sendFeatureMessageReply( const FeatureMessage& reply ) override;
 
+	void stopFeatureWorker( const QUuid& featureUid ) override;
+
 	VeyonCore& core()
 	{
 		return m_core;
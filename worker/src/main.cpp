@@ -45,7 +45,10 @@ int main( int argc, char **argv )
 		qFatal( "Invalid feature UID given" );
 	}
 
-	VeyonWorker worker( featureUid );
+	// proves to the server that we're the process it started
+	const auto token = arguments.value( 2 );
+
+	VeyonWorker worker( featureUid, token );
 
 	return worker.core().exec();
 }